@@ -15,10 +15,13 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <system_error>
+#include <vector>
 #include "analysis_data_file_handler.hpp"
+#include "analysis_data_table.hpp"
 #include "string_to_uint.hpp"
 
 namespace gobb_analyzer {
@@ -47,15 +50,483 @@ bool AnalysisDataFileHandler::store(Generation generation, const AnalysisStatist
     std::filesystem::path tmpFilePath(tmp_file_path());
 
     std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(fileMagic_, sizeof(fileMagic_));
     ofs.write(reinterpret_cast<const char*>(&stats), sizeof(AnalysisStatistics));
+    if (!write_table(ofs, table, tableSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, filePath);
+}
+
+bool AnalysisDataFileHandler::load(Generation generation, AnalysisStatistics& stats,
+    AnalysisData* table, std::size_t tableSize) const {
+    if (generation > MaxGeneration) {
+        return false;
+    }
+
+    std::filesystem::path filePath(file_path(generation));
+    std::ifstream ifs(filePath, std::ios::binary);
+
+    //
+    // If the file doesn't start with the magic number, it is a file in the legacy format.
+    //
+    char magic[sizeof(fileMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail()) {
+        return false;
+    }
+    bool isLegacy = (std::memcmp(magic, fileMagic_, sizeof(fileMagic_)) != 0);
+    if (isLegacy) {
+        ifs.seekg(0);
+    }
+    ifs.read(reinterpret_cast<char*>(&stats), sizeof(AnalysisStatistics));
+    if (!read_table(ifs, table, tableSize, isLegacy)) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::store_checkpoint(const AnalysisCheckpoint& checkpoint, const AnalysisData* table,
+    std::size_t tableSize) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(checkpointMagic_, sizeof(checkpointMagic_));
+    ofs.write(reinterpret_cast<const char*>(&checkpoint), sizeof(AnalysisCheckpoint));
+    if (!write_table(ofs, table, tableSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, checkpoint_file_path());
+}
+
+bool AnalysisDataFileHandler::find_checkpoint(AnalysisCheckpoint& checkpoint) const {
+    std::ifstream ifs(checkpoint_file_path(), std::ios::binary);
+    return read_checkpoint_header(ifs, checkpoint);
+}
+
+bool AnalysisDataFileHandler::load_checkpoint(AnalysisCheckpoint& checkpoint, AnalysisData* table,
+    std::size_t tableSize) const {
+    std::ifstream ifs(checkpoint_file_path(), std::ios::binary);
+    if (!read_checkpoint_header(ifs, checkpoint) || !read_table(ifs, table, tableSize, false)) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+void AnalysisDataFileHandler::remove_checkpoint() {
+    std::error_code errCode;
+    std::filesystem::remove(checkpoint_file_path(), errCode);
+}
+
+bool AnalysisDataFileHandler::store_wdl(const AnalysisStatistics& stats, bool complete, const std::uint8_t* table,
+    std::size_t tableSize) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(wdlMagic_, sizeof(wdlMagic_));
+    std::uint64_t completeFlag = complete ? 1u : 0u;
+    ofs.write(reinterpret_cast<const char*>(&completeFlag), sizeof(completeFlag));
+    ofs.write(reinterpret_cast<const char*>(&stats), sizeof(AnalysisStatistics));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(table), tableSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, wdl_file_path());
+}
+
+bool AnalysisDataFileHandler::load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+    std::size_t tableSize) const {
+    std::ifstream ifs(wdl_file_path(), std::ios::binary);
+    char magic[sizeof(wdlMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, wdlMagic_, sizeof(wdlMagic_)) != 0) {
+        return false;
+    }
+    std::uint64_t completeFlag;
+    ifs.read(reinterpret_cast<char*>(&completeFlag), sizeof(completeFlag));
+    complete = (completeFlag != 0u);
+    ifs.read(reinterpret_cast<char*>(&stats), sizeof(AnalysisStatistics));
+    if (!read_bytes(ifs, reinterpret_cast<char*>(table), tableSize)) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::store_reachability(const std::uint8_t* bitmap, std::size_t bitmapSize) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(reachabilityMagic_, sizeof(reachabilityMagic_));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(bitmap), bitmapSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, reachability_file_path());
+}
+
+bool AnalysisDataFileHandler::load_reachability(std::uint8_t* bitmap, std::size_t bitmapSize) const {
+    std::ifstream ifs(reachability_file_path(), std::ios::binary);
+    char magic[sizeof(reachabilityMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, reachabilityMagic_, sizeof(reachabilityMagic_)) != 0) {
+        return false;
+    }
+    if (!read_bytes(ifs, reinterpret_cast<char*>(bitmap), bitmapSize)) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::store_opening(const AnalysisStatistics& stats, const std::uint32_t* ids,
+    const AnalysisData* data, std::size_t entryNums) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    std::uint64_t nums = entryNums;
+    ofs.write(openingMagic_, sizeof(openingMagic_));
+    ofs.write(reinterpret_cast<const char*>(&stats), sizeof(AnalysisStatistics));
+    ofs.write(reinterpret_cast<const char*>(&nums), sizeof(nums));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(ids), entryNums * sizeof(std::uint32_t)) ||
+        !write_bytes(ofs, reinterpret_cast<const char*>(data), entryNums * sizeof(AnalysisData))) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, opening_file_path());
+}
+
+bool AnalysisDataFileHandler::load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+    std::vector<AnalysisData>& data) const {
+    std::ifstream ifs(opening_file_path(), std::ios::binary);
+    char magic[sizeof(openingMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, openingMagic_, sizeof(openingMagic_)) != 0) {
+        return false;
+    }
+    std::uint64_t nums;
+    ifs.read(reinterpret_cast<char*>(&stats), sizeof(AnalysisStatistics));
+    ifs.read(reinterpret_cast<char*>(&nums), sizeof(nums));
+    if (ifs.fail() || nums > AnalysisDataTableSize) {
+        return false;
+    }
+
+    ids.resize(nums);
+    data.resize(nums);
+    if (!read_bytes(ifs, reinterpret_cast<char*>(ids.data()), nums * sizeof(std::uint32_t)) ||
+        !read_bytes(ifs, reinterpret_cast<char*>(data.data()), nums * sizeof(AnalysisData))) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::store_best_moves(const std::uint8_t* table, std::size_t tableSize) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(bestMoveMagic_, sizeof(bestMoveMagic_));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(table), tableSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, best_move_file_path());
+}
+
+bool AnalysisDataFileHandler::load_best_moves(std::uint8_t* table, std::size_t tableSize) const {
+    std::ifstream ifs(best_move_file_path(), std::ios::binary);
+    char magic[sizeof(bestMoveMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, bestMoveMagic_, sizeof(bestMoveMagic_)) != 0) {
+        return false;
+    }
+    if (!read_bytes(ifs, reinterpret_cast<char*>(table), tableSize)) {
+        return false;
+    }
+
+    ifs.close();
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::store_late_game(const AnalysisStatistics& stats, int offBoardPieceNums,
+    const std::uint32_t* ids, const AnalysisData* data, std::size_t entryNums) {
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    std::uint32_t pieceNums = static_cast<std::uint32_t>(offBoardPieceNums);
+    std::uint64_t nums = entryNums;
+    ofs.write(lateGameMagic_, sizeof(lateGameMagic_));
+    ofs.write(reinterpret_cast<const char*>(&stats), sizeof(AnalysisStatistics));
+    ofs.write(reinterpret_cast<const char*>(&pieceNums), sizeof(pieceNums));
+    ofs.write(reinterpret_cast<const char*>(&nums), sizeof(nums));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(ids), entryNums * sizeof(std::uint32_t)) ||
+        !write_bytes(ofs, reinterpret_cast<const char*>(data), entryNums * sizeof(AnalysisData))) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, late_game_file_path());
+}
+
+bool AnalysisDataFileHandler::load_late_game(AnalysisStatistics& stats, int& offBoardPieceNums,
+    std::vector<std::uint32_t>& ids, std::vector<AnalysisData>& data) const {
+    std::ifstream ifs(late_game_file_path(), std::ios::binary);
+    char magic[sizeof(lateGameMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, lateGameMagic_, sizeof(lateGameMagic_)) != 0) {
+        return false;
+    }
+    std::uint32_t pieceNums;
+    std::uint64_t nums;
+    ifs.read(reinterpret_cast<char*>(&stats), sizeof(AnalysisStatistics));
+    ifs.read(reinterpret_cast<char*>(&pieceNums), sizeof(pieceNums));
+    ifs.read(reinterpret_cast<char*>(&nums), sizeof(nums));
+    if (ifs.fail() || pieceNums > PieceSetNums || nums > AnalysisDataTableSize) {
+        return false;
+    }
+
+    ids.resize(nums);
+    data.resize(nums);
+    if (!read_bytes(ifs, reinterpret_cast<char*>(ids.data()), nums * sizeof(std::uint32_t)) ||
+        !read_bytes(ifs, reinterpret_cast<char*>(data.data()), nums * sizeof(AnalysisData))) {
+        return false;
+    }
+
+    ifs.close();
+    if (ifs.fail()) {
+        return false;
+    }
+    offBoardPieceNums = static_cast<int>(pieceNums);
+    return true;
+}
+
+bool AnalysisDataFileHandler::store_status_index(Generation generation, const std::uint8_t* image,
+    std::size_t imageSize) {
+    if (generation > MaxGeneration) {
+        return false;
+    }
+    std::error_code errCode;
+    if (!is_directory(dirPath_, errCode) &&
+        !std::filesystem::create_directories(dirPath_, errCode)) {
+        return false;
+    }
+
+    std::filesystem::path tmpFilePath(tmp_file_path());
+    std::ofstream ofs(tmpFilePath, std::ios::binary);
+    ofs.write(statusIndexMagic_, sizeof(statusIndexMagic_));
+    if (!write_bytes(ofs, reinterpret_cast<const char*>(image), imageSize)) {
+        ofs.close();
+        clean();
+        return false;
+    }
+
+    return close_and_rename(ofs, tmpFilePath, status_index_file_path(generation));
+}
+
+bool AnalysisDataFileHandler::map_status_index(Generation generation, MappedFile& mapping) const {
+    if (generation > MaxGeneration || !mapping.open(status_index_file_path(generation))) {
+        return false;
+    }
+    if (mapping.size() < sizeof(statusIndexMagic_) ||
+        std::memcmp(mapping.data(), statusIndexMagic_, sizeof(statusIndexMagic_)) != 0) {
+        mapping.close();
+        return false;
+    }
+    return true;
+}
+
+const std::uint8_t* AnalysisDataFileHandler::mapped_status_index(const MappedFile& mapping,
+    std::size_t& imageSize) noexcept {
+    imageSize = mapping.size() - sizeof(statusIndexMagic_);
+    return mapping.data() + sizeof(statusIndexMagic_);
+}
+
+bool AnalysisDataFileHandler::map(Generation generation, AnalysisStatistics& stats, MappedFile& mapping) const {
+    if (generation > MaxGeneration) {
+        return false;
+    }
+    return map_file(file_path(generation), stats, mapping);
+}
+
+bool AnalysisDataFileHandler::map_file(const std::filesystem::path& path, AnalysisStatistics& stats,
+    MappedFile& mapping) {
+    if (!mapping.open(path)) {
+        return false;
+    }
+    std::size_t tableSize = AnalysisDataTableSize * sizeof(AnalysisData);
+    if (mapping.size() != sizeof(fileMagic_) + sizeof(AnalysisStatistics) + tableSize ||
+        std::memcmp(mapping.data(), fileMagic_, sizeof(fileMagic_)) != 0) {
+        mapping.close();
+        return false;
+    }
+
+    std::memcpy(&stats, mapping.data() + sizeof(fileMagic_), sizeof(AnalysisStatistics));
+    return true;
+}
+
+Generation AnalysisDataFileHandler::map_latest(AnalysisStatistics& stats, MappedFile& mapping) const {
+    Generation latestGeneration = find_latest();
+    if (latestGeneration == InvalidGeneration) {
+        return InvalidGeneration;
+    }
+    if (map(latestGeneration, stats, mapping)) {
+        return latestGeneration;
+    }
+    return InvalidGeneration;
+}
+
+std::filesystem::path AnalysisDataFileHandler::latest_file_path() const {
+    Generation latestGeneration = find_latest();
+    if (latestGeneration == InvalidGeneration) {
+        return std::filesystem::path();
+    }
+    return file_path(latestGeneration);
+}
+
+bool AnalysisDataFileHandler::is_legacy_file(const std::filesystem::path& path) {
+    //
+    // A file in the legacy format has no magic number, and the statistics data are followed by the table.
+    //
+    std::error_code errCode;
+    std::uintmax_t fileSize = std::filesystem::file_size(path, errCode);
+    if (errCode || fileSize != sizeof(AnalysisStatistics) + AnalysisDataTableSize * sizeof(AnalysisData)) {
+        return false;
+    }
+
+    std::ifstream ifs(path, std::ios::binary);
+    char magic[sizeof(fileMagic_)];
+    ifs.read(magic, sizeof(magic));
+    return !ifs.fail() && std::memcmp(magic, fileMagic_, sizeof(fileMagic_)) != 0;
+}
+
+const AnalysisData* AnalysisDataFileHandler::mapped_table(const MappedFile& mapping) noexcept {
+    return reinterpret_cast<const AnalysisData*>(mapping.data() + sizeof(fileMagic_) + sizeof(AnalysisStatistics));
+}
+
+bool AnalysisDataFileHandler::write_bytes(std::ofstream& ofs, const char* data, std::size_t size) {
+    std::size_t writtenSize = 0u;
+    while (writtenSize < size) {
+        std::size_t ioSize = size - writtenSize;
+        if (ioSize > maxIoSize) {
+            ioSize = maxIoSize;
+        }
+        ofs.write(data + writtenSize, ioSize);
+        if (ofs.fail()) {
+            return false;
+        }
+        writtenSize += ioSize;
+    }
+    return true;
+}
+
+bool AnalysisDataFileHandler::read_bytes(std::ifstream& ifs, char* data, std::size_t size) const {
+    std::size_t readSize = 0u;
+    while (readSize < size) {
+        std::size_t ioSize = size - readSize;
+        if (ioSize > maxIoSize) {
+            ioSize = maxIoSize;
+        }
+        ifs.read(data + readSize, ioSize);
+        if (ifs.fail()) {
+            return false;
+        }
+        readSize += ioSize;
+    }
+    return true;
+}
+
+bool AnalysisDataFileHandler::read_checkpoint_header(std::ifstream& ifs, AnalysisCheckpoint& checkpoint) const {
+    char magic[sizeof(checkpointMagic_)];
+    ifs.read(magic, sizeof(magic));
+    if (ifs.fail() || std::memcmp(magic, checkpointMagic_, sizeof(checkpointMagic_)) != 0) {
+        return false;
+    }
+    ifs.read(reinterpret_cast<char*>(&checkpoint), sizeof(AnalysisCheckpoint));
+    return !ifs.fail();
+}
+
+bool AnalysisDataFileHandler::write_table(std::ofstream& ofs, const AnalysisData* table, std::size_t tableSize) {
+    //
+    // Analysis data files are always in the linear layout.  If the table is in the tiled layout,
+    // analysis data are written in the order of position IDs through a buffer.
+    //
+    if (TiledTableLayout && tableSize == AnalysisDataTableSize * sizeof(AnalysisData)) {
+        std::vector<AnalysisData> buffer(maxIoSize / sizeof(AnalysisData));
+        PositionId id = 0u;
+        while (id < AnalysisDataTableSize) {
+            std::size_t nums = buffer.size();
+            if (nums > AnalysisDataTableSize - id) {
+                nums = AnalysisDataTableSize - id;
+            }
+            for (std::size_t i = 0u; i < nums; i++) {
+                buffer[i] = table[table_index(id + i)];
+            }
+            ofs.write(reinterpret_cast<const char*>(buffer.data()), nums * sizeof(AnalysisData));
+            if (ofs.fail()) {
+                return false;
+            }
+            id += nums;
+        }
+        return true;
+    }
 
     const char* p = reinterpret_cast<const char*>(table);
     std::size_t writtenSize = 0u;
     while (writtenSize + maxIoSize < tableSize) {
         ofs.write(p, maxIoSize);
         if (ofs.fail()) {
-            ofs.close();
-            clean();
             return false;
         }
         p += maxIoSize;
@@ -64,37 +535,43 @@ bool AnalysisDataFileHandler::store(Generation generation, const AnalysisStatist
     if (writtenSize < tableSize) {
         ofs.write(p, tableSize - writtenSize);
         if (ofs.fail()) {
-            ofs.close();
-            clean();
             return false;
         }
     }
 
-    ofs.close();
-    if (ofs.fail()) {
-        clean();
-        return false;
-    }
-
-    std::filesystem::rename(tmpFilePath, filePath, errCode);
-    if (static_cast<bool>(errCode)) {
-        clean();
-        return false;
-    }
-
     return true;
 }
 
-bool AnalysisDataFileHandler::load(Generation generation, AnalysisStatistics& stats,
-    AnalysisData* table, std::size_t tableSize) const {
-    if (generation > MaxGeneration) {
-        return false;
+bool AnalysisDataFileHandler::read_table(std::ifstream& ifs, AnalysisData* table, std::size_t tableSize,
+    bool isLegacy) const {
+    //
+    // If the table is in the tiled layout, analysis data in the file (in the linear layout) are read
+    // through a buffer and placed in the table.
+    //
+    if (TiledTableLayout && tableSize == AnalysisDataTableSize * sizeof(AnalysisData)) {
+        std::vector<AnalysisData> buffer(maxIoSize / sizeof(AnalysisData));
+        PositionId id = 0u;
+        while (id < AnalysisDataTableSize) {
+            std::size_t nums = buffer.size();
+            if (nums > AnalysisDataTableSize - id) {
+                nums = AnalysisDataTableSize - id;
+            }
+            ifs.read(reinterpret_cast<char*>(buffer.data()), nums * sizeof(AnalysisData));
+            if (ifs.fail()) {
+                return false;
+            }
+            for (std::size_t i = 0u; i < nums; i++) {
+                if (isLegacy) {
+                    table[table_index(id + i)] = legacy_to_analysisData(buffer[i]);
+                } else {
+                    table[table_index(id + i)] = buffer[i];
+                }
+            }
+            id += nums;
+        }
+        return true;
     }
 
-    std::filesystem::path filePath(file_path(generation));
-    std::ifstream ifs(filePath, std::ios::binary);
-    ifs.read(reinterpret_cast<char*>(&stats), sizeof(AnalysisStatistics));
-
     char* p = reinterpret_cast<char*>(table);
     std::size_t readSize = 0u;
     while (readSize + maxIoSize < tableSize) {
@@ -111,8 +588,29 @@ bool AnalysisDataFileHandler::load(Generation generation, AnalysisStatistics& st
             return false;
         }
     }
-    ifs.close();
-    if (ifs.fail()) {
+
+    if (isLegacy) {
+        std::size_t tableNums = tableSize / sizeof(AnalysisData);
+        for (std::size_t i = 0u; i < tableNums; i++) {
+            table[i] = legacy_to_analysisData(table[i]);
+        }
+    }
+
+    return true;
+}
+
+bool AnalysisDataFileHandler::close_and_rename(std::ofstream& ofs, const std::filesystem::path& tmpFilePath,
+    const std::filesystem::path& filePath) {
+    ofs.close();
+    if (ofs.fail()) {
+        clean();
+        return false;
+    }
+
+    std::error_code errCode;
+    std::filesystem::rename(tmpFilePath, filePath, errCode);
+    if (static_cast<bool>(errCode)) {
+        clean();
         return false;
     }
 
@@ -182,12 +680,47 @@ std::filesystem::path AnalysisDataFileHandler::file_path(Generation generation)
     return dirPath_ / (filePrefix_ + std::to_string(generation) + fileSuffix_);
 }
 
+std::filesystem::path AnalysisDataFileHandler::checkpoint_file_path() const {
+    return dirPath_ / checkpointFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::wdl_file_path() const {
+    return dirPath_ / wdlFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::reachability_file_path() const {
+    return dirPath_ / reachabilityFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::opening_file_path() const {
+    return dirPath_ / openingFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::best_move_file_path() const {
+    return dirPath_ / bestMoveFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::late_game_file_path() const {
+    return dirPath_ / lateGameFile_;
+}
+
+std::filesystem::path AnalysisDataFileHandler::status_index_file_path(Generation generation) const {
+    return dirPath_ / (filePrefix_ + std::to_string(generation) + statusIndexFileSuffix_);
+}
+
 std::filesystem::path AnalysisDataFileHandler::tmp_file_path() const {
     return dirPath_ / tmpFile_;
 }
 
 const std::string AnalysisDataFileHandler::filePrefix_("gobb_analyzer_");
 const std::string AnalysisDataFileHandler::fileSuffix_(".dat");
+const std::string AnalysisDataFileHandler::statusIndexFileSuffix_(".idx");
 const std::string AnalysisDataFileHandler::tmpFile_("gobb_analyer_tmp.dat");
+const std::string AnalysisDataFileHandler::checkpointFile_("gobb_analyzer_checkpoint.dat");
+const std::string AnalysisDataFileHandler::wdlFile_("gobb_analyzer_wdl.dat");
+const std::string AnalysisDataFileHandler::reachabilityFile_("gobb_analyzer_reachable.dat");
+const std::string AnalysisDataFileHandler::openingFile_("gobb_analyzer_opening.dat");
+const std::string AnalysisDataFileHandler::bestMoveFile_("gobb_analyzer_bestmove.dat");
+const std::string AnalysisDataFileHandler::lateGameFile_("gobb_analyzer_lategame.dat");
 const std::string AnalysisDataFileHandler::defaultDir_(".");
 } // namespace gobb_analyzer
@@ -16,16 +16,21 @@
 //
 
 #ifndef GOBB_ANALYZER_ANALYSIS_DATA_FILE_HANDLER_HPP
-#define GOBB_ANALYZER_ANALYSIS_DATA_FILE_HANDLER_H
+#define GOBB_ANALYZER_ANALYSIS_DATA_FILE_HANDLER_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <vector>
 #include "analyzer.hpp"
+#include "mapped_file.hpp"
 
 ///
 /// @file   analysis_data_file_handler.hpp
-/// @brief  Define the class `AnalysisDataFileHandler`, implementation of `AnalysisDataIOHandler`.
+/// @brief  Define the class `AnalysisDataFileHandler`, implementation of `AnalysisDataIOHandler` and
+///         `ExportDataIOHandler`.
 ///
 namespace gobb_analyzer {
 
@@ -35,7 +40,7 @@ namespace gobb_analyzer {
 /// The handler reads and writes files `gobb_analyzer_<generation>.dat` at the specified directory,
 /// where `<generation>` is a generation number of the analysis data.
 ///
-class AnalysisDataFileHandler: public AnalysisDataIOHandler {
+class AnalysisDataFileHandler: public AnalysisDataIOHandler, public ExportDataIOHandler {
 public:
     ///
     /// Default constructor.
@@ -106,6 +111,9 @@ public:
     /// @param   tableSize   the number of elements in `table`.
     /// @return  true upon success.
     ///
+    /// If `table` is a whole table of analysis data in the tiled layout (see `TiledTableLayout`), analysis
+    /// data are written in the order of position IDs, so that files are independent of the table layout.
+    ///
     virtual bool store(Generation generation, const AnalysisStatistics& stats,
         const AnalysisData* table, std::size_t tableSize);
 
@@ -119,6 +127,9 @@ public:
     /// @return  true upon success.
     ///
     /// Upon success, the loaded analysis data and its statistics are written to `table` and `stats`.
+    /// If the file was written by gobb_analyzer 1.0.0 or earlier, the analysis data are converted from
+    /// the legacy encoding.  If `table` is a whole table of analysis data in the tiled layout, the analysis
+    /// data are placed in the table according to the layout.
     ///
     virtual bool load(Generation generation, AnalysisStatistics& stats,
         AnalysisData* table, std::size_t tableSize) const;
@@ -147,12 +158,317 @@ public:
     ///
     virtual Generation load_latest(AnalysisStatistics& stats, AnalysisData* table, std::size_t tableSize) const;
 
+    ///
+    /// Store a checkpoint to the file `gobb_analyzer_checkpoint.dat`.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @param   table       a table of analysis data.
+    /// @param   tableSize   the number of elements in `table`.
+    /// @return  true upon success.
+    ///
+    /// An existing checkpoint file is replaced.
+    ///
+    virtual bool store_checkpoint(const AnalysisCheckpoint& checkpoint, const AnalysisData* table,
+        std::size_t tableSize);
+
+    ///
+    /// Read a checkpoint from the checkpoint file, without analysis data.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @return  true if the checkpoint file is found and read.
+    ///
+    virtual bool find_checkpoint(AnalysisCheckpoint& checkpoint) const;
+
+    ///
+    /// Load a checkpoint and analysis data from the checkpoint file.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @param   table       a table of analysis data.
+    /// @param   tableSize   the number of elements in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_checkpoint(AnalysisCheckpoint& checkpoint, AnalysisData* table,
+        std::size_t tableSize) const;
+
+    ///
+    /// Remove the checkpoint file.
+    ///
+    virtual void remove_checkpoint();
+
+    ///
+    /// Store a table of win/draw/loss values to the file `gobb_analyzer_wdl.dat`.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   complete   false if the analysis has been interrupted.
+    /// @param   table      a table of WDL values, 2 bits per position.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    /// WDL values are indexed by position IDs regardless of the layout of the analysis data table.
+    ///
+    virtual bool store_wdl(const AnalysisStatistics& stats, bool complete, const std::uint8_t* table,
+        std::size_t tableSize);
+
+    ///
+    /// Load a table of win/draw/loss values from the file `gobb_analyzer_wdl.dat`.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   complete   false if the analysis has been interrupted.
+    /// @param   table      a table of WDL values, 2 bits per position.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+        std::size_t tableSize) const;
+
+    ///
+    /// Store a bitmap of reachable positions to the file `gobb_analyzer_reachable.dat`.
+    ///
+    /// @param   bitmap      a bitmap, one bit for each position ID.
+    /// @param   bitmapSize  the number of bytes in `bitmap`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_reachability(const std::uint8_t* bitmap, std::size_t bitmapSize);
+
+    ///
+    /// Load a bitmap of reachable positions from the file `gobb_analyzer_reachable.dat`.
+    ///
+    /// @param   bitmap      a bitmap, one bit for each position ID.
+    /// @param   bitmapSize  the number of bytes in `bitmap`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_reachability(std::uint8_t* bitmap, std::size_t bitmapSize) const;
+
+    ///
+    /// Store an opening database to the file `gobb_analyzer_opening.dat`.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   ids        minimized position IDs of the entries, in ascending order.
+    /// @param   data       analysis data of the entries.
+    /// @param   entryNums  the number of entries.
+    /// @return  true upon success.
+    ///
+    /// The file contains the number of entries, all the position IDs, then all the analysis data.
+    ///
+    virtual bool store_opening(const AnalysisStatistics& stats, const std::uint32_t* ids, const AnalysisData* data,
+        std::size_t entryNums);
+
+    ///
+    /// Load an opening database from the file `gobb_analyzer_opening.dat`.
+    ///
+    /// @param   stats  statistics data.
+    /// @param   ids    minimized position IDs of the entries, in ascending order.
+    /// @param   data   analysis data of the entries.
+    /// @return  true upon success.
+    ///
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const;
+
+    ///
+    /// Store a best-move table to the file `gobb_analyzer_bestmove.dat`.
+    ///
+    /// @param   table      a best-move table, one byte for each position ID.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_best_moves(const std::uint8_t* table, std::size_t tableSize);
+
+    ///
+    /// Load a best-move table from the file `gobb_analyzer_bestmove.dat`.
+    ///
+    /// @param   table      a best-move table, one byte for each position ID.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_best_moves(std::uint8_t* table, std::size_t tableSize) const;
+
+    ///
+    /// Store a late-game database to the file `gobb_analyzer_lategame.dat`.
+    ///
+    /// @param   stats              statistics data.
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board of the entries.
+    /// @param   ids                minimized position IDs of the entries, in ascending order.
+    /// @param   data               analysis data of the entries.
+    /// @param   entryNums          the number of entries.
+    /// @return  true upon success.
+    ///
+    /// The file has the same layout as the opening database, except that the maximum number of pieces off
+    /// the board follows the statistics data.
+    ///
+    virtual bool store_late_game(const AnalysisStatistics& stats, int offBoardPieceNums, const std::uint32_t* ids,
+        const AnalysisData* data, std::size_t entryNums);
+
+    ///
+    /// Load a late-game database from the file `gobb_analyzer_lategame.dat`.
+    ///
+    /// @param   stats              statistics data.
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board of the entries.
+    /// @param   ids                minimized position IDs of the entries, in ascending order.
+    /// @param   data               analysis data of the entries.
+    /// @return  true upon success.
+    ///
+    virtual bool load_late_game(AnalysisStatistics& stats, int& offBoardPieceNums, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const;
+
+    ///
+    /// Store an image of a status index to the file `gobb_analyzer_<GENERATION>.idx`.
+    ///
+    /// @param   generation  the generation of the analysis data indexed.
+    /// @param   image       the image (see `status_index.hpp`).
+    /// @param   imageSize   the number of bytes in `image`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_status_index(Generation generation, const std::uint8_t* image, std::size_t imageSize);
+
+    ///
+    /// Map the status index file of the specified generation into memory.
+    ///
+    /// @param   generation  a generation number.
+    /// @param   mapping     a mapping of the file.
+    /// @return  true upon success.
+    ///
+    /// Use mapped_status_index() to get the image.
+    ///
+    bool map_status_index(Generation generation, MappedFile& mapping) const;
+
+    ///
+    /// Return the image of a status index in a mapped file.
+    ///
+    /// @param   mapping    a mapping by map_status_index().
+    /// @param   imageSize  the number of bytes of the image is put here.
+    /// @return  the image.
+    ///
+    static const std::uint8_t* mapped_status_index(const MappedFile& mapping, std::size_t& imageSize) noexcept;
+
+    ///
+    /// Map the analysis data file of the specified generation into memory.
+    ///
+    /// @param   generation  a generation number.
+    /// @param   stats       statistics data.
+    /// @param   mapping     a mapping of the file.
+    /// @return  true upon success.
+    ///
+    /// Unlike load(), the table is not copied, and processes mapping the same file share it in memory.
+    /// Use mapped_table() to get the table, which is in the linear layout.  Files in the legacy format
+    /// cannot be mapped.
+    ///
+    bool map(Generation generation, AnalysisStatistics& stats, MappedFile& mapping) const;
+
+    ///
+    /// Map the analysis data file of the latest generation into memory.
+    ///
+    /// @param   stats    statistics data.
+    /// @param   mapping  a mapping of the file.
+    /// @return  the generation of the mapped file, or -1 upon failure.
+    ///
+    Generation map_latest(AnalysisStatistics& stats, MappedFile& mapping) const;
+
+    ///
+    /// Map the analysis data file at the specified path into memory.
+    ///
+    /// @param   path     a path to the analysis data file.
+    /// @param   stats    statistics data.
+    /// @param   mapping  a mapping of the file.
+    /// @return  true upon success.
+    ///
+    /// It is the same as map() except that the file is not searched in the data directory.
+    ///
+    static bool map_file(const std::filesystem::path& path, AnalysisStatistics& stats, MappedFile& mapping);
+
+    ///
+    /// Return the path to the analysis data file of the latest generation.
+    ///
+    /// @return  the path, or an empty path if no analysis data file is found.
+    ///
+    std::filesystem::path latest_file_path() const;
+
+    ///
+    /// Test whether a file is an analysis data file in the legacy format.
+    ///
+    /// @param   path  a path to a file.
+    /// @return  true if the file is in the legacy format.
+    ///
+    /// It tells why map_file() fails on a file written by an old version.
+    ///
+    static bool is_legacy_file(const std::filesystem::path& path);
+
+    ///
+    /// Return the table of analysis data in a mapped file.
+    ///
+    /// @param   mapping  a mapping by map() or map_latest().
+    /// @return  the table in the linear layout.
+    ///
+    static const AnalysisData* mapped_table(const MappedFile& mapping) noexcept;
+
     ///
     /// Remove a temporary file.
     ///
     virtual void clean();
 
 private:
+    ///
+    /// Write a table of analysis data to a file in the linear layout.
+    ///
+    /// @param   ofs        an output stream.
+    /// @param   table      a table of analysis data.
+    /// @param   tableSize  the number of elements in `table`.
+    /// @return  true if succeeded.
+    ///
+    bool write_table(std::ofstream& ofs, const AnalysisData* table, std::size_t tableSize);
+
+    ///
+    /// Read a table of analysis data in the linear layout from a file.
+    ///
+    /// @param   ifs        an input stream.
+    /// @param   table      a table of analysis data.
+    /// @param   tableSize  the number of elements in `table`.
+    /// @param   isLegacy   true if analysis data are recorded in the legacy encoding.
+    /// @return  true if succeeded.
+    ///
+    bool read_table(std::ifstream& ifs, AnalysisData* table, std::size_t tableSize, bool isLegacy) const;
+
+    ///
+    /// Read the magic number and a checkpoint from a checkpoint file.
+    ///
+    /// @param   ifs         an input stream.
+    /// @param   checkpoint  a checkpoint.
+    /// @return  true if succeeded.
+    ///
+    bool read_checkpoint_header(std::ifstream& ifs, AnalysisCheckpoint& checkpoint) const;
+
+    ///
+    /// Write bytes to a file, at most `maxIoSize` bytes at a time.
+    ///
+    /// @param   ofs   an output stream.
+    /// @param   data  bytes to be written.
+    /// @param   size  the number of bytes.
+    /// @return  true if succeeded.
+    ///
+    bool write_bytes(std::ofstream& ofs, const char* data, std::size_t size);
+
+    ///
+    /// Read bytes from a file, at most `maxIoSize` bytes at a time.
+    ///
+    /// @param   ifs   an input stream.
+    /// @param   data  a buffer.
+    /// @param   size  the number of bytes.
+    /// @return  true if succeeded.
+    ///
+    bool read_bytes(std::ifstream& ifs, char* data, std::size_t size) const;
+
+    ///
+    /// Close a temporary file being written, and rename it to an analysis data file.
+    ///
+    /// @param   ofs          an output stream of the temporary file.
+    /// @param   tmpFilePath  a path to the temporary file.
+    /// @param   filePath     a path to the analysis data file.
+    /// @return  true if succeeded.
+    ///
+    /// The temporary file is removed if it fails.
+    ///
+    bool close_and_rename(std::ofstream& ofs, const std::filesystem::path& tmpFilePath,
+        const std::filesystem::path& filePath);
+
     ///
     /// Return an absolute path to the analysis data file with the specified generation number.
     ///
@@ -168,6 +484,56 @@ private:
     ///
     std::filesystem::path tmp_file_path() const;
 
+    ///
+    /// Return an absolute path to the checkpoint file.
+    ///
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path checkpoint_file_path() const;
+
+    ///
+    /// Return an absolute path to the WDL file.
+    ///
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path wdl_file_path() const;
+
+    ///
+    /// Return an absolute path to the reachability file.
+    ///
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path reachability_file_path() const;
+
+    ///
+    /// Return an absolute path to the opening database file.
+    ///
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path opening_file_path() const;
+
+    ///
+    /// Return an absolute path to the best-move table file.
+    ///
+    /// @return  a path.
+    ///
+    std::filesystem::path best_move_file_path() const;
+
+    ///
+    /// Return an absolute path to the late-game database file.
+    ///
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path late_game_file_path() const;
+
+    ///
+    /// Return an absolute path to the status index file with the specified generation number.
+    ///
+    /// @param   generation  a generation number.
+    /// @return  an absolute path.
+    ///
+    std::filesystem::path status_index_file_path(Generation generation) const;
+
     /// A path to the directory where analysis data files are stored.
     std::filesystem::path dirPath_;
 
@@ -180,11 +546,65 @@ private:
     /// A file suffix of analysis data files.
     static const std::string fileSuffix_;
 
+    /// A file suffix of status index files.
+    static const std::string statusIndexFileSuffix_;
+
     /// A name of the temporary file (filename only).
     static const std::string tmpFile_;
 
+    /// A name of the checkpoint file (filename only).
+    static const std::string checkpointFile_;
+
+    /// A name of the WDL file (filename only).
+    static const std::string wdlFile_;
+
+    /// A name of the reachability file (filename only).
+    static const std::string reachabilityFile_;
+
+    /// A name of the opening database file (filename only).
+    static const std::string openingFile_;
+
+    /// A name of the best-move table file (filename only).
+    static const std::string bestMoveFile_;
+
+    /// A name of the late-game database file (filename only).
+    static const std::string lateGameFile_;
+
     /// Maximum I/O size in bytes.
     static constexpr std::size_t maxIoSize = 0x100'0000;
+
+    ///
+    /// A magic number at the beginning of analysis data files.
+    ///
+    /// Files written by gobb_analyzer 1.0.0 or earlier have no magic number.  They start with statistics
+    /// data directly, and their analysis data are recorded in the legacy encoding.
+    ///
+    static constexpr char fileMagic_[8] = {'G', 'O', 'B', 'B', 'A', 'D', '0', '2'};
+
+    ///
+    /// A magic number at the beginning of checkpoint files.
+    ///
+    /// Checkpoints of `GOBBCP01` don't record the table layout, and they are not found.
+    ///
+    static constexpr char checkpointMagic_[8] = {'G', 'O', 'B', 'B', 'C', 'P', '0', '2'};
+
+    /// A magic number at the beginning of WDL files.
+    static constexpr char wdlMagic_[8] = {'G', 'O', 'B', 'B', 'W', 'D', 'L', '2'};
+
+    /// A magic number at the beginning of reachability files.
+    static constexpr char reachabilityMagic_[8] = {'G', 'O', 'B', 'B', 'R', 'B', '0', '1'};
+
+    /// A magic number at the beginning of opening database files.
+    static constexpr char openingMagic_[8] = {'G', 'O', 'B', 'B', 'O', 'P', '0', '1'};
+
+    /// A magic number at the beginning of best-move table files.
+    static constexpr char bestMoveMagic_[8] = {'G', 'O', 'B', 'B', 'B', 'M', '0', '1'};
+
+    /// A magic number at the beginning of late-game database files.
+    static constexpr char lateGameMagic_[8] = {'G', 'O', 'B', 'B', 'L', 'G', '0', '1'};
+
+    /// A magic number at the beginning of status index files.
+    static constexpr char statusIndexMagic_[8] = {'G', 'O', 'B', 'B', 'I', 'X', '0', '1'};
 };
 
 } // namespace gobb_analyzer
@@ -0,0 +1,303 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fmt/core.h>
+#include "analysis_data_table.hpp"
+
+#if defined(HAVE_SYS_MMAN_H)
+extern "C" {
+#include <sys/mman.h>
+}
+#endif
+
+#if defined(__linux__) && defined(HAVE_LINUX_MEMPOLICY_H)
+extern "C" {
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+#define GOBB_ANALYZER_USE_MBIND
+#endif
+
+namespace gobb_analyzer {
+
+namespace {
+
+///
+/// The size of a huge page.
+///
+/// The size of a mapping is rounded up to a multiple of it, as required by `MAP_HUGETLB`.
+///
+constexpr std::size_t hugePageSize = 0x20'0000u;
+
+///
+/// The maximum number of NUMA nodes we handle.
+///
+constexpr int maxNumaNodeNums = 64;
+
+///
+/// Return the size of the mapping for a table.
+///
+/// @param   size  the number of elements in the table.
+/// @return  the size of the mapping in bytes.
+///
+std::size_t mapping_size(std::size_t size) noexcept {
+    std::size_t bytes = size * sizeof(AnalysisData);
+    return (bytes + hugePageSize - 1u) / hugePageSize * hugePageSize;
+}
+
+///
+/// Read a list of numbers in sysfs.
+///
+/// @param   path  the path of the file.
+/// @return  the numbers in ascending order.
+///
+/// A list of Linux (e.g. "0-1,3") is read.  It returns an empty vector if the file is not available.
+///
+std::vector<int> read_sysfs_list(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string list;
+    std::vector<int> result;
+    if (!std::getline(ifs, list)) {
+        return result;
+    }
+
+    std::size_t index = 0u;
+    while (index < list.size()) {
+        char* end;
+        long first = std::strtol(list.c_str() + index, &end, 10);
+        long last = first;
+        if (end == list.c_str() + index) {
+            break;
+        }
+        index = end - list.c_str();
+        if (index < list.size() && list[index] == '-') {
+            last = std::strtol(list.c_str() + index + 1u, &end, 10);
+            index = end - list.c_str();
+        }
+        for (long i = (first < 0) ? 0 : first; i <= last; i++) {
+            result.push_back(static_cast<int>(i));
+        }
+        if (index < list.size() && list[index] != ',') {
+            break;
+        }
+        index++;
+    }
+    return result;
+}
+
+///
+/// Read a bitmask of NUMA nodes online.
+///
+/// @return  a bitmask of the nodes.
+///
+/// It returns 0 if the list is not available.
+///
+unsigned long long online_numa_node_mask() {
+    unsigned long long mask = 0u;
+    for (int node: online_numa_nodes()) {
+        mask |= 1ull << node;
+    }
+    return mask;
+}
+
+///
+/// Return the size of a block in the `TableNumaMode::Block` placement.
+///
+/// @param   size          the number of elements in the table.
+/// @param   numaNodeNums  the number of NUMA nodes.
+/// @return  the size of a block in bytes, a multiple of the huge page size.
+///
+std::size_t numa_block_size(std::size_t size, int numaNodeNums) noexcept {
+    std::size_t pageNums = mapping_size(size) / hugePageSize;
+    return (pageNums + numaNodeNums - 1u) / numaNodeNums * hugePageSize;
+}
+
+} // namespace
+
+std::string tablePlacement_to_string(const TablePlacement& placement) {
+    std::string pages;
+    switch (placement.pageMode) {
+    case TablePageMode::HugeTLB:
+        pages = "huge pages (hugetlbfs)";
+        break;
+    case TablePageMode::TransparentHugePages:
+        pages = "transparent huge pages";
+        break;
+    default:
+        pages = "normal pages";
+        break;
+    }
+
+    if (placement.shared) {
+        pages += " shared between processes";
+    }
+
+    if (placement.numaMode == TableNumaMode::Interleave) {
+        return fmt::format("{}, interleaved across {} NUMA nodes", pages, placement.numaNodeNums);
+    } else if (placement.numaMode == TableNumaMode::Block) {
+        return fmt::format("{}, divided into blocks on {} NUMA nodes", pages, placement.numaNodeNums);
+    } else {
+        return fmt::format("{}, default NUMA policy ({} NUMA node(s) online)", pages, placement.numaNodeNums);
+    }
+}
+
+std::vector<int> online_numa_nodes() {
+    std::vector<int> nodes = read_sysfs_list("/sys/devices/system/node/online");
+    while (!nodes.empty() && nodes.back() >= maxNumaNodeNums) {
+        nodes.pop_back();
+    }
+    return nodes;
+}
+
+int numa_node_nums() noexcept {
+    try {
+        std::size_t nums = online_numa_nodes().size();
+        return (nums == 0u) ? 1 : static_cast<int>(nums);
+    } catch (...) {
+        return 1;
+    }
+}
+
+std::vector<int> numa_node_cpus(int node) {
+    return read_sysfs_list(fmt::format("/sys/devices/system/node/node{}/cpulist", node));
+}
+
+int numa_block_of_table_index(std::size_t index, std::size_t size, int numaNodeNums) noexcept {
+    if (numaNodeNums <= 1) {
+        return 0;
+    }
+    return static_cast<int>(index * sizeof(AnalysisData) / numa_block_size(size, numaNodeNums));
+}
+
+AnalysisData* allocate_analysisDataTable(std::size_t size, const TablePlacementPolicy& policy,
+    TablePlacement* placement) {
+    static_assert(UnfixedAnalysisData == 0u, "the table relies on zero-filled memory");
+    TablePlacement result;
+    result.numaNodeNums = numa_node_nums();
+
+#if defined(HAVE_SYS_MMAN_H)
+    std::size_t length = mapping_size(size);
+    void* table = MAP_FAILED;
+    int sharingFlag = policy.shared ? MAP_SHARED : MAP_PRIVATE;
+    result.shared = policy.shared;
+
+#if defined(MAP_HUGETLB)
+    if (policy.pageMode == TablePageMode::Auto || policy.pageMode == TablePageMode::HugeTLB) {
+        table = mmap(nullptr, length, PROT_READ | PROT_WRITE, sharingFlag | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (table != MAP_FAILED) {
+            result.pageMode = TablePageMode::HugeTLB;
+        } else if (policy.pageMode == TablePageMode::HugeTLB) {
+            throw std::system_error(errno, std::generic_category(), "failed to map the table on hugetlbfs");
+        }
+    }
+#else
+    if (policy.pageMode == TablePageMode::HugeTLB) {
+        throw std::system_error(std::make_error_code(std::errc::not_supported), "hugetlbfs is not supported");
+    }
+#endif
+
+    if (table == MAP_FAILED) {
+        table = mmap(nullptr, length, PROT_READ | PROT_WRITE, sharingFlag | MAP_ANONYMOUS, -1, 0);
+        if (table == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        result.pageMode = TablePageMode::Normal;
+
+#if defined(MADV_HUGEPAGE)
+        if (policy.pageMode != TablePageMode::Normal && madvise(table, length, MADV_HUGEPAGE) == 0) {
+            result.pageMode = TablePageMode::TransparentHugePages;
+        }
+#endif
+    }
+
+#if defined(GOBB_ANALYZER_USE_MBIND)
+    //
+    // The memory policy must be set before the pages are touched.
+    // Since the table is zero-filled on demand, no page has been touched yet.
+    //
+    constexpr std::size_t maskBits = 8 * sizeof(unsigned long);
+    if (policy.numaMode == TableNumaMode::Interleave && result.numaNodeNums >= 2) {
+        unsigned long long nodeMask = online_numa_node_mask();
+        unsigned long mbindMask[maxNumaNodeNums / maskBits] = {};
+        for (int node = 0; node < maxNumaNodeNums; node++) {
+            if ((nodeMask >> node) & 1u) {
+                mbindMask[node / maskBits] |= 1ul << (node % maskBits);
+            }
+        }
+        if (syscall(SYS_mbind, table, length, MPOL_INTERLEAVE, mbindMask, maxNumaNodeNums + 1, 0) == 0) {
+            result.numaMode = TableNumaMode::Interleave;
+        }
+    } else if (policy.numaMode == TableNumaMode::Block && result.numaNodeNums >= 2) {
+        //
+        // The block K prefers the K'th node online.  Pages go to another node when the node is full.
+        //
+        std::vector<int> nodes = online_numa_nodes();
+        std::size_t blockSize = numa_block_size(size, result.numaNodeNums);
+        bool succeeded = true;
+        for (std::size_t k = 0u; k < nodes.size() && k * blockSize < length; k++) {
+            unsigned long mbindMask[maxNumaNodeNums / maskBits] = {};
+            mbindMask[nodes[k] / maskBits] |= 1ul << (nodes[k] % maskBits);
+            std::size_t blockLength = (length - k * blockSize < blockSize) ? length - k * blockSize : blockSize;
+            if (syscall(SYS_mbind, static_cast<char*>(table) + k * blockSize, blockLength, MPOL_PREFERRED,
+                mbindMask, maxNumaNodeNums + 1, 0) != 0) {
+                succeeded = false;
+            }
+        }
+        if (succeeded) {
+            result.numaMode = TableNumaMode::Block;
+        }
+    }
+#endif
+
+#else
+    if (policy.pageMode == TablePageMode::HugeTLB) {
+        throw std::system_error(std::make_error_code(std::errc::not_supported), "hugetlbfs is not supported");
+    }
+    void* table = std::calloc(size, sizeof(AnalysisData));
+    if (table == nullptr) {
+        throw std::bad_alloc();
+    }
+#endif
+
+    if (placement != nullptr) {
+        *placement = result;
+    }
+    return static_cast<AnalysisData*>(table);
+}
+
+void free_analysisDataTable(AnalysisData* table, std::size_t size) noexcept {
+    if (table == nullptr) {
+        return;
+    }
+
+#if defined(HAVE_SYS_MMAN_H)
+    munmap(table, mapping_size(size));
+#else
+    static_cast<void>(size);
+    std::free(table);
+#endif
+}
+
+} // namespace gobb_analyzer
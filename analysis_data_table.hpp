@@ -0,0 +1,291 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_ANALYSIS_DATA_TABLE_HPP
+#define GOBB_ANALYZER_ANALYSIS_DATA_TABLE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "analyzer.hpp"
+
+///
+/// @file   analysis_data_table.hpp
+/// @brief  Define the layout of a table of analysis data, and functions to allocate and free the table.
+///
+namespace gobb_analyzer {
+
+///
+/// Whether the table of analysis data is in the tiled layout.
+///
+/// The layout is selected at build time (CMake option `TILED_TABLE_LAYOUT`).  In the linear layout, an
+/// element of a position is placed at the index equal to the position ID.  In the tiled layout, the table
+/// is divided into tiles of `TableTileLargeNums` x `TableTileMediumNums` x `TableTileSmallNums`
+/// positions in terms of the (large, medium, small) quad indices of the position ID, and positions in a tile
+/// are placed together.  Positions whose quad indices are close to each other, such as positions
+/// reached by moving a large piece, are likely to share a page.
+///
+/// The layout affects only the table in memory.  Analysis data files are always in the linear layout.
+///
+#ifdef GOBB_TILED_TABLE_LAYOUT
+constexpr bool TiledTableLayout = true;
+#else
+constexpr bool TiledTableLayout = false;
+#endif
+
+/// The number of large quad indices in a tile.  777 large quad indices covered by tiles are its multiple.
+constexpr std::size_t TableTileLargeNums = 7u;
+
+/// The number of medium quad indices in a tile.
+constexpr std::size_t TableTileMediumNums = 16u;
+
+/// The number of small quad indices in a tile.
+constexpr std::size_t TableTileSmallNums = 16u;
+
+///
+/// The number of positions covered by tiles.
+///
+/// Positions with position IDs equal to or greater than it are placed in the linear layout.
+///
+constexpr std::size_t TiledTableSize = 777u * PieceQuadCombinationNums * PieceQuadCombinationNums;
+
+///
+/// Return an index of the table in the tiled layout.
+///
+/// @param   id  a position ID less than `AnalysisDataTableSize`.
+/// @return  the index where analysis data of the position is placed.
+///
+inline std::size_t tiled_table_index(PositionId id) noexcept {
+    constexpr std::size_t q = PieceQuadCombinationNums;
+    if (id >= TiledTableSize) {
+        return id;
+    }
+
+    std::size_t large = id / (q * q);
+    std::size_t medium = (id / q) % q;
+    std::size_t small = id % q;
+
+    std::size_t mediumBlock = medium / TableTileMediumNums;
+    std::size_t smallBlock = small / TableTileSmallNums;
+    std::size_t tileMediumNums = q - mediumBlock * TableTileMediumNums;
+    if (tileMediumNums > TableTileMediumNums) {
+        tileMediumNums = TableTileMediumNums;
+    }
+    std::size_t tileSmallNums = q - smallBlock * TableTileSmallNums;
+    if (tileSmallNums > TableTileSmallNums) {
+        tileSmallNums = TableTileSmallNums;
+    }
+
+    return (large / TableTileLargeNums) * TableTileLargeNums * q * q
+        + mediumBlock * TableTileLargeNums * TableTileMediumNums * q
+        + smallBlock * TableTileLargeNums * tileMediumNums * TableTileSmallNums
+        + ((large % TableTileLargeNums) * tileMediumNums + medium % TableTileMediumNums) * tileSmallNums
+        + small % TableTileSmallNums;
+}
+
+///
+/// Return a position ID placed at an index of the table in the tiled layout.
+///
+/// @param   index  an index of the table less than `AnalysisDataTableSize`.
+/// @return  the position ID.
+///
+/// It is the inverse of `tiled_table_index()`.
+///
+inline PositionId tiled_table_index_to_id(std::size_t index) noexcept {
+    constexpr std::size_t q = PieceQuadCombinationNums;
+    if (index >= TiledTableSize) {
+        return static_cast<PositionId>(index);
+    }
+
+    std::size_t largeBlock = index / (TableTileLargeNums * q * q);
+    std::size_t rest = index % (TableTileLargeNums * q * q);
+    std::size_t mediumBlock = rest / (TableTileLargeNums * TableTileMediumNums * q);
+    rest %= TableTileLargeNums * TableTileMediumNums * q;
+
+    std::size_t tileMediumNums = q - mediumBlock * TableTileMediumNums;
+    if (tileMediumNums > TableTileMediumNums) {
+        tileMediumNums = TableTileMediumNums;
+    }
+    std::size_t smallBlock = rest / (TableTileLargeNums * tileMediumNums * TableTileSmallNums);
+    rest %= TableTileLargeNums * tileMediumNums * TableTileSmallNums;
+    std::size_t tileSmallNums = q - smallBlock * TableTileSmallNums;
+    if (tileSmallNums > TableTileSmallNums) {
+        tileSmallNums = TableTileSmallNums;
+    }
+
+    std::size_t large = largeBlock * TableTileLargeNums + rest / (tileSmallNums * tileMediumNums);
+    std::size_t medium = mediumBlock * TableTileMediumNums + (rest / tileSmallNums) % tileMediumNums;
+    std::size_t small = smallBlock * TableTileSmallNums + rest % tileSmallNums;
+    return static_cast<PositionId>(large * q * q + medium * q + small);
+}
+
+///
+/// Return an index of the table where analysis data of a position is placed.
+///
+/// @param   id  a position ID less than `AnalysisDataTableSize`.
+/// @return  the index of the table.
+///
+inline std::size_t table_index(PositionId id) noexcept {
+    if constexpr (TiledTableLayout) {
+        return tiled_table_index(id);
+    } else {
+        return id;
+    }
+}
+
+///
+/// Return a position ID whose analysis data is placed at an index of the table.
+///
+/// @param   index  an index of the table less than `AnalysisDataTableSize`.
+/// @return  the position ID.
+///
+inline PositionId table_index_to_id(std::size_t index) noexcept {
+    if constexpr (TiledTableLayout) {
+        return tiled_table_index_to_id(index);
+    } else {
+        return static_cast<PositionId>(index);
+    }
+}
+
+///
+/// Return a name of the table layout in effect.
+///
+/// @return  "tiled" or "linear".
+///
+inline const char* tableLayout_name() noexcept {
+    return TiledTableLayout ? "tiled" : "linear";
+}
+
+///
+/// Kinds of pages backing a table of analysis data.
+///
+enum class TablePageMode {
+    Auto                 = 0,  ///< Try `HugeTLB`, `TransparentHugePages` and `Normal` in this order.
+    HugeTLB              = 1,  ///< Pages of hugetlbfs (`MAP_HUGETLB`).
+    TransparentHugePages = 2,  ///< Transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+    Normal               = 3   ///< Normal pages.
+};
+
+///
+/// Placement of a table of analysis data across NUMA nodes.
+///
+enum class TableNumaMode {
+    Interleave = 0,  ///< Interleave pages across all NUMA nodes, if two or more nodes are online.
+    None       = 1,  ///< Follow the default memory policy of the process.
+    Block      = 2   ///< Divide the table into contiguous blocks, one for each NUMA node online.
+};
+
+///
+/// How to place a table of analysis data in memory.
+///
+struct TablePlacementPolicy {
+    TablePageMode pageMode = TablePageMode::Auto;       ///< kinds of pages.
+    TableNumaMode numaMode = TableNumaMode::Interleave;  ///< placement across NUMA nodes.
+    bool shared = false;                                 ///< share the table with child processes.
+};
+
+///
+/// Placement of a table of analysis data actually in effect.
+///
+struct TablePlacement {
+    TablePageMode pageMode = TablePageMode::Normal;  ///< kinds of pages (never `Auto`).
+    TableNumaMode numaMode = TableNumaMode::None;    ///< placement across NUMA nodes.
+    int numaNodeNums = 1;                            ///< the number of NUMA nodes online.
+    bool shared = false;                             ///< whether the table is shared with child processes.
+};
+
+///
+/// Return a description of the table placement.
+///
+/// @param   placement  placement of a table.
+/// @return  a description such as "transparent huge pages, interleaved across 2 NUMA nodes".
+///
+std::string tablePlacement_to_string(const TablePlacement& placement);
+
+///
+/// Return the number of NUMA nodes online.
+///
+/// @return  the number of NUMA nodes.
+///
+/// It returns 1 if the number is not available on the system.
+///
+int numa_node_nums() noexcept;
+
+///
+/// Return the NUMA nodes online.
+///
+/// @return  the node numbers in ascending order.
+///
+/// It returns an empty vector if the nodes are not available on the system.
+///
+std::vector<int> online_numa_nodes();
+
+///
+/// Return the CPUs of a NUMA node.
+///
+/// @param   node  a node number.
+/// @return  the CPU numbers in ascending order.
+///
+/// It returns an empty vector if the CPUs are not available on the system.
+///
+std::vector<int> numa_node_cpus(int node);
+
+///
+/// Return the block of a table index in the `TableNumaMode::Block` placement.
+///
+/// @param   index         an index of the table.
+/// @param   size          the number of elements in the table.
+/// @param   numaNodeNums  the number of NUMA nodes online.
+/// @return  K if the index is in the block K, which prefers the K'th node returned by `online_numa_nodes()`.
+///
+int numa_block_of_table_index(std::size_t index, std::size_t size, int numaNodeNums) noexcept;
+
+///
+/// Allocate a table of analysis data.
+///
+/// @param   size       the number of elements in the table.
+/// @param   policy     how to place the table in memory.
+/// @param   placement  if not `nullptr`, the placement actually in effect is written to it.
+/// @return  a pointer to the allocated table.
+///
+/// All elements of the table are set to `UnfixedAnalysisData` (zero).
+/// The function gets the memory as an anonymous mapping if available, so that pages of the table are
+/// zero-filled by the operating system on demand, without touching all of them in advance.
+/// Huge pages and NUMA placement are requested only where the system supports them.  If a request
+/// is refused, the function falls back to the next kind of pages in the order of `TablePageMode::Auto`,
+/// except that an explicit request of `TablePageMode::HugeTLB` never falls back.
+/// If `policy.shared` is true, the table is mapped as shared memory, so that child processes created by
+/// `fork()` afterwards read and write the same table.  It is not available without `mmap()`.
+/// It throws `std::bad_alloc` if it fails to allocate the memory, and `std::system_error` if
+/// `TablePageMode::HugeTLB` is requested but the pages of hugetlbfs are not available.
+///
+AnalysisData* allocate_analysisDataTable(std::size_t size, const TablePlacementPolicy& policy = {},
+    TablePlacement* placement = nullptr);
+
+///
+/// Free a table of analysis data.
+///
+/// @param   table  a pointer to the table returned from `allocate_analysisDataTable()`.
+/// @param   size   the number of elements in the table.
+///
+/// It does nothing if `table` is `nullptr`.
+///
+void free_analysisDataTable(AnalysisData* table, std::size_t size) noexcept;
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_ANALYSIS_DATA_TABLE_HPP
@@ -0,0 +1,94 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <system_error>
+#include <vector>
+#include "analysis_data_table.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test tiled_table_index(PositionId id) and tiled_table_index_to_id(std::size_t index).
+//
+TEST(AnalysisDataTableTest, TiledTableIndex) {
+    constexpr std::size_t q = PieceQuadCombinationNums;
+
+    // The tiled layout is a permutation within each range of TableTileLargeNums large quad indices.
+    for (std::size_t largeBlock: {std::size_t{0u}, std::size_t{110u}}) {
+        std::size_t first = largeBlock * TableTileLargeNums * q * q;
+        std::size_t last = first + TableTileLargeNums * q * q;
+        std::vector<bool> used(last - first, false);
+
+        for (PositionId id = first; id < last; id++) {
+            std::size_t index = tiled_table_index(id);
+            ASSERT_GE(index, first);
+            ASSERT_LT(index, last);
+            ASSERT_FALSE(used[index - first]);
+            used[index - first] = true;
+            ASSERT_EQ(id, tiled_table_index_to_id(index));
+        }
+    }
+
+    // Positions in a tile are placed together.
+    ASSERT_EQ(0u, tiled_table_index(0u));
+    ASSERT_EQ(1u, tiled_table_index(1u));
+    ASSERT_EQ(TableTileSmallNums, tiled_table_index(q));
+    ASSERT_EQ(TableTileSmallNums * TableTileMediumNums, tiled_table_index(q * q));
+
+    // Positions out of tiles are placed in the linear layout.
+    for (PositionId id = TiledTableSize; id < AnalysisDataTableSize; id++) {
+        ASSERT_EQ(id, tiled_table_index(id));
+        ASSERT_EQ(id, tiled_table_index_to_id(id));
+    }
+}
+
+//
+// Test allocate_analysisDataTable() with TablePageMode::HugeTLB.
+//
+TEST(AnalysisDataTableTest, AllocateHugeTlbNeverFallsBack) {
+    constexpr std::size_t size = 0x1000u;
+    TablePlacementPolicy policy;
+    policy.pageMode = TablePageMode::HugeTLB;
+    policy.numaMode = TableNumaMode::None;
+
+    // Either the table is on hugetlbfs, or the allocation fails; it never falls back silently.
+    TablePlacement placement;
+    AnalysisData* table = nullptr;
+    try {
+        table = allocate_analysisDataTable(size, policy, &placement);
+    } catch (const std::system_error&) {
+        return;
+    }
+    EXPECT_EQ(placement.pageMode, TablePageMode::HugeTLB);
+    EXPECT_EQ(table[size - 1u], UnfixedAnalysisData);
+    free_analysisDataTable(table, size);
+}
+
+TEST(AnalysisDataTableTest, AllocateNormal) {
+    constexpr std::size_t size = 0x1000u;
+    TablePlacementPolicy policy;
+    policy.pageMode = TablePageMode::Normal;
+    policy.numaMode = TableNumaMode::None;
+
+    TablePlacement placement;
+    AnalysisData* table = allocate_analysisDataTable(size, policy, &placement);
+    EXPECT_EQ(placement.pageMode, TablePageMode::Normal);
+    EXPECT_EQ(table[0], UnfixedAnalysisData);
+    EXPECT_EQ(table[size - 1u], UnfixedAnalysisData);
+    free_analysisDataTable(table, size);
+}
@@ -15,7 +15,28 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
 #include "analyzer.hpp"
+#include "analysis_data_table.hpp"
+#include "reachability.hpp"
+#include "run_threads.hpp"
+#include "thread_affinity.hpp"
+#include "thread_barrier.hpp"
+
+#if defined(HAVE_UNISTD_H) && defined(HAVE_SYS_WAIT_H)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace gobb_analyzer {
 
@@ -78,6 +99,12 @@ void AnalysisStatistics::add(const AnalysisStatistics& other) noexcept {
 AnalysisDataIOHandler::~AnalysisDataIOHandler() {
 }
 
+//
+// Class ExportDataIOHandler.
+//
+ExportDataIOHandler::~ExportDataIOHandler() {
+}
+
 //
 // Class AnalysisLogger.
 //
@@ -88,25 +115,127 @@ AnalysisLogger::~AnalysisLogger() {
 // Class Analyzer.
 //
 Analyzer::Analyzer(AnalysisLogger& logger)
+    : Analyzer(logger, TablePlacementPolicy()) {
+}
+
+Analyzer::Analyzer(AnalysisLogger& logger, const TablePlacementPolicy& placementPolicy)
     : generation_(InvalidGeneration),
       storedGeneration_(InvalidGeneration),
       analysisDataTable_(nullptr),
+      previousTable_(nullptr),
+      pageMode_(placementPolicy.pageMode),
+      numaMode_(placementPolicy.numaMode),
       statistics_(),
+      tableInBlocks_(false),
+      threadAffinity_(false),
+      prefetchDepth_(DefaultPrefetchDepth),
+      prefetchEntries_(MaxPrefetchDepth + 1u),
+      strategy_(AnalysisStrategy::Serial),
+      threadNums_(1),
+      shardNums_(1),
+      workDir_("."),
+      shardWorkers_(),
+      tableShared_(false),
+      cursor_(0u),
+      generationStats_(),
+      generationUpdated_(false),
+      stopFlag_(nullptr),
+      checkpointInterval_(0),
+      lastCheckpointTime_(),
+      interrupted_(false),
+      reachabilityFilter_(false),
       logger_(logger) {
-    analysisDataTable_ = new AnalysisData [AnalysisDataTableSize];
+    TablePlacement placement;
+    analysisDataTable_ = allocate_analysisDataTable(AnalysisDataTableSize, placementPolicy, &placement);
+    tableInBlocks_ = (placement.numaMode == TableNumaMode::Block);
+    tableShared_ = placement.shared;
+    logger_.notice("analysis data table: {} layout, {}.", tableLayout_name(), tablePlacement_to_string(placement));
 }
 
 Analyzer::~Analyzer() {
-    delete[] analysisDataTable_;
+    stop_shard_workers();
+    free_analysisDataTable(previousTable_, AnalysisDataTableSize);
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
+}
+
+void Analyzer::set_thread_affinity(bool enabled) noexcept {
+    threadAffinity_ = enabled;
+}
+
+void Analyzer::set_prefetch_depth(std::size_t depth) noexcept {
+    if (depth < 1u) {
+        prefetchDepth_ = 1u;
+    } else if (depth > MaxPrefetchDepth) {
+        prefetchDepth_ = MaxPrefetchDepth;
+    } else {
+        prefetchDepth_ = depth;
+    }
+}
+
+void Analyzer::set_strategy(AnalysisStrategy strategy) noexcept {
+    strategy_ = strategy;
+}
+
+void Analyzer::set_thread_nums(int threadNums) noexcept {
+    if (threadNums < 1) {
+        threadNums_ = 1;
+    } else {
+        threadNums_ = threadNums;
+    }
+}
+
+void Analyzer::set_shard_nums(int shardNums) noexcept {
+    if (shardNums < 1) {
+        shardNums_ = 1;
+    } else if (shardNums > MaxShardNums) {
+        shardNums_ = MaxShardNums;
+    } else {
+        shardNums_ = shardNums;
+    }
+}
+
+void Analyzer::set_work_directory(const std::string& dirName) {
+    workDir_ = dirName;
+}
+
+void Analyzer::set_stop_flag(const volatile std::sig_atomic_t* stopFlag) noexcept {
+    stopFlag_ = stopFlag;
+}
+
+void Analyzer::set_checkpoint_interval(std::chrono::seconds interval) noexcept {
+    checkpointInterval_ = interval;
+}
+
+bool Analyzer::interrupted() const noexcept {
+    return interrupted_;
+}
+
+void Analyzer::set_reachability_filter(bool enabled) noexcept {
+    reachabilityFilter_ = enabled;
 }
 
 bool Analyzer::start(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode) {
     generation_ = 0u;
+    cursor_ = 0u;
+    generationStats_.clear();
+    generationUpdated_ = false;
+    handler.remove_checkpoint();
+    std::unique_ptr<ReachabilityBitmap> reachable;
+    if (reachabilityFilter_) {
+        reachable.reset(new ReachabilityBitmap());
+        if (!compute_reachability(handler, *reachable)) {
+            return false;
+        }
+    }
+
     logger_.notice("start the generation 0 (initialization).");
-    if (!initialize()) {
+    auto startTime = std::chrono::steady_clock::now();
+    if (!initialize(reachable.get())) {
         return false;
     }
+    reachable.reset();
     log_statistics(0, statistics_);
+    log_elapsed_time(0, startTime);
 
     if (ioMode == AnalysisDataIOMode::StoreEveryGenerations) {
         if (!handler.store(0u, statistics_, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData))) {
@@ -123,6 +252,20 @@ bool Analyzer::start(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode)
 
 bool Analyzer::resume(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode) {
     Generation generation = handler.find_latest();
+
+    //
+    // A checkpoint is used only if it is newer than the latest analysis data.
+    //
+    AnalysisCheckpoint checkpoint;
+    if (handler.find_checkpoint(checkpoint)) {
+        if (generation == InvalidGeneration || checkpoint.generation > generation) {
+            logger_.notice("found the checkpoint in the generation {}.", static_cast<int>(checkpoint.generation));
+            return resume(handler, ioMode, checkpoint, generation);
+        }
+        logger_.notice("ignore the checkpoint in the generation {} older than the stored analysis data.",
+            static_cast<int>(checkpoint.generation));
+    }
+
     if (generation == InvalidGeneration) {
         logger_.warn("no analysis data found.");
         return start(handler, ioMode);
@@ -142,14 +285,132 @@ bool Analyzer::resume(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode,
     return analyze(handler, ioMode);
 }
 
+bool Analyzer::resume(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode, const AnalysisCheckpoint& checkpoint,
+    Generation storedGeneration) {
+    //
+    // A cursor in the middle of a generation is meaningful only to the strategy which wrote it.
+    //
+    if (checkpoint.cursor != 0u &&
+        (checkpoint.strategy != strategy_ ||
+            (strategy_ == AnalysisStrategy::Bucket && checkpoint.threadNums != static_cast<std::uint32_t>(threadNums_)))) {
+        logger_.error("the checkpoint was written by another strategy or number of threads.");
+        return false;
+    }
+
+    //
+    // A cursor is a table index, so that it also depends on the layout of the table built in.
+    //
+    if (checkpoint.cursor != 0u && checkpoint.tiledLayout != TiledTableLayout) {
+        logger_.error("the checkpoint was written with the {} table layout, but the table is in the {} layout.",
+            checkpoint.tiledLayout ? "tiled" : "linear", tableLayout_name());
+        return false;
+    }
+
+    AnalysisCheckpoint loadedCheckpoint;
+    if (!handler.load_checkpoint(loadedCheckpoint, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData))) {
+        logger_.error("failed to load the checkpoint.");
+        return false;
+    }
+    generation_ = loadedCheckpoint.generation;
+    storedGeneration_ = storedGeneration;
+    statistics_ = loadedCheckpoint.stats;
+    generationStats_ = loadedCheckpoint.generationStats;
+    generationUpdated_ = loadedCheckpoint.updated;
+    cursor_ = loadedCheckpoint.cursor;
+    logger_.notice("resume analysis from the checkpoint in the generation {}.", static_cast<int>(generation_));
+    return analyze(handler, ioMode);
+}
+
 bool Analyzer::analyze(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode) {
+    if (strategy_ == AnalysisStrategy::Forked && !tableShared_) {
+        logger_.error("the analysis data table is not shared with worker processes.");
+        return false;
+    }
+    lastCheckpointTime_ = std::chrono::steady_clock::now();
+
+    //
+    // Worker processes of the Forked strategy live until the analysis returns.
+    //
+    struct ShardWorkersGuard {
+        Analyzer& analyzer;
+        ~ShardWorkersGuard() { analyzer.stop_shard_workers(); }
+    } shardWorkersGuard {*this};
+
+    ThreadAffinityGuard affinity;
+    if (threadAffinity_) {
+        std::vector<int> cpus = region_cpus(1, AnalysisDataTableSize);
+        if (!cpus.empty()) {
+            affinity.pin(cpus[0]);
+        }
+    }
+
     while (generation_ <= MaxGeneration) {
-        logger_.notice("analyze the generation {}.", static_cast<int>(generation_));
+        //
+        // Between generations, the analysis can pause with any strategy.
+        //
+        if (cursor_ == 0u && should_pause()) {
+            if (storedGeneration_ + 1 != generation_ || storedGeneration_ == InvalidGeneration) {
+                if (!store_checkpoint(handler)) {
+                    return false;
+                }
+            }
+            if (stop_requested()) {
+                logger_.notice("the analysis is interrupted.");
+                interrupted_ = true;
+                return true;
+            }
+            lastCheckpointTime_ = std::chrono::steady_clock::now();
+        }
 
-        AnalysisStatistics generationStats;
-        bool updated = analyze_generation(generationStats);
-        statistics_.add(generationStats);
-        log_statistics(generation_, generationStats);
+        if (cursor_ == 0u) {
+            logger_.notice("analyze the generation {}.", static_cast<int>(generation_));
+
+            //
+            // Only flagged positions are analyzed.  Compared with a run without the reachability filter,
+            // the difference is the work saved in the generation.
+            //
+            PositionId flaggedNums = count_flagged_positions();
+            PositionId canonicalNums = AnalysisDataTableSize - statistics_.transformedNums;
+            logger_.notice("{} flagged positions ({:.1f}% of {} canonical positions).", flaggedNums,
+                100.0 * static_cast<double>(flaggedNums) / static_cast<double>(canonicalNums), canonicalNums);
+        } else {
+            logger_.notice("analyze the generation {} from the checkpoint.", static_cast<int>(generation_));
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        bool completed = true;
+        if (strategy_ == AnalysisStrategy::Bucket) {
+            completed = analyze_generation_bucket(generationStats_, false, cursor_, generationUpdated_);
+        } else if (strategy_ == AnalysisStrategy::Jacobi) {
+            completed = analyze_generation_bucket(generationStats_, true, cursor_, generationUpdated_);
+        } else if (strategy_ == AnalysisStrategy::Forked) {
+            if (analyze_generation_forked(generationStats_)) {
+                generationUpdated_ = true;
+            }
+        } else {
+            completed = analyze_generation(generationStats_, cursor_, generationUpdated_);
+        }
+
+        if (!completed) {
+            if (!store_checkpoint(handler)) {
+                return false;
+            }
+            if (stop_requested()) {
+                logger_.notice("the analysis is interrupted.");
+                interrupted_ = true;
+                return true;
+            }
+            lastCheckpointTime_ = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        bool updated = generationUpdated_;
+        statistics_.add(generationStats_);
+        log_statistics(generation_, generationStats_);
+        log_elapsed_time(generation_, startTime);
+        cursor_ = 0u;
+        generationStats_.clear();
+        generationUpdated_ = false;
 
         bool needsStoring = false;
         if (updated) {
@@ -165,11 +426,13 @@ bool Analyzer::analyze(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode
                 return false;
             }
             storedGeneration_ = generation_;
+            lastCheckpointTime_ = std::chrono::steady_clock::now();
             logger_.notice("stored analysis data of the generation {}.", static_cast<int>(generation_));
         }
 
         if (!updated) {
             logger_.notice("no update occurred. the analysis is complete.");
+            handler.remove_checkpoint();
             break;
         }
         generation_++;
@@ -182,42 +445,142 @@ bool Analyzer::analyze(AnalysisDataIOHandler& handler, AnalysisDataIOMode ioMode
     return true;
 }
 
-bool Analyzer::initialize() noexcept {
-    bool updated = false;
+std::vector<int> Analyzer::region_cpus(int regionNums, std::size_t regionSize) const {
+    std::vector<int> nodes = online_numa_nodes();
+    std::vector<std::vector<int>> nodeCpus;
+    for (int node: nodes) {
+        std::vector<int> cpus = numa_node_cpus(node);
+        if (!cpus.empty()) {
+            nodeCpus.push_back(cpus);
+        }
+    }
+    if (nodeCpus.empty()) {
+        return std::vector<int>();
+    }
 
     //
-    // Set initial values.
+    // The region R goes to the node holding the middle of the region.  Regions of a node take its CPUs in
+    // turn.  Nodes without CPUs are skipped, unless the table is placed in blocks.
     //
-    AnalysisData initialData = to_analysisData(false, MaxTurn, AnalysisStatus::Unfixed);
-    for (PositionId i = 0u; i < AnalysisDataTableSize; i++) {
-        analysisDataTable_[i] = initialData;
+    int nodeNums = static_cast<int>(nodeCpus.size());
+    bool inBlocks = tableInBlocks_ && nodeCpus.size() == nodes.size();
+    std::vector<std::size_t> assignedNums(nodeNums, 0u);
+    std::vector<int> result(regionNums);
+    for (int region = 0; region < regionNums; region++) {
+        int node;
+        if (inBlocks) {
+            std::size_t middle = region * regionSize + regionSize / 2u;
+            if (middle >= AnalysisDataTableSize) {
+                middle = AnalysisDataTableSize - 1u;
+            }
+            node = numa_block_of_table_index(middle, AnalysisDataTableSize, nodeNums);
+            if (node >= nodeNums) {
+                node = nodeNums - 1;
+            }
+        } else {
+            node = static_cast<int>(static_cast<long long>(region) * nodeNums / regionNums);
+        }
+        const std::vector<int>& cpus = nodeCpus[node];
+        result[region] = cpus[assignedNums[node] % cpus.size()];
+        assignedNums[node]++;
+    }
+    return result;
+}
+
+bool Analyzer::stop_requested() const noexcept {
+    return stopFlag_ != nullptr && *stopFlag_ != 0;
+}
+
+bool Analyzer::should_pause() const noexcept {
+    if (stop_requested()) {
+        return true;
+    }
+    return checkpointInterval_.count() > 0 &&
+        std::chrono::steady_clock::now() - lastCheckpointTime_ >= checkpointInterval_;
+}
+
+bool Analyzer::store_checkpoint(AnalysisDataIOHandler& handler) {
+    AnalysisCheckpoint checkpoint;
+    checkpoint.generation = generation_;
+    checkpoint.strategy = strategy_;
+    checkpoint.threadNums = static_cast<std::uint32_t>(threadNums_);
+    checkpoint.cursor = cursor_;
+    checkpoint.tiledLayout = TiledTableLayout;
+    checkpoint.updated = generationUpdated_;
+    checkpoint.stats = statistics_;
+    checkpoint.generationStats = generationStats_;
+
+    if (!handler.store_checkpoint(checkpoint, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData))) {
+        logger_.error("failed to store the checkpoint in the generation {}.", static_cast<int>(generation_));
+        return false;
     }
+    logger_.notice("stored the checkpoint in the generation {}.", static_cast<int>(generation_));
+    return true;
+}
 
+bool Analyzer::compute_reachability(AnalysisDataIOHandler& handler, ReachabilityBitmap& reachable) {
+    logger_.notice("search positions reachable from the initial position.");
+    auto startTime = std::chrono::steady_clock::now();
+    int levelNums = reachable.compute(threadNums_);
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+    logger_.notice("found {} reachable positions in {} levels. ({:.3f} sec.)", reachable.count(), levelNums,
+        elapsedTime.count());
+
+    if (!handler.store_reachability(reachable.data(), ReachabilityBitmap::byte_size())) {
+        logger_.error("failed to store the bitmap of reachable positions.");
+        return false;
+    }
+    logger_.notice("stored the bitmap of reachable positions.");
+    return true;
+}
+
+bool Analyzer::initialize(const ReachabilityBitmap* reachable) {
+    bool updated = false;
+    PositionId unreachableNums = 0u;
+
+    //
+    // We need not set initial values.  All positions are already marked with Unfixed, since the table
+    // is allocated with zero-filled memory.
+    //
     for (PositionId i = 0u; i < AnalysisDataTableSize; i++) {
-        if (status_of_analysisData(analysisDataTable_[i]) == AnalysisStatus::Transformed) {
-            statistics_.transformedNums++;
-            continue;
-        }
+        AnalysisData& data = analysisDataTable_[table_index(i)];
 
+        //
+        // If the position can be transformed to another symmetric position with a smaller position ID,
+        // the position is marked with Transformed.  We don't depend on the order of positions to be
+        // initialized, since the table index of a position may differ from its position ID.
+        //
         Position pos(i);
+        bool transformed = false;
         for (TransformerId trans: EffectiveTransformerIds) {
-            //
-            // If the position can be transformed to another symmetric position with a smaller position ID,
-            // the position is marked with Transformed.
-            //
-            Position transPos = pos.transform(trans);
-            PositionId transPosId = transPos.id();
-            if (transPosId > i && transPosId < AnalysisDataTableSize) {
-                analysisDataTable_[transPosId] = to_analysisData(false, 0u, AnalysisStatus::Transformed);
+            if (pos.transform(trans).id() < i) {
+                transformed = true;
+                break;
             }
         }
+        if (transformed) {
+            data = to_analysisData(false, 0u, AnalysisStatus::Transformed);
+            statistics_.transformedNums++;
+            continue;
+        }
+
+        //
+        // If the position is never reached from the initial position, it is marked with Contradictory.
+        // No reachable position moves to it, so that it doesn't affect the results of reachable positions.
+        //
+        if (reachable != nullptr && !reachable->test(i)) {
+            data = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+            statistics_.contradictoryNums++;
+            unreachableNums++;
+            continue;
+        }
 
         //
         // At the beginning of the turn, if three pieces of the active player have already been lined up
         // in a row, the position is marked with Contradictory.
         //
         if (pos.is_winner(PlayerId::Active)) {
-            analysisDataTable_[i] = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+            data = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
             statistics_.contradictoryNums++;
             continue;
         }
@@ -229,7 +592,7 @@ bool Analyzer::initialize() noexcept {
         int activePieceNums = on_board_piece_nums(pos, PlayerId::Active);
         int inactivePieceNums = on_board_piece_nums(pos, PlayerId::Inactive);
         if (activePieceNums == 0 && inactivePieceNums >= 2) {
-            analysisDataTable_[i] = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+            data = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
             statistics_.contradictoryNums++;
             continue;
         }
@@ -239,7 +602,7 @@ bool Analyzer::initialize() noexcept {
         // but the active player has placed one or more pieces, the position is marked with Contradictory.
         //
         if (inactivePieceNums == 0 && activePieceNums >= 1) {
-            analysisDataTable_[i] = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+            data = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
             statistics_.contradictoryNums++;
             continue;
         }
@@ -250,7 +613,7 @@ bool Analyzer::initialize() noexcept {
         // We sets the number of remained turns to 0, because the game was over in the previous turn.
         //
         if (pos.is_winner(PlayerId::Inactive)) {
-            analysisDataTable_[i] = to_analysisData(true, 0u, AnalysisStatus::Lost);
+            data = to_analysisData(true, 0u, AnalysisStatus::Lost);
             updated = true;
             statistics_.lostNums++;
             continue;
@@ -263,7 +626,7 @@ bool Analyzer::initialize() noexcept {
         // We sets the number of remained turns to 1, because the game is over during the current turn.
         //
         if (move_nums(pos) == 0) {
-            analysisDataTable_[i] = to_analysisData(true, 1u, AnalysisStatus::LostStalemate);
+            data = to_analysisData(true, 1u, AnalysisStatus::LostStalemate);
             updated = true;
             statistics_.lostStalemateNums++;
             continue;
@@ -272,137 +635,748 @@ bool Analyzer::initialize() noexcept {
         statistics_.unfixedNums++;
     }
 
+    //
+    // Unreachable positions are never flagged in later generations.  Report how many canonical positions
+    // the analysis skips.
+    //
+    if (reachable != nullptr) {
+        PositionId canonicalNums = AnalysisDataTableSize - statistics_.transformedNums;
+        logger_.notice("skip {} unreachable positions ({:.1f}% of {} canonical positions).", unreachableNums,
+            100.0 * static_cast<double>(unreachableNums) / static_cast<double>(canonicalNums), canonicalNums);
+    }
+
     return updated;
 }
 
-bool Analyzer::analyze_generation(AnalysisStatistics& stats) noexcept {
+bool Analyzer::analyze_generation(AnalysisStatistics& stats, std::size_t& cursor, bool& updated) noexcept {
+    PrefetchEntry& spareEntry = prefetchEntries_[MaxPrefetchDepth];
+
+    //
+    // Positions are scanned in the order of the table indexes, so that the table is read sequentially.
+    // Between batches, the analysis can pause at every `BucketChunkSize` table indexes.
+    //
+    std::size_t i = cursor;
+    std::size_t nextPauseCheck = i + BucketChunkSize;
+    while (i < AnalysisDataTableSize) {
+        if (i >= nextPauseCheck) {
+            nextPauseCheck = i + BucketChunkSize;
+            if (should_pause()) {
+                cursor = i;
+                return false;
+            }
+        }
+
+        std::size_t end;
+        std::size_t entryNums = prefetch_batch(i, end);
+        std::size_t entryIndex = 0u;
+
+        for (; i < end; i++) {
+            if (!updateFlag_of_analysisData(analysisDataTable_[i])) {
+                continue;
+            }
+
+            //
+            // The update flag of a position in the range of the batch may have been set by a preceding
+            // position in the same batch.  Such a position has not been picked up.
+            //
+            PrefetchEntry* entry;
+            if (entryIndex < entryNums && prefetchEntries_[entryIndex].index == i) {
+                entry = &prefetchEntries_[entryIndex];
+                entryIndex++;
+            } else {
+                entry = &spareEntry;
+                entry->position = table_index_to_id(i);
+                entry->index = i;
+                entry->moveNums = -1;
+                entry->moveBackNums = -1;
+            }
+
+            if (analyze_position(stats, *entry)) {
+                updated = true;
+            }
+        }
+    }
+
+    cursor = AnalysisDataTableSize;
+    return true;
+}
+
+bool Analyzer::analyze_generation_bucket(AnalysisStatistics& stats, bool jacobi, std::size_t& cursor,
+    bool& updated) {
+    if (jacobi && previousTable_ == nullptr) {
+        TablePlacementPolicy placementPolicy;
+        placementPolicy.pageMode = pageMode_;
+        placementPolicy.numaMode = numaMode_;
+        TablePlacement placement;
+        previousTable_ = allocate_analysisDataTable(AnalysisDataTableSize, placementPolicy, &placement);
+        logger_.notice("analysis data table of the previous generation: {} layout, {}.", tableLayout_name(),
+            tablePlacement_to_string(placement));
+    }
+    const AnalysisData* scannedTable = jacobi ? previousTable_ : analysisDataTable_;
+
+    //
+    // Thread T owns the region T, and it scans the region chunk by chunk.
+    //
+    std::size_t regionSize = (AnalysisDataTableSize + threadNums_ - 1) / threadNums_;
+    std::size_t roundNums = (regionSize + BucketChunkSize - 1) / BucketChunkSize;
+
+    std::vector<TableUpdateBuckets> buckets(threadNums_, TableUpdateBuckets(threadNums_));
+    std::vector<AnalysisStatistics> threadStats(threadNums_);
+    std::vector<char> threadUpdated(threadNums_, false);
+    std::vector<std::exception_ptr> threadErrors(threadNums_);
+    std::atomic<bool> failed(false);
+    std::atomic<std::size_t> pausedRound(roundNums);
+    ThreadBarrier barrier(threadNums_);
+    std::vector<int> cpus;
+    if (threadAffinity_) {
+        cpus = region_cpus(threadNums_, regionSize);
+    }
+
+    auto worker = [&](int region) {
+        ThreadAffinityGuard affinity;
+        if (!cpus.empty()) {
+            affinity.pin(cpus[region]);
+        }
+        PrefetchEntry entry;
+        std::size_t regionBegin = region * regionSize;
+        std::size_t regionEnd = regionBegin + regionSize;
+        if (regionBegin > AnalysisDataTableSize) {
+            regionBegin = AnalysisDataTableSize;
+        }
+        if (regionEnd > AnalysisDataTableSize) {
+            regionEnd = AnalysisDataTableSize;
+        }
+
+        //
+        // In the Jacobi strategy, the region is copied to the previous table, and the update flags in the
+        // region are cleared at once.  Flags set in the generation are kept for the next generation.  Only
+        // elements with the flag are written, as in `apply_buckets()`.
+        //
+        if (jacobi && cursor == 0u) {
+            std::copy(analysisDataTable_ + regionBegin, analysisDataTable_ + regionEnd,
+                previousTable_ + regionBegin);
+            for (std::size_t i = regionBegin; i < regionEnd; i++) {
+                if (updateFlag_of_analysisData(previousTable_[i])) {
+                    analysisDataTable_[i] = set_updateFlag_of_analysisData(previousTable_[i], false);
+                }
+            }
+            barrier.wait();
+        }
+
+        for (std::size_t round = cursor; round < roundNums; round++) {
+            std::size_t begin = regionBegin + round * BucketChunkSize;
+            std::size_t end = begin + BucketChunkSize;
+            if (begin > regionEnd) {
+                begin = regionEnd;
+            }
+            if (end > regionEnd) {
+                end = regionEnd;
+            }
+
+            try {
+                if (scan_chunk(scannedTable, begin, end, regionSize, buckets[region], entry)) {
+                    threadUpdated[region] = true;
+                }
+            } catch (...) {
+                threadErrors[region] = std::current_exception();
+                failed = true;
+            }
+            barrier.wait();
+            if (failed) {
+                return;
+            }
+
+            std::size_t clearedEnd = jacobi ? begin : end;
+            if (apply_buckets(region, begin, clearedEnd, buckets, threadStats[region])) {
+                threadUpdated[region] = true;
+            }
+
+            //
+            // The thread 0 decides whether to pause after the round.  All the threads see the decision
+            // after the barrier.  The Jacobi strategy never pauses in the middle of a generation.
+            //
+            if (region == 0 && !jacobi && round + 1 < roundNums && should_pause()) {
+                pausedRound = round + 1;
+            }
+            barrier.wait();
+            if (pausedRound <= round + 1) {
+                return;
+            }
+        }
+    };
+
+    //
+    // The calling thread works as the thread 0.  If it fails to create a thread, the other threads quit
+    // at the end of the first scan.
+    //
+    run_threads(threadNums_, worker, [&](int missingNums) {
+        failed = true;
+        for (int i = 0; i < missingNums; i++) {
+            barrier.arrive_and_drop();
+        }
+    });
+
+    for (const std::exception_ptr& error: threadErrors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (int i = 0; i < threadNums_; i++) {
+        stats.add(threadStats[i]);
+        if (threadUpdated[i]) {
+            updated = true;
+        }
+    }
+    cursor = pausedRound;
+    return pausedRound == roundNums;
+}
+
+bool Analyzer::scan_chunk(const AnalysisData* table, std::size_t begin, std::size_t end, std::size_t regionSize,
+    TableUpdateBuckets& buckets, PrefetchEntry& entry) const {
     bool updated = false;
 
-    for (PositionId i = 0u; i < AnalysisDataTableSize; i++) {
-        AnalysisData& data = analysisDataTable_[i];
+    auto append = [&](std::size_t index, Turn turn, TableUpdateKind kind) {
+        std::size_t region = index / regionSize;
+        if (region >= buckets.size()) {
+            region = buckets.size() - 1;
+        }
+        buckets[region].push_back(TableUpdate{static_cast<std::uint32_t>(index), turn, kind});
+    };
+
+    for (std::size_t i = begin; i < end; i++) {
+        AnalysisData data = table[i];
         if (!updateFlag_of_analysisData(data)) {
             continue;
         }
-        data = set_updateFlag_of_analysisData(data, false);
 
+        entry.position = table_index_to_id(i);
+        entry.index = i;
+        entry.moveNums = -1;
+        entry.moveBackNums = -1;
+
+        //
+        // The same as analyze_position(), except that updates of the table are appended to the buckets.
+        // An update of the position itself can be predicted here, since only the position updates itself
+        // with SetLost.
+        //
         AnalysisStatus status = status_of_analysisData(data);
+        Turn turn = turn_of_analysisData(data);
+        bool lost = false;
+
         if (status == AnalysisStatus::Lost || status == AnalysisStatus::LostStalemate) {
-            Position pos(i);
-            if (turn_of_analysisData(data) == 0u || analyze_unfixed_or_lost(stats, pos)) {
-                if (analyze_move_backs_from_active_player_lost(stats, pos)) {
-                    updated = true;
+            if (turn == 0u) {
+                lost = true;
+            } else {
+                Turn nextTurn;
+                generate_moves(entry);
+                if (moves_all_won(table, entry, nextTurn) && turn > nextTurn) {
+                    append(i, nextTurn, TableUpdateKind::SetLost);
+                    turn = nextTurn;
+                    lost = true;
                 }
             }
         } else if (status == AnalysisStatus::Won) {
-            Position pos(i);
-            if (analyze_move_backs_from_active_player_won(stats, pos)) {
-                updated = true;
+            Turn nextTurn = (turn == MaxTurn) ? turn : turn + 1u;
+            generate_move_backs(entry);
+            for (int j = 0; j < entry.moveBackNums; j++) {
+                AnalysisData dstData = table[entry.moveBackIndexes[j]];
+                AnalysisStatus dstStatus = status_of_analysisData(dstData);
+                if (dstStatus == AnalysisStatus::Unfixed ||
+                    ((dstStatus == AnalysisStatus::Lost || dstStatus == AnalysisStatus::LostStalemate) &&
+                        turn_of_analysisData(dstData) > nextTurn)) {
+                    append(entry.moveBackIndexes[j], 0u, TableUpdateKind::SetUpdateFlag);
+                    updated = true;
+                }
             }
         } else if (status == AnalysisStatus::Unfixed) {
-            Position pos(i);
-            if (analyze_unfixed_or_lost(stats, pos)) {
-                analyze_move_backs_from_active_player_lost(stats, pos);
+            Turn nextTurn;
+            generate_moves(entry);
+            if (moves_all_won(table, entry, nextTurn)) {
+                append(i, nextTurn, TableUpdateKind::SetLost);
+                turn = nextTurn;
+                lost = true;
                 updated = true;
             }
         }
+
+        if (lost) {
+            Turn nextTurn = (turn == MaxTurn) ? turn : turn + 1u;
+            generate_move_backs(entry);
+            for (int j = 0; j < entry.moveBackNums; j++) {
+                AnalysisData dstData = table[entry.moveBackIndexes[j]];
+                AnalysisStatus dstStatus = status_of_analysisData(dstData);
+                if (dstStatus == AnalysisStatus::Unfixed ||
+                    ((dstStatus == AnalysisStatus::Won || dstStatus == AnalysisStatus::WonStalemate) &&
+                        turn_of_analysisData(dstData) > nextTurn)) {
+                    append(entry.moveBackIndexes[j], nextTurn, TableUpdateKind::SetWon);
+                }
+            }
+        }
     }
 
     return updated;
 }
 
-bool Analyzer::analyze_move_backs_from_active_player_lost(AnalysisStatistics& stats, const Position& pos) noexcept {
+bool Analyzer::apply_buckets(int region, std::size_t begin, std::size_t end, std::vector<TableUpdateBuckets>& buckets,
+    AnalysisStatistics& stats) noexcept {
     bool updated = false;
 
-    Turn turn = turn_of_analysisData(analysisDataTable_[pos.id()]);
-    Turn nextTurn;
-    if (turn == MaxTurn) {
-        nextTurn = turn;
-    } else {
-        nextTurn = turn + 1u;
+    for (std::size_t i = begin; i < end; i++) {
+        if (updateFlag_of_analysisData(analysisDataTable_[i])) {
+            analysisDataTable_[i] = set_updateFlag_of_analysisData(analysisDataTable_[i], false);
+        }
     }
 
-    for (PieceId piece: InactivePlayerPieceIds) {
-        LocationIdPair locPair = pos.locations_of_piece(piece);
+    for (TableUpdateBuckets& threadBuckets: buckets) {
+        std::vector<TableUpdate>& bucket = threadBuckets[region];
+        if (apply_table_updates(bucket.data(), bucket.size(), stats)) {
+            updated = true;
+        }
+        bucket.clear();
+    }
 
-        for (int i = 0; i < 2; i++) {
-            LocationId src = locPair.locations[i];
+    return updated;
+}
 
-            for (LocationId dst: LocationIds) {
-                MoveResult moveResult = pos.move_back(piece, src, dst);
-                if (moveResult.status != MoveResultStatus::Success) {
-                    continue;
-                }
+bool Analyzer::apply_table_updates(const TableUpdate* updates, std::size_t updateNums, AnalysisStatistics& stats)
+    noexcept {
+    bool updated = false;
 
-                AnalysisData& dstData = analysisDataTable_[moveResult.position.minimize_id()];
-                AnalysisStatus dstStatus = status_of_analysisData(dstData);
+    //
+    // The updates commute: SetLost keeps the update flag, SetWon takes the minimum turn, and
+    // SetUpdateFlag only sets the flag.  A position never receives both SetLost and SetWon in a round.
+    //
+    for (std::size_t i = 0u; i < updateNums; i++) {
+        const TableUpdate& update = updates[i];
+        AnalysisData& data = analysisDataTable_[update.index];
+        AnalysisStatus status = status_of_analysisData(data);
 
-                if (dstStatus == AnalysisStatus::Unfixed) {
-                    dstData = to_analysisData(true, nextTurn, AnalysisStatus::Won);
-                    stats.wonNums++;
-                    updated = true;
-                } else if ((dstStatus == AnalysisStatus::Won || dstStatus == AnalysisStatus::WonStalemate) &&
-                    turn_of_analysisData(dstData) > nextTurn) {
-                    dstData = to_analysisData(true, nextTurn, AnalysisStatus::Won);
-                }
+        if (update.kind == TableUpdateKind::SetLost) {
+            if (status == AnalysisStatus::Unfixed) {
+                data = to_analysisData(updateFlag_of_analysisData(data), update.turn, AnalysisStatus::Lost);
+                stats.lostNums++;
+            } else if (turn_of_analysisData(data) > update.turn) {
+                data = to_analysisData(updateFlag_of_analysisData(data), update.turn, AnalysisStatus::Lost);
             }
-
-            if (locPair.locations[0] == locPair.locations[1]) {
-                break;
+        } else if (update.kind == TableUpdateKind::SetWon) {
+            if (status == AnalysisStatus::Unfixed) {
+                data = to_analysisData(true, update.turn, AnalysisStatus::Won);
+                stats.wonNums++;
+                updated = true;
+            } else if ((status == AnalysisStatus::Won || status == AnalysisStatus::WonStalemate) &&
+                turn_of_analysisData(data) > update.turn) {
+                data = to_analysisData(true, update.turn, AnalysisStatus::Won);
             }
+        } else {
+            data = set_updateFlag_of_analysisData(data, true);
         }
     }
 
     return updated;
 }
 
-bool Analyzer::analyze_move_backs_from_active_player_won(AnalysisStatistics& stats, const Position& pos) noexcept {
-    static_cast<void>(stats);
+#if defined(HAVE_UNISTD_H) && defined(HAVE_SYS_WAIT_H)
+bool Analyzer::analyze_generation_forked(AnalysisStatistics& stats) {
+    if (shardWorkers_.empty()) {
+        start_shard_workers();
+    }
+
+    std::vector<ShardResult> scanResults;
+    std::vector<ShardResult> applyResults;
+    run_shard_workers(ShardPhase::Scan, scanResults);
+    run_shard_workers(ShardPhase::Apply, applyResults);
+
     bool updated = false;
+    for (int i = 0; i < shardNums_; i++) {
+        stats.add(scanResults[i].stats);
+        stats.add(applyResults[i].stats);
+        if (scanResults[i].updated || applyResults[i].updated) {
+            updated = true;
+        }
+    }
+    return updated;
+}
 
-    Turn turn = turn_of_analysisData(analysisDataTable_[pos.id()]);
-    Turn nextTurn;
-    if (turn == MaxTurn) {
-        nextTurn = turn;
-    } else {
-        nextTurn = turn + 1u;
+void Analyzer::run_shard_workers(ShardPhase phase, std::vector<ShardResult>& results) {
+    results.assign(shardNums_, ShardResult{false, false, AnalysisStatistics()});
+    std::vector<bool> sent(shardNums_, false);
+
+    //
+    // All the workers run the phase at once.
+    //
+    char command = static_cast<char>(phase);
+    for (int shard = 0; shard < shardNums_; shard++) {
+        ssize_t writtenSize;
+        do {
+            writtenSize = write(shardWorkers_[shard].commandFd, &command, 1u);
+        } while (writtenSize < 0 && errno == EINTR);
+        sent[shard] = (writtenSize == 1);
     }
 
-    for (PieceId piece: InactivePlayerPieceIds) {
-        LocationIdPair locPair = pos.locations_of_piece(piece);
+    bool succeeded = true;
+    for (int shard = 0; shard < shardNums_; shard++) {
+        if (!sent[shard]) {
+            succeeded = false;
+            continue;
+        }
+        ShardResult& result = results[shard];
+        std::size_t readSize = 0u;
+        while (readSize < sizeof(result)) {
+            ssize_t n = read(shardWorkers_[shard].resultFd, reinterpret_cast<char*>(&result) + readSize,
+                sizeof(result) - readSize);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            readSize += n;
+        }
+        if (readSize < sizeof(result) || !result.succeeded) {
+            succeeded = false;
+        }
+    }
 
-        for (int i = 0; i < 2; i++) {
-            LocationId src = locPair.locations[i];
+    if (!succeeded) {
+        stop_shard_workers();
+        for (int from = 0; from < shardNums_; from++) {
+            for (int to = 0; to < shardNums_; to++) {
+                std::error_code errCode;
+                std::filesystem::remove(shard_message_path(from, to), errCode);
+            }
+        }
+        throw std::runtime_error(fmt::format("a worker process failed in the generation {}",
+            static_cast<int>(generation_)));
+    }
+}
 
-            for (LocationId dst: LocationIds) {
-                MoveResult moveResult = pos.move_back(piece, src, dst);
-                if (moveResult.status != MoveResultStatus::Success) {
-                    continue;
-                }
+void Analyzer::start_shard_workers() {
+    for (int shard = 0; shard < shardNums_; shard++) {
+        int commandFds[2];
+        int resultFds[2];
+        if (pipe(commandFds) != 0) {
+            break;
+        }
+        if (pipe(resultFds) != 0) {
+            close(commandFds[0]);
+            close(commandFds[1]);
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            //
+            // A worker closes the pipes of the workers forked before it, so that each worker sees the end
+            // of its commands as soon as the analyzer closes the pipe.
+            //
+            for (const ShardWorker& worker: shardWorkers_) {
+                close(worker.commandFd);
+                close(worker.resultFd);
+            }
+            close(commandFds[1]);
+            close(resultFds[0]);
+            serve_shard(shard, commandFds[0], resultFds[1]);
+        }
+        close(commandFds[0]);
+        close(resultFds[1]);
+        if (pid < 0) {
+            close(commandFds[1]);
+            close(resultFds[0]);
+            break;
+        }
+        shardWorkers_.push_back(ShardWorker {static_cast<int>(pid), commandFds[1], resultFds[0]});
+    }
 
-                PositionId minId = moveResult.position.minimize_id();
-                AnalysisData& dstData = analysisDataTable_[minId];
-                AnalysisStatus dstStatus = status_of_analysisData(dstData);
+    if (static_cast<int>(shardWorkers_.size()) < shardNums_) {
+        stop_shard_workers();
+        throw std::runtime_error("failed to create worker processes");
+    }
+    logger_.notice("started {} worker processes.", shardNums_);
+}
 
-                if (dstStatus == AnalysisStatus::Unfixed) {
-                    dstData = set_updateFlag_of_analysisData(dstData, true);
-                    updated = true;
-                } else if ((dstStatus == AnalysisStatus::Lost || dstStatus == AnalysisStatus::LostStalemate) &&
-                    turn_of_analysisData(dstData) > nextTurn) {
-                    dstData = set_updateFlag_of_analysisData(dstData, true);
-                    updated = true;
-                }
+void Analyzer::stop_shard_workers() noexcept {
+    if (shardWorkers_.empty()) {
+        return;
+    }
+
+    //
+    // Closing the command pipes lets all the workers exit before waiting for any of them.
+    //
+    for (const ShardWorker& worker: shardWorkers_) {
+        close(worker.commandFd);
+        close(worker.resultFd);
+    }
+    for (const ShardWorker& worker: shardWorkers_) {
+        int status;
+        while (waitpid(static_cast<pid_t>(worker.processId), &status, 0) < 0 && errno == EINTR) {
+        }
+    }
+    shardWorkers_.clear();
+}
+
+void Analyzer::serve_shard(int shard, int commandFd, int resultFd) {
+    //
+    // The worker exits with _exit(), so that it never runs destructors of objects (including the shared
+    // table) inherited from the analyzer process.  A signal to the process group interrupts read() in
+    // the worker, and the worker goes on waiting, because the analyzer decides when to stop.
+    //
+    for (;;) {
+        char command;
+        ssize_t readSize = read(commandFd, &command, 1u);
+        if (readSize < 0 && errno == EINTR) {
+            continue;
+        }
+        if (readSize <= 0) {
+            _exit(0);
+        }
+
+        ShardResult result{false, false, AnalysisStatistics()};
+        try {
+            if (command == static_cast<char>(ShardPhase::Scan)) {
+                scan_shard(shard, result);
+            } else {
+                apply_shard(shard, result);
             }
-            if (locPair.locations[0] == locPair.locations[1]) {
+            result.succeeded = true;
+        } catch (...) {
+            result.succeeded = false;
+        }
+
+        std::size_t writtenSize = 0u;
+        while (writtenSize < sizeof(result)) {
+            ssize_t n = write(resultFd, reinterpret_cast<const char*>(&result) + writtenSize,
+                sizeof(result) - writtenSize);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                _exit(1);
+            }
+            writtenSize += n;
+        }
+    }
+}
+
+void Analyzer::scan_shard(int shard, ShardResult& result) const {
+    std::size_t shardSize = shard_size();
+    std::size_t shardBegin = shard * shardSize;
+    std::size_t shardEnd = shardBegin + shardSize;
+    if (shardBegin > AnalysisDataTableSize) {
+        shardBegin = AnalysisDataTableSize;
+    }
+    if (shardEnd > AnalysisDataTableSize || shard + 1 == shardNums_) {
+        shardEnd = AnalysisDataTableSize;
+    }
+
+    std::vector<std::ofstream> files(shardNums_);
+    for (int to = 0; to < shardNums_; to++) {
+        files[to].open(shard_message_path(shard, to), std::ios::binary | std::ios::trunc);
+        if (!files[to]) {
+            throw std::runtime_error("failed to create a message file");
+        }
+    }
+
+    //
+    // The shard is scanned chunk by chunk, and the buckets are flushed to the message files after each
+    // chunk, in order to bound the memory for the buckets.
+    //
+    TableUpdateBuckets buckets(shardNums_);
+    PrefetchEntry entry;
+    for (std::size_t begin = shardBegin; begin < shardEnd; begin += BucketChunkSize) {
+        std::size_t end = begin + BucketChunkSize;
+        if (end > shardEnd) {
+            end = shardEnd;
+        }
+        if (scan_chunk(analysisDataTable_, begin, end, shardSize, buckets, entry)) {
+            result.updated = true;
+        }
+        for (int to = 0; to < shardNums_; to++) {
+            if (buckets[to].empty()) {
+                continue;
+            }
+            files[to].write(reinterpret_cast<const char*>(buckets[to].data()),
+                buckets[to].size() * sizeof(TableUpdate));
+            if (files[to].fail()) {
+                throw std::runtime_error("failed to write a message file");
+            }
+            buckets[to].clear();
+        }
+    }
+
+    for (std::ofstream& file: files) {
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("failed to write a message file");
+        }
+    }
+}
+
+void Analyzer::apply_shard(int shard, ShardResult& result) {
+    std::size_t shardSize = shard_size();
+    std::size_t shardBegin = shard * shardSize;
+    std::size_t shardEnd = shardBegin + shardSize;
+    if (shardBegin > AnalysisDataTableSize) {
+        shardBegin = AnalysisDataTableSize;
+    }
+    if (shardEnd > AnalysisDataTableSize || shard + 1 == shardNums_) {
+        shardEnd = AnalysisDataTableSize;
+    }
+
+    //
+    // All the flagged positions in the shard have been scanned in the generation.
+    //
+    for (std::size_t i = shardBegin; i < shardEnd; i++) {
+        if (updateFlag_of_analysisData(analysisDataTable_[i])) {
+            analysisDataTable_[i] = set_updateFlag_of_analysisData(analysisDataTable_[i], false);
+        }
+    }
+
+    std::vector<TableUpdate> updates(BucketChunkSize);
+    for (int from = 0; from < shardNums_; from++) {
+        std::string path = shard_message_path(from, shard);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("failed to open a message file");
+        }
+        for (;;) {
+            file.read(reinterpret_cast<char*>(updates.data()), updates.size() * sizeof(TableUpdate));
+            std::size_t updateNums = file.gcount() / sizeof(TableUpdate);
+            if (apply_table_updates(updates.data(), updateNums, result.stats)) {
+                result.updated = true;
+            }
+            if (file.eof()) {
                 break;
+            } else if (file.fail()) {
+                throw std::runtime_error("failed to read a message file");
+            }
+        }
+        file.close();
+        std::error_code errCode;
+        std::filesystem::remove(path, errCode);
+    }
+}
+#else
+bool Analyzer::analyze_generation_forked(AnalysisStatistics& stats) {
+    static_cast<void>(stats);
+    throw std::runtime_error("the fork strategy is not supported on this system");
+}
+
+void Analyzer::stop_shard_workers() noexcept {
+}
+#endif
+
+std::size_t Analyzer::shard_size() const noexcept {
+    constexpr std::size_t slabSize = TableTileLargeNums * PieceQuadCombinationNums * PieceQuadCombinationNums;
+    constexpr std::size_t slabNums = TiledTableSize / slabSize;
+    return (slabNums + shardNums_ - 1) / shardNums_ * slabSize;
+}
+
+std::string Analyzer::shard_message_path(int from, int to) const {
+    std::filesystem::path path(workDir_);
+    path /= fmt::format("gobb_analyzer_shard_{}_{}.tmp", from, to);
+    return path.string();
+}
+
+bool Analyzer::moves_all_won(const AnalysisData* table, const PrefetchEntry& entry, Turn& nextTurn) const noexcept {
+    nextTurn = 0u;
+
+    for (int i = 0; i < entry.moveNums; i++) {
+        AnalysisData dstData = table[entry.moveIndexes[i]];
+        AnalysisStatus dstStatus = status_of_analysisData(dstData);
+
+        if (dstStatus != AnalysisStatus::Won && dstStatus != AnalysisStatus::WonStalemate) {
+            return false;
+        }
+        Turn turn = turn_of_analysisData(dstData);
+        if (turn + 1 == MaxTurn) {
+            nextTurn = MaxTurn;
+        } else if (turn + 1 > nextTurn) {
+            nextTurn = turn + 1;
+        }
+    }
+
+    return true;
+}
+
+std::size_t Analyzer::prefetch_batch(std::size_t start, std::size_t& end) noexcept {
+    std::size_t entryNums = 0u;
+
+    std::size_t i = start;
+    for (; i < AnalysisDataTableSize && entryNums < prefetchDepth_; i++) {
+        AnalysisData data = analysisDataTable_[i];
+        if (!updateFlag_of_analysisData(data)) {
+            continue;
+        }
+
+        PrefetchEntry& entry = prefetchEntries_[entryNums];
+        entry.position = table_index_to_id(i);
+        entry.index = i;
+        entry.moveNums = -1;
+        entry.moveBackNums = -1;
+        entryNums++;
+
+        //
+        // Generate positions which analyze_position() is going to read, according to the current
+        // status of the position.
+        //
+        AnalysisStatus status = status_of_analysisData(data);
+        if (status == AnalysisStatus::Lost || status == AnalysisStatus::LostStalemate) {
+            if (turn_of_analysisData(data) != 0u) {
+                generate_moves(entry);
+            }
+            generate_move_backs(entry);
+        } else if (status == AnalysisStatus::Won) {
+            generate_move_backs(entry);
+        } else if (status == AnalysisStatus::Unfixed) {
+            generate_moves(entry);
+        }
+
+        for (int j = 0; j < entry.moveNums; j++) {
+            prefetch_analysisData(&analysisDataTable_[entry.moveIndexes[j]]);
+        }
+        for (int j = 0; j < entry.moveBackNums; j++) {
+            prefetch_analysisData(&analysisDataTable_[entry.moveBackIndexes[j]]);
+        }
+    }
+
+    end = i;
+    return entryNums;
+}
+
+bool Analyzer::analyze_position(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept {
+    bool updated = false;
+
+    AnalysisData& data = analysisDataTable_[entry.index];
+    data = set_updateFlag_of_analysisData(data, false);
+
+    AnalysisStatus status = status_of_analysisData(data);
+    if (status == AnalysisStatus::Lost || status == AnalysisStatus::LostStalemate) {
+        if (turn_of_analysisData(data) == 0u || analyze_unfixed_or_lost(stats, entry)) {
+            if (analyze_move_backs_from_active_player_lost(stats, entry)) {
+                updated = true;
             }
         }
+    } else if (status == AnalysisStatus::Won) {
+        if (analyze_move_backs_from_active_player_won(stats, entry)) {
+            updated = true;
+        }
+    } else if (status == AnalysisStatus::Unfixed) {
+        if (analyze_unfixed_or_lost(stats, entry)) {
+            analyze_move_backs_from_active_player_lost(stats, entry);
+            updated = true;
+        }
     }
 
     return updated;
 }
 
-bool Analyzer::analyze_unfixed_or_lost(AnalysisStatistics& stats, const Position& pos) noexcept {
-    Turn nextTurn = 0u;
+void Analyzer::generate_moves(PrefetchEntry& entry) const noexcept {
+    if (entry.moveNums >= 0) {
+        return;
+    }
+
+    const Position& pos = entry.position;
+    int nums = 0;
 
     for (PieceId piece: ActivePlayerPieceIds) {
         LocationIdPair locPair = pos.locations_of_piece(piece);
@@ -415,19 +1389,37 @@ bool Analyzer::analyze_unfixed_or_lost(AnalysisStatistics& stats, const Position
                 if (moveResult.status != MoveResultStatus::Success) {
                     continue;
                 }
+                entry.moveIndexes[nums++] = table_index(moveResult.position.minimize_id());
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
 
-                AnalysisData& dstData = analysisDataTable_[moveResult.position.minimize_id()];
-                AnalysisStatus dstStatus = status_of_analysisData(dstData);
+    entry.moveNums = nums;
+}
 
-                if (dstStatus != AnalysisStatus::Won && dstStatus != AnalysisStatus::WonStalemate) {
-                    return false;
-                }
-                Turn turn = turn_of_analysisData(dstData);
-                if (turn + 1 == MaxTurn) {
-                    nextTurn = MaxTurn;
-                } else if (turn + 1 > nextTurn) {
-                    nextTurn = turn + 1;
+void Analyzer::generate_move_backs(PrefetchEntry& entry) const noexcept {
+    if (entry.moveBackNums >= 0) {
+        return;
+    }
+
+    const Position& pos = entry.position;
+    int nums = 0;
+
+    for (PieceId piece: InactivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: LocationIds) {
+                MoveResult moveResult = pos.move_back(piece, src, dst);
+                if (moveResult.status != MoveResultStatus::Success) {
+                    continue;
                 }
+                entry.moveBackIndexes[nums++] = table_index(moveResult.position.minimize_id());
             }
             if (locPair.locations[0] == locPair.locations[1]) {
                 break;
@@ -435,8 +1427,78 @@ bool Analyzer::analyze_unfixed_or_lost(AnalysisStatistics& stats, const Position
         }
     }
 
+    entry.moveBackNums = nums;
+}
+
+bool Analyzer::analyze_move_backs_from_active_player_lost(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept {
     bool updated = false;
-    AnalysisData& dstData = analysisDataTable_[pos.id()];
+
+    Turn turn = turn_of_analysisData(analysisDataTable_[entry.index]);
+    Turn nextTurn;
+    if (turn == MaxTurn) {
+        nextTurn = turn;
+    } else {
+        nextTurn = turn + 1u;
+    }
+
+    generate_move_backs(entry);
+    for (int i = 0; i < entry.moveBackNums; i++) {
+        AnalysisData& dstData = analysisDataTable_[entry.moveBackIndexes[i]];
+        AnalysisStatus dstStatus = status_of_analysisData(dstData);
+
+        if (dstStatus == AnalysisStatus::Unfixed) {
+            dstData = to_analysisData(true, nextTurn, AnalysisStatus::Won);
+            stats.wonNums++;
+            updated = true;
+        } else if ((dstStatus == AnalysisStatus::Won || dstStatus == AnalysisStatus::WonStalemate) &&
+            turn_of_analysisData(dstData) > nextTurn) {
+            dstData = to_analysisData(true, nextTurn, AnalysisStatus::Won);
+        }
+    }
+
+    return updated;
+}
+
+bool Analyzer::analyze_move_backs_from_active_player_won(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept {
+    static_cast<void>(stats);
+    bool updated = false;
+
+    Turn turn = turn_of_analysisData(analysisDataTable_[entry.index]);
+    Turn nextTurn;
+    if (turn == MaxTurn) {
+        nextTurn = turn;
+    } else {
+        nextTurn = turn + 1u;
+    }
+
+    generate_move_backs(entry);
+    for (int i = 0; i < entry.moveBackNums; i++) {
+        AnalysisData& dstData = analysisDataTable_[entry.moveBackIndexes[i]];
+        AnalysisStatus dstStatus = status_of_analysisData(dstData);
+
+        if (dstStatus == AnalysisStatus::Unfixed) {
+            dstData = set_updateFlag_of_analysisData(dstData, true);
+            updated = true;
+        } else if ((dstStatus == AnalysisStatus::Lost || dstStatus == AnalysisStatus::LostStalemate) &&
+            turn_of_analysisData(dstData) > nextTurn) {
+            dstData = set_updateFlag_of_analysisData(dstData, true);
+            updated = true;
+        }
+    }
+
+    return updated;
+}
+
+bool Analyzer::analyze_unfixed_or_lost(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept {
+    Turn nextTurn;
+
+    generate_moves(entry);
+    if (!moves_all_won(analysisDataTable_, entry, nextTurn)) {
+        return false;
+    }
+
+    bool updated = false;
+    AnalysisData& dstData = analysisDataTable_[entry.index];
     AnalysisStatus curStatus = status_of_analysisData(dstData);
     Turn curTurn = turn_of_analysisData(dstData);
 
@@ -498,6 +1560,32 @@ int Analyzer::on_board_piece_nums(const Position& pos, PlayerId player) const no
     return nums;
 }
 
+PositionId Analyzer::count_flagged_positions() const {
+    std::vector<PositionId> threadCounts(threadNums_, 0u);
+    std::size_t rangeSize = (AnalysisDataTableSize + threadNums_ - 1) / threadNums_;
+    auto worker = [&](int range) {
+        std::size_t begin = range * rangeSize;
+        std::size_t end = begin + rangeSize;
+        if (end > AnalysisDataTableSize) {
+            end = AnalysisDataTableSize;
+        }
+        PositionId nums = 0u;
+        for (std::size_t i = begin; i < end; i++) {
+            if (updateFlag_of_analysisData(analysisDataTable_[i])) {
+                nums++;
+            }
+        }
+        threadCounts[range] = nums;
+    };
+    run_threads(threadNums_, worker);
+
+    PositionId flaggedNums = 0u;
+    for (PositionId nums: threadCounts) {
+        flaggedNums += nums;
+    }
+    return flaggedNums;
+}
+
 void Analyzer::log_statistics(Generation generation, AnalysisStatistics& stats) {
     if (generation == 0) {
         logger_.info("analysis result of the initialization:");
@@ -518,4 +1606,15 @@ void Analyzer::log_statistics(Generation generation, AnalysisStatistics& stats)
     logger_.info();
 }
 
+void Analyzer::log_elapsed_time(Generation generation, std::chrono::steady_clock::time_point startTime) {
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+    if (strategy_ == AnalysisStrategy::Serial) {
+        logger_.notice("elapsed time of the generation {}: {:.3f} sec. (prefetch depth = {})",
+            static_cast<int>(generation), elapsedTime.count(), prefetchDepth_);
+    } else {
+        logger_.notice("elapsed time of the generation {}: {:.3f} sec.", static_cast<int>(generation),
+            elapsedTime.count());
+    }
+}
+
 } // namespace gobb_analyzer
@@ -18,9 +18,12 @@
 #ifndef GOBB_ANALYZER_ANALYZER_HPP
 #define GOBB_ANALYZER_ANALYZER_HPP
 
+#include <chrono>
+#include <csignal>
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <fmt/core.h>
 #include "definitions.hpp"
 #include "position.hpp"
@@ -63,6 +66,9 @@ constexpr Generation InvalidGeneration = 0x0fffu;
 /// Analysis data about a position.
 ///
 /// It consists of an update flag (1 bit), the number of remaining turns (12 bits) and a status code (3 bits).
+/// The number of remaining turns is recorded as a value XORed with `MaxTurn`, so that the analysis data
+/// with all bits zero means `Unfixed` with `MaxTurn` remaining turns and no update flag.
+/// A table of analysis data can therefore be initialized just by zero-filled memory.
 ///
 using AnalysisData = std::uint16_t;
 
@@ -74,6 +80,44 @@ using Turn = std::uint16_t;
 /// The maximum number of remaining turns in a game.
 static constexpr Turn MaxTurn = 0x0ffeu;
 
+/// Analysis data of a position not analyzed yet (i.e. `Unfixed` with `MaxTurn` remaining turns).
+constexpr AnalysisData UnfixedAnalysisData = 0x0000u;
+
+///
+/// The maximum number of possible moves at a position.
+///
+/// Each of three kinds of pieces of the active player can be moved from two locations to nine squares.
+///
+constexpr std::size_t MaxMoveNums = PlayerPieceIdNums * 2u * OnBoardLocationIdNums;
+
+///
+/// The maximum number of possible retrograde moves at a position.
+///
+/// Each of three kinds of pieces of the inactive player can be moved back from two squares to ten locations.
+///
+constexpr std::size_t MaxMoveBackNums = PlayerPieceIdNums * 2u * LocationIdNums;
+
+/// The default number of positions processed in a batch of prefetching.
+constexpr std::size_t DefaultPrefetchDepth = 16u;
+
+/// The maximum number of positions processed in a batch of prefetching.
+constexpr std::size_t MaxPrefetchDepth = 256u;
+
+///
+/// Prefetch analysis data into the cache.
+///
+/// @param   data  a pointer to analysis data.
+///
+/// It is only a hint and it never faults, even if the data has not been touched yet.
+///
+inline void prefetch_analysisData(const AnalysisData* data) noexcept {
+#if defined(__GNUC__)
+    __builtin_prefetch(data, 1, 0);
+#else
+    static_cast<void>(data);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
 ///
@@ -111,7 +155,7 @@ inline bool updateFlag_of_analysisData(AnalysisData data) {
 /// @return  the number of remaining turns.
 ///
 inline Turn turn_of_analysisData(AnalysisData data) {
-    return (data & 0x7ff8u) >> 3;
+    return ((data & 0x7ff8u) >> 3) ^ MaxTurn;
 }
 
 ///
@@ -134,7 +178,7 @@ inline AnalysisStatus status_of_analysisData(AnalysisData data) {
 ///
 inline AnalysisData to_analysisData(bool updateFlag, Turn turn, AnalysisStatus status) {
     return (static_cast<AnalysisData>(updateFlag) << 15) |
-        ((turn & 0x0fffu) << 3) |
+        (((turn ^ MaxTurn) & 0x0fffu) << 3) |
         (static_cast<AnalysisData>(status) & 0x0007u);
 }
 
@@ -157,7 +201,7 @@ inline AnalysisData set_updateFlag_of_analysisData(AnalysisData data, bool updat
 /// @return  the resulting analysis data.
 ///
 inline AnalysisData set_turn_of_analysisData(AnalysisData data, Turn turn) {
-    return (data & 0x8007u) | ((turn & 0x0fffu) << 3);
+    return (data & 0x8007u) | (((turn ^ MaxTurn) & 0x0fffu) << 3);
 }
 
 ///
@@ -171,6 +215,19 @@ inline AnalysisData set_status_of_analysisData(AnalysisData data, AnalysisStatus
     return (data & 0xfff8u) | (static_cast<AnalysisData>(status) & 0x0007u);
 }
 
+///
+/// Convert analysis data in the legacy encoding.
+///
+/// @param   data  analysis data recorded by gobb_analyzer 1.0.0 or earlier.
+/// @return  the resulting analysis data.
+///
+/// In the legacy encoding, the number of remaining turns was recorded as is, and the initial value
+/// of analysis data was not zero.
+///
+inline AnalysisData legacy_to_analysisData(AnalysisData data) {
+    return data ^ static_cast<AnalysisData>(MaxTurn << 3);
+}
+
 ///
 /// Check if the status code in the analysis data is valid.
 ///
@@ -301,6 +358,43 @@ struct AnalysisStatistics {
     void add(const AnalysisStatistics& other) noexcept;
 };
 
+///
+/// A strategy to execute analysis of a generation.
+///
+enum class AnalysisStrategy {
+    Serial = 0,  ///< Scan and update the table in a single thread.
+    Bucket = 1,  ///< Scan the table in multiple threads, and apply updates through per-region buckets.
+    Jacobi = 2,  ///< Like `Bucket`, but read the table of the previous generation.
+    Forked = 3   ///< Like `Jacobi`, but scan and update shards of a shared table in forked worker processes.
+};
+
+/// The number of table indexes scanned by a thread in a round of the `AnalysisStrategy::Bucket` strategy.
+constexpr std::size_t BucketChunkSize = 0x1'0000u;
+
+///
+/// The maximum number of shards in the `AnalysisStrategy::Forked` strategy.
+///
+/// The table is divided into shards at multiples of 7 large quad indices (111 in total), so that shards
+/// are contiguous both in the linear and the tiled layouts.
+///
+constexpr int MaxShardNums = 111;
+
+///
+/// A checkpoint in the middle of analysis.
+///
+/// It records where to resume the analysis, together with a table of analysis data.
+///
+struct AnalysisCheckpoint {
+    Generation generation;               ///< the generation being analyzed.
+    AnalysisStrategy strategy;           ///< the strategy which wrote the checkpoint.
+    std::uint32_t threadNums;            ///< the number of threads in the `AnalysisStrategy::Bucket` strategy.
+    std::uint64_t cursor;                ///< where to resume the generation (0 means the beginning).
+    bool tiledLayout;                    ///< whether the table was in the tiled layout, which orders the cursor.
+    bool updated;                        ///< whether the table has been updated in the generation so far.
+    AnalysisStatistics stats;            ///< statistics of the analysis before the generation.
+    AnalysisStatistics generationStats;  ///< statistics of the generation so far.
+};
+
 ////////////////////////////////////////////////////////////////////////////
 
 ///
@@ -365,6 +459,85 @@ public:
     ///
     virtual Generation load_latest(AnalysisStatistics& stats, AnalysisData* table, std::size_t tableSize) const = 0;
 
+    ///
+    /// Store a checkpoint and analysis data.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @param   table       a table of analysis data.
+    /// @param   tableSize   the number of elements in `table`.
+    /// @return  true upon success.
+    ///
+    /// Only the latest checkpoint is kept.
+    ///
+    virtual bool store_checkpoint(const AnalysisCheckpoint& checkpoint, const AnalysisData* table,
+        std::size_t tableSize) = 0;
+
+    ///
+    /// Find a stored checkpoint, without loading analysis data.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @return  true if a checkpoint is found.
+    ///
+    virtual bool find_checkpoint(AnalysisCheckpoint& checkpoint) const = 0;
+
+    ///
+    /// Load a checkpoint and analysis data.
+    ///
+    /// @param   checkpoint  a checkpoint.
+    /// @param   table       a table of analysis data.
+    /// @param   tableSize   the number of elements in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_checkpoint(AnalysisCheckpoint& checkpoint, AnalysisData* table,
+        std::size_t tableSize) const = 0;
+
+    ///
+    /// Remove a stored checkpoint.
+    ///
+    virtual void remove_checkpoint() = 0;
+
+    ///
+    /// Store a table of win/draw/loss values and its statistics.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   complete   false if the analysis has been interrupted.
+    /// @param   table      a table of WDL values, 2 bits per position.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_wdl(const AnalysisStatistics& stats, bool complete, const std::uint8_t* table,
+        std::size_t tableSize) = 0;
+
+    ///
+    /// Load a table of win/draw/loss values and its statistics.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   complete   false if the analysis has been interrupted.
+    /// @param   table      a table of WDL values, 2 bits per position.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+        std::size_t tableSize) const = 0;
+
+    ///
+    /// Store a bitmap of positions reachable from the initial position.
+    ///
+    /// @param   bitmap      a bitmap, one bit for each position ID.
+    /// @param   bitmapSize  the number of bytes in `bitmap`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_reachability(const std::uint8_t* bitmap, std::size_t bitmapSize) = 0;
+
+    ///
+    /// Load a bitmap of positions reachable from the initial position.
+    ///
+    /// @param   bitmap      a bitmap, one bit for each position ID.
+    /// @param   bitmapSize  the number of bytes in `bitmap`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_reachability(std::uint8_t* bitmap, std::size_t bitmapSize) const = 0;
+
     ///
     /// Removes resources not used any longer for loading and storing analysis data.
     ///
@@ -373,6 +546,98 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////
 
+///
+/// I/O handler for loading and storing data exported from analysis data.
+///
+/// This is an abstract class.  Analyzers don't use it; an exporter stores the data through it, and
+/// inspectors load them.
+///
+class ExportDataIOHandler {
+public:
+    ///
+    /// Destructor.
+    ///
+    virtual ~ExportDataIOHandler();
+
+    ///
+    /// Store an opening database.
+    ///
+    /// @param   stats      statistics data.
+    /// @param   ids        minimized position IDs of the entries, in ascending order.
+    /// @param   data       analysis data of the entries.
+    /// @param   entryNums  the number of entries.
+    /// @return  true upon success.
+    ///
+    virtual bool store_opening(const AnalysisStatistics& stats, const std::uint32_t* ids, const AnalysisData* data,
+        std::size_t entryNums) = 0;
+
+    ///
+    /// Load an opening database.
+    ///
+    /// @param   stats  statistics data.
+    /// @param   ids    minimized position IDs of the entries, in ascending order.
+    /// @param   data   analysis data of the entries.
+    /// @return  true upon success.
+    ///
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const = 0;
+
+    ///
+    /// Store a best-move table.
+    ///
+    /// @param   table      a best-move table, one byte for each position ID.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_best_moves(const std::uint8_t* table, std::size_t tableSize) = 0;
+
+    ///
+    /// Load a best-move table.
+    ///
+    /// @param   table      a best-move table, one byte for each position ID.
+    /// @param   tableSize  the number of bytes in `table`.
+    /// @return  true upon success.
+    ///
+    virtual bool load_best_moves(std::uint8_t* table, std::size_t tableSize) const = 0;
+
+    ///
+    /// Store a late-game database.
+    ///
+    /// @param   stats              statistics data.
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board of the entries.
+    /// @param   ids                minimized position IDs of the entries, in ascending order.
+    /// @param   data               analysis data of the entries.
+    /// @param   entryNums          the number of entries.
+    /// @return  true upon success.
+    ///
+    virtual bool store_late_game(const AnalysisStatistics& stats, int offBoardPieceNums, const std::uint32_t* ids,
+        const AnalysisData* data, std::size_t entryNums) = 0;
+
+    ///
+    /// Load a late-game database.
+    ///
+    /// @param   stats              statistics data.
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board of the entries.
+    /// @param   ids                minimized position IDs of the entries, in ascending order.
+    /// @param   data               analysis data of the entries.
+    /// @return  true upon success.
+    ///
+    virtual bool load_late_game(AnalysisStatistics& stats, int& offBoardPieceNums, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const = 0;
+
+    ///
+    /// Store an image of a status index.
+    ///
+    /// @param   generation  the generation of the analysis data indexed.
+    /// @param   image       the image (see `status_index.hpp`).
+    /// @param   imageSize   the number of bytes in `image`.
+    /// @return  true upon success.
+    ///
+    virtual bool store_status_index(Generation generation, const std::uint8_t* image, std::size_t imageSize) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////
+
 ///
 /// A flag to select how often to store the analysis data.
 ///
@@ -499,6 +764,11 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////
 
+struct TablePlacementPolicy;
+enum class TablePageMode;
+enum class TableNumaMode;
+class ReachabilityBitmap;
+
 ///
 /// Perform retrograde analsys of Gobblet Gobblers.
 ///
@@ -519,6 +789,16 @@ public:
     ///
     Analyzer(AnalysisLogger& logger);
 
+    ///
+    /// Constructor.
+    ///
+    /// @param   logger           a logging instance to output messages.
+    /// @param   placementPolicy  how to place the table of analysis data in memory.
+    ///
+    /// The placement of the table actually in effect is reported to `logger`.
+    ///
+    Analyzer(AnalysisLogger& logger, const TablePlacementPolicy& placementPolicy);
+
     Analyzer(const Analyzer& other) = delete;
     Analyzer(Analyzer&& other) = delete;
     Analyzer& operator=(const Analyzer& other) = delete;
@@ -549,6 +829,10 @@ public:
     ///
     /// It loads the analysis data of the latest generation stored by the I/O handler, then resumes
     /// retrograde analysis.
+    /// If the I/O handler has a checkpoint newer than the latest generation, it resumes retrograde
+    /// analysis from the checkpoint instead.  A checkpoint taken in the middle of a generation can be
+    /// resumed only with the same strategy (and the same number of threads in the `AnalysisStrategy::Bucket`
+    /// strategy).
     /// If no stored analysis data is found, it reports a warning and starts retrograde analysis from
     /// the beginning.
     ///
@@ -569,15 +853,216 @@ public:
     ///
     bool resume(AnalysisDataIOHandler& handler, AnalysisDataIOMode mode, Generation generation);
 
+    ///
+    /// Pin the analysis thread, and threads of the `AnalysisStrategy::Bucket` and `AnalysisStrategy::Jacobi`
+    /// strategies, to CPUs.
+    ///
+    /// @param   enabled  true to pin the threads.
+    ///
+    /// The thread which owns a region is pinned to a CPU of the NUMA node where the region lies, if the
+    /// table is placed with `TableNumaMode::Block`.  The whole table is the region of the analysis thread.
+    /// Otherwise the threads are pinned to CPUs spread evenly across NUMA nodes.  The calling thread gets
+    /// its own CPU affinity back when start() or resume() returns.
+    ///
+    void set_thread_affinity(bool enabled) noexcept;
+
+    ///
+    /// Set the number of positions processed in a batch of prefetching.
+    ///
+    /// @param   depth  the number of positions.
+    ///
+    /// During the analysis of a generation, positions to be updated are picked up in batches.
+    /// For each batch, the analyzer first generates positions reachable by a move from the positions in
+    /// the batch, and prefetches their analysis data.  Then it reads and updates the analysis data.
+    /// `depth` is clamped between 1 and `MaxPrefetchDepth`.  If it is 1, the analysis data are read just
+    /// after they are prefetched, in the same way as the analysis without prefetching.
+    ///
+    void set_prefetch_depth(std::size_t depth) noexcept;
+
+    ///
+    /// Set the strategy to execute analysis of a generation.
+    ///
+    /// @param   strategy  a strategy.
+    ///
+    /// In the `AnalysisStrategy::Bucket` strategy, the table is divided into regions, one for each thread.
+    /// The analysis of a generation proceeds in rounds.  In a round, each thread scans a chunk of its own
+    /// region without writing the table, and appends updates of the table to buckets for the regions
+    /// which the updates target.  After all the threads have finished scanning, each thread applies the
+    /// updates in the buckets for its own region.  Thus every element of the table is written by a single
+    /// thread.  The updates applied in a round commute, so that the analysis reaches the same final result
+    /// as the `AnalysisStrategy::Serial` strategy.  Statistics of each generation may differ.
+    ///
+    /// The `AnalysisStrategy::Jacobi` strategy works in the same way as `AnalysisStrategy::Bucket`, except
+    /// that threads scan a copy of the table taken at the beginning of the generation.  An update made in a
+    /// generation is never seen until the next generation, so that the number of generations and statistics
+    /// of each generation don't depend on the number of threads.  It needs another table for the copy.
+    ///
+    void set_strategy(AnalysisStrategy strategy) noexcept;
+
+    ///
+    /// Set the number of threads used in the `AnalysisStrategy::Bucket` strategy.
+    ///
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    ///
+    void set_thread_nums(int threadNums) noexcept;
+
+    ///
+    /// Set the number of worker processes used in the `AnalysisStrategy::Forked` strategy.
+    ///
+    /// @param   shardNums  the number of worker processes, each of which writes a shard of the table.
+    ///                     It is clamped between 1 and `MaxShardNums`.
+    ///
+    /// In the `AnalysisStrategy::Forked` strategy, the table is divided into shards by large quad indices
+    /// of positions, and the analyzer forks a worker process for each shard at the first generation.  A
+    /// worker owns its shard until the analysis returns, and runs two phases of every generation on a
+    /// command from the analyzer.  In the first phase, each worker scans its own shard, and writes updates
+    /// of the table to message files, one for each shard which the updates target.  In the second phase,
+    /// each worker applies the updates in the message files for its own shard.  Like the
+    /// `AnalysisStrategy::Jacobi` strategy, the results of each generation don't depend on the number of
+    /// workers.
+    ///
+    /// A worker writes only its own shard, but it reads analysis data of positions in any shard while
+    /// scanning, so that all the workers map the whole table.  The table must have been allocated with
+    /// `TablePlacementPolicy::shared`, so that the table stored by the analyzer contains the results of
+    /// all the workers.
+    ///
+    void set_shard_nums(int shardNums) noexcept;
+
+    ///
+    /// Set a directory where message files of the `AnalysisStrategy::Forked` strategy are written.
+    ///
+    /// @param   dirName  a path to the directory.
+    ///
+    void set_work_directory(const std::string& dirName);
+
+    ///
+    /// Set a flag to request the analyzer to stop.
+    ///
+    /// @param   stopFlag  a flag set to non-zero by a signal handler, or nullptr.
+    ///
+    /// The analyzer polls the flag.  Once it is set, the analyzer stores a checkpoint at the next point
+    /// where it can pause, and returns from start() or resume() with interrupted() being true.
+    /// The `AnalysisStrategy::Serial` and `AnalysisStrategy::Bucket` strategies can pause in the middle
+    /// of a generation, while the other strategies pause only between generations.
+    ///
+    void set_stop_flag(const volatile std::sig_atomic_t* stopFlag) noexcept;
+
+    ///
+    /// Set the interval of checkpoints.
+    ///
+    /// @param   interval  wall-clock time between checkpoints.  If it is zero, no periodic checkpoint is
+    ///                    stored.
+    ///
+    /// A checkpoint is stored in the same places as those where the analyzer pauses on a stop request.
+    /// Storing analysis data of a generation also restarts the interval.
+    ///
+    void set_checkpoint_interval(std::chrono::seconds interval) noexcept;
+
+    ///
+    /// Restrict the analysis to positions reachable from the initial position.
+    ///
+    /// @param   enabled  true to restrict the analysis.
+    ///
+    /// If it is enabled, start() searches positions reachable from the initial position before the
+    /// initialization, and stores the bitmap of the reachable positions through the I/O handler.
+    /// Unreachable positions are marked with `AnalysisStatus::Contradictory`, since they never arise in
+    /// a game, so that they are never analyzed.  Reachable positions get the same results as an
+    /// unrestricted analysis.  It has no effect on resume(), because the marks are kept in the table.
+    ///
+    void set_reachability_filter(bool enabled) noexcept;
+
+    ///
+    /// Whether the last analysis has stopped on a stop request.
+    ///
+    /// @return  true if it has stopped before the analysis is complete.
+    ///
+    bool interrupted() const noexcept;
+
 private:
+    /// Unit tests access the internals through it.
+    friend class AnalyzerTestPeer;
+
+    ///
+    /// A position picked up in a batch of prefetching, with positions reachable by a move from it.
+    ///
+    struct PrefetchEntry {
+        Position position;                            ///< a position.
+        std::size_t index;                            ///< the table index of the position.
+        int moveNums;                                 ///< the number of `moveIndexes` (-1 if not generated).
+        int moveBackNums;                             ///< the number of `moveBackIndexes` (-1 if not generated).
+        std::size_t moveIndexes[MaxMoveNums];         ///< table indexes of positions after a move.
+        std::size_t moveBackIndexes[MaxMoveBackNums]; ///< table indexes of positions before a move.
+    };
+
+    ///
+    /// Kinds of updates of the table in the `AnalysisStrategy::Bucket` strategy.
+    ///
+    enum class TableUpdateKind: std::uint8_t {
+        SetLost       = 0,  ///< Mark the position with Lost, or decrease its turn.
+        SetWon        = 1,  ///< Mark the position with Won, or decrease its turn.
+        SetUpdateFlag = 2   ///< Set the update flag of the position.
+    };
+
+    ///
+    /// An update of the table in the `AnalysisStrategy::Bucket` strategy.
+    ///
+    struct TableUpdate {
+        std::uint32_t index;   ///< the table index of the position to be updated.
+        Turn turn;             ///< the number of turns (unused in `TableUpdateKind::SetUpdateFlag`).
+        TableUpdateKind kind;  ///< the kind of the update.
+    };
+
+    static_assert(AnalysisDataTableSize <= 0xffff'ffffu, "table indexes must fit TableUpdate::index");
+
+    /// Buckets of a thread, one for each region.
+    using TableUpdateBuckets = std::vector<std::vector<TableUpdate>>;
+
+    ///
+    /// Phases of a generation in the `AnalysisStrategy::Forked` strategy.
+    ///
+    enum class ShardPhase {
+        Scan  = 0,  ///< Scan shards, and write updates to message files.
+        Apply = 1   ///< Apply updates in message files.
+    };
+
+    ///
+    /// A result of a worker process sent to the analyzer through a pipe.
+    ///
+    struct ShardResult {
+        bool succeeded;            ///< whether the worker has succeeded.
+        bool updated;              ///< whether the table has been updated.
+        AnalysisStatistics stats;  ///< statistics of the shard in the generation.
+    };
+
+    ///
+    /// A worker process of the `AnalysisStrategy::Forked` strategy, seen from the analyzer.
+    ///
+    struct ShardWorker {
+        int processId;  ///< the process ID of the worker.
+        int commandFd;  ///< the pipe to send a phase to the worker.
+        int resultFd;   ///< the pipe to receive a result from the worker.
+    };
+
     ///
     /// Initialize a table of analysis data.
     ///
+    /// @param   reachable  a bitmap of reachable positions, or nullptr to analyze all positions.
     /// @return  true if the table has been updated.
     ///
     /// It sets an initial data for each position.
+    /// The table must be filled with `UnfixedAnalysisData` in advance.  Since `UnfixedAnalysisData` is zero,
+    /// a table just allocated by `allocate_analysisDataTable()` satisfies the condition.
+    ///
+    bool initialize(const ReachabilityBitmap* reachable);
+
     ///
-    bool initialize() noexcept;
+    /// Search positions reachable from the initial position, and store the bitmap.
+    ///
+    /// @param   handler    an I/O handler to store the bitmap.
+    /// @param   reachable  a bitmap to be computed.
+    /// @return  true upon success.
+    ///
+    bool compute_reachability(AnalysisDataIOHandler& handler, ReachabilityBitmap& reachable);
 
     ///
     /// Perform retrograde analysis.
@@ -590,49 +1075,280 @@ private:
     ///
     bool analyze(AnalysisDataIOHandler& handler, AnalysisDataIOMode mode);
 
+    ///
+    /// Resume retrograde analysis from a checkpoint.
+    ///
+    /// @param   handler           an I/O handler to store the analysis data.
+    /// @param   mode              how often to store the analysis data.
+    /// @param   checkpoint        the header of the checkpoint found by the I/O handler.
+    /// @param   storedGeneration  the generation of the latest stored analysis data.
+    /// @return  true upon success.
+    ///
+    bool resume(AnalysisDataIOHandler& handler, AnalysisDataIOMode mode, const AnalysisCheckpoint& checkpoint,
+        Generation storedGeneration);
+
+    ///
+    /// Whether the stop flag is set.
+    ///
+    /// @return  true if a stop is requested.
+    ///
+    bool stop_requested() const noexcept;
+
+    ///
+    /// Whether the analysis should pause to store a checkpoint.
+    ///
+    /// @return  true if a stop is requested or the checkpoint interval has elapsed.
+    ///
+    bool should_pause() const noexcept;
+
+    ///
+    /// Store a checkpoint of the current state of the analysis.
+    ///
+    /// @param   handler  an I/O handler to store the checkpoint.
+    /// @return  true upon success.
+    ///
+    bool store_checkpoint(AnalysisDataIOHandler& handler);
+
     ///
     /// Perform retrograde analysis of the current generation.
     ///
+    /// @param   stats    statistics of the current generation.
+    /// @param   cursor   the table index to start from.  On return, the table index to continue from.
+    /// @param   updated  set to true if the table has been updated.
+    /// @return  true if the generation is complete, false if it has paused by should_pause().
+    ///
+    bool analyze_generation(AnalysisStatistics& stats, std::size_t& cursor, bool& updated) noexcept;
+
+    ///
+    /// Return CPUs to which threads working on regions of the table are pinned.
+    ///
+    /// @param   regionNums  the number of regions.
+    /// @param   regionSize  the number of table indexes in a region.
+    /// @return  a CPU number for each region, or an empty vector if CPUs of NUMA nodes are not available.
+    ///
+    std::vector<int> region_cpus(int regionNums, std::size_t regionSize) const;
+
+    ///
+    /// Perform retrograde analysis of a generation in the `AnalysisStrategy::Bucket` strategy.
+    ///
+    /// @param   stats    statistics of the current generation.
+    /// @param   jacobi   true in the `AnalysisStrategy::Jacobi` strategy.
+    /// @param   cursor   the round to start from.  On return, the round to continue from.
+    /// @param   updated  set to true if the table has been updated.
+    /// @return  true if the generation is complete, false if it has paused by should_pause().
+    ///
+    /// It throws an exception if it fails to create threads or to allocate buckets.
+    /// It pauses only between rounds, and never in the `AnalysisStrategy::Jacobi` strategy.
+    ///
+    bool analyze_generation_bucket(AnalysisStatistics& stats, bool jacobi, std::size_t& cursor, bool& updated);
+
+    ///
+    /// Scan a chunk of the table and append updates to buckets.
+    ///
+    /// @param   table       a table to be scanned.
+    /// @param   begin       the first table index of the chunk.
+    /// @param   end         the table index next to the last of the chunk.
+    /// @param   regionSize  the number of table indexes in a region.
+    /// @param   buckets     buckets of the thread.
+    /// @param   entry       a work area.
+    /// @return  true if the scan results in an update of the table.
+    ///
+    /// It reads `table`, but doesn't write it.
+    ///
+    bool scan_chunk(const AnalysisData* table, std::size_t begin, std::size_t end, std::size_t regionSize,
+        TableUpdateBuckets& buckets, PrefetchEntry& entry) const;
+
+    ///
+    /// Apply updates in buckets for a region.
+    ///
+    /// @param   region   the region number.
+    /// @param   begin    the first table index of the chunk whose update flags are cleared.
+    /// @param   end      the table index next to the last of the chunk whose update flags are cleared.
+    /// @param   buckets  buckets of all the threads.
+    /// @param   stats    statistics of the current generation.
+    /// @return  true if the table has been updated.
+    ///
+    /// It clears the update flags of positions in the scanned chunk, then applies the updates.  Elements
+    /// without the update flag are not written, so that untouched pages of the table stay unmapped.
+    /// The buckets for the region are emptied.
+    ///
+    bool apply_buckets(int region, std::size_t begin, std::size_t end, std::vector<TableUpdateBuckets>& buckets,
+        AnalysisStatistics& stats) noexcept;
+
+    ///
+    /// Apply updates of the table.
+    ///
+    /// @param   updates     updates of the table.
+    /// @param   updateNums  the number of updates.
+    /// @param   stats       statistics of the current generation.
+    /// @return  true if the table has been updated.
+    ///
+    bool apply_table_updates(const TableUpdate* updates, std::size_t updateNums, AnalysisStatistics& stats)
+        noexcept;
+
+    ///
+    /// Perform retrograde analysis of a generation in the `AnalysisStrategy::Forked` strategy.
+    ///
+    /// @param   stats  statistics of the current generation.
+    /// @return  true if the table has been updated.
+    ///
+    /// It throws an exception if a worker process fails.
+    ///
+    bool analyze_generation_forked(AnalysisStatistics& stats);
+
+    ///
+    /// Send a phase of the generation to the worker processes of all the shards, and wait for them.
+    ///
+    /// @param   phase    a phase of the generation.
+    /// @param   results  results of the workers.
+    ///
+    /// It throws an exception if a worker process fails.  The worker processes are stopped then.
+    ///
+    void run_shard_workers(ShardPhase phase, std::vector<ShardResult>& results);
+
+    ///
+    /// Create a worker process for each shard.
+    ///
+    /// It throws an exception if it fails to create a worker process.
+    ///
+    void start_shard_workers();
+
+    ///
+    /// Stop the worker processes, and wait for them to exit.
+    ///
+    /// It does nothing if no worker process is running.
+    ///
+    void stop_shard_workers() noexcept;
+
+    ///
+    /// Run phases sent by the analyzer until it closes the pipe, and exit (in a worker process).
+    ///
+    /// @param   shard      a shard number.
+    /// @param   commandFd  the pipe to receive a phase from the analyzer.
+    /// @param   resultFd   the pipe to send a result to the analyzer.
+    ///
+    [[noreturn]] void serve_shard(int shard, int commandFd, int resultFd);
+
+    ///
+    /// Scan a shard and write updates to message files (in a worker process).
+    ///
+    /// @param   shard   a shard number.
+    /// @param   result  a result of the worker.
+    ///
+    /// It throws an exception if it fails to write a message file.
+    ///
+    void scan_shard(int shard, ShardResult& result) const;
+
+    ///
+    /// Apply updates in message files for a shard (in a worker process).
+    ///
+    /// @param   shard   a shard number.
+    /// @param   result  a result of the worker.
+    ///
+    /// It throws an exception if it fails to read a message file.
+    ///
+    void apply_shard(int shard, ShardResult& result);
+
+    ///
+    /// Return the number of table indexes in a shard.
+    ///
+    /// @return  the number of table indexes.  The last shard may be smaller or larger.
+    ///
+    std::size_t shard_size() const noexcept;
+
+    ///
+    /// Return a path to a message file.
+    ///
+    /// @param   from  the shard number of the writer.
+    /// @param   to    the shard number of the reader.
+    /// @return  a path to the message file.
+    ///
+    std::string shard_message_path(int from, int to) const;
+
+    ///
+    /// Check whether all positions after a move from the position in the entry are marked with Won or
+    /// WonStalemate.
+    ///
+    /// @param   table     a table of analysis data.
+    /// @param   entry     an entry.
+    /// @param   nextTurn  the number of turns of the position if it is marked with Lost.
+    /// @return  true if all the positions are marked with Won or WonStalemate.
+    ///
+    /// Moves of the entry must have been generated.
+    ///
+    bool moves_all_won(const AnalysisData* table, const PrefetchEntry& entry, Turn& nextTurn) const noexcept;
+
+    ///
+    /// Pick up positions to be updated and prefetch analysis data of positions reachable from them.
+    ///
+    /// @param   start  a table index where picking up starts.
+    /// @param   end    a table index where picking up ends.  It is updated to the table index next to
+    ///                 the last position picked up.
+    /// @return  the number of positions picked up.
+    ///
+    /// It picks up at most `prefetchDepth_` positions with the update flag set, in the order of the
+    /// table indexes.
+    ///
+    std::size_t prefetch_batch(std::size_t start, std::size_t& end) noexcept;
+
+    ///
+    /// Perform retrograde analysis of a position.
+    ///
     /// @param   stats  statistics of the current generation.
+    /// @param   entry  a position with the update flag set.
     /// @return  true if the table has been updated.
     ///
-    bool analyze_generation(AnalysisStatistics& stats) noexcept;
+    bool analyze_position(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept;
+
+    ///
+    /// Generate positions after a move from the position in the entry, if not generated yet.
+    ///
+    /// @param   entry  an entry.
+    ///
+    void generate_moves(PrefetchEntry& entry) const noexcept;
+
+    ///
+    /// Generate positions before a move to the position in the entry, if not generated yet.
+    ///
+    /// @param   entry  an entry.
+    ///
+    void generate_move_backs(PrefetchEntry& entry) const noexcept;
 
     ///
     /// Update analysis status of previous positions of the position marked with Lost or LostStalemate.
     ///
     /// @param   stats  statistics data of the current generation.
-    /// @param   pos    a position marked with Lost or LostStalemate.
+    /// @param   entry  a position marked with Lost or LostStalemate.
     /// @return  true if the analysis data table has been updated.
     ///
     /// If a position P is marked with Lost or LostStalemate, we mark all the previous positions of P
     /// with Win.
     ///
-    bool analyze_move_backs_from_active_player_lost(AnalysisStatistics& stats, const Position& pos) noexcept;
+    bool analyze_move_backs_from_active_player_lost(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept;
 
     ///
     /// Update analysis status of positions just before the position marked with Won or WonStalemate.
     ///
     /// @param   stats  statistics data of the current generation.
-    /// @param   pos    a position marked with Won or WonStalemate.
+    /// @param   entry  a position marked with Won or WonStalemate.
     /// @return  true if the analysis data table has been updated.
     ///
     /// If a position P is marked with Won or WonStalemate, we set the update flags of all the previous
     /// positions of P.
     ///
-    bool analyze_move_backs_from_active_player_won(AnalysisStatistics& stats, const Position& pos) noexcept;
+    bool analyze_move_backs_from_active_player_won(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept;
 
     ///
     /// Try to update analysis status of a position marked with Unfixed or Lost.
     ///
     /// @param   stats  statistics data of the current generation.
-    /// @param   pos    a position marked with Unfixed or Lost.
+    /// @param   entry  a position marked with Unfixed or Lost.
     /// @return  true if the analysis data table has been updated.
     ///
     /// If all the subsequent positions of the position P are marked with either Won or WonStalemate,
     /// we mark the position P as Lost.
     ///
-    bool analyze_unfixed_or_lost(AnalysisStatistics& stats, const Position& pos) noexcept;
+    bool analyze_unfixed_or_lost(AnalysisStatistics& stats, PrefetchEntry& entry) noexcept;
 
     ///
     /// Count possible movements at the position.
@@ -653,6 +1369,15 @@ private:
     ///
     int on_board_piece_nums(const Position& pos, PlayerId player) const noexcept;
 
+    ///
+    /// Count positions with the update flag.
+    ///
+    /// @return  the number of positions to be analyzed in the current generation.
+    ///
+    /// The table is divided among threads.
+    ///
+    PositionId count_flagged_positions() const;
+
     ///
     /// Output statistics report.
     ///
@@ -661,6 +1386,14 @@ private:
     ///
     void log_statistics(Generation generation, AnalysisStatistics& stats);
 
+    ///
+    /// Output elapsed time of a generation.
+    ///
+    /// @param   generation  a generation number.
+    /// @param   startTime   the time when the generation started.
+    ///
+    void log_elapsed_time(Generation generation, std::chrono::steady_clock::time_point startTime);
+
     /// The current generation.
     Generation generation_;
 
@@ -670,9 +1403,72 @@ private:
     /// Analysis data of all positions.
     AnalysisData* analysisDataTable_;
 
+    /// A copy of the table at the beginning of a generation (`AnalysisStrategy::Jacobi` only).
+    AnalysisData* previousTable_;
+
+    /// Pages backing the tables.
+    TablePageMode pageMode_;
+
+    /// Placement of the tables across NUMA nodes.
+    TableNumaMode numaMode_;
+
     /// Statistics of the analysis.
     AnalysisStatistics statistics_;
 
+    /// Whether the table is divided into blocks on NUMA nodes (`TableNumaMode::Block`).
+    bool tableInBlocks_;
+
+    /// Whether to pin threads to CPUs.
+    bool threadAffinity_;
+
+    /// The number of positions processed in a batch of prefetching.
+    std::size_t prefetchDepth_;
+
+    /// Positions picked up in the current batch of prefetching.
+    std::vector<PrefetchEntry> prefetchEntries_;
+
+    /// The strategy to execute analysis of a generation.
+    AnalysisStrategy strategy_;
+
+    /// The number of threads used in the `AnalysisStrategy::Bucket` strategy.
+    int threadNums_;
+
+    /// The number of worker processes used in the `AnalysisStrategy::Forked` strategy.
+    int shardNums_;
+
+    /// A directory where message files are written.
+    std::string workDir_;
+
+    /// Worker processes in the `AnalysisStrategy::Forked` strategy, while an analysis is running.
+    std::vector<ShardWorker> shardWorkers_;
+
+    /// Whether the table is shared with child processes.
+    bool tableShared_;
+
+    /// Where the current generation continues from (a table index or a round).
+    std::size_t cursor_;
+
+    /// Statistics of the current generation so far.
+    AnalysisStatistics generationStats_;
+
+    /// Whether the table has been updated in the current generation so far.
+    bool generationUpdated_;
+
+    /// A flag to request the analyzer to stop.
+    const volatile std::sig_atomic_t* stopFlag_;
+
+    /// The interval of checkpoints.
+    std::chrono::seconds checkpointInterval_;
+
+    /// When the last checkpoint or analysis data was stored.
+    std::chrono::steady_clock::time_point lastCheckpointTime_;
+
+    /// Whether the last analysis has stopped on a stop request.
+    bool interrupted_;
+
+    /// Whether the analysis is restricted to reachable positions.
+    bool reachabilityFilter_;
+
     /// Logger.
     AnalysisLogger& logger_;
 };
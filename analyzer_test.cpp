@@ -0,0 +1,823 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fmt/core.h>
+#include "analyzer.hpp"
+#include "analysis_data_file_handler.hpp"
+#include "analysis_data_table.hpp"
+#include "best_move_table.hpp"
+#include "wdl_analyzer.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+namespace gobb_analyzer {
+
+//
+// Access to the internals of Analyzer for the tests.
+//
+class AnalyzerTestPeer {
+public:
+    using TableUpdate = Analyzer::TableUpdate;
+    using TableUpdateKind = Analyzer::TableUpdateKind;
+
+    static AnalysisData* table(Analyzer& analyzer) {
+        return analyzer.analysisDataTable_;
+    }
+
+    static bool apply_table_updates(Analyzer& analyzer, const std::vector<TableUpdate>& updates,
+        AnalysisStatistics& stats) {
+        return analyzer.apply_table_updates(updates.data(), updates.size(), stats);
+    }
+
+    static std::size_t shard_worker_nums(const Analyzer& analyzer) {
+        return analyzer.shardWorkers_.size();
+    }
+};
+
+//
+// Access to the internals of WdlAnalyzer for the tests.
+//
+class WdlAnalyzerTestPeer {
+public:
+    static void fill(WdlAnalyzer& analyzer, WdlValue value) {
+        std::uint8_t byte = 0u;
+        for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+            byte = set_wdlValue_of_byte(byte, id, value);
+        }
+        std::memset(reinterpret_cast<std::uint8_t*>(analyzer.table_.get()), byte, WdlTableSize);
+    }
+
+    static WdlValue value(const WdlAnalyzer& analyzer, PositionId id) {
+        return analyzer.value(id);
+    }
+
+    static void set_value(WdlAnalyzer& analyzer, PositionId id, WdlValue value) {
+        analyzer.set_value(id, value);
+    }
+
+    static void mark(WdlAnalyzer& analyzer, PositionId id) {
+        analyzer.mark(id);
+    }
+
+    static void scan_range(WdlAnalyzer& analyzer, PositionId begin, PositionId end, AnalysisStatistics& stats) {
+        analyzer.scan_range(begin, end, stats);
+    }
+
+    static void analyze_range(WdlAnalyzer& analyzer, PositionId begin, PositionId end, AnalysisStatistics& stats) {
+        analyzer.analyze_range(begin, end, stats);
+    }
+};
+
+} // namespace gobb_analyzer
+
+namespace {
+
+using TableUpdate = AnalyzerTestPeer::TableUpdate;
+using TableUpdateKind = AnalyzerTestPeer::TableUpdateKind;
+
+/// Table entries which are not `UnfixedAnalysisData`, with their table indexes.
+using TableEntries = std::vector<std::pair<std::size_t, AnalysisData>>;
+
+//
+// A logger which discards all messages.
+//
+class NullLogger: public AnalysisLogger {
+public:
+    virtual void info() {}
+    virtual void info(const std::string&) {}
+    virtual void notice() {}
+    virtual void notice(const std::string&) {}
+    virtual void warn() {}
+    virtual void warn(const std::string&) {}
+    virtual void error() {}
+    virtual void error(const std::string&) {}
+};
+
+//
+// A logger which sets a stop flag when the given generation starts, so that the analysis pauses at the
+// first chance in the middle of the generation.
+//
+class StoppingLogger: public NullLogger {
+public:
+    StoppingLogger(Generation generation, volatile std::sig_atomic_t& stopFlag)
+        : startMessage_(fmt::format("analyze the generation {}.", static_cast<int>(generation))),
+          stopFlag_(stopFlag) {
+    }
+
+    using NullLogger::notice;
+    virtual void notice(const std::string& message) {
+        if (message == startMessage_) {
+            stopFlag_ = 1;
+        }
+    }
+
+private:
+    std::string startMessage_;
+    volatile std::sig_atomic_t& stopFlag_;
+};
+
+//
+// A logger which counts the given notice message and the generations.
+//
+class CountingLogger: public NullLogger {
+public:
+    explicit CountingLogger(const std::string& message)
+        : message_(message),
+          messageNums_(0),
+          generationNums_(0) {
+    }
+
+    using NullLogger::notice;
+    virtual void notice(const std::string& message) {
+        if (message == message_) {
+            messageNums_++;
+        }
+        if (message.compare(0, 23u, "analyze the generation ") == 0) {
+            generationNums_++;
+        }
+    }
+
+    int message_nums() const { return messageNums_; }
+    int generation_nums() const { return generationNums_; }
+
+private:
+    std::string message_;
+    int messageNums_;
+    int generationNums_;
+};
+
+//
+// An I/O handler which keeps everything in memory.
+//
+// It has analysis data of the generation 0 whose table consists of the given entries, and keeps the
+// statistics of the stored generations.
+//
+class MemoryHandler: public AnalysisDataIOHandler {
+public:
+    explicit MemoryHandler(const TableEntries& entries)
+        : initialEntries_(entries),
+          storedGeneration_(InvalidGeneration),
+          storedStatistics_(),
+          checkpoint_(),
+          hasCheckpoint_(false),
+          checkpointEntries_() {
+    }
+
+    virtual bool store(Generation generation, const AnalysisStatistics& stats, const AnalysisData*, std::size_t) {
+        storedGeneration_ = generation;
+        storedStatistics_.push_back(stats);
+        return true;
+    }
+    virtual bool load(Generation generation, AnalysisStatistics&, AnalysisData* table, std::size_t) const {
+        if (generation != 0u) {
+            return false;
+        }
+        for (const auto& entry: initialEntries_) {
+            table[entry.first] = entry.second;
+        }
+        return true;
+    }
+    virtual Generation find_latest() const { return 0u; }
+    virtual Generation load_latest(AnalysisStatistics& stats, AnalysisData* table, std::size_t tableSize) const {
+        return load(0u, stats, table, tableSize) ? 0u : InvalidGeneration;
+    }
+    virtual bool store_checkpoint(const AnalysisCheckpoint& checkpoint, const AnalysisData* table,
+        std::size_t tableSize) {
+        checkpoint_ = checkpoint;
+        hasCheckpoint_ = true;
+        checkpointEntries_.clear();
+        for (std::size_t i = 0u; i < tableSize / sizeof(AnalysisData); i++) {
+            if (table[i] != UnfixedAnalysisData) {
+                checkpointEntries_.emplace_back(i, table[i]);
+            }
+        }
+        return true;
+    }
+    virtual bool find_checkpoint(AnalysisCheckpoint& checkpoint) const {
+        checkpoint = checkpoint_;
+        return hasCheckpoint_;
+    }
+    virtual bool load_checkpoint(AnalysisCheckpoint& checkpoint, AnalysisData* table, std::size_t) const {
+        if (!hasCheckpoint_) {
+            return false;
+        }
+        checkpoint = checkpoint_;
+        for (const auto& entry: checkpointEntries_) {
+            table[entry.first] = entry.second;
+        }
+        return true;
+    }
+    virtual void remove_checkpoint() { hasCheckpoint_ = false; }
+    virtual bool store_wdl(const AnalysisStatistics&, bool, const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_wdl(AnalysisStatistics&, bool&, std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_reachability(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_reachability(std::uint8_t*, std::size_t) const { return false; }
+    virtual void clean() {}
+
+    Generation stored_generation() const { return storedGeneration_; }
+    const std::vector<AnalysisStatistics>& stored_statistics() const { return storedStatistics_; }
+
+private:
+    TableEntries initialEntries_;
+    Generation storedGeneration_;
+    std::vector<AnalysisStatistics> storedStatistics_;
+    AnalysisCheckpoint checkpoint_;
+    bool hasCheckpoint_;
+    TableEntries checkpointEntries_;
+};
+
+//
+// Return table entries of positions just after a player has lined up three pieces, found by random games.
+// They are marked with Lost in 0 turn and the update flag, as the initialization does.
+//
+TableEntries lined_up_position_entries(std::size_t nums) {
+    std::mt19937 random(1u);
+    std::set<std::size_t> indexes;
+    while (indexes.size() < nums) {
+        Position pos(InitialPositionId);
+        for (int ply = 0; ply < 64; ply++) {
+            std::vector<Position> nextPositions;
+            for (PieceId piece: ActivePlayerPieceIds) {
+                LocationIdPair locPair = pos.locations_of_piece(piece);
+                for (LocationId src: locPair.locations) {
+                    for (LocationId dst: OnBoardLocationIds) {
+                        MoveResult moveResult = pos.move(piece, src, dst);
+                        if (moveResult.status == MoveResultStatus::Success) {
+                            nextPositions.push_back(moveResult.position);
+                        }
+                    }
+                }
+            }
+            if (nextPositions.empty()) {
+                break;
+            }
+            pos = nextPositions[random() % nextPositions.size()];
+            if (pos.is_winner(PlayerId::Inactive)) {
+                if (!pos.is_winner(PlayerId::Active)) {
+                    indexes.insert(table_index(pos.minimize_id()));
+                }
+                break;
+            }
+        }
+    }
+
+    TableEntries entries;
+    for (std::size_t index: indexes) {
+        entries.emplace_back(index, to_analysisData(true, 0u, AnalysisStatus::Lost));
+    }
+    return entries;
+}
+
+//
+// Return table entries which are not `UnfixedAnalysisData`.
+//
+TableEntries table_entries(const AnalysisData* table) {
+    TableEntries entries;
+    for (std::size_t i = 0u; i < AnalysisDataTableSize; i++) {
+        if (table[i] != UnfixedAnalysisData) {
+            entries.emplace_back(i, table[i]);
+        }
+    }
+    return entries;
+}
+
+//
+// Return true if two statistics have the same counters.
+//
+bool same_statistics(const AnalysisStatistics& x, const AnalysisStatistics& y) {
+    return x.lostNums == y.lostNums
+        && x.lostStalemateNums == y.lostStalemateNums
+        && x.wonNums == y.wonNums
+        && x.transformedNums == y.transformedNums
+        && x.contradictoryNums == y.contradictoryNums
+        && x.unfixedNums == y.unfixedNums;
+}
+
+//
+// Return a placement policy of the table for a strategy.
+//
+TablePlacementPolicy placement_policy(AnalysisStrategy strategy) {
+    TablePlacementPolicy policy;
+    policy.numaMode = TableNumaMode::None;
+    policy.shared = (strategy == AnalysisStrategy::Forked);
+    return policy;
+}
+
+//
+// Set a strategy, the number of its threads or processes, and a work directory to an analyzer.
+//
+void configure_analyzer(Analyzer& analyzer, AnalysisStrategy strategy, int nums, const std::string& workDir) {
+    analyzer.set_strategy(strategy);
+    analyzer.set_thread_nums(nums);
+    analyzer.set_shard_nums(nums);
+    analyzer.set_work_directory(workDir);
+}
+
+//
+// Run the analysis from the generation 0 with the given entries until it completes, and return the final
+// entries.  If `generationStats` is not null, statistics of all the generations are stored into it.
+//
+TableEntries analyze_entries(const TableEntries& entries, AnalysisStrategy strategy, int nums,
+    const std::string& workDir, std::size_t prefetchDepth = DefaultPrefetchDepth,
+    std::vector<AnalysisStatistics>* generationStats = nullptr) {
+    NullLogger logger;
+    Analyzer analyzer(logger, placement_policy(strategy));
+    configure_analyzer(analyzer, strategy, nums, workDir);
+    analyzer.set_prefetch_depth(prefetchDepth);
+
+    MemoryHandler handler(entries);
+    AnalysisDataIOMode ioMode = AnalysisDataIOMode::StoreFinalGeneration;
+    if (generationStats != nullptr) {
+        ioMode = AnalysisDataIOMode::StoreEveryGenerations;
+    }
+    EXPECT_TRUE(analyzer.resume(handler, ioMode));
+    EXPECT_NE(handler.stored_generation(), InvalidGeneration);
+    if (generationStats != nullptr) {
+        *generationStats = handler.stored_statistics();
+    }
+    return table_entries(AnalyzerTestPeer::table(analyzer));
+}
+
+//
+// Solve win/draw/loss by WdlAnalyzer from the given initial entries, and test that it gives the same
+// win/draw/loss as the final entries of the analysis.
+//
+// Only the positions fixed by the analysis are unfixed in the WDL table, and the other positions are
+// excluded, so that passes over the whole table are not needed.  An excluded position is treated as a draw
+// when a position looks up the positions after its moves, and it is never marked.  It is solved once by
+// scan passes only, and once by propagation passes only, from the initial entries marked as if a scan
+// pass had fixed them.  A scan pass after the analysis is complete must fix nothing.
+//
+void test_wdl_values(const TableEntries& initialEntries, const TableEntries& finalEntries) {
+    for (bool scanning: {true, false}) {
+        NullLogger logger;
+        WdlAnalyzer analyzer(logger);
+        WdlAnalyzerTestPeer::fill(analyzer, WdlValue::Excluded);
+
+        std::vector<PositionId> ids;
+        for (const auto& entry: finalEntries) {
+            ids.push_back(table_index_to_id(entry.first));
+            WdlAnalyzerTestPeer::set_value(analyzer, ids.back(), WdlValue::Unknown);
+        }
+        for (const auto& entry: initialEntries) {
+            WdlAnalyzerTestPeer::set_value(analyzer, table_index_to_id(entry.first), WdlValue::Lost);
+            WdlAnalyzerTestPeer::mark(analyzer, table_index_to_id(entry.first));
+        }
+
+        for (;;) {
+            AnalysisStatistics stats;
+            for (PositionId id: ids) {
+                if (scanning) {
+                    WdlAnalyzerTestPeer::scan_range(analyzer, id, id + 1u, stats);
+                } else {
+                    WdlAnalyzerTestPeer::analyze_range(analyzer, id, id + 1u, stats);
+                }
+            }
+            if (stats.lostNums == 0u && stats.wonNums == 0u) {
+                break;
+            }
+        }
+
+        AnalysisStatistics scanStats;
+        for (PositionId id: ids) {
+            WdlAnalyzerTestPeer::scan_range(analyzer, id, id + 1u, scanStats);
+        }
+        ASSERT_EQ(scanStats.lostNums, 0u);
+        ASSERT_EQ(scanStats.wonNums, 0u);
+
+        std::size_t wonNums = 0u;
+        std::size_t lostNums = 0u;
+        for (const auto& entry: finalEntries) {
+            AnalysisStatus status = status_of_analysisData(entry.second);
+            WdlValue expected = WdlValue::Unknown;
+            if (status == AnalysisStatus::Won || status == AnalysisStatus::WonStalemate) {
+                expected = WdlValue::Won;
+                wonNums++;
+            } else if (status == AnalysisStatus::Lost || status == AnalysisStatus::LostStalemate) {
+                expected = WdlValue::Lost;
+                lostNums++;
+            }
+            ASSERT_EQ(expected, WdlAnalyzerTestPeer::value(analyzer, table_index_to_id(entry.first)))
+                << (scanning ? "scan" : "propagation");
+        }
+        ASSERT_GT(wonNums, 0u);
+        ASSERT_GE(lostNums, initialEntries.size());
+    }
+}
+
+//
+// Create an empty temporary directory.
+//
+std::filesystem::path make_temp_directory(const std::string& name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+        fmt::format("gobb_analyzer_test_{}_{}", name, std::chrono::steady_clock::now().time_since_epoch().count());
+    std::filesystem::create_directories(path);
+    return path;
+}
+
+} // namespace
+
+//
+// Test the encoding of AnalysisData.
+//
+TEST(AnalyzerTest, AnalysisDataEncoding) {
+    // The all-zero word means Unfixed with MaxTurn remaining turns.
+    ASSERT_FALSE(updateFlag_of_analysisData(UnfixedAnalysisData));
+    ASSERT_EQ(MaxTurn, turn_of_analysisData(UnfixedAnalysisData));
+    ASSERT_EQ(AnalysisStatus::Unfixed, status_of_analysisData(UnfixedAnalysisData));
+    ASSERT_EQ(UnfixedAnalysisData, to_analysisData(false, MaxTurn, AnalysisStatus::Unfixed));
+
+    for (Turn turn = 0u; turn <= MaxTurn; turn++) {
+        for (int i = 0; i < AnalysisStatusNums; i++) {
+            AnalysisStatus status = static_cast<AnalysisStatus>(i);
+            for (bool updateFlag: {false, true}) {
+                AnalysisData data = to_analysisData(updateFlag, turn, status);
+                ASSERT_EQ(updateFlag, updateFlag_of_analysisData(data));
+                ASSERT_EQ(turn, turn_of_analysisData(data));
+                ASSERT_EQ(status, status_of_analysisData(data));
+            }
+        }
+    }
+
+    AnalysisData data = to_analysisData(true, 3u, AnalysisStatus::Won);
+    data = set_turn_of_analysisData(data, 5u);
+    ASSERT_EQ(5u, turn_of_analysisData(data));
+    data = set_updateFlag_of_analysisData(data, false);
+    ASSERT_FALSE(updateFlag_of_analysisData(data));
+    data = set_status_of_analysisData(data, AnalysisStatus::Lost);
+    ASSERT_EQ(AnalysisStatus::Lost, status_of_analysisData(data));
+    ASSERT_EQ(5u, turn_of_analysisData(data));
+}
+
+//
+// Test legacy_to_analysisData(AnalysisData data).
+//
+TEST(AnalyzerTest, LegacyToAnalysisData) {
+    // In the legacy encoding, the turn was recorded as is.
+    auto to_legacy = [](bool updateFlag, Turn turn, AnalysisStatus status) {
+        return static_cast<AnalysisData>((static_cast<AnalysisData>(updateFlag) << 15) |
+            ((turn & 0x0fffu) << 3) | (static_cast<AnalysisData>(status) & 0x0007u));
+    };
+
+    ASSERT_EQ(UnfixedAnalysisData, legacy_to_analysisData(to_legacy(false, MaxTurn, AnalysisStatus::Unfixed)));
+    ASSERT_EQ(to_analysisData(true, 0u, AnalysisStatus::Lost),
+        legacy_to_analysisData(to_legacy(true, 0u, AnalysisStatus::Lost)));
+    ASSERT_EQ(to_analysisData(false, 12u, AnalysisStatus::Won),
+        legacy_to_analysisData(to_legacy(false, 12u, AnalysisStatus::Won)));
+    ASSERT_EQ(to_analysisData(false, 0u, AnalysisStatus::Transformed),
+        legacy_to_analysisData(to_legacy(false, 0u, AnalysisStatus::Transformed)));
+}
+
+//
+// Test packing of WDL values.
+//
+TEST(AnalyzerTest, WdlValuePacking) {
+    const WdlValue values[] = {WdlValue::Won, WdlValue::Excluded, WdlValue::Unknown, WdlValue::Lost};
+    std::uint8_t byte = 0u;
+    for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+        ASSERT_EQ(WdlValue::Unknown, wdlValue_of_byte(byte, id));
+        byte = set_wdlValue_of_byte(byte, id, values[id]);
+    }
+    for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+        ASSERT_EQ(values[id], wdlValue_of_byte(byte, id + WdlValuesPerByte));
+    }
+
+    byte = set_wdlValue_of_byte(byte, 1u, WdlValue::Lost);
+    ASSERT_EQ(WdlValue::Won, wdlValue_of_byte(byte, 0u));
+    ASSERT_EQ(WdlValue::Lost, wdlValue_of_byte(byte, 1u));
+    ASSERT_EQ(WdlValue::Unknown, wdlValue_of_byte(byte, 2u));
+    ASSERT_EQ(WdlValue::Lost, wdlValue_of_byte(byte, 3u));
+
+    ASSERT_EQ(AnalysisStatus::Unfixed, wdlValue_to_analysisStatus(WdlValue::Unknown));
+    ASSERT_EQ(AnalysisStatus::Lost, wdlValue_to_analysisStatus(WdlValue::Lost));
+    ASSERT_EQ(AnalysisStatus::Won, wdlValue_to_analysisStatus(WdlValue::Won));
+    ASSERT_EQ(AnalysisStatus::Contradictory, wdlValue_to_analysisStatus(WdlValue::Excluded));
+}
+
+//
+// Test entries of a best-move table and the order of moves.
+//
+TEST(AnalyzerTest, BestMoveEntry) {
+    for (int index = NoBestMoveIndex; index < static_cast<int>(MaxMoveNums); index++) {
+        std::uint8_t entry = to_bestMoveEntry(WdlValue::Won, index);
+        ASSERT_EQ(WdlValue::Won, wdlValue_of_bestMoveEntry(entry));
+        ASSERT_EQ(index, moveIndex_of_bestMoveEntry(entry));
+    }
+    ASSERT_EQ(WdlValue::Excluded, wdlValue_of_bestMoveEntry(to_bestMoveEntry(WdlValue::Excluded, 53)));
+
+    // At the initial position, each of 3 pieces can be put on 9 squares.
+    Position pos(InitialPositionId);
+    PieceId piece;
+    LocationId src;
+    LocationId dst;
+    ASSERT_TRUE(nth_move(pos, 0, piece, src, dst));
+    ASSERT_EQ(LocationId::Out, src);
+    ASSERT_EQ(OnBoardLocationIds[0], dst);
+    ASSERT_TRUE(nth_move(pos, 26, piece, src, dst));
+    ASSERT_EQ(LocationId::Out, src);
+    ASSERT_EQ(OnBoardLocationIds[OnBoardLocationIdNums - 1], dst);
+    ASSERT_FALSE(nth_move(pos, 27, piece, src, dst));
+}
+
+//
+// Test Analyzer::apply_table_updates() with SetWon.
+//
+TEST(AnalyzerTest, ApplyTableUpdatesSetWon) {
+    NullLogger logger;
+    Analyzer analyzer(logger);
+    AnalysisData* table = AnalyzerTestPeer::table(analyzer);
+
+    // An Unfixed position becomes Won with the minimum turn and the update flag.
+    AnalysisStatistics stats;
+    ASSERT_TRUE(AnalyzerTestPeer::apply_table_updates(analyzer,
+        {{100u, 7u, TableUpdateKind::SetWon}, {100u, 5u, TableUpdateKind::SetWon}, {100u, 9u, TableUpdateKind::SetWon}},
+        stats));
+    ASSERT_EQ(table[100], to_analysisData(true, 5u, AnalysisStatus::Won));
+    ASSERT_EQ(stats.wonNums, 1u);
+
+    // The turn of a Won position only decreases, without counting the position again.
+    table[200] = to_analysisData(false, 9u, AnalysisStatus::Won);
+    stats = AnalysisStatistics();
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer, {{200u, 11u, TableUpdateKind::SetWon}}, stats));
+    ASSERT_EQ(table[200], to_analysisData(false, 9u, AnalysisStatus::Won));
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer, {{200u, 8u, TableUpdateKind::SetWon}}, stats));
+    ASSERT_EQ(table[200], to_analysisData(true, 8u, AnalysisStatus::Won));
+    ASSERT_EQ(stats.wonNums, 0u);
+
+    // Lost and other fixed positions are never changed to Won.
+    table[300] = to_analysisData(false, 4u, AnalysisStatus::Lost);
+    table[301] = to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer,
+        {{300u, 1u, TableUpdateKind::SetWon}, {301u, 1u, TableUpdateKind::SetWon}}, stats));
+    ASSERT_EQ(table[300], to_analysisData(false, 4u, AnalysisStatus::Lost));
+    ASSERT_EQ(table[301], to_analysisData(false, 0u, AnalysisStatus::Contradictory));
+}
+
+//
+// Test Analyzer::apply_table_updates() with SetLost and SetUpdateFlag.
+//
+TEST(AnalyzerTest, ApplyTableUpdatesSetLost) {
+    NullLogger logger;
+    Analyzer analyzer(logger);
+    AnalysisData* table = AnalyzerTestPeer::table(analyzer);
+
+    // SetLost keeps the update flag as it is.
+    AnalysisStatistics stats;
+    table[101] = to_analysisData(true, MaxTurn, AnalysisStatus::Unfixed);
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer,
+        {{100u, 6u, TableUpdateKind::SetLost}, {101u, 6u, TableUpdateKind::SetLost}}, stats));
+    ASSERT_EQ(table[100], to_analysisData(false, 6u, AnalysisStatus::Lost));
+    ASSERT_EQ(table[101], to_analysisData(true, 6u, AnalysisStatus::Lost));
+    ASSERT_EQ(stats.lostNums, 2u);
+
+    // The turn of a Lost position only decreases.
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer,
+        {{101u, 8u, TableUpdateKind::SetLost}, {101u, 2u, TableUpdateKind::SetLost}}, stats));
+    ASSERT_EQ(table[101], to_analysisData(true, 2u, AnalysisStatus::Lost));
+    ASSERT_EQ(stats.lostNums, 2u);
+
+    // SetUpdateFlag sets the flag only.
+    table[200] = to_analysisData(false, 3u, AnalysisStatus::Won);
+    ASSERT_FALSE(AnalyzerTestPeer::apply_table_updates(analyzer,
+        {{200u, 0u, TableUpdateKind::SetUpdateFlag}, {201u, 0u, TableUpdateKind::SetUpdateFlag}}, stats));
+    ASSERT_EQ(table[200], to_analysisData(true, 3u, AnalysisStatus::Won));
+    ASSERT_EQ(table[201], to_analysisData(true, MaxTurn, AnalysisStatus::Unfixed));
+}
+
+//
+// Test that the result of Analyzer::apply_table_updates() doesn't depend on the order of the updates.
+//
+TEST(AnalyzerTest, ApplyTableUpdatesOrderIndependent) {
+    NullLogger logger;
+    Analyzer analyzer(logger);
+    AnalysisData* table = AnalyzerTestPeer::table(analyzer);
+
+    const TableEntries initialEntries = {
+        {10u, UnfixedAnalysisData},
+        {11u, to_analysisData(true, MaxTurn, AnalysisStatus::Unfixed)},
+        {12u, to_analysisData(false, 9u, AnalysisStatus::Won)},
+        {13u, to_analysisData(true, 12u, AnalysisStatus::Lost)}};
+    std::vector<TableUpdate> updates = {
+        {10u, 5u, TableUpdateKind::SetWon}, {10u, 3u, TableUpdateKind::SetWon}, {10u, 7u, TableUpdateKind::SetWon},
+        {10u, 0u, TableUpdateKind::SetUpdateFlag},
+        {11u, 6u, TableUpdateKind::SetLost}, {11u, 4u, TableUpdateKind::SetLost},
+        {11u, 0u, TableUpdateKind::SetUpdateFlag},
+        {12u, 11u, TableUpdateKind::SetWon}, {12u, 8u, TableUpdateKind::SetWon},
+        {13u, 10u, TableUpdateKind::SetLost}, {13u, 14u, TableUpdateKind::SetLost},
+        {13u, 0u, TableUpdateKind::SetUpdateFlag}};
+    const TableEntries expectedEntries = {
+        {10u, to_analysisData(true, 3u, AnalysisStatus::Won)},
+        {11u, to_analysisData(true, 4u, AnalysisStatus::Lost)},
+        {12u, to_analysisData(true, 8u, AnalysisStatus::Won)},
+        {13u, to_analysisData(true, 10u, AnalysisStatus::Lost)}};
+
+    std::mt19937 random(1u);
+    for (int trial = 0; trial < 32; trial++) {
+        if (trial == 1) {
+            std::reverse(updates.begin(), updates.end());
+        } else if (trial > 1) {
+            std::shuffle(updates.begin(), updates.end(), random);
+        }
+        for (const auto& entry: initialEntries) {
+            table[entry.first] = entry.second;
+        }
+
+        AnalysisStatistics stats;
+        ASSERT_TRUE(AnalyzerTestPeer::apply_table_updates(analyzer, updates, stats));
+        for (const auto& entry: expectedEntries) {
+            ASSERT_EQ(table[entry.first], entry.second) << "trial " << trial << ", index " << entry.first;
+        }
+        ASSERT_EQ(stats.wonNums, 1u);
+        ASSERT_EQ(stats.lostNums, 1u);
+    }
+}
+
+//
+// Test that the strategies reach the same final analysis data from a small synthetic table.
+//
+TEST(AnalyzerTest, StrategiesReachSameResult) {
+    TableEntries entries = lined_up_position_entries(200u);
+    std::filesystem::path workDir = make_temp_directory("strategies");
+
+    TableEntries serialEntries = analyze_entries(entries, AnalysisStrategy::Serial, 1, workDir.string());
+    ASSERT_GT(serialEntries.size(), entries.size());
+    test_wdl_values(entries, serialEntries);
+    TableEntries bucketEntries = analyze_entries(entries, AnalysisStrategy::Bucket, 3, workDir.string());
+    ASSERT_TRUE(serialEntries == bucketEntries);
+    TableEntries forkedEntries = analyze_entries(entries, AnalysisStrategy::Forked, 2, workDir.string());
+    ASSERT_TRUE(serialEntries == forkedEntries);
+
+    //
+    // The Jacobi strategy reads the table of the previous generation, so that each generation has the
+    // same result regardless of the number of threads.
+    //
+    std::vector<AnalysisStatistics> jacobiStats1;
+    TableEntries jacobiEntries1 = analyze_entries(entries, AnalysisStrategy::Jacobi, 1, workDir.string(),
+        DefaultPrefetchDepth, &jacobiStats1);
+    ASSERT_TRUE(serialEntries == jacobiEntries1);
+    std::vector<AnalysisStatistics> jacobiStats3;
+    TableEntries jacobiEntries3 = analyze_entries(entries, AnalysisStrategy::Jacobi, 3, workDir.string(),
+        DefaultPrefetchDepth, &jacobiStats3);
+    ASSERT_TRUE(serialEntries == jacobiEntries3);
+    ASSERT_EQ(jacobiStats1.size(), jacobiStats3.size());
+    for (std::size_t i = 0u; i < jacobiStats1.size(); i++) {
+        ASSERT_TRUE(same_statistics(jacobiStats1[i], jacobiStats3[i])) << "generation " << i + 1u;
+    }
+
+    std::filesystem::remove_all(workDir);
+}
+
+//
+// Test that the Forked strategy forks its workers once for all the generations, and that the workers have
+// exited when the analysis returns.
+//
+TEST(AnalyzerTest, ForkedWorkersLastAllGenerations) {
+    TableEntries entries = lined_up_position_entries(20u);
+    std::filesystem::path workDir = make_temp_directory("forked");
+
+    CountingLogger logger("started 2 worker processes.");
+    Analyzer analyzer(logger, placement_policy(AnalysisStrategy::Forked));
+    configure_analyzer(analyzer, AnalysisStrategy::Forked, 2, workDir.string());
+    MemoryHandler handler(entries);
+    ASSERT_TRUE(analyzer.resume(handler, AnalysisDataIOMode::StoreFinalGeneration));
+    ASSERT_GE(logger.generation_nums(), 2);
+    ASSERT_EQ(logger.message_nums(), 1);
+    ASSERT_EQ(AnalyzerTestPeer::shard_worker_nums(analyzer), 0u);
+
+    std::filesystem::remove_all(workDir);
+}
+
+//
+// Test that the depth of prefetching doesn't change the final analysis data.
+//
+TEST(AnalyzerTest, PrefetchDepthsReachSameResult) {
+    TableEntries entries = lined_up_position_entries(200u);
+    std::filesystem::path workDir = make_temp_directory("prefetch");
+
+    TableEntries shallowEntries = analyze_entries(entries, AnalysisStrategy::Serial, 1, workDir.string(), 1u);
+    ASSERT_GT(shallowEntries.size(), entries.size());
+    TableEntries deepEntries = analyze_entries(entries, AnalysisStrategy::Serial, 1, workDir.string(),
+        MaxPrefetchDepth);
+    ASSERT_TRUE(shallowEntries == deepEntries);
+    TableEntries bucketEntries = analyze_entries(entries, AnalysisStrategy::Bucket, 3, workDir.string(),
+        MaxPrefetchDepth);
+    ASSERT_TRUE(shallowEntries == bucketEntries);
+
+    std::filesystem::remove_all(workDir);
+}
+
+//
+// Interrupt the analysis in the middle of the generation 2, resume it from the checkpoint, and test that it
+// reaches the same table and statistics as an uninterrupted analysis.
+//
+void test_interrupted_analysis(AnalysisStrategy strategy, int nums, const TableEntries& entries,
+    const std::string& workDir) {
+    std::vector<AnalysisStatistics> expectedStats;
+    TableEntries expectedEntries = analyze_entries(entries, strategy, nums, workDir, DefaultPrefetchDepth,
+        &expectedStats);
+
+    MemoryHandler handler(entries);
+    volatile std::sig_atomic_t stopFlag = 0;
+    {
+        StoppingLogger logger(2u, stopFlag);
+        Analyzer analyzer(logger, placement_policy(strategy));
+        configure_analyzer(analyzer, strategy, nums, workDir);
+        analyzer.set_stop_flag(&stopFlag);
+        ASSERT_TRUE(analyzer.resume(handler, AnalysisDataIOMode::StoreEveryGenerations));
+        ASSERT_TRUE(analyzer.interrupted());
+    }
+
+    AnalysisCheckpoint checkpoint;
+    ASSERT_TRUE(handler.find_checkpoint(checkpoint));
+    ASSERT_EQ(checkpoint.generation, 2u);
+    ASSERT_EQ(checkpoint.strategy, strategy);
+    ASSERT_NE(checkpoint.cursor, 0u);
+
+    stopFlag = 0;
+    NullLogger logger;
+    Analyzer analyzer(logger, placement_policy(strategy));
+    configure_analyzer(analyzer, strategy, nums, workDir);
+    analyzer.set_stop_flag(&stopFlag);
+    ASSERT_TRUE(analyzer.resume(handler, AnalysisDataIOMode::StoreEveryGenerations));
+    ASSERT_FALSE(analyzer.interrupted());
+    ASSERT_FALSE(handler.find_checkpoint(checkpoint));
+
+    ASSERT_TRUE(table_entries(AnalyzerTestPeer::table(analyzer)) == expectedEntries);
+    const std::vector<AnalysisStatistics>& stats = handler.stored_statistics();
+    ASSERT_EQ(stats.size(), expectedStats.size());
+    for (std::size_t i = 0u; i < stats.size(); i++) {
+        ASSERT_TRUE(same_statistics(stats[i], expectedStats[i])) << "generation " << i + 1u;
+    }
+}
+
+//
+// Test that an analysis interrupted in the middle of a generation resumes from its checkpoint.
+//
+TEST(AnalyzerTest, ResumeFromCheckpoint) {
+    TableEntries entries = lined_up_position_entries(200u);
+    std::filesystem::path workDir = make_temp_directory("checkpoint");
+
+    test_interrupted_analysis(AnalysisStrategy::Serial, 1, entries, workDir.string());
+    test_interrupted_analysis(AnalysisStrategy::Bucket, 3, entries, workDir.string());
+
+    std::filesystem::remove_all(workDir);
+}
+
+//
+// Test that a checkpoint records the table layout, and that a checkpoint in the middle of a generation is
+// refused by a build with the other layout, whose table indexes are ordered differently.
+//
+TEST(AnalyzerTest, CheckpointTableLayout) {
+    std::filesystem::path workDir = make_temp_directory("layout");
+    AnalysisCheckpoint checkpoint = AnalysisCheckpoint();
+    checkpoint.generation = 2u;
+    checkpoint.strategy = AnalysisStrategy::Serial;
+    checkpoint.threadNums = 1u;
+    checkpoint.cursor = 12345u;
+    checkpoint.tiledLayout = !TiledTableLayout;
+
+    AnalysisDataFileHandler fileHandler(workDir.string());
+    AnalysisData table[4] = {};
+    ASSERT_TRUE(fileHandler.store_checkpoint(checkpoint, table, sizeof(table)));
+    AnalysisCheckpoint loadedCheckpoint = AnalysisCheckpoint();
+    ASSERT_TRUE(fileHandler.load_checkpoint(loadedCheckpoint, table, sizeof(table)));
+    ASSERT_EQ(loadedCheckpoint.tiledLayout, !TiledTableLayout);
+    ASSERT_EQ(loadedCheckpoint.cursor, 12345u);
+
+    NullLogger logger;
+    {
+        MemoryHandler handler(TableEntries {});
+        ASSERT_TRUE(handler.store_checkpoint(checkpoint, nullptr, 0u));
+        Analyzer analyzer(logger, placement_policy(AnalysisStrategy::Serial));
+        configure_analyzer(analyzer, AnalysisStrategy::Serial, 1, workDir.string());
+        ASSERT_FALSE(analyzer.resume(handler, AnalysisDataIOMode::StoreFinalGeneration));
+        ASSERT_EQ(handler.stored_generation(), InvalidGeneration);
+    }
+
+    std::filesystem::remove_all(workDir);
+}
@@ -0,0 +1,128 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "best_move_table.hpp"
+#include "analysis_data_table.hpp"
+
+namespace gobb_analyzer {
+
+bool nth_move(const Position& pos, int index, PieceId& piece, LocationId& source, LocationId& destination) noexcept {
+    int count = 0;
+
+    for (PieceId p: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(p);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(p, src, dst);
+                if (moveResult.status != MoveResultStatus::Success) {
+                    continue;
+                }
+                if (count == index) {
+                    piece = p;
+                    source = src;
+                    destination = dst;
+                    return true;
+                }
+                count++;
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+
+    return false;
+}
+
+std::uint8_t best_move_entry(const AnalysisData* table, PositionId id) noexcept {
+    AnalysisStatus posStatus = status_of_analysisData(table[table_index(id)]);
+    WdlValue value;
+    if (posStatus == AnalysisStatus::Won || posStatus == AnalysisStatus::WonStalemate) {
+        value = WdlValue::Won;
+    } else if (posStatus == AnalysisStatus::Lost || posStatus == AnalysisStatus::LostStalemate) {
+        value = WdlValue::Lost;
+    } else if (posStatus == AnalysisStatus::Unfixed) {
+        value = WdlValue::Unknown;
+    } else {
+        return to_bestMoveEntry(WdlValue::Excluded, NoBestMoveIndex);
+    }
+
+    Position pos(id);
+    if (pos.is_winner(PlayerId::Active) || pos.is_winner(PlayerId::Inactive)) {
+        return to_bestMoveEntry(value, NoBestMoveIndex);
+    }
+
+    //
+    // Statuses of positions after moves are recorded for the opponent.  A move to a lost position is a win,
+    // and a move to a won position is a loss.
+    //
+    int bestIndex = NoBestMoveIndex;
+    int bestRank = 0;
+    Turn bestTurn = 0u;
+    int index = 0;
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status != MoveResultStatus::Success) {
+                    continue;
+                }
+
+                AnalysisData nextData = table[table_index(moveResult.position.minimize_id())];
+                AnalysisStatus nextStatus = status_of_analysisData(nextData);
+                Turn nextTurn = turn_of_analysisData(nextData);
+
+                //
+                // Ranks of moves: 3 for a win, 2 for a draw and 1 for a loss.
+                //
+                int rank;
+                if (nextStatus == AnalysisStatus::Lost || nextStatus == AnalysisStatus::LostStalemate) {
+                    rank = 3;
+                } else if (nextStatus == AnalysisStatus::Unfixed) {
+                    rank = 2;
+                } else if (nextStatus == AnalysisStatus::Won || nextStatus == AnalysisStatus::WonStalemate) {
+                    rank = 1;
+                } else {
+                    rank = 0;
+                }
+
+                if (rank > bestRank
+                    || (rank == bestRank && rank == 3 && nextTurn < bestTurn)
+                    || (rank == bestRank && rank == 1 && nextTurn > bestTurn)) {
+                    bestIndex = index;
+                    bestRank = rank;
+                    bestTurn = nextTurn;
+                }
+                index++;
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+
+    return to_bestMoveEntry(value, bestIndex);
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_BEST_MOVE_TABLE_HPP
+#define GOBB_ANALYZER_BEST_MOVE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "analyzer.hpp"
+#include "wdl_analyzer.hpp"
+
+///
+/// @file   best_move_table.hpp
+/// @brief  Define entries of a best-move table and their related functions.
+///
+/// A best-move table has a byte for each minimized position ID.  The lower 2 bits of an entry hold the
+/// WDL value of the position, and the upper 6 bits hold the index of an optimal move plus one (0 if the
+/// position has no move).  A move index is the position of the move in the order of `nth_move()`.
+///
+namespace gobb_analyzer {
+
+/// The number of bytes of a best-move table.
+constexpr std::size_t BestMoveTableSize = AnalysisDataTableSize;
+
+/// The move index which means the position has no move.
+constexpr int NoBestMoveIndex = -1;
+
+static_assert(MaxMoveNums < 64u, "a move index must fit 6 bits of a best-move entry");
+
+///
+/// Create an entry of a best-move table.
+///
+/// @param   value      the WDL value of the position.
+/// @param   moveIndex  the index of the best move, or `NoBestMoveIndex`.
+/// @return  an entry.
+///
+inline std::uint8_t to_bestMoveEntry(WdlValue value, int moveIndex) noexcept {
+    return static_cast<std::uint8_t>(((moveIndex + 1) << 2) | static_cast<int>(value));
+}
+
+///
+/// Get a WDL value from an entry of a best-move table.
+///
+/// @param   entry  an entry.
+/// @return  the WDL value of the position.
+///
+inline WdlValue wdlValue_of_bestMoveEntry(std::uint8_t entry) noexcept {
+    return static_cast<WdlValue>(entry & 0x03u);
+}
+
+///
+/// Get a move index from an entry of a best-move table.
+///
+/// @param   entry  an entry.
+/// @return  the index of the best move, or `NoBestMoveIndex`.
+///
+inline int moveIndex_of_bestMoveEntry(std::uint8_t entry) noexcept {
+    return static_cast<int>(entry >> 2) - 1;
+}
+
+///
+/// Get a move of the specified index.
+///
+/// @param   pos          a position.
+/// @param   index        a move index.
+/// @param   piece        a piece to be moved is put here.
+/// @param   source       the source location of the piece is put here.
+/// @param   destination  the destination of the piece is put here.
+/// @return  true if the move is found.
+///
+/// Moves are counted in the same order as `Inspector::inspect_moves()` enumerates them, including moves to
+/// contradictory positions which `Inspector::inspect_moves()` omits.  The order
+/// depends on locations of pieces only, so that a move of a minimized position can be mapped to a move of
+/// any symmetric position by `antitransform_LocationId()`.
+///
+bool nth_move(const Position& pos, int index, PieceId& piece, LocationId& source, LocationId& destination) noexcept;
+
+///
+/// Create an entry of a best-move table from analysis data.
+///
+/// @param   table  the whole table of analysis data.
+/// @param   id     a minimized position ID.
+/// @return  an entry.
+///
+/// The best move is chosen in the same way as `Inspector::inspect_moves()`: the fastest win, a draw, or
+/// the slowest loss.  The first one in the order of `nth_move()` is taken if two or more moves are the best.
+/// Transformed and contradictory positions get `WdlValue::Excluded` without a move.
+///
+std::uint8_t best_move_entry(const AnalysisData* table, PositionId id) noexcept;
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_BEST_MOVE_TABLE_HPP
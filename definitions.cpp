@@ -15,6 +15,8 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <cctype>
+#include <cstring>
 #include "definitions.hpp"
 
 namespace gobb_analyzer {
@@ -267,4 +269,59 @@ const std::string& playerColor_to_string(PlayerColor color) {
     }
 }
 
+std::string move_to_notation(PieceId piece, LocationId source, LocationId destination) {
+    return pieceSize_to_string(pieceSize_of_pieceId(piece)) + ":" + locationId_to_string(source) + "-"
+        + locationId_to_string(destination);
+}
+
+bool notation_to_move(const char* begin, const char* end, PieceId& piece, LocationId& source,
+    LocationId& destination) {
+    //
+    // Names are compared without case.
+    //
+    auto equal_names = [](const std::string& name, const char* textBegin, const char* textEnd) {
+        if (name.size() != static_cast<std::size_t>(textEnd - textBegin)) {
+            return false;
+        }
+        for (std::size_t i = 0u; i < name.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(name[i]))
+                != std::tolower(static_cast<unsigned char>(textBegin[i]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto find_location = [&](const char* textBegin, const char* textEnd, LocationId& location) {
+        for (int i = static_cast<int>(LocationId::Out); i <= static_cast<int>(LocationId::SE); i++) {
+            if (equal_names(locationId_to_string(static_cast<LocationId>(i)), textBegin, textEnd)) {
+                location = static_cast<LocationId>(i);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const char* colon = static_cast<const char*>(std::memchr(begin, ':', end - begin));
+    if (colon == nullptr) {
+        return false;
+    }
+    const char* hyphen = static_cast<const char*>(std::memchr(colon, '-', end - colon));
+    if (hyphen == nullptr) {
+        return false;
+    }
+
+    PieceSize size = PieceSize::Invalid;
+    for (PieceSize s: PieceSizes) {
+        if (equal_names(pieceSize_to_string(s), begin, colon)) {
+            size = s;
+        }
+    }
+    if (size == PieceSize::Invalid) {
+        return false;
+    }
+    piece = to_pieceId(PlayerId::Active, size);
+
+    return find_location(colon + 1, hyphen, source) && find_location(hyphen + 1, end, destination);
+}
+
 } // namespace gobb_analyzer
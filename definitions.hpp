@@ -415,6 +415,33 @@ inline bool is_on_board_locationId(LocationId id) {
     return (id >= LocationId::NW && id <= LocationId::SE);
 }
 
+///
+/// Return the notation of a move.
+///
+/// @param   piece        a piece ID.
+/// @param   source       the source location ID of the piece.
+/// @param   destination  the destination location ID of the piece.
+/// @return  the notation.
+///
+/// A move is written as SIZE:SOURCE-DESTINATION (e.g. "Large:Out-Center").
+///
+std::string move_to_notation(PieceId piece, LocationId source, LocationId destination);
+
+///
+/// Parse the notation of a move by the active player.
+///
+/// @param   begin        the beginning of the notation.
+/// @param   end          the end of the notation.
+/// @param   piece        a piece ID of the active player.
+/// @param   source       the source location ID of the piece.
+/// @param   destination  the destination location ID of the piece.
+/// @return  true upon success.
+///
+/// The notation is the same as that of move_to_notation(), except that names are compared without case.
+///
+bool notation_to_move(const char* begin, const char* end, PieceId& piece, LocationId& source,
+    LocationId& destination);
+
 } // namespace gobb_analyzer
 
 #endif // GOBB_ANALYZER_DEFINITIONS_HPP
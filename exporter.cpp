@@ -0,0 +1,238 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <vector>
+#include "exporter.hpp"
+#include "analysis_data_table.hpp"
+#include "best_move_table.hpp"
+#include "reachability.hpp"
+#include "run_threads.hpp"
+#include "status_index.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(AnalysisDataTableSize <= 0xffff'ffffu, "minimized position IDs must fit opening database keys");
+
+//
+// Class Exporter.
+//
+Exporter::Exporter(AnalysisLogger& logger)
+    : analysisDataTable_(nullptr),
+      statistics_(),
+      threadNums_(1),
+      logger_(logger) {
+    analysisDataTable_ = allocate_analysisDataTable(AnalysisDataTableSize);
+}
+
+Exporter::~Exporter() {
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
+}
+
+bool Exporter::load(AnalysisDataIOHandler& handler, Generation generation) {
+    return handler.load(generation, statistics_, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData));
+}
+
+Generation Exporter::load_latest(AnalysisDataIOHandler& handler) {
+    return handler.load_latest(statistics_, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData));
+}
+
+void Exporter::set_thread_nums(int threadNums) noexcept {
+    if (threadNums < 1) {
+        threadNums_ = 1;
+    } else {
+        threadNums_ = threadNums;
+    }
+}
+
+bool Exporter::export_opening(AnalysisDataIOHandler& inputHandler, ExportDataIOHandler& outputHandler) {
+    ReachabilityBitmap reachable;
+    load_reachability(inputHandler, reachable);
+
+    //
+    // Positions are visited in the order of position IDs, so that the entries are sorted.
+    //
+    PositionId entryNums = reachable.count();
+    std::vector<std::uint32_t> ids;
+    std::vector<AnalysisData> data;
+    ids.reserve(entryNums);
+    data.reserve(entryNums);
+    for (PositionId id = 0u; id < AnalysisDataTableSize; id++) {
+        if (!reachable.test(id)) {
+            continue;
+        }
+        ids.push_back(static_cast<std::uint32_t>(id));
+        data.push_back(set_updateFlag_of_analysisData(analysisDataTable_[table_index(id)], false));
+    }
+
+    logger_.notice("opening database: {} positions, {} bytes.", ids.size(),
+        ids.size() * (sizeof(std::uint32_t) + sizeof(AnalysisData)));
+    if (!outputHandler.store_opening(statistics_, ids.data(), data.data(), ids.size())) {
+        logger_.error("failed to store the opening database.");
+        return false;
+    }
+    logger_.notice("stored the opening database.");
+    return true;
+}
+
+bool Exporter::export_best_moves(ExportDataIOHandler& outputHandler) {
+    std::vector<std::uint8_t> table(BestMoveTableSize);
+
+    //
+    // Each thread writes its own range of entries.  The calling thread works on the range 0.
+    //
+    PositionId rangeSize = (AnalysisDataTableSize + threadNums_ - 1) / threadNums_;
+    auto worker = [&](int range) {
+        PositionId beginId = range * rangeSize;
+        PositionId endId = beginId + rangeSize;
+        if (endId > AnalysisDataTableSize) {
+            endId = AnalysisDataTableSize;
+        }
+        for (PositionId id = beginId; id < endId; id++) {
+            table[id] = best_move_entry(analysisDataTable_, id);
+        }
+    };
+
+    logger_.notice("search the best moves of all positions.");
+    run_threads(threadNums_, worker);
+
+    logger_.notice("best-move table: {} bytes.", table.size());
+    if (!outputHandler.store_best_moves(table.data(), table.size())) {
+        logger_.error("failed to store the best-move table.");
+        return false;
+    }
+    logger_.notice("stored the best-move table.");
+    return true;
+}
+
+bool Exporter::export_late_game(ExportDataIOHandler& outputHandler, int offBoardPieceNums) {
+    //
+    // Each thread collects the entries of its own range, and they are concatenated in the order of ranges.
+    //
+    std::vector<std::vector<std::uint32_t>> rangeIds(threadNums_);
+    std::vector<std::vector<AnalysisData>> rangeData(threadNums_);
+    PositionId rangeSize = (AnalysisDataTableSize + threadNums_ - 1) / threadNums_;
+    auto worker = [&](int range) {
+        PositionId beginId = range * rangeSize;
+        PositionId endId = beginId + rangeSize;
+        if (endId > AnalysisDataTableSize) {
+            endId = AnalysisDataTableSize;
+        }
+        for (PositionId id = beginId; id < endId; id++) {
+            AnalysisData data = analysisDataTable_[table_index(id)];
+            AnalysisStatus status = status_of_analysisData(data);
+            if (status == AnalysisStatus::Contradictory || status == AnalysisStatus::Transformed) {
+                continue;
+            }
+            if (Position(id).off_board_piece_nums() > offBoardPieceNums) {
+                continue;
+            }
+            rangeIds[range].push_back(static_cast<std::uint32_t>(id));
+            rangeData[range].push_back(set_updateFlag_of_analysisData(data, false));
+        }
+    };
+
+    logger_.notice("search positions with {} pieces or less off the board.", offBoardPieceNums);
+    run_threads(threadNums_, worker);
+
+    std::size_t entryNums = 0u;
+    for (const std::vector<std::uint32_t>& ids: rangeIds) {
+        entryNums += ids.size();
+    }
+    std::vector<std::uint32_t> ids;
+    std::vector<AnalysisData> data;
+    ids.reserve(entryNums);
+    data.reserve(entryNums);
+    for (int i = 0; i < threadNums_; i++) {
+        ids.insert(ids.end(), rangeIds[i].begin(), rangeIds[i].end());
+        data.insert(data.end(), rangeData[i].begin(), rangeData[i].end());
+        rangeIds[i] = std::vector<std::uint32_t>();
+        rangeData[i] = std::vector<AnalysisData>();
+    }
+
+    logger_.notice("late-game database: {} positions, {} bytes.", ids.size(),
+        ids.size() * (sizeof(std::uint32_t) + sizeof(AnalysisData)));
+    if (!outputHandler.store_late_game(statistics_, offBoardPieceNums, ids.data(), data.data(), ids.size())) {
+        logger_.error("failed to store the late-game database.");
+        return false;
+    }
+    logger_.notice("stored the late-game database.");
+    return true;
+}
+
+bool Exporter::export_status_index(ExportDataIOHandler& outputHandler, Generation generation) {
+    //
+    // Keys are encoded by threads in batches, and appended to the image in the order of keys, so that
+    // the memory for encoded containers is bounded.
+    //
+    constexpr std::uint32_t BatchKeyNumsPerThread = 16u;
+    std::uint32_t batchKeyNums = BatchKeyNumsPerThread * threadNums_;
+    std::vector<StatusIndexChunk> chunks(batchKeyNums);
+    StatusIndexBuilder builder;
+
+    logger_.notice("index positions by status and turn.");
+    for (std::uint32_t batchKey = 0u; batchKey < StatusIndexKeyNums; batchKey += batchKeyNums) {
+        std::uint32_t keyNums = batchKeyNums;
+        if (keyNums > StatusIndexKeyNums - batchKey) {
+            keyNums = static_cast<std::uint32_t>(StatusIndexKeyNums - batchKey);
+        }
+
+        std::uint32_t rangeSize = (keyNums + threadNums_ - 1) / threadNums_;
+        auto worker = [&](int range) {
+            std::vector<AnalysisData> data(StatusIndexContainerSize);
+            for (std::uint32_t i = range * rangeSize; i < (range + 1) * rangeSize && i < keyNums; i++) {
+                PositionId beginId = static_cast<PositionId>(batchKey + i) * StatusIndexContainerSize;
+                PositionId endId = beginId + StatusIndexContainerSize;
+                if (endId > AnalysisDataTableSize) {
+                    endId = AnalysisDataTableSize;
+                }
+                for (PositionId id = beginId; id < endId; id++) {
+                    data[id - beginId] = analysisDataTable_[table_index(id)];
+                }
+                StatusIndex::encode_chunk(batchKey + i, data.data(), endId - beginId, chunks[i]);
+            }
+        };
+
+        run_threads(threadNums_, worker);
+
+        for (std::uint32_t i = 0u; i < keyNums; i++) {
+            builder.append(chunks[i]);
+        }
+    }
+
+    std::vector<std::uint8_t> image = builder.finish();
+    logger_.notice("status index: {} bytes.", image.size());
+    if (!outputHandler.store_status_index(generation, image.data(), image.size())) {
+        logger_.error("failed to store the status index.");
+        return false;
+    }
+    logger_.notice("stored the status index.");
+    return true;
+}
+
+void Exporter::load_reachability(AnalysisDataIOHandler& handler, ReachabilityBitmap& reachable) {
+    if (handler.load_reachability(reachable.data(), ReachabilityBitmap::byte_size())) {
+        logger_.notice("loaded the bitmap of reachable positions.");
+        return;
+    }
+
+    logger_.notice("search positions reachable from the initial position.");
+    int levelNums = reachable.compute(threadNums_);
+    logger_.notice("found {} reachable positions in {} levels.", reachable.count(), levelNums);
+}
+
+} // namespace gobb_analyzer
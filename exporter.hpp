@@ -0,0 +1,158 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_EXPORTER_HPP
+#define GOBB_ANALYZER_EXPORTER_HPP
+
+#include "analyzer.hpp"
+
+///
+/// @file   exporter.hpp
+/// @brief  Define `Exporter` class, which derives compact databases from analysis data.
+///
+namespace gobb_analyzer {
+
+class ReachabilityBitmap;
+
+///
+/// Exporter of analysis data.
+///
+/// It loads a whole table of analysis data, and writes databases derived from it through an I/O handler.
+///
+class Exporter {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   logger  a logger.
+    ///
+    Exporter(AnalysisLogger& logger);
+
+    Exporter(const Exporter& other) = delete;
+    Exporter(Exporter&& other) = delete;
+    Exporter& operator=(const Exporter& other) = delete;
+    Exporter& operator=(Exporter&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~Exporter();
+
+    ///
+    /// Load the analysis data of the specified generation.
+    ///
+    /// @param   handler     an I/O handler to load the analysis data.
+    /// @param   generation  a generation number.
+    /// @return  true upon success.
+    ///
+    bool load(AnalysisDataIOHandler& handler, Generation generation);
+
+    ///
+    /// Load the analysis data of the latest generation.
+    ///
+    /// @param   handler  an I/O handler to load the analysis data.
+    /// @return  the generation of the loaded data, or -1 upon failure.
+    ///
+    Generation load_latest(AnalysisDataIOHandler& handler);
+
+    ///
+    /// Set the number of threads.
+    ///
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    ///
+    void set_thread_nums(int threadNums) noexcept;
+
+    ///
+    /// Export the opening database.
+    ///
+    /// @param   inputHandler   an I/O handler to load the bitmap of reachable positions.
+    /// @param   outputHandler  an I/O handler to store the database.
+    /// @return  true upon success.
+    ///
+    /// The opening database contains analysis data of positions reachable from the initial position only,
+    /// sorted by minimized position IDs.  If the bitmap of reachable positions stored by `gobb_analyze -r`
+    /// is found, it is used.  Otherwise the reachable positions are searched.
+    ///
+    bool export_opening(AnalysisDataIOHandler& inputHandler, ExportDataIOHandler& outputHandler);
+
+    ///
+    /// Export the best-move table.
+    ///
+    /// @param   outputHandler  an I/O handler to store the table.
+    /// @return  true upon success.
+    ///
+    /// The best-move table has a byte for each minimized position ID, which holds the WDL value of the
+    /// position and the index of its best move (see `best_move_table.hpp`).  It lets a player choose a move
+    /// with a single lookup, and it is half the size of the analysis data.  Positions are divided among
+    /// threads.  It throws an exception if it fails to create threads.
+    ///
+    bool export_best_moves(ExportDataIOHandler& outputHandler);
+
+    ///
+    /// Export the late-game database.
+    ///
+    /// @param   outputHandler      an I/O handler to store the database.
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board.
+    /// @return  true upon success.
+    ///
+    /// The late-game database contains analysis data of positions with `offBoardPieceNums` pieces or less
+    /// off the board, sorted by minimized position IDs.  Since a move never increases the number of pieces
+    /// off the board, it is closed under moves, and `HybridProber` searches other positions until it is
+    /// reached.  Contradictory positions are omitted.  Positions are divided among threads.  It throws an
+    /// exception if it fails to create threads.
+    ///
+    bool export_late_game(ExportDataIOHandler& outputHandler, int offBoardPieceNums);
+
+    ///
+    /// Export the status index.
+    ///
+    /// @param   outputHandler  an I/O handler to store the index.
+    /// @param   generation     the generation of the loaded analysis data.
+    /// @return  true upon success.
+    ///
+    /// The status index has compressed bitmaps of minimized position IDs for each pair of a status and
+    /// the number of remaining turns (see `status_index.hpp`), so that positions with the pair are counted
+    /// and listed without scanning the table.  Containers of a batch of keys are divided among threads.
+    /// It throws an exception if it fails to create threads.
+    ///
+    bool export_status_index(ExportDataIOHandler& outputHandler, Generation generation);
+
+private:
+    ///
+    /// Load the bitmap of reachable positions, or search them if the bitmap is not stored.
+    ///
+    /// @param   handler    an I/O handler to load the bitmap.
+    /// @param   reachable  a bitmap.
+    ///
+    void load_reachability(AnalysisDataIOHandler& handler, ReachabilityBitmap& reachable);
+
+    /// Analysis data of all positions.
+    AnalysisData* analysisDataTable_;
+
+    /// Statistics of the analysis.
+    AnalysisStatistics statistics_;
+
+    /// The number of threads.
+    int threadNums_;
+
+    /// Logger.
+    AnalysisLogger& logger_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_EXPORTER_HPP
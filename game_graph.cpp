@@ -0,0 +1,220 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#include "game_graph.hpp"
+#include "run_threads.hpp"
+
+namespace gobb_analyzer {
+
+//
+// Class GameGraph.
+//
+GameGraph::GameGraph(const Inspector& inspector)
+    : inspector_(inspector),
+      threadNums_(1),
+      maxNodeNums_(100000u),
+      bestMovesOnly_(false),
+      truncated_(false),
+      nodes_(),
+      edges_(),
+      indexes_() {
+}
+
+void GameGraph::set_thread_nums(int threadNums) noexcept {
+    if (threadNums < 1) {
+        threadNums_ = 1;
+    } else {
+        threadNums_ = threadNums;
+    }
+}
+
+void GameGraph::set_max_node_nums(std::size_t nodeNums) noexcept {
+    maxNodeNums_ = nodeNums;
+}
+
+void GameGraph::set_best_moves_only(bool bestMovesOnly) noexcept {
+    bestMovesOnly_ = bestMovesOnly;
+}
+
+bool GameGraph::build(PositionId id, int maxDepth) {
+    nodes_.clear();
+    edges_.clear();
+    indexes_.clear();
+    truncated_ = false;
+    if (!is_valid_positionId(id)) {
+        return false;
+    }
+
+    PositionId rootId = Position(id).minimize_id();
+    PositionInspectionResult rootResult = inspector_.inspect_position(rootId);
+    nodes_.push_back(GameGraphNode {rootId, rootResult.turn, rootResult.analysisStatus, 0, 0u, 0u, false});
+    indexes_.emplace(rootId, 0u);
+
+    std::vector<std::uint32_t> level {0u};
+    std::vector<std::vector<FoundMove>> rangeMoves(threadNums_);
+    for (int depth = 0; depth < maxDepth && !level.empty(); depth++) {
+        //
+        // Each thread lists the moves of its own range of the level.  The calling thread works on the
+        // range 0.
+        //
+        std::size_t rangeSize = (level.size() + threadNums_ - 1) / threadNums_;
+        auto worker = [&](int range) {
+            std::size_t beginIndex = range * rangeSize;
+            std::size_t endIndex = beginIndex + rangeSize;
+            if (beginIndex > level.size()) {
+                beginIndex = level.size();
+            }
+            if (endIndex > level.size()) {
+                endIndex = level.size();
+            }
+            rangeMoves[range].clear();
+            list_moves(level, beginIndex, endIndex, rangeMoves[range]);
+        };
+
+        run_threads(threadNums_, worker);
+
+        //
+        // The moves are added in the order of the level.  A position is expanded only if all the positions
+        // after its moves fit the maximum number of positions, even if some of them are already in the
+        // graph.  Once a position is not expanded, the rest of the level is not expanded either.
+        //
+        std::vector<std::uint32_t> nextLevel;
+        std::size_t levelIndex = 0u;
+        for (int range = 0; range < threadNums_ && !truncated_; range++) {
+            const std::vector<FoundMove>& moves = rangeMoves[range];
+            std::size_t moveIndex = 0u;
+            while (levelIndex < level.size() && levelIndex < (range + 1) * rangeSize) {
+                std::uint32_t node = level[levelIndex];
+                std::size_t endMoveIndex = moveIndex;
+                while (endMoveIndex < moves.size() && moves[endMoveIndex].node == node) {
+                    endMoveIndex++;
+                }
+                if (nodes_.size() + (endMoveIndex - moveIndex) > maxNodeNums_) {
+                    truncated_ = true;
+                    break;
+                }
+
+                nodes_[node].firstEdge = static_cast<std::uint32_t>(edges_.size());
+                nodes_[node].edgeNums = static_cast<std::uint32_t>(endMoveIndex - moveIndex);
+                nodes_[node].expanded = true;
+                for (; moveIndex < endMoveIndex; moveIndex++) {
+                    const FoundMove& found = moves[moveIndex];
+                    auto inserted = indexes_.emplace(found.targetId, static_cast<std::uint32_t>(nodes_.size()));
+                    if (inserted.second) {
+                        //
+                        // The status of a move is seen from the player who moves, and it is inverted for
+                        // the position after the move.
+                        //
+                        nodes_.push_back(GameGraphNode {found.targetId, found.move.turn,
+                            invert_analysisStatus(found.move.analysisStatus), depth + 1, 0u, 0u, false});
+                        nextLevel.push_back(inserted.first->second);
+                    }
+                    edges_.push_back(GameGraphEdge {found.move.piece, found.move.source, found.move.destination,
+                        inserted.first->second, found.move.isBestMove});
+                }
+                levelIndex++;
+            }
+        }
+        if (truncated_) {
+            break;
+        }
+        level.swap(nextLevel);
+    }
+
+    return true;
+}
+
+const std::vector<GameGraphNode>& GameGraph::nodes() const noexcept {
+    return nodes_;
+}
+
+const std::vector<GameGraphEdge>& GameGraph::edges() const noexcept {
+    return edges_;
+}
+
+bool GameGraph::truncated() const noexcept {
+    return truncated_;
+}
+
+void GameGraph::write_json(std::ostream& out) const {
+    out << "{\"root\":" << (nodes_.empty() ? 0u : nodes_[0].positionId)
+        << ",\"truncated\":" << (truncated_ ? "true" : "false")
+        << ",\"nodes\":[";
+    for (std::size_t i = 0u; i < nodes_.size(); i++) {
+        const GameGraphNode& node = nodes_[i];
+        out << (i == 0u ? "\n" : ",\n")
+            << "{\"position\":" << node.positionId
+            << ",\"depth\":" << node.depth
+            << ",\"status\":\"" << analysisStatus_to_string(node.analysisStatus) << "\""
+            << ",\"turn\":";
+        if (inspector_.wdl_only()) {
+            out << "null";
+        } else {
+            out << node.turn;
+        }
+        out << ",\"expanded\":" << (node.expanded ? "true" : "false")
+            << ",\"moves\":[";
+        for (std::uint32_t j = 0u; j < node.edgeNums; j++) {
+            const GameGraphEdge& edge = edges_[node.firstEdge + j];
+            out << (j == 0u ? "" : ",")
+                << "{\"move\":\"" << move_to_notation(edge.piece, edge.source, edge.destination) << "\""
+                << ",\"position\":" << nodes_[edge.target].positionId
+                << ",\"best\":" << (inspector_.wdl_only() ? "null" : (edge.isBestMove ? "true" : "false")) << "}";
+        }
+        out << "]}";
+    }
+    out << "]}\n";
+}
+
+void GameGraph::write_dot(std::ostream& out) const {
+    out << "digraph gobb {\n";
+    for (const GameGraphNode& node: nodes_) {
+        out << "  p" << node.positionId << " [label=\"" << node.positionId << "\\n"
+            << analysisStatus_to_string(node.analysisStatus);
+        if (!inspector_.wdl_only()) {
+            out << " " << node.turn;
+        }
+        out << "\"" << (node.expanded ? "" : ", style=dashed") << "];\n";
+    }
+    for (const GameGraphNode& node: nodes_) {
+        for (std::uint32_t j = 0u; j < node.edgeNums; j++) {
+            const GameGraphEdge& edge = edges_[node.firstEdge + j];
+            out << "  p" << node.positionId << " -> p" << nodes_[edge.target].positionId
+                << " [label=\"" << move_to_notation(edge.piece, edge.source, edge.destination) << "\""
+                << (edge.isBestMove ? ", style=bold" : "") << "];\n";
+        }
+    }
+    out << "}\n";
+}
+
+void GameGraph::list_moves(const std::vector<std::uint32_t>& level, std::size_t beginIndex, std::size_t endIndex,
+    std::vector<FoundMove>& moves) const {
+    MoveInspectionResult results[MaxMoveNums];
+    for (std::size_t i = beginIndex; i < endIndex; i++) {
+        std::uint32_t node = level[i];
+        std::size_t resultNums = inspector_.inspect_moves(nodes_[node].positionId, results);
+        for (std::size_t j = 0u; j < resultNums; j++) {
+            if (bestMovesOnly_ && !results[j].isBestMove) {
+                continue;
+            }
+            moves.push_back(FoundMove {node, results[j], Position(results[j].positionId).minimize_id()});
+        }
+    }
+}
+
+} // namespace gobb_analyzer
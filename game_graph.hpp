@@ -0,0 +1,216 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#ifndef GOBB_ANALYZER_GAME_GRAPH_HPP
+#define GOBB_ANALYZER_GAME_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "analyzer.hpp"
+#include "inspector.hpp"
+#include "position.hpp"
+
+///
+/// @file   game_graph.hpp
+/// @brief  Define `GameGraph` class, which collects the solved game graph below a position.
+///
+namespace gobb_analyzer {
+
+///
+/// A position in a game graph.
+///
+struct GameGraphNode {
+    PositionId positionId;          ///< a minimized position ID.
+    Turn turn;                      ///< the number of remaining turns.
+    AnalysisStatus analysisStatus;  ///< the status code of the position.
+    int depth;                      ///< the number of moves from the root at which it is found first.
+    std::uint32_t firstEdge;        ///< the index of the first move in `edges()`.
+    std::uint32_t edgeNums;         ///< the number of moves.
+    bool expanded;                  ///< whether the moves have been collected.
+};
+
+///
+/// A move in a game graph.
+///
+struct GameGraphEdge {
+    PieceId piece;                  ///< a piece to be moved.
+    LocationId source;              ///< the source location of the piece.
+    LocationId destination;         ///< the destination of the piece.
+    std::uint32_t target;           ///< the index of the position after the move in `nodes()`.
+    bool isBestMove;                ///< true if this is the best move among the candidates.
+};
+
+///
+/// The solved game graph below a position.
+///
+/// Positions reachable from the root in a limited number of moves are collected level by level, with the
+/// analysis data and the moves given by `Inspector::inspect_moves()`.  Positions are identified by
+/// minimized position IDs, so that a position reached by different sequences of moves, or by symmetric
+/// ones, is a single node.  Thus the graph grows with the number of distinct positions, not with the
+/// number of sequences of moves.  Moves of a node are those of the minimized position.
+///
+class GameGraph {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   inspector  an inspector to look up positions.  It must remain while the graph is built.
+    ///
+    GameGraph(const Inspector& inspector);
+
+    GameGraph(const GameGraph& other) = delete;
+    GameGraph(GameGraph&& other) = delete;
+    GameGraph& operator=(const GameGraph& other) = delete;
+    GameGraph& operator=(GameGraph&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~GameGraph() = default;
+
+    ///
+    /// Set the number of threads.
+    ///
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    ///
+    void set_thread_nums(int threadNums) noexcept;
+
+    ///
+    /// Set the maximum number of positions.
+    ///
+    /// @param   nodeNums  the number of positions.
+    ///
+    /// A position takes about 100 bytes of memory, and a move about 60 bytes while the graph is built.
+    /// The default is 100000.
+    ///
+    void set_max_node_nums(std::size_t nodeNums) noexcept;
+
+    ///
+    /// Set whether only the best moves are followed.
+    ///
+    /// @param   bestMovesOnly  true to drop moves other than the best moves.
+    ///
+    void set_best_moves_only(bool bestMovesOnly) noexcept;
+
+    ///
+    /// Collect positions below a position.
+    ///
+    /// @param   id        a position ID of the root.
+    /// @param   maxDepth  the maximum number of moves from the root.
+    /// @return  true upon success, or false if the position ID is invalid.
+    ///
+    /// Positions in a level are divided among threads to list their moves, and then new positions are
+    /// added in the order of the level, so that the graph doesn't depend on the number of threads.  A
+    /// position is not expanded if the game is over, it is `maxDepth` moves away from the root, or its
+    /// moves might exceed the maximum number of positions (see truncated()).  It throws an exception if it
+    /// fails to allocate memory or to create threads.
+    ///
+    bool build(PositionId id, int maxDepth);
+
+    ///
+    /// Return the positions.
+    ///
+    /// @return  the positions in the order of levels.  The first one is the root.
+    ///
+    const std::vector<GameGraphNode>& nodes() const noexcept;
+
+    ///
+    /// Return the moves.
+    ///
+    /// @return  the moves of all positions, grouped by positions.
+    ///
+    const std::vector<GameGraphEdge>& edges() const noexcept;
+
+    ///
+    /// Whether the graph has been truncated by the maximum number of positions.
+    ///
+    /// @return  true if a position within the maximum depth has not been expanded.
+    ///
+    bool truncated() const noexcept;
+
+    ///
+    /// Write the graph in JSON.
+    ///
+    /// @param   out  an output stream.
+    ///
+    /// Each position is written once with its status, the number of remaining turns and its moves.
+    ///
+    void write_json(std::ostream& out) const;
+
+    ///
+    /// Write the graph in the DOT language of Graphviz.
+    ///
+    /// @param   out  an output stream.
+    ///
+    /// The best moves are drawn in bold, and positions not expanded are drawn in dashed lines.
+    ///
+    void write_dot(std::ostream& out) const;
+
+private:
+    ///
+    /// A move found in a level, to be added to the graph.
+    ///
+    struct FoundMove {
+        std::uint32_t node;             ///< the index of the position of the move.
+        MoveInspectionResult move;      ///< the move.
+        PositionId targetId;            ///< the minimized position ID after the move.
+    };
+
+    ///
+    /// List the moves of positions in a range of a level.
+    ///
+    /// @param   level       indexes of the positions in the level.
+    /// @param   beginIndex  the first index of the range in `level`.
+    /// @param   endIndex    the index next to the last of the range in `level`.
+    /// @param   moves       the moves are appended here, in the order of `level`.
+    ///
+    void list_moves(const std::vector<std::uint32_t>& level, std::size_t beginIndex, std::size_t endIndex,
+        std::vector<FoundMove>& moves) const;
+
+    /// The inspector.
+    const Inspector& inspector_;
+
+    /// The number of threads.
+    int threadNums_;
+
+    /// The maximum number of positions.
+    std::size_t maxNodeNums_;
+
+    /// Whether only the best moves are followed.
+    bool bestMovesOnly_;
+
+    /// Whether the graph has been truncated by the maximum number of positions.
+    bool truncated_;
+
+    /// Positions of the graph.  The first one is the root.
+    std::vector<GameGraphNode> nodes_;
+
+    /// Moves of the positions.
+    std::vector<GameGraphEdge> edges_;
+
+    /// Indexes of nodes in `nodes_` keyed by minimized position IDs.
+    std::unordered_map<PositionId, std::uint32_t> indexes_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_GAME_GRAPH_HPP
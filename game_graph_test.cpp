@@ -0,0 +1,324 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "game_graph.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+namespace {
+
+/// The number of moves from the initial position covered by the test data.
+constexpr int TestDepth = 3;
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a minimized position in the opening database.
+    //
+    void set_opening(PositionId minimizedId, AnalysisStatus status, Turn turn) {
+        opening_[minimizedId] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// Return the minimized positions reachable by a move from a position.
+//
+std::set<PositionId> successors(PositionId id) {
+    std::set<PositionId> ids;
+    Position pos(id);
+    if (pos.is_winner(PlayerId::Active) || pos.is_winner(PlayerId::Inactive)) {
+        return ids;
+    }
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+        for (LocationId src: locPair.locations) {
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status == MoveResultStatus::Success) {
+                    ids.insert(moveResult.position.minimize_id());
+                }
+            }
+        }
+    }
+    return ids;
+}
+
+//
+// Return the number of moves from the initial position to each minimized position within `TestDepth`
+// moves.
+//
+std::map<PositionId, int> distances_from_initial_position() {
+    std::map<PositionId, int> distances;
+    std::vector<PositionId> level {Position(InitialPositionId).minimize_id()};
+    distances.emplace(level[0], 0);
+    for (int depth = 1; depth <= TestDepth; depth++) {
+        std::vector<PositionId> nextLevel;
+        for (PositionId id: level) {
+            for (PositionId next: successors(id)) {
+                if (distances.emplace(next, depth).second) {
+                    nextLevel.push_back(next);
+                }
+            }
+        }
+        level.swap(nextLevel);
+    }
+    return distances;
+}
+
+//
+// Load an opening database of the positions within `TestDepth` moves, which have various results.
+//
+void load_opening(Inspector& inspector) {
+    const AnalysisStatus statuses[] = {AnalysisStatus::Won, AnalysisStatus::Lost, AnalysisStatus::Unfixed};
+    OpeningHandler handler;
+    for (const auto& entry: distances_from_initial_position()) {
+        PositionId id = entry.first;
+        handler.set_opening(id, statuses[id % 3u], static_cast<Turn>(id % 7u + 1u));
+    }
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// Return the graph in JSON.
+//
+std::string graph_json(const GameGraph& graph) {
+    std::ostringstream out;
+    graph.write_json(out);
+    return out.str();
+}
+
+} // namespace
+
+//
+// Test that a position reached by different sequences of moves, or by symmetric ones, is a single node
+// found at its shortest distance, and that every move of an expanded node is kept.
+//
+TEST(GameGraphTest, Positions) {
+    Inspector inspector;
+    load_opening(inspector);
+    GameGraph graph(inspector);
+    ASSERT_FALSE(graph.build(PositionIdNums, TestDepth));
+    ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+    ASSERT_FALSE(graph.truncated());
+
+    std::map<PositionId, int> distances = distances_from_initial_position();
+    const std::vector<GameGraphNode>& nodes = graph.nodes();
+    const std::vector<GameGraphEdge>& edges = graph.edges();
+    ASSERT_EQ(nodes.size(), distances.size());
+    ASSERT_EQ(nodes[0].positionId, Position(InitialPositionId).minimize_id());
+
+    std::set<PositionId> ids;
+    for (const GameGraphNode& node: nodes) {
+        ASSERT_TRUE(ids.insert(node.positionId).second);
+        ASSERT_EQ(node.depth, distances.at(node.positionId));
+        ASSERT_EQ(node.expanded, node.depth < TestDepth);
+        if (!node.expanded) {
+            ASSERT_EQ(node.edgeNums, 0u);
+            continue;
+        }
+
+        //
+        // Symmetric moves are kept as different edges to the same node.
+        //
+        std::vector<MoveInspectionResult> moves = inspector.inspect_moves(node.positionId);
+        ASSERT_EQ(node.edgeNums, moves.size());
+        for (std::uint32_t j = 0u; j < node.edgeNums; j++) {
+            const GameGraphEdge& edge = edges[node.firstEdge + j];
+            ASSERT_EQ(edge.piece, moves[j].piece);
+            ASSERT_EQ(edge.source, moves[j].source);
+            ASSERT_EQ(edge.destination, moves[j].destination);
+            ASSERT_EQ(edge.isBestMove, moves[j].isBestMove);
+            ASSERT_EQ(nodes[edge.target].positionId, Position(moves[j].positionId).minimize_id());
+        }
+    }
+
+    //
+    // The moves of the root lead to fewer positions than the moves, because of symmetry.
+    //
+    std::set<std::uint32_t> rootTargets;
+    for (std::uint32_t j = 0u; j < nodes[0].edgeNums; j++) {
+        rootTargets.insert(edges[nodes[0].firstEdge + j].target);
+    }
+    ASSERT_LT(rootTargets.size(), nodes[0].edgeNums);
+}
+
+//
+// Test that a position is not expanded if its moves might exceed the maximum number of positions, and
+// that the rest of the level is not expanded either.
+//
+TEST(GameGraphTest, MaxNodes) {
+    Inspector inspector;
+    load_opening(inspector);
+    GameGraph graph(inspector);
+    std::size_t rootMoveNums = inspector.inspect_moves(InitialPositionId).size();
+
+    //
+    // The root is not expanded if its moves exceed the limit, even though they lead to fewer positions.
+    //
+    graph.set_max_node_nums(rootMoveNums);
+    ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+    ASSERT_TRUE(graph.truncated());
+    ASSERT_EQ(graph.nodes().size(), 1u);
+    ASSERT_FALSE(graph.nodes()[0].expanded);
+
+    //
+    // The positions after the first move are expanded as long as they fit, but not all of them fit.
+    //
+    GameGraph whole(inspector);
+    ASSERT_TRUE(whole.build(InitialPositionId, TestDepth));
+    std::size_t maxNodeNums = 0u;
+    for (const GameGraphNode& node: whole.nodes()) {
+        if (node.depth <= 2) {
+            maxNodeNums++;
+        }
+    }
+    maxNodeNums--;
+    graph.set_max_node_nums(maxNodeNums);
+    ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+    ASSERT_TRUE(graph.truncated());
+    const std::vector<GameGraphNode>& nodes = graph.nodes();
+    ASSERT_LE(nodes.size(), maxNodeNums);
+    ASSERT_TRUE(nodes[0].expanded);
+    bool levelTruncated = false;
+    for (const GameGraphNode& node: nodes) {
+        if (node.depth != 1) {
+            ASSERT_FALSE(node.depth == 2 && node.expanded);
+            continue;
+        }
+        if (!node.expanded) {
+            levelTruncated = true;
+        }
+        ASSERT_FALSE(levelTruncated && node.expanded);
+    }
+    ASSERT_TRUE(levelTruncated);
+    ASSERT_TRUE(nodes[1].expanded);
+
+    //
+    // Room for the root and all the moves is enough, even though the moves lead to fewer positions.
+    //
+    ASSERT_LT(whole.nodes().size(), whole.edges().size() + 1u);
+    graph.set_max_node_nums(whole.edges().size() + 1u);
+    ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+    ASSERT_FALSE(graph.truncated());
+    ASSERT_EQ(graph_json(graph), graph_json(whole));
+}
+
+//
+// Test that only the best moves, and the positions after them, are collected with `set_best_moves_only()`.
+//
+TEST(GameGraphTest, BestMovesOnly) {
+    Inspector inspector;
+    load_opening(inspector);
+    GameGraph whole(inspector);
+    ASSERT_TRUE(whole.build(InitialPositionId, TestDepth));
+    std::set<PositionId> wholeIds;
+    for (const GameGraphNode& node: whole.nodes()) {
+        wholeIds.insert(node.positionId);
+    }
+
+    GameGraph graph(inspector);
+    graph.set_best_moves_only(true);
+    ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+    ASSERT_FALSE(graph.truncated());
+    const std::vector<GameGraphNode>& nodes = graph.nodes();
+    ASSERT_LT(nodes.size(), whole.nodes().size());
+    for (const GameGraphNode& node: nodes) {
+        ASSERT_EQ(wholeIds.count(node.positionId), 1u);
+        if (!node.expanded) {
+            continue;
+        }
+        std::size_t bestMoveNums = 0u;
+        for (const MoveInspectionResult& move: inspector.inspect_moves(node.positionId)) {
+            if (move.isBestMove) {
+                bestMoveNums++;
+            }
+        }
+        ASSERT_EQ(node.edgeNums, bestMoveNums);
+        for (std::uint32_t j = 0u; j < node.edgeNums; j++) {
+            ASSERT_TRUE(graph.edges()[node.firstEdge + j].isBestMove);
+        }
+    }
+}
+
+//
+// Test that the graph doesn't depend on the number of threads, with or without truncation.
+//
+TEST(GameGraphTest, ThreadNums) {
+    Inspector inspector;
+    load_opening(inspector);
+    std::size_t rootMoveNums = inspector.inspect_moves(InitialPositionId).size();
+
+    for (std::size_t maxNodeNums: {std::size_t(100000u), rootMoveNums + 150u}) {
+        GameGraph single(inspector);
+        single.set_max_node_nums(maxNodeNums);
+        ASSERT_TRUE(single.build(InitialPositionId, TestDepth));
+        ASSERT_EQ(single.truncated(), maxNodeNums < 100000u);
+        std::string expected = graph_json(single);
+
+        for (int threadNums: {2, 3, 8}) {
+            GameGraph graph(inspector);
+            graph.set_thread_nums(threadNums);
+            graph.set_max_node_nums(maxNodeNums);
+            ASSERT_TRUE(graph.build(InitialPositionId, TestDepth));
+            ASSERT_EQ(graph.truncated(), single.truncated());
+            ASSERT_EQ(graph_json(graph), expected);
+        }
+    }
+}
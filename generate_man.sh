@@ -3,7 +3,7 @@
 # Generate man pages from Markdown files.
 # (`pandoc` is required.)
 #
-MD_FILES="gobb_analyze.1.md gobb_inspect.1.md"
+MD_FILES="gobb_analyze.1.md gobb_inspect.1.md gobb_export.1.md gobb_inspectd.1.md gobb_play.1.md gobb_solve.1.md gobb_query.1.md gobb_annotate.1.md"
 
 for MD_FILE in ${MD_FILES}; do
     if [ ! -f "${MD_FILE}" ]; then
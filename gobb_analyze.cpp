@@ -15,31 +15,69 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <chrono>
+#include <csignal>
 #include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <string>
 #include <iostream>
 #include <cstring>
+#include <thread>
 #include "analysis_cout_logger.hpp"
 #include "analysis_data_file_handler.hpp"
+#include "analysis_data_table.hpp"
 #include "analyzer.hpp"
+#include "wdl_analyzer.hpp"
 #include "string_to_uint.hpp"
 #include "version.hpp"
 
 using namespace gobb_analyzer;
 
+/// The maximum number of threads.
+constexpr unsigned long MaxThreadNums = 1024u;
+
+/// Set by SIGINT or SIGTERM to stop the analysis.
+volatile std::sig_atomic_t stopRequested = 0;
+
+//
+// Handle SIGINT and SIGTERM.
+//
+extern "C" void handle_stop_signal(int) {
+    stopRequested = 1;
+}
+
 //
 // Print the help messages.
 //
 void print_help_message() {
     std::cout << "Usage: gobb_analyze [OPTION...]" << std::endl;
     std::cout << "Options:" << std::endl;
+    std::cout << "  -c SECONDS  store a checkpoint every SECONDS (default: 0, only on" << std::endl;
+    std::cout << "              SIGINT or SIGTERM)" << std::endl;
     std::cout << "  -d DIR      store analysis data files in DIR (default: .)" << std::endl;
     std::cout << "  -g NUM      resume analysis the NUM'th generation" << std::endl;
     std::cout << "              (default: the latest generation stored)" << std::endl;
     std::cout << "  -i          start analysis initially" << std::endl;
+    std::cout << "  -j NUM      use NUM threads in the bucket and jacobi strategies" << std::endl;
+    std::cout << "              (default: the number of CPUs)" << std::endl;
+    std::cout << "  -M MODE     pages for the analysis data table: auto, hugetlb, thp" << std::endl;
+    std::cout << "              or normal (default: auto)" << std::endl;
+    std::cout << "  -m STRATEGY analysis strategy: serial, bucket, jacobi or fork" << std::endl;
+    std::cout << "              (default: serial)" << std::endl;
+    std::cout << "  -N MODE     NUMA placement of the analysis data table: interleave," << std::endl;
+    std::cout << "              block or none (default: interleave)" << std::endl;
+    std::cout << "  -P DEPTH    prefetch analysis data of DEPTH positions ahead (1-"
+              << MaxPrefetchDepth << "," << std::endl;
+    std::cout << "              default: " << DefaultPrefetchDepth << ")" << std::endl;
+    std::cout << "  -r          analyze only positions reachable from the initial position" << std::endl;
+    std::cout << "              (with -i)" << std::endl;
     std::cout << "  -s          store analysis data to a file every generation" << std::endl;
+    std::cout << "  -w NUM      use NUM worker processes in the fork strategy" << std::endl;
+    std::cout << "              (1-" << MaxShardNums << ", default: the number of CPUs)" << std::endl;
+    std::cout << "  --pin-threads" << std::endl;
+    std::cout << "              pin the analysis thread and worker threads to CPUs" << std::endl;
+    std::cout << "  --wdl-only  solve win/draw/loss only, and store it to a WDL file" << std::endl;
     std::cout << "  --help      print this help, then exit" << std::endl;
     std::cout << "  --version   print version information, then exit" << std::endl;
 }
@@ -67,10 +105,25 @@ int main(int argc, char* argv[]) {
     //
     std::string dataDir;
     unsigned long generation = 0u;
+    unsigned long checkpointInterval = 0u;
     bool opt_d = false;
     bool opt_g = false;
     bool opt_i = false;
+    bool opt_r = false;
     bool opt_s = false;
+    bool opt_pin = false;
+    bool opt_wdl = false;
+    TablePlacementPolicy placementPolicy;
+    std::size_t prefetchDepth = DefaultPrefetchDepth;
+    AnalysisStrategy strategy = AnalysisStrategy::Serial;
+    unsigned long threadNums = std::thread::hardware_concurrency();
+    if (threadNums == 0u) {
+        threadNums = 1u;
+    }
+    unsigned long shardNums = threadNums;
+    if (shardNums > static_cast<unsigned long>(MaxShardNums)) {
+        shardNums = MaxShardNums;
+    }
 
     int optind = 1;
     while (optind < argc) {
@@ -82,6 +135,25 @@ int main(int argc, char* argv[]) {
         if (ch == '-' && argv[optind][2] == '\0') {
             optind++;
             break;
+        } else if (ch == 'c') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-c'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (!string_to_uint(optarg, checkpointInterval)) {
+                std::cerr << argv[0] << ": invalid checkpoint interval: " << optarg << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
         } else if (ch == 'd') {
             opt_d = true;
             const char* optarg;
@@ -121,9 +193,156 @@ int main(int argc, char* argv[]) {
         } else if (ch == 'i') {
             opt_i = true;
             optind++;
+        } else if (ch == 'j') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-j'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (!string_to_uint(optarg, threadNums) || threadNums < 1u || threadNums > MaxThreadNums) {
+                std::cerr << argv[0] << ": invalid number of threads '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'm') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-m'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (std::strcmp(optarg, "serial") == 0) {
+                strategy = AnalysisStrategy::Serial;
+            } else if (std::strcmp(optarg, "bucket") == 0) {
+                strategy = AnalysisStrategy::Bucket;
+            } else if (std::strcmp(optarg, "jacobi") == 0) {
+                strategy = AnalysisStrategy::Jacobi;
+            } else if (std::strcmp(optarg, "fork") == 0) {
+                strategy = AnalysisStrategy::Forked;
+            } else {
+                std::cerr << argv[0] << ": invalid strategy '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'M') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-M'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (std::strcmp(optarg, "auto") == 0) {
+                placementPolicy.pageMode = TablePageMode::Auto;
+            } else if (std::strcmp(optarg, "hugetlb") == 0) {
+                placementPolicy.pageMode = TablePageMode::HugeTLB;
+            } else if (std::strcmp(optarg, "thp") == 0) {
+                placementPolicy.pageMode = TablePageMode::TransparentHugePages;
+            } else if (std::strcmp(optarg, "normal") == 0) {
+                placementPolicy.pageMode = TablePageMode::Normal;
+            } else {
+                std::cerr << argv[0] << ": invalid page mode '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'N') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-N'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (std::strcmp(optarg, "interleave") == 0) {
+                placementPolicy.numaMode = TableNumaMode::Interleave;
+            } else if (std::strcmp(optarg, "block") == 0) {
+                placementPolicy.numaMode = TableNumaMode::Block;
+            } else if (std::strcmp(optarg, "none") == 0) {
+                placementPolicy.numaMode = TableNumaMode::None;
+            } else {
+                std::cerr << argv[0] << ": invalid NUMA mode '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'P') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-P'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (!string_to_uint(optarg, prefetchDepth) || prefetchDepth < 1u ||
+                prefetchDepth > MaxPrefetchDepth) {
+                std::cerr << argv[0] << ": invalid prefetch depth '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'r') {
+            opt_r = true;
+            optind++;
         } else if (ch == 's') {
             opt_s = true;
             optind++;
+        } else if (ch == 'w') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-w'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (!string_to_uint(optarg, shardNums) || shardNums < 1u ||
+                shardNums > static_cast<unsigned long>(MaxShardNums)) {
+                std::cerr << argv[0] << ": invalid number of worker processes '" << optarg << "'" << std::endl;
+                print_try_help_message(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[optind], "--pin-threads") == 0) {
+            opt_pin = true;
+            optind++;
+        } else if (std::strcmp(argv[optind], "--wdl-only") == 0) {
+            opt_wdl = true;
+            optind++;
         } else if (std::strcmp(argv[optind], "--help") == 0) {
             print_help_message();
             return 0;
@@ -147,6 +366,54 @@ int main(int argc, char* argv[]) {
         print_try_help_message(argv[0]);
     }
 
+    if (opt_g && opt_wdl) {
+        std::cerr << argv[0] << ": '-g' and '--wdl-only' options are conflicted" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+
+    //
+    // The reachable positions are applied at the initialization, which resuming skips.
+    //
+    if (opt_r && !opt_i) {
+        std::cerr << argv[0] << ": '-r' option requires '-i' option" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+
+    if (opt_r && opt_wdl) {
+        std::cerr << argv[0] << ": '-r' and '--wdl-only' options are conflicted" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+
+    //
+    // In the WDL-only mode, creates a WdlAnalyzer instance instead.
+    //
+    if (opt_wdl) {
+        try {
+            AnalysisCoutLogger logger;
+            WdlAnalyzer analyzer(logger);
+            analyzer.set_thread_nums(static_cast<int>(threadNums));
+            analyzer.set_stop_flag(&stopRequested);
+            AnalysisDataFileHandler fileHandler;
+            if (opt_d) {
+                fileHandler = AnalysisDataFileHandler(dataDir);
+            }
+            bool success = opt_i ? analyzer.start(fileHandler) : analyzer.resume(fileHandler);
+            if (!success || analyzer.interrupted()) {
+                return 1;
+            }
+        } catch (std::exception& err) {
+            std::cerr << "an exception raised, " << err.what() <<  std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     //
     // Creates an Anlyzer instance and do analysis.
     //
@@ -157,9 +424,24 @@ int main(int argc, char* argv[]) {
         ioMode = AnalysisDataIOMode::StoreFinalGeneration;
     }
 
+    if (strategy == AnalysisStrategy::Forked) {
+        placementPolicy.shared = true;
+    }
+
     try {
         AnalysisCoutLogger logger;
-        Analyzer analyzer(logger);
+        Analyzer analyzer(logger, placementPolicy);
+        analyzer.set_thread_affinity(opt_pin);
+        analyzer.set_prefetch_depth(prefetchDepth);
+        analyzer.set_strategy(strategy);
+        analyzer.set_thread_nums(static_cast<int>(threadNums));
+        analyzer.set_shard_nums(static_cast<int>(shardNums));
+        if (opt_d) {
+            analyzer.set_work_directory(dataDir);
+        }
+        analyzer.set_stop_flag(&stopRequested);
+        analyzer.set_checkpoint_interval(std::chrono::seconds(checkpointInterval));
+        analyzer.set_reachability_filter(opt_r);
         AnalysisDataFileHandler fileHandler;
         if (opt_d) {
             fileHandler = AnalysisDataFileHandler(dataDir);
@@ -178,6 +460,9 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         }
+        if (analyzer.interrupted()) {
+            return 1;
+        }
     } catch (std::exception& err) {
         std::cerr << "an exception raised, " << err.what() <<  std::endl;
         return 1;
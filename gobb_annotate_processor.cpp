@@ -0,0 +1,361 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gobb_annotate_processor.hpp"
+#include "run_threads.hpp"
+#include "string_to_uint.hpp"
+
+using namespace gobb_analyzer;
+
+GobbAnnotateProcessor::GobbAnnotateProcessor(const Inspector& inspector, AnnotateOutputFormat format,
+    int threadNums)
+    : inspector_(inspector),
+      format_(format),
+      threadNums_(threadNums < 1 ? 1 : threadNums),
+      records_(),
+      lineEnds_(),
+      counts_() {
+    lineEnds_.reserve(chunkLineNums_);
+}
+
+GobbAnnotateProcessor::~GobbAnnotateProcessor() {
+}
+
+bool GobbAnnotateProcessor::process(std::FILE* in, std::FILE* out) {
+    std::vector<char> inputBuffer(inputBufferSize_);
+
+    //
+    // A line may be split by the boundary of reads, so that its head is kept in `records_` until its end
+    // is read.
+    //
+    for (;;) {
+        std::size_t readSize = std::fread(inputBuffer.data(), 1u, inputBuffer.size(), in);
+        if (readSize == 0u) {
+            break;
+        }
+
+        const char* p = inputBuffer.data();
+        const char* end = p + readSize;
+        while (p < end) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (newline == nullptr) {
+                records_.append(p, end);
+                break;
+            }
+            records_.append(p, newline);
+            lineEnds_.push_back(records_.size());
+            p = newline + 1;
+            if (lineEnds_.size() >= chunkLineNums_ && !flush_chunk(out)) {
+                return false;
+            }
+        }
+    }
+    if (std::ferror(in)) {
+        std::cerr << "failed to read game records" << std::endl;
+        return false;
+    }
+    if (records_.size() > (lineEnds_.empty() ? 0u : lineEnds_.back())) {
+        lineEnds_.push_back(records_.size());
+    }
+
+    return flush_chunk(out) && std::fflush(out) == 0;
+}
+
+const AnnotateCounts& GobbAnnotateProcessor::counts() const noexcept {
+    return counts_;
+}
+
+bool GobbAnnotateProcessor::flush_chunk(std::FILE* out) {
+    std::size_t lineNums = lineEnds_.size();
+    if (lineNums == 0u) {
+        return true;
+    }
+
+    //
+    // Each thread annotates its own range of lines, and the outputs are written in the order of ranges.
+    //
+    std::vector<std::string> outputs(threadNums_);
+    std::vector<AnnotateCounts> rangeCounts(threadNums_, AnnotateCounts());
+    std::size_t rangeSize = (lineNums + threadNums_ - 1) / threadNums_;
+    auto worker = [&](int range) {
+        std::size_t beginLine = range * rangeSize;
+        std::size_t endLine = beginLine + rangeSize;
+        if (beginLine > lineNums) {
+            beginLine = lineNums;
+        }
+        if (endLine > lineNums) {
+            endLine = lineNums;
+        }
+        annotate_range(beginLine, endLine, outputs[range], rangeCounts[range]);
+    };
+
+    run_threads(threadNums_, worker);
+
+    records_.clear();
+    lineEnds_.clear();
+
+    for (int i = 0; i < threadNums_; i++) {
+        counts_.gameNums += rangeCounts[i].gameNums;
+        counts_.moveNums += rangeCounts[i].moveNums;
+        counts_.blunderNums += rangeCounts[i].blunderNums;
+        counts_.mistakeNums += rangeCounts[i].mistakeNums;
+        counts_.errorNums += rangeCounts[i].errorNums;
+        if (std::fwrite(outputs[i].data(), 1u, outputs[i].size(), out) != outputs[i].size()) {
+            std::cerr << "failed to write annotated records" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void GobbAnnotateProcessor::annotate_range(std::size_t beginLine, std::size_t endLine, std::string& output,
+    AnnotateCounts& counts) const {
+    //
+    // All the games of the range are replayed first, so that their positions are looked up at once.
+    //
+    std::vector<Game> games(endLine - beginLine);
+    std::vector<PositionId> positions;
+    std::vector<GameMove> moves;
+    for (std::size_t line = beginLine; line < endLine; line++) {
+        std::size_t lineBegin = (line == 0u) ? 0u : lineEnds_[line - 1];
+        replay_game(records_.data() + lineBegin, records_.data() + lineEnds_[line], games[line - beginLine],
+            positions, moves);
+    }
+
+    std::vector<PositionInspectionResult> results(positions.size());
+    inspector_.inspect_positions(positions.data(), positions.size(), results.data(), 1);
+
+    auto append_result = [&](const PositionInspectionResult& result) {
+        output += ",\"status\":\"";
+        output += analysisStatus_to_string(result.analysisStatus);
+        output += "\",\"turn\":";
+        if (inspector_.wdl_only()) {
+            output += "null";
+        } else {
+            output += std::to_string(result.turn);
+        }
+    };
+
+    for (const Game& game: games) {
+        counts.gameNums++;
+        if (!game.error.empty()) {
+            counts.errorNums++;
+            if (format_ == AnnotateOutputFormat::JsonLines) {
+                output += "{\"error\":\"" + game.error + "\"}\n";
+            } else {
+                output += "error " + game.error + "\n";
+            }
+            continue;
+        }
+
+        std::uint64_t blunderNums = 0u;
+        std::uint64_t mistakeNums = 0u;
+        const PositionInspectionResult& start = results[game.firstPosition];
+        if (format_ == AnnotateOutputFormat::JsonLines) {
+            output += "{\"start\":";
+            output += std::to_string(start.positionId);
+            append_result(start);
+            output += ",\"moves\":[";
+        } else if (game.hasStart) {
+            output += std::to_string(start.positionId);
+        }
+
+        for (std::size_t i = 0u; i < game.moveNums; i++) {
+            const GameMove& move = moves[game.firstMove + i];
+            const PositionInspectionResult& before = results[game.firstPosition + i];
+            const PositionInspectionResult& after = results[game.firstPosition + i + 1];
+            const char* mark = annotate_move(move, before, after);
+            if (mark[0] != '\0' && mark[1] != '\0') {
+                blunderNums++;
+            } else if (mark[0] != '\0') {
+                mistakeNums++;
+            }
+
+            if (format_ == AnnotateOutputFormat::JsonLines) {
+                output += (i == 0u) ? "{\"move\":\"" : ",{\"move\":\"";
+                output += move_to_notation(move.piece, move.source, move.destination);
+                if (move.lost) {
+                    output += "\",\"position\":null,\"status\":null,\"turn\":null";
+                } else {
+                    output += "\",\"position\":";
+                    output += std::to_string(after.positionId);
+                    append_result(after);
+                }
+                output += ",\"mark\":\"";
+                output += mark;
+                output += "\"}";
+            } else {
+                if (i > 0u || game.hasStart) {
+                    output += ' ';
+                }
+                output += move_to_notation(move.piece, move.source, move.destination);
+                output += mark;
+            }
+        }
+
+        if (format_ == AnnotateOutputFormat::JsonLines) {
+            output += "],\"blunders\":" + std::to_string(blunderNums) + ",\"mistakes\":"
+                + std::to_string(mistakeNums) + "}\n";
+        } else {
+            output += '\n';
+        }
+        counts.moveNums += game.moveNums;
+        counts.blunderNums += blunderNums;
+        counts.mistakeNums += mistakeNums;
+    }
+}
+
+void GobbAnnotateProcessor::replay_game(const char* begin, const char* end, Game& game,
+    std::vector<PositionId>& positions, std::vector<GameMove>& moves) const {
+    game.firstPosition = positions.size();
+    game.firstMove = moves.size();
+    game.moveNums = 0u;
+    game.hasStart = false;
+    game.error.clear();
+
+    auto is_space = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    };
+    auto next_word = [&](const char*& wordBegin, const char*& wordEnd) {
+        while (begin < end && is_space(*begin)) {
+            begin++;
+        }
+        wordBegin = begin;
+        while (begin < end && !is_space(*begin)) {
+            begin++;
+        }
+        wordEnd = begin;
+        return wordBegin < wordEnd;
+    };
+
+    //
+    // A record optionally begins with the position ID where the game starts.
+    //
+    Position pos(InitialPositionId);
+    const char* wordBegin;
+    const char* wordEnd;
+    bool hasWord = next_word(wordBegin, wordEnd);
+    if (hasWord && std::isdigit(static_cast<unsigned char>(*wordBegin))) {
+        std::string word(wordBegin, wordEnd);
+        PositionId id;
+        if (!string_to_uint(word, id) || !is_valid_positionId(id)) {
+            game.error = "invalid position '" + word + "'";
+            return;
+        }
+        pos = Position(id);
+        game.hasStart = true;
+        hasWord = next_word(wordBegin, wordEnd);
+    }
+    positions.push_back(pos.id());
+
+    //
+    // The game is over after a move lining up three pieces of the opponent.  It is recorded as a move, but
+    // the position before it is looked up again in place of the position after it.
+    //
+    bool over = false;
+    for (; hasWord; hasWord = next_word(wordBegin, wordEnd)) {
+        std::size_t ply = game.moveNums + 1u;
+        GameMove move;
+        if (!notation_to_move(wordBegin, wordEnd, move.piece, move.source, move.destination)) {
+            game.error = "invalid move '" + std::string(wordBegin, wordEnd) + "' at ply " + std::to_string(ply);
+            return;
+        }
+        if (over || pos.is_winner(PlayerId::Active) || pos.is_winner(PlayerId::Inactive)) {
+            game.error = "the game is over before '" + std::string(wordBegin, wordEnd) + "' at ply "
+                + std::to_string(ply);
+            return;
+        }
+        MoveResult moveResult = pos.move(move.piece, move.source, move.destination);
+        if (moveResult.status == MoveResultStatus::Invalid) {
+            game.error = "illegal move '" + std::string(wordBegin, wordEnd) + "' at ply " + std::to_string(ply);
+            return;
+        }
+        move.lost = (moveResult.status == MoveResultStatus::Lost);
+        if (move.lost) {
+            over = true;
+        } else {
+            pos = moveResult.position;
+        }
+        positions.push_back(pos.id());
+        moves.push_back(move);
+        game.moveNums++;
+    }
+}
+
+const char* GobbAnnotateProcessor::annotate_move(const GameMove& move, const PositionInspectionResult& before,
+    const PositionInspectionResult& after) const {
+    //
+    // Outcomes are 1 for a win, 0 for a draw and -1 for a loss.  Moves from or to positions without a
+    // known outcome (e.g. contradictory positions) are not marked.
+    //
+    constexpr int UnknownOutcome = 2;
+    auto outcome_of_status = [](AnalysisStatus status) {
+        switch (status) {
+        case AnalysisStatus::Won:
+        case AnalysisStatus::WonStalemate:
+            return 1;
+        case AnalysisStatus::Lost:
+        case AnalysisStatus::LostStalemate:
+            return -1;
+        case AnalysisStatus::Unfixed:
+            return 0;
+        default:
+            return UnknownOutcome;
+        }
+    };
+
+    int beforeOutcome = outcome_of_status(before.analysisStatus);
+    if (beforeOutcome == UnknownOutcome) {
+        return "";
+    }
+
+    //
+    // The outcome and the distance after the move are seen from the player who has moved.  A move lining
+    // up three pieces of the opponent loses at once.
+    //
+    int afterOutcome = -1;
+    Turn afterTurn = 0;
+    if (!move.lost) {
+        int outcome = outcome_of_status(after.analysisStatus);
+        if (outcome == UnknownOutcome) {
+            return "";
+        }
+        afterOutcome = -outcome;
+        afterTurn = after.turn;
+    }
+
+    if (afterOutcome < beforeOutcome) {
+        return "??";
+    }
+    if (afterOutcome > beforeOutcome || inspector_.wdl_only()) {
+        return "";
+    }
+    if (beforeOutcome == 1 && afterTurn + 1 > before.turn) {
+        return "?";
+    }
+    if (beforeOutcome == -1 && afterTurn + 1 < before.turn) {
+        return "?";
+    }
+    return "";
+}
+
@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANNOTATE_PROCESSOR_HPP
+#define GOBB_ANNOTATE_PROCESSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "position.hpp"
+#include "inspector.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Output formats of GobbAnnotateProcessor.
+//
+enum class AnnotateOutputFormat {
+    Text,       // the moves with marks appended.
+    JsonLines   // a JSON object in a line for each game.
+};
+
+//
+// Counts of annotated games.
+//
+struct AnnotateCounts {
+    std::uint64_t gameNums;     // the number of games.
+    std::uint64_t moveNums;     // the number of moves.
+    std::uint64_t blunderNums;  // the number of moves changing the outcome.
+    std::uint64_t mistakeNums;  // the number of moves worsening the distance.
+    std::uint64_t errorNums;    // the number of games with an invalid or illegal move.
+};
+
+//
+// Class GobbAnnotateProcessor.
+//
+// It reads game records, one game in a line, and writes an annotated record for each of them in the input
+// order.  A record is a sequence of moves written as SIZE:SOURCE-DESTINATION (e.g. Large:Out-Center),
+// optionally preceded by the position ID where the game starts.  Games are read in chunks, and a chunk is
+// divided among threads.  Each thread replays its games, and then looks up all the positions at once in
+// the order of the table (see Inspector::inspect_positions()).
+//
+class GobbAnnotateProcessor {
+public:
+    GobbAnnotateProcessor() = delete;
+    GobbAnnotateProcessor(const Inspector& inspector, AnnotateOutputFormat format, int threadNums);
+    GobbAnnotateProcessor(const GobbAnnotateProcessor& other) = delete;
+    GobbAnnotateProcessor(GobbAnnotateProcessor&& other) = delete;
+    ~GobbAnnotateProcessor();
+    GobbAnnotateProcessor& operator=(const GobbAnnotateProcessor& other) = delete;
+    GobbAnnotateProcessor& operator=(GobbAnnotateProcessor&& other) = delete;
+
+    bool process(std::FILE* in, std::FILE* out);
+    const AnnotateCounts& counts() const noexcept;
+
+private:
+    // Unit tests access the internals through it.
+    friend class GobbAnnotateProcessorTestPeer;
+
+    // A move of a game.
+    struct GameMove {
+        PieceId piece;
+        LocationId source;
+        LocationId destination;
+        bool lost;  // the move lines up three pieces of the opponent.
+    };
+
+    // A replayed game.
+    struct Game {
+        std::size_t firstPosition;  // the index of the starting position in the positions of the range.
+        std::size_t firstMove;      // the index of the first move in the moves of the range.
+        std::size_t moveNums;       // the number of moves.
+        bool hasStart;              // whether the record gives the starting position.
+        std::string error;          // an error message, or empty.
+    };
+
+    bool flush_chunk(std::FILE* out);
+    void annotate_range(std::size_t beginLine, std::size_t endLine, std::string& output,
+        AnnotateCounts& counts) const;
+    void replay_game(const char* begin, const char* end, Game& game, std::vector<PositionId>& positions,
+        std::vector<GameMove>& moves) const;
+    const char* annotate_move(const GameMove& move, const PositionInspectionResult& before,
+        const PositionInspectionResult& after) const;
+
+    const Inspector& inspector_;
+    AnnotateOutputFormat format_;
+    int threadNums_;
+    std::string records_;
+    std::vector<std::size_t> lineEnds_;
+    AnnotateCounts counts_;
+
+    static constexpr std::size_t chunkLineNums_ = 1u << 16;
+    static constexpr std::size_t inputBufferSize_ = 1u << 20;
+};
+
+#endif // GOBB_ANNOTATE_PROCESSOR_HPP
@@ -0,0 +1,190 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gobb_annotate_processor.hpp"
+#include "wdl_analyzer.hpp"
+#include "gtest/gtest.h"
+
+//
+// Access to the internals of GobbAnnotateProcessor for the tests.
+//
+class GobbAnnotateProcessorTestPeer {
+public:
+    //
+    // Return the mark of a move from `before` to `after`.
+    //
+    static std::string annotate_move(const GobbAnnotateProcessor& processor, bool lost, AnalysisStatus beforeStatus,
+        Turn beforeTurn, AnalysisStatus afterStatus, Turn afterTurn) {
+        GobbAnnotateProcessor::GameMove move = {PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center, lost};
+        PositionInspectionResult before = {InitialPositionId, beforeTurn, beforeStatus};
+        PositionInspectionResult after = {InitialPositionId, afterTurn, afterStatus};
+        if (lost) {
+            after = PositionInspectionResult();
+        }
+        return processor.annotate_move(move, before, after);
+    }
+};
+
+namespace {
+
+//
+// An I/O handler which gives WDL data kept in memory to an inspector.
+//
+class WdlHandler: public AnalysisDataIOHandler {
+public:
+    WdlHandler()
+        : wdlTable_() {
+        std::uint8_t byte = 0u;
+        for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+            byte = set_wdlValue_of_byte(byte, id, WdlValue::Excluded);
+        }
+        wdlTable_.assign(WdlTableSize, byte);
+    }
+
+    virtual bool store(Generation, const AnalysisStatistics&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool load(Generation, AnalysisStatistics&, AnalysisData*, std::size_t) const { return false; }
+    virtual Generation find_latest() const { return InvalidGeneration; }
+    virtual Generation load_latest(AnalysisStatistics&, AnalysisData*, std::size_t) const {
+        return InvalidGeneration;
+    }
+    virtual bool store_checkpoint(const AnalysisCheckpoint&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool find_checkpoint(AnalysisCheckpoint&) const { return false; }
+    virtual bool load_checkpoint(AnalysisCheckpoint&, AnalysisData*, std::size_t) const { return false; }
+    virtual void remove_checkpoint() {}
+    virtual bool store_wdl(const AnalysisStatistics&, bool, const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+        std::size_t tableSize) const {
+        if (wdlTable_.size() != tableSize) {
+            return false;
+        }
+        stats = AnalysisStatistics();
+        complete = true;
+        std::copy(wdlTable_.begin(), wdlTable_.end(), table);
+        return true;
+    }
+    virtual bool store_reachability(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_reachability(std::uint8_t*, std::size_t) const { return false; }
+    virtual void clean() {}
+
+private:
+    std::vector<std::uint8_t> wdlTable_;
+};
+
+} // namespace
+
+//
+// Test that a move changing the outcome for the player who moves is marked `??`.
+//
+TEST(GobbAnnotateProcessorTest, Blunder) {
+    Inspector inspector;
+    GobbAnnotateProcessor processor(inspector, AnnotateOutputFormat::Text, 1);
+
+    //
+    // The status after the move is seen from the opponent.
+    //
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Unfixed, 0u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Won, 2u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Unfixed, 0u,
+        AnalysisStatus::WonStalemate, 8u), "??");
+
+    //
+    // Keeping or improving the outcome is not a blunder.
+    //
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Unfixed, 0u,
+        AnalysisStatus::Unfixed, 0u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Lost, 4u,
+        AnalysisStatus::Unfixed, 0u), "");
+}
+
+//
+// Test that a move keeping the outcome but worsening the distance is marked `?`.
+//
+TEST(GobbAnnotateProcessorTest, Mistake) {
+    Inspector inspector;
+    GobbAnnotateProcessor processor(inspector, AnnotateOutputFormat::Text, 1);
+
+    //
+    // A winner should win faster, and the best move reaches a position lost in one turn less.
+    //
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Lost, 4u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Lost, 6u), "?");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::WonStalemate, 5u,
+        AnalysisStatus::LostStalemate, 6u), "?");
+
+    //
+    // A loser should lose slower.
+    //
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Lost, 6u,
+        AnalysisStatus::Won, 5u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Lost, 6u,
+        AnalysisStatus::Won, 3u), "?");
+
+    //
+    // Moves from or to positions without a known outcome are not marked.
+    //
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Contradictory, 0u,
+        AnalysisStatus::Unfixed, 0u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Contradictory, 0u), "");
+}
+
+//
+// Test that a move lining up three pieces of the opponent is taken as a loss at once.
+//
+TEST(GobbAnnotateProcessorTest, ImmediateLoss) {
+    Inspector inspector;
+    GobbAnnotateProcessor processor(inspector, AnnotateOutputFormat::Text, 1);
+
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Won, 5u,
+        AnalysisStatus::Invalid, 0u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Unfixed, 0u,
+        AnalysisStatus::Invalid, 0u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Lost, 3u,
+        AnalysisStatus::Invalid, 0u), "?");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Lost, 1u,
+        AnalysisStatus::Invalid, 0u), "");
+}
+
+//
+// Test that only blunders are marked with WDL data, which have no distance.
+//
+TEST(GobbAnnotateProcessorTest, WdlData) {
+    WdlHandler handler;
+    Inspector inspector;
+    ASSERT_TRUE(inspector.load_wdl(handler));
+    ASSERT_TRUE(inspector.wdl_only());
+    GobbAnnotateProcessor processor(inspector, AnnotateOutputFormat::Text, 1);
+
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 0u,
+        AnalysisStatus::Unfixed, 0u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Unfixed, 0u,
+        AnalysisStatus::Invalid, 0u), "??");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Won, 0u,
+        AnalysisStatus::Lost, 0u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, false, AnalysisStatus::Lost, 0u,
+        AnalysisStatus::Won, 0u), "");
+    ASSERT_EQ(GobbAnnotateProcessorTestPeer::annotate_move(processor, true, AnalysisStatus::Lost, 0u,
+        AnalysisStatus::Invalid, 0u), "");
+}
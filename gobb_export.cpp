@@ -0,0 +1,221 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "analysis_cout_logger.hpp"
+#include "analysis_data_file_handler.hpp"
+#include "exporter.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+using namespace gobb_analyzer;
+
+/// The maximum number of threads.
+constexpr unsigned long MaxThreadNums = 1024u;
+
+//
+// Print the help messages.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_export [OPTION...] -t TYPE" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -d DIR      load an analysis data file in DIR (default: .)" << std::endl;
+    std::cout << "  -g NUM      load analysis data file of the NUM'th generation" << std::endl;
+    std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -j NUM      use NUM threads (default: the number of CPUs)" << std::endl;
+    std::cout << "  -l NUM      export positions with NUM pieces or less off the board" << std::endl;
+    std::cout << "              (type 'lategame' only, default: 1)" << std::endl;
+    std::cout << "  -o DIR      write the exported file in DIR (default: the same as -d)" << std::endl;
+    std::cout << "  -t TYPE     type of the exported file: opening, bestmove, lategame, index" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_export --help' ..." message.
+//
+void print_try_help_message(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string dataDir;
+    std::string outputDir;
+    std::string exportType;
+    unsigned long generation = 0u;
+    unsigned long offBoardPieceNums = 1u;
+    bool opt_d = false;
+    bool opt_g = false;
+    bool opt_o = false;
+    unsigned long threadNums = std::thread::hardware_concurrency();
+    if (threadNums == 0u) {
+        threadNums = 1u;
+    }
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'd' || ch == 'g' || ch == 'j' || ch == 'l' || ch == 'o' || ch == 't') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'd') {
+                opt_d = true;
+                dataDir = std::string(optarg);
+            } else if (ch == 'g') {
+                opt_g = true;
+                if (!string_to_uint(optarg, generation) || generation > MaxGeneration) {
+                    std::cerr << argv[0] << ": invalid generation '" << optarg << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'j') {
+                if (!string_to_uint(optarg, threadNums) || threadNums < 1u || threadNums > MaxThreadNums) {
+                    std::cerr << argv[0] << ": invalid number of threads: " << optarg << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'l') {
+                if (!string_to_uint(optarg, offBoardPieceNums) || offBoardPieceNums > PieceSetNums) {
+                    std::cerr << argv[0] << ": invalid number of pieces: " << optarg << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'o') {
+                opt_o = true;
+                outputDir = std::string(optarg);
+            } else {
+                exportType = std::string(optarg);
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_try_help_message(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        std::cerr << argv[0] << ": too many arguments" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+    if (exportType.empty()) {
+        std::cerr << argv[0] << ": missing option '-t'" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+    if (exportType != "opening" && exportType != "bestmove" && exportType != "lategame" && exportType != "index") {
+        std::cerr << argv[0] << ": unknown type '" << exportType << "'" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+
+    //
+    // Creates an Exporter instance and exports the data.
+    //
+    try {
+        AnalysisCoutLogger logger;
+        AnalysisDataFileHandler inputHandler;
+        if (opt_d) {
+            inputHandler = AnalysisDataFileHandler(dataDir);
+        }
+        AnalysisDataFileHandler outputHandler(inputHandler);
+        if (opt_o) {
+            outputHandler = AnalysisDataFileHandler(outputDir);
+        }
+
+        Exporter exporter(logger);
+        exporter.set_thread_nums(static_cast<int>(threadNums));
+        Generation loadedGeneration = static_cast<Generation>(generation);
+        if (opt_g) {
+            if (!exporter.load(inputHandler, loadedGeneration)) {
+                std::cerr << "failed to load the analysis data file of the specified generation" << std::endl;
+                return 1;
+            }
+        } else {
+            loadedGeneration = exporter.load_latest(inputHandler);
+            if (loadedGeneration == InvalidGeneration) {
+                std::cerr << "failed to load an analysis data file" << std::endl;
+                return 1;
+            }
+        }
+
+        if (exportType == "opening") {
+            if (!exporter.export_opening(inputHandler, outputHandler)) {
+                return 1;
+            }
+        } else if (exportType == "bestmove") {
+            if (!exporter.export_best_moves(outputHandler)) {
+                return 1;
+            }
+        } else if (exportType == "lategame") {
+            if (!exporter.export_late_game(outputHandler, static_cast<int>(offBoardPieceNums))) {
+                return 1;
+            }
+        } else {
+            if (!exporter.export_status_index(outputHandler, loadedGeneration)) {
+                return 1;
+            }
+        }
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -15,11 +15,17 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <cstdio>
 #include <cstring>
 #include <exception>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 #include "analysis_data_file_handler.hpp"
+#include "game_graph.hpp"
+#include "gobb_inspect_batch_processor.hpp"
 #include "gobb_inspect_processor.hpp"
 #include "position_text_creator.hpp"
 #include "string_to_uint.hpp"
@@ -34,17 +40,40 @@ extern "C" {
 }
 #endif
 
+/// The maximum number of threads.
+constexpr unsigned long MaxThreadNums = 1024u;
+
 //
 // Print the help message.
 //
 void print_help_message() {
     std::cout << "Usage: gobb_inspect [OPTION...] [POSITION-ID]" << std::endl;
     std::cout << "Options:" << std::endl;
+    std::cout << "  -b          also load the best-move table written by 'gobb_export'" << std::endl;
     std::cout << "  -c          print pieces in color on the terminal" << std::endl;
     std::cout << "  -C          do not print pieces in color on the terminal" << std::endl;
     std::cout << "  -d DIR      load an analysis data file in DIR (default: .)" << std::endl;
+    std::cout << "  -f FILE     read position IDs from FILE with --batch (default: standard in)" << std::endl;
+    std::cout << "  -F FORMAT   output format of --batch: json, binary (default: json)" << std::endl;
     std::cout << "  -g NUM      load analysis data file of the NUM'th generation" << std::endl;
     std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -i          also map the status index written by 'gobb_export'" << std::endl;
+    std::cout << "  -j NUM      use NUM threads with --batch or --graph (default: the number of CPUs)" << std::endl;
+    std::cout << "  -n NUM      print at most NUM moves of a principal variation (default: 100)" << std::endl;
+    std::cout << "  -o          load the opening database written by 'gobb_export'" << std::endl;
+    std::cout << "  -w          load the WDL file written by 'gobb_analyze --wdl-only'" << std::endl;
+    std::cout << "  --batch     print analysis data of position IDs read from FILE, then exit" << std::endl;
+    std::cout << "  --graph FORMAT" << std::endl;
+    std::cout << "              print the game graph below POSITION-ID in FORMAT: json, dot, then exit" << std::endl;
+    std::cout << "  --depth NUM follow NUM moves from POSITION-ID with --graph (default: 4)" << std::endl;
+    std::cout << "  --max-nodes NUM" << std::endl;
+    std::cout << "              collect at most NUM positions with --graph (default: 100000)" << std::endl;
+    std::cout << "  --best-only follow the best moves only with --graph" << std::endl;
+    std::cout << "  --pv        print principal variations of POSITION-ID or position IDs" << std::endl;
+    std::cout << "              read from standard in, then exit" << std::endl;
+    std::cout << "  --script FILE" << std::endl;
+    std::cout << "              execute commands in FILE without prompts, then exit" << std::endl;
+    std::cout << "  --json      print moves, retrograde moves and the history in JSON" << std::endl;
     std::cout << "  --help      print this help, then exit" << std::endl;
     std::cout << "  --version   print version information, then exit" << std::endl;
 }
@@ -63,6 +92,40 @@ void print_hint(const char* argv0) {
     std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
 }
 
+//
+// Print a principal variation of a position in a line.
+//
+void print_principal_variation(const Inspector& inspector, PositionId posId, int maxPlies) {
+    PositionInspectionResult posResult = inspector.inspect_position(posId);
+    std::vector<MoveInspectionResult> moves = inspector.principal_variation(posId, maxPlies);
+
+    std::string line = std::to_string(posId) + " " + analysisStatus_to_string(posResult.analysisStatus);
+    for (const MoveInspectionResult& move: moves) {
+        line += " " + move_to_notation(move.piece, move.source, move.destination);
+    }
+    line += '\n';
+    std::cout << line;
+}
+
+//
+// Print principal variations of positions read from standard in.
+//
+bool print_principal_variations(const Inspector& inspector, int maxPlies) {
+    bool success = true;
+    std::string word;
+    while (std::cin >> word) {
+        PositionId posId;
+        if (!string_to_uint(word, posId) || !is_valid_positionId(posId)) {
+            std::cerr << "invalid position '" << word << "'" << std::endl;
+            success = false;
+            continue;
+        }
+        print_principal_variation(inspector, posId, maxPlies);
+    }
+    std::cout << std::flush;
+    return success;
+}
+
 //
 // Main.
 //
@@ -72,9 +135,28 @@ int main(int argc, char* argv[]) {
     //
     std::string dataDir;
     unsigned long generation = 0u;
+    bool opt_b = false;
     bool opt_c = false;
     bool opt_d = false;
     bool opt_g = false;
+    bool opt_i = false;
+    bool opt_o = false;
+    bool opt_w = false;
+    bool opt_pv = false;
+    bool opt_batch = false;
+    bool opt_json = false;
+    bool opt_bestOnly = false;
+    std::string graphFormat;
+    unsigned long graphDepth = 4u;
+    unsigned long maxNodeNums = 100000u;
+    std::string scriptFile;
+    unsigned long maxPlies = 100u;
+    std::string inputFile;
+    BatchOutputFormat outputFormat = BatchOutputFormat::JsonLines;
+    unsigned long threadNums = std::thread::hardware_concurrency();
+    if (threadNums == 0u) {
+        threadNums = 1u;
+    }
 #if defined(_WIN32)
     opt_c = _isatty(1);
 #elif defined(HAVE_UNISTD_H)
@@ -91,6 +173,9 @@ int main(int argc, char* argv[]) {
         if (ch == '-' && argv[optind][2] == '\0') {
             optind++;
             break;
+        } else if (ch == 'b') {
+            opt_b = true;
+            optind++;
         } else if (ch == 'c') {
             opt_c = true;
             optind++;
@@ -133,6 +218,125 @@ int main(int argc, char* argv[]) {
                 print_hint(argv[0]);
                 return 1;
             }
+        } else if (ch == 'f' || ch == 'F' || ch == 'j') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'f') {
+                inputFile = std::string(optarg);
+            } else if (ch == 'F') {
+                if (std::strcmp(optarg, "json") == 0) {
+                    outputFormat = BatchOutputFormat::JsonLines;
+                } else if (std::strcmp(optarg, "binary") == 0) {
+                    outputFormat = BatchOutputFormat::Binary;
+                } else {
+                    std::cerr << argv[0] << ": unknown format '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else {
+                if (!string_to_uint(optarg, threadNums) || threadNums < 1u || threadNums > MaxThreadNums) {
+                    std::cerr << argv[0] << ": invalid number of threads: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (ch == 'n') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-n'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+            if (!string_to_uint(optarg, maxPlies) || maxPlies > MaxTurn) {
+                std::cerr << argv[0] << ": invalid number of moves '" << optarg << "'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+        } else if (ch == 'i') {
+            opt_i = true;
+            optind++;
+        } else if (ch == 'o') {
+            opt_o = true;
+            optind++;
+        } else if (ch == 'w') {
+            opt_w = true;
+            optind++;
+        } else if (std::strcmp(argv[optind], "--batch") == 0) {
+            opt_batch = true;
+            optind++;
+        } else if (std::strcmp(argv[optind], "--pv") == 0) {
+            opt_pv = true;
+            optind++;
+        } else if (std::strcmp(argv[optind], "--script") == 0) {
+            if (optind + 1 >= argc) {
+                std::cerr << argv[0] << ": missing argument to option '--script'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            scriptFile = std::string(argv[optind + 1]);
+            optind += 2;
+        } else if (std::strcmp(argv[optind], "--graph") == 0) {
+            if (optind + 1 >= argc) {
+                std::cerr << argv[0] << ": missing argument to option '--graph'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            graphFormat = std::string(argv[optind + 1]);
+            if (graphFormat != "json" && graphFormat != "dot") {
+                std::cerr << argv[0] << ": unknown format '" << graphFormat << "'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            optind += 2;
+        } else if (std::strcmp(argv[optind], "--depth") == 0) {
+            if (optind + 1 >= argc) {
+                std::cerr << argv[0] << ": missing argument to option '--depth'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            if (!string_to_uint(argv[optind + 1], graphDepth) || graphDepth > MaxTurn) {
+                std::cerr << argv[0] << ": invalid depth '" << argv[optind + 1] << "'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            optind += 2;
+        } else if (std::strcmp(argv[optind], "--max-nodes") == 0) {
+            if (optind + 1 >= argc) {
+                std::cerr << argv[0] << ": missing argument to option '--max-nodes'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            if (!string_to_uint(argv[optind + 1], maxNodeNums) || maxNodeNums < 1u || maxNodeNums > 0xffff'ffffu) {
+                std::cerr << argv[0] << ": invalid number of positions '" << argv[optind + 1] << "'" << std::endl;
+                print_hint(argv[0]);
+                return 1;
+            }
+            optind += 2;
+        } else if (std::strcmp(argv[optind], "--best-only") == 0) {
+            opt_bestOnly = true;
+            optind++;
+        } else if (std::strcmp(argv[optind], "--json") == 0) {
+            opt_json = true;
+            optind++;
         } else if (std::strcmp(argv[optind], "--help") == 0) {
             print_help_message();
             return 0;
@@ -146,6 +350,38 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if ((opt_g && opt_w) || (opt_g && opt_o) || (opt_o && opt_w)) {
+        std::cerr << argv[0] << ": '-g', '-o' and '-w' options are conflicted" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (opt_i && (opt_o || opt_w)) {
+        std::cerr << argv[0] << ": '-i' option cannot be used with '-o' or '-w'" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (opt_w && opt_bestOnly) {
+        std::cerr << argv[0] << ": '--best-only' option cannot be used with '-w'" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (opt_w && opt_pv && !opt_b) {
+        std::cerr << argv[0] << ": '--pv' option needs '-b' with '-w'" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    int modeNums = (opt_batch ? 1 : 0) + (opt_pv ? 1 : 0) + (scriptFile.empty() ? 0 : 1)
+        + (graphFormat.empty() ? 0 : 1);
+    if (modeNums > 1) {
+        std::cerr << argv[0] << ": '--batch', '--graph', '--pv' and '--script' options are conflicted" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (opt_batch && optind < argc) {
+        std::cerr << argv[0] << ": too many arguments" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
     if (optind + 1 < argc) {
         std::cerr << argv[0] << ": too many arguments" << std::endl;
         print_hint(argv[0]);
@@ -153,7 +389,8 @@ int main(int argc, char* argv[]) {
     }
 
     PositionId posId;
-    if (optind + 1 == argc) {
+    bool havePosId = (optind + 1 == argc);
+    if (havePosId) {
         if (!string_to_uint(argv[optind], posId)) {
             std::cerr << argv[0] << ": invalid position '"  << argv[optind] << "'" << std::endl;
             print_hint(argv[0]);
@@ -164,6 +401,31 @@ int main(int argc, char* argv[]) {
         posId = InitialPositionId;
     }
 
+    if (!graphFormat.empty() && !is_valid_positionId(posId)) {
+        std::cerr << argv[0] << ": invalid position '"  << posId << "'" << std::endl;
+        return 1;
+    }
+    if (opt_pv) {
+        if (havePosId && !is_valid_positionId(posId)) {
+            std::cerr << argv[0] << ": invalid position '"  << posId << "'" << std::endl;
+            return 1;
+        }
+        std::ios::sync_with_stdio(false);
+    }
+
+    //
+    // The output of a script is written to a buffer, and it is flushed at the end.
+    //
+    std::ifstream script;
+    if (!scriptFile.empty()) {
+        script.open(scriptFile);
+        if (!script) {
+            std::cerr << argv[0] << ": failed to open the file '" << scriptFile << "'" << std::endl;
+            return 1;
+        }
+        std::ios::sync_with_stdio(false);
+    }
+
     //
     // Creates a GobbInspectProcessor instance and starts interactive processing.
     //
@@ -176,20 +438,101 @@ int main(int argc, char* argv[]) {
         }
 
         Inspector inspector;
-        if (opt_g) {
-            if (!inspector.load(fileHandler, static_cast<Generation>(generation))) {
+        Generation loadedGeneration = static_cast<Generation>(generation);
+        if (opt_o) {
+            if (!inspector.load_opening(fileHandler)) {
+                std::cerr << "failed to load the opening database" << std::endl;
+                return 1;
+            }
+        } else if (opt_w) {
+            if (!inspector.load_wdl(fileHandler)) {
+                std::cerr << "failed to load the WDL file" << std::endl;
+                return 1;
+            }
+        } else if (opt_g) {
+            if (!inspector.load(fileHandler, loadedGeneration)) {
                 std::cerr << "failed to load the analysis data file of the specified generation" << std::endl;
                 return 1;
             }
         } else {
-            if (inspector.load_latest(fileHandler) == InvalidGeneration) {
+            loadedGeneration = inspector.load_latest(fileHandler);
+            if (loadedGeneration == InvalidGeneration) {
                 std::cerr << "failed to load an analysis data file" << std::endl;
                 return 1;
             }
         }
 
+        //
+        // The status index is mapped, and it must remain mapped while the inspector is used.
+        //
+        MappedFile statusIndexMapping;
+        if (opt_i) {
+            std::size_t imageSize;
+            if (!fileHandler.map_status_index(loadedGeneration, statusIndexMapping) ||
+                !inspector.use_status_index(
+                    AnalysisDataFileHandler::mapped_status_index(statusIndexMapping, imageSize), imageSize)) {
+                std::cerr << "failed to map the status index" << std::endl;
+                return 1;
+            }
+        }
+
+        if (opt_b && !inspector.load_best_moves(fileHandler)) {
+            std::cerr << "failed to load the best-move table" << std::endl;
+            return 1;
+        }
+
+        if (opt_batch) {
+            std::FILE* in = stdin;
+            if (!inputFile.empty()) {
+                in = std::fopen(inputFile.c_str(), "rb");
+                if (in == nullptr) {
+                    std::cerr << argv[0] << ": failed to open the file '" << inputFile << "'" << std::endl;
+                    return 1;
+                }
+            }
+            GobbInspectBatchProcessor batchProcessor(inspector, outputFormat, static_cast<int>(threadNums));
+            bool success = batchProcessor.process(in, stdout);
+            if (in != stdin) {
+                std::fclose(in);
+            }
+            return success ? 0 : 1;
+        }
+
+        if (!graphFormat.empty()) {
+            std::ios::sync_with_stdio(false);
+            GameGraph graph(inspector);
+            graph.set_thread_nums(static_cast<int>(threadNums));
+            graph.set_max_node_nums(maxNodeNums);
+            graph.set_best_moves_only(opt_bestOnly);
+            graph.build(posId, static_cast<int>(graphDepth));
+            if (graphFormat == "json") {
+                graph.write_json(std::cout);
+            } else {
+                graph.write_dot(std::cout);
+            }
+            std::cout << std::flush;
+            if (graph.truncated()) {
+                std::cerr << "the graph is truncated at " << graph.nodes().size() << " positions" << std::endl;
+            }
+            return 0;
+        }
+
+        if (opt_pv) {
+            if (havePosId) {
+                print_principal_variation(inspector, posId, static_cast<int>(maxPlies));
+                std::cout << std::flush;
+                return 0;
+            }
+            return print_principal_variations(inspector, static_cast<int>(maxPlies)) ? 0 : 1;
+        }
+
         GobbInspectProcessor processor(inspector, textCreator, posId);
-        processor.do_main_loop();
+        processor.set_json_output(opt_json);
+        if (!scriptFile.empty()) {
+            processor.do_script(script);
+        } else {
+            processor.do_main_loop();
+        }
     } catch (std::exception& err) {
         std::cerr << "an exception raised, " << err.what() <<  std::endl;
         return 1;
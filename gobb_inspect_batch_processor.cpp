@@ -0,0 +1,165 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gobb_inspect_batch_processor.hpp"
+
+using namespace gobb_analyzer;
+
+GobbInspectBatchProcessor::GobbInspectBatchProcessor(const Inspector& inspector, BatchOutputFormat format,
+    int threadNums)
+    : inspector_(inspector),
+      format_(format),
+      threadNums_(threadNums),
+      ids_(),
+      results_(),
+      overflowTokens_(),
+      outputBuffer_() {
+    ids_.reserve(chunkSize_);
+}
+
+GobbInspectBatchProcessor::~GobbInspectBatchProcessor() {
+}
+
+bool GobbInspectBatchProcessor::process(std::FILE* in, std::FILE* out) {
+    std::vector<char> inputBuffer(inputBufferSize_);
+
+    //
+    // A number may be split by the boundary of reads, so that the parser keeps its state across them.
+    //
+    PositionId value = 0u;
+    std::size_t digitNums = 0u;
+    std::string overflowToken;
+    std::size_t lineNum = 1u;
+    for (;;) {
+        std::size_t readSize = std::fread(inputBuffer.data(), 1u, inputBuffer.size(), in);
+        if (readSize == 0u) {
+            break;
+        }
+
+        for (std::size_t i = 0u; i < readSize; i++) {
+            char c = inputBuffer[i];
+            if ('0' <= c && c <= '9') {
+                //
+                // Too large numbers are replaced with `InvalidPositionId`, and their digits are kept to be
+                // reported.
+                //
+                if (value < PositionIdNums) {
+                    value = value * 10u + static_cast<PositionId>(c - '0');
+                } else {
+                    if (value != InvalidPositionId) {
+                        overflowToken = std::to_string(value);
+                        value = InvalidPositionId;
+                    }
+                    overflowToken += c;
+                }
+                digitNums++;
+            } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                if (digitNums > 0u) {
+                    if (value == InvalidPositionId) {
+                        overflowTokens_.emplace_back(ids_.size(), overflowToken);
+                    }
+                    ids_.push_back(value);
+                    value = 0u;
+                    digitNums = 0u;
+                    if (ids_.size() >= chunkSize_ && !flush_chunk(out)) {
+                        return false;
+                    }
+                }
+                if (c == '\n') {
+                    lineNum++;
+                }
+            } else {
+                std::cerr << "invalid character in position IDs at line " << lineNum << std::endl;
+                return false;
+            }
+        }
+    }
+    if (std::ferror(in)) {
+        std::cerr << "failed to read position IDs" << std::endl;
+        return false;
+    }
+    if (digitNums > 0u) {
+        if (value == InvalidPositionId) {
+            overflowTokens_.emplace_back(ids_.size(), overflowToken);
+        }
+        ids_.push_back(value);
+    }
+
+    return flush_chunk(out) && std::fflush(out) == 0;
+}
+
+bool GobbInspectBatchProcessor::flush_chunk(std::FILE* out) {
+    results_.resize(ids_.size());
+    inspector_.inspect_positions(ids_.data(), ids_.size(), results_.data(), threadNums_);
+
+    outputBuffer_.clear();
+    auto overflow = overflowTokens_.begin();
+    for (std::size_t i = 0u; i < results_.size(); i++) {
+        if (format_ == BatchOutputFormat::JsonLines) {
+            if (overflow != overflowTokens_.end() && overflow->first == i) {
+                append_json_line(results_[i], overflow->second);
+                ++overflow;
+            } else {
+                append_json_line(results_[i], std::to_string(results_[i].positionId));
+            }
+        } else {
+            append_binary_record(results_[i]);
+        }
+    }
+    ids_.clear();
+    overflowTokens_.clear();
+
+    if (std::fwrite(outputBuffer_.data(), 1u, outputBuffer_.size(), out) != outputBuffer_.size()) {
+        std::cerr << "failed to write results" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GobbInspectBatchProcessor::append_json_line(const PositionInspectionResult& result,
+    const std::string& positionText) {
+    outputBuffer_ += "{\"position\":";
+    outputBuffer_ += positionText;
+    outputBuffer_ += ",\"status\":\"";
+    outputBuffer_ += analysisStatus_to_string(result.analysisStatus);
+    outputBuffer_ += "\",\"turn\":";
+    if (inspector_.wdl_only()) {
+        outputBuffer_ += "null";
+    } else {
+        outputBuffer_ += std::to_string(result.turn);
+    }
+    outputBuffer_ += "}\n";
+}
+
+void GobbInspectBatchProcessor::append_binary_record(const PositionInspectionResult& result) {
+    //
+    // A record is a position ID (8 bytes), the number of remaining turns (2 bytes), a status code (1 byte)
+    // and a padding (1 byte), in little endian.
+    //
+    std::uint64_t id = result.positionId;
+    for (int i = 0; i < 8; i++) {
+        outputBuffer_ += static_cast<char>((id >> (i * 8)) & 0xffu);
+    }
+    outputBuffer_ += static_cast<char>(result.turn & 0xffu);
+    outputBuffer_ += static_cast<char>((result.turn >> 8) & 0xffu);
+    outputBuffer_ += static_cast<char>(static_cast<std::uint8_t>(result.analysisStatus));
+    outputBuffer_ += '\0';
+}
@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_INSPECT_BATCH_PROCESSOR_HPP
+#define GOBB_INSPECT_BATCH_PROCESSOR_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "position.hpp"
+#include "inspector.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Output formats of GobbInspectBatchProcessor.
+//
+enum class BatchOutputFormat {
+    JsonLines,  // a JSON object in a line for each position.
+    Binary      // a 12-byte record for each position.
+};
+
+//
+// Class GobbInspectBatchProcessor.
+//
+// It reads position IDs separated by white spaces, and writes their analysis data in the input order.
+// Positions are looked up in chunks, so that the input can be a stream of any length.  A number too large
+// for a position ID is written as it is read in the JSON lines format.
+//
+
+class GobbInspectBatchProcessor {
+public:
+    GobbInspectBatchProcessor() = delete;
+    GobbInspectBatchProcessor(const Inspector& inspector, BatchOutputFormat format, int threadNums);
+    GobbInspectBatchProcessor(const GobbInspectBatchProcessor& other) = delete;
+    GobbInspectBatchProcessor(GobbInspectBatchProcessor&& other) = delete;
+    ~GobbInspectBatchProcessor();
+    GobbInspectBatchProcessor& operator=(const GobbInspectBatchProcessor& other) = delete;
+    GobbInspectBatchProcessor& operator=(GobbInspectBatchProcessor&& other) = delete;
+
+    bool process(std::FILE* in, std::FILE* out);
+
+private:
+    bool flush_chunk(std::FILE* out);
+    void append_json_line(const PositionInspectionResult& result, const std::string& positionText);
+    void append_binary_record(const PositionInspectionResult& result);
+
+    const Inspector& inspector_;
+    BatchOutputFormat format_;
+    int threadNums_;
+    std::vector<PositionId> ids_;
+    std::vector<PositionInspectionResult> results_;
+    std::vector<std::pair<std::size_t, std::string>> overflowTokens_;
+    std::string outputBuffer_;
+
+    static constexpr std::size_t chunkSize_ = 1u << 20;
+    static constexpr std::size_t inputBufferSize_ = 1u << 20;
+};
+
+#endif // GOBB_INSPECT_BATCH_PROCESSOR_HPP
@@ -0,0 +1,240 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "gobb_inspect_batch_processor.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+/// The size of a read from the input, which is the same as that of GobbInspectBatchProcessor.
+constexpr std::size_t InputBufferSize = 1u << 20;
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// Return the positions after the first move, which are not minimized.
+//
+std::vector<PositionId> first_positions() {
+    std::vector<PositionId> ids;
+    Position pos(InitialPositionId);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        for (LocationId dst: OnBoardLocationIds) {
+            MoveResult moveResult = pos.move(piece, LocationId::Out, dst);
+            if (moveResult.status == MoveResultStatus::Success) {
+                ids.push_back(moveResult.position.id());
+            }
+        }
+    }
+    return ids;
+}
+
+//
+// Load an opening database where the positions after the first move have various results.
+//
+void load_opening(Inspector& inspector) {
+    OpeningHandler handler;
+    handler.set_opening(InitialPositionId, AnalysisStatus::Won, 9u);
+    std::vector<PositionId> ids = first_positions();
+    for (std::size_t i = 0u; i < ids.size(); i++) {
+        AnalysisStatus status = (i % 2u == 0u) ? AnalysisStatus::Lost : AnalysisStatus::Unfixed;
+        handler.set_opening(ids[i], status, static_cast<Turn>(i));
+    }
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// Run a batch processor on an input, and return the output.
+//
+bool run_batch(const Inspector& inspector, BatchOutputFormat format, int threadNums, const std::string& input,
+    std::string& output) {
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    std::fwrite(input.data(), 1u, input.size(), in);
+    std::rewind(in);
+
+    GobbInspectBatchProcessor processor(inspector, format, threadNums);
+    bool result = processor.process(in, out);
+
+    output.clear();
+    std::rewind(out);
+    char buffer[4096];
+    std::size_t readSize;
+    while ((readSize = std::fread(buffer, 1u, sizeof(buffer), out)) > 0u) {
+        output.append(buffer, readSize);
+    }
+    std::fclose(in);
+    std::fclose(out);
+    return result;
+}
+
+//
+// Return a JSON line of a position.
+//
+std::string json_line(const std::string& positionText, AnalysisStatus status, Turn turn) {
+    return "{\"position\":" + positionText + ",\"status\":\"" + analysisStatus_to_string(status) +
+        "\",\"turn\":" + std::to_string(turn) + "}\n";
+}
+
+//
+// Return a JSON line of a position looked up by Inspector::inspect_position().
+//
+std::string json_line(const Inspector& inspector, PositionId id) {
+    PositionInspectionResult result = inspector.inspect_position(id);
+    return json_line(std::to_string(id), result.analysisStatus, result.turn);
+}
+
+} // namespace
+
+//
+// Test that results are written in the input order, although positions are looked up in the order of
+// the table.
+//
+TEST(GobbInspectBatchProcessorTest, InputOrder) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    //
+    // The positions are given in the reverse order, with duplicates, an invalid ID and a position missing
+    // in the database.
+    //
+    std::vector<PositionId> ids = first_positions();
+    std::string input;
+    std::string expected;
+    for (auto it = ids.rbegin(); it != ids.rend(); ++it) {
+        input += std::to_string(*it) + " " + std::to_string(InitialPositionId) + "\n";
+        expected += json_line(inspector, *it) + json_line(inspector, InitialPositionId);
+    }
+    MoveResult missing = Position(ids[0]).move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center);
+    ASSERT_EQ(missing.status, MoveResultStatus::Success);
+    PositionId missingId = missing.position.id();
+    ASSERT_EQ(inspector.inspect_position(missingId).analysisStatus, AnalysisStatus::Contradictory);
+    input += std::to_string(PositionIdNums) + "\t" + std::to_string(ids[0]) + " " + std::to_string(missingId) + "\r\n";
+    expected += json_line(std::to_string(PositionIdNums), AnalysisStatus::Invalid, 0u);
+    expected += json_line(inspector, ids[0]);
+    expected += json_line(inspector, missingId);
+
+    for (int threadNums: {1, 3}) {
+        std::string output;
+        ASSERT_TRUE(run_batch(inspector, BatchOutputFormat::JsonLines, threadNums, input, output));
+        ASSERT_EQ(output, expected);
+    }
+}
+
+//
+// Test that a number split by the boundary of reads is parsed as a number.
+//
+TEST(GobbInspectBatchProcessorTest, ReadBoundary) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    std::vector<PositionId> ids = first_positions();
+    std::string first = std::to_string(ids[1]);
+    std::string second = std::to_string(ids[2]);
+    ASSERT_GT(first.size(), 3u);
+    std::string input(InputBufferSize - 3u, ' ');
+    input += first + "\n" + second;
+
+    std::string output;
+    ASSERT_TRUE(run_batch(inspector, BatchOutputFormat::JsonLines, 1, input, output));
+    ASSERT_EQ(output, json_line(inspector, ids[1]) + json_line(inspector, ids[2]));
+}
+
+//
+// Test that a number too large for a position ID is reported as it is read.
+//
+TEST(GobbInspectBatchProcessorTest, Overflow) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    std::string tooLarge = "123456789012345678901234567890";
+    std::string input = std::to_string(InitialPositionId) + " 000" + tooLarge + " " +
+        std::to_string(InitialPositionId) + " " + tooLarge;
+    std::string output;
+    ASSERT_TRUE(run_batch(inspector, BatchOutputFormat::JsonLines, 1, input, output));
+    ASSERT_EQ(output, json_line(inspector, InitialPositionId) +
+        json_line(tooLarge, AnalysisStatus::Invalid, 0u) +
+        json_line(inspector, InitialPositionId) +
+        json_line(tooLarge, AnalysisStatus::Invalid, 0u));
+
+    //
+    // A binary record can't hold the number, and has `InvalidPositionId` instead.
+    //
+    ASSERT_TRUE(run_batch(inspector, BatchOutputFormat::Binary, 1, tooLarge, output));
+    ASSERT_EQ(output.size(), 12u);
+    ASSERT_EQ(output.substr(0u, 8u), std::string(8u, '\xff'));
+    ASSERT_EQ(static_cast<std::uint8_t>(output[10]), static_cast<std::uint8_t>(AnalysisStatus::Invalid));
+}
+
+//
+// Test that a character other than digits and white spaces stops the processing.
+//
+TEST(GobbInspectBatchProcessorTest, InvalidCharacter) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    std::string output;
+    ASSERT_FALSE(run_batch(inspector, BatchOutputFormat::JsonLines, 1, "1 2x\n", output));
+}
@@ -15,8 +15,12 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 #include "gobb_inspect_processor.hpp"
@@ -25,16 +29,20 @@
 using namespace gobb_analyzer;
 
 GobbInspectProcessor::GobbInspectProcessor(Inspector& inspector, PositionTextCreator& textCreator,
-    PositionId posId)
+    PositionId posId, std::ostream& output)
     : inspector_(inspector),
+      cache_(inspector, cacheCapacity_),
       textCreator_(textCreator),
       position_(posId),
-      positionInspectionResult_(inspector.inspect_position(posId)),
-      moveInspectionResults_(inspector.inspect_moves(posId)),
-      moveBackInspectionResults_(inspector.inspect_move_backs(posId)),
+      positionInspectionResult_(),
+      moveInspectionResults_(),
+      moveBackInspectionResults_(),
       historyTable_(),
-      currentHistoryIndex_(0u) {
-    historyTable_.push_back(inspector_.inspect_position(posId));
+      currentHistoryIndex_(0u),
+      output_(output),
+      jsonOutput_(false) {
+    inspect_position(posId);
+    historyTable_.push_back(positionInspectionResult_);
 }
 
 GobbInspectProcessor::~GobbInspectProcessor() {
@@ -47,50 +55,80 @@ void GobbInspectProcessor::do_main_loop() {
     show_moves();
 
     for (;;) {
-        std::cout << "gobb_inspect> " << std::flush;
+        output_ << "gobb_inspect> " << std::flush;
         if (!std::getline(std::cin, line)) {
             break;
         }
-
-        std::vector<std::string> args = split_into_arguments(line);
-        if (args.size() == 0) {
-            continue;
+        if (!execute_command(line)) {
+            break;
         }
+    }
+    output_ << std::flush;
+}
 
-        if (args[0] == "show-position" || args[0] == "sp") {
-            do_show_position_command(args);
-        } else if (args[0] == "goto-position" || args[0] == "gp") {
-            do_goto_position_command(args);
-        } else if (args[0] == "show-moves" || args[0] == "sm") {
-            do_show_moves_command(args);
-        } else if (args[0] == "show-movebacks" || args[0] == "smb") {
-            do_show_move_backs_command(args);
-        } else if (args[0] == "move" || args[0] == "m") {
-            do_move_command(args);
-        } else if (args[0] == "moveback" || args[0] == "mb") {
-            do_move_back_command(args);
-        } else if (args[0] == "show-history" || args[0] == "sh") {
-            do_show_history_command(args);
-        } else if (args[0] == "goto-history" || args[0] == "gh") {
-            do_goto_history_command(args);
-        } else if (args[0] == "next" || args[0] == "n") {
-            do_next_command(args);
-        } else if (args[0] == "previous" || args[0] == "p") {
-            do_previous_command(args);
-        } else if (args[0] == "help" || args[0] == "?") {
-            do_help_command(args);
-        } else if (args[0] == "exit") {
+void GobbInspectProcessor::do_script(std::istream& in) {
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (!execute_command(line)) {
             break;
-        } else {
-            show_line("invalid command");
-            show_hint();
         }
     }
+    output_ << std::flush;
+}
+
+void GobbInspectProcessor::set_json_output(bool jsonOutput) {
+    jsonOutput_ = jsonOutput;
+}
+
+bool GobbInspectProcessor::execute_command(const std::string& line) {
+    std::vector<std::string> args = split_into_arguments(line);
+    if (args.size() == 0 || args[0][0] == '#') {
+        return true;
+    }
+
+    if (args[0] == "show-position" || args[0] == "sp") {
+        do_show_position_command(args);
+    } else if (args[0] == "goto-position" || args[0] == "gp") {
+        do_goto_position_command(args);
+    } else if (args[0] == "show-moves" || args[0] == "sm") {
+        do_show_moves_command(args);
+    } else if (args[0] == "show-movebacks" || args[0] == "smb") {
+        do_show_move_backs_command(args);
+    } else if (args[0] == "move" || args[0] == "m") {
+        do_move_command(args);
+    } else if (args[0] == "moveback" || args[0] == "mb") {
+        do_move_back_command(args);
+    } else if (args[0] == "best-move" || args[0] == "bm") {
+        do_best_move_command(args);
+    } else if (args[0] == "show-history" || args[0] == "sh") {
+        do_show_history_command(args);
+    } else if (args[0] == "goto-history" || args[0] == "gh") {
+        do_goto_history_command(args);
+    } else if (args[0] == "next" || args[0] == "n") {
+        do_next_command(args);
+    } else if (args[0] == "previous" || args[0] == "p") {
+        do_previous_command(args);
+    } else if (args[0] == "show-index" || args[0] == "si") {
+        do_show_index_command(args);
+    } else if (args[0] == "find-positions" || args[0] == "fp") {
+        do_find_positions_command(args);
+    } else if (args[0] == "show-cache" || args[0] == "sc") {
+        do_show_cache_command(args);
+    } else if (args[0] == "help" || args[0] == "?") {
+        do_help_command(args);
+    } else if (args[0] == "exit") {
+        return false;
+    } else {
+        show_error("invalid command");
+        show_hint();
+    }
+    return true;
 }
 
 void GobbInspectProcessor::do_show_position_command(const std::vector<std::string>& args) {
     if (args.size() != 1) {
-        show_line("invalid arguments to 'show-position' command");
+        show_error("invalid arguments to 'show-position' command");
         show_hint();
         return;
     }
@@ -99,7 +137,7 @@ void GobbInspectProcessor::do_show_position_command(const std::vector<std::strin
 
 void GobbInspectProcessor::do_show_moves_command(const std::vector<std::string>& args) {
     if (args.size() != 1) {
-        show_line("invalid arguments to 'show-moves' command");
+        show_error("invalid arguments to 'show-moves' command");
         show_hint();
         return;
     }
@@ -108,7 +146,7 @@ void GobbInspectProcessor::do_show_moves_command(const std::vector<std::string>&
 
 void GobbInspectProcessor::do_show_move_backs_command(const std::vector<std::string>& args) {
     if (args.size() != 1) {
-        show_line("invalid arguments to 'show-movebacks' command");
+        show_error("invalid arguments to 'show-movebacks' command");
         show_hint();
         return;
     }
@@ -117,19 +155,16 @@ void GobbInspectProcessor::do_show_move_backs_command(const std::vector<std::str
 
 void GobbInspectProcessor::do_goto_position_command(const std::vector<std::string>& args) {
     if (args.size() != 2) {
-        show_line("invalid arguments to 'position' command");
+        show_error("invalid arguments to 'position' command");
         show_hint();
         return;
     }
     PositionId posId;
     if (!string_to_uint(args[1], posId)) {
-        show_line("invalid position");
+        show_error("invalid position");
         return;
     }
-    position_ = posId;
-    positionInspectionResult_ = inspector_.inspect_position(posId);
-    moveInspectionResults_ = inspector_.inspect_moves(posId);
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(posId);
+    inspect_position(posId);
 
     show_horizontal_line();
     show_position();
@@ -139,18 +174,18 @@ void GobbInspectProcessor::do_goto_position_command(const std::vector<std::strin
 
 void GobbInspectProcessor::do_move_command(const std::vector<std::string>& args) {
     if (args.size() != 2) {
-        show_line("invalid arguments for 'move' command");
+        show_error("invalid arguments for 'move' command");
         show_hint();
         return;
     }
 
     unsigned long index = 0u;
     if (!string_to_uint(args[1], index)) {
-        show_line("invalid index");
+        show_error("invalid index");
         return;
     }
     if (index >= moveInspectionResults_.size()) {
-        show_line("invalid index for 'move' command");
+        show_error("invalid index for 'move' command");
         return;
     }
 
@@ -158,10 +193,7 @@ void GobbInspectProcessor::do_move_command(const std::vector<std::string>& args)
         moveInspectionResults_[index].piece,
         moveInspectionResults_[index].source,
         moveInspectionResults_[index].destination);
-    position_ = moveResult.position;
-    positionInspectionResult_ = inspector_.inspect_position(position_.id());
-    moveInspectionResults_ = inspector_.inspect_moves(position_.id());
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(position_.id());
+    inspect_position(moveResult.position.id());
 
     show_horizontal_line();
     show_position();
@@ -171,17 +203,18 @@ void GobbInspectProcessor::do_move_command(const std::vector<std::string>& args)
 
 void GobbInspectProcessor::do_move_back_command(const std::vector<std::string>& args) {
     if (args.size() != 2) {
-        show_line("invalid arguments for 'moveback' command");
+        show_error("invalid arguments for 'moveback' command");
         show_hint();
         return;
     }
 
     unsigned long index = 0u;
     if (!string_to_uint(args[1], index)) {
-        show_line("invalid index");
+        show_error("invalid index");
+        return;
     }
     if (index >= moveBackInspectionResults_.size()) {
-        show_line("invalid index for 'moveback' command");
+        show_error("invalid index for 'moveback' command");
         return;
     }
 
@@ -189,10 +222,7 @@ void GobbInspectProcessor::do_move_back_command(const std::vector<std::string>&
         moveBackInspectionResults_[index].piece,
         moveBackInspectionResults_[index].source,
         moveBackInspectionResults_[index].destination);
-    position_ = moveResult.position;
-    positionInspectionResult_ = inspector_.inspect_position(position_.id());
-    moveInspectionResults_ = inspector_.inspect_moves(position_.id());
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(position_.id());
+    inspect_position(moveResult.position.id());
 
     show_horizontal_line();
     show_position();
@@ -200,9 +230,33 @@ void GobbInspectProcessor::do_move_back_command(const std::vector<std::string>&
     add_history(positionInspectionResult_);
 }
 
+void GobbInspectProcessor::do_best_move_command(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        show_error("invalid arguments to 'best-move' command");
+        show_hint();
+        return;
+    }
+    if (!inspector_.has_best_moves()) {
+        show_error("no best-move table is loaded");
+        return;
+    }
+
+    MoveInspectionResult insRes;
+    if (!inspector_.best_move(position_.id(), insRes)) {
+        show_error("no best move");
+        return;
+    }
+    show_line("best move: {:{}s}, {:{}s} -> {:{}s}, position = {:{}d}, {}",
+        pieceSize_to_string(pieceSize_of_pieceId(insRes.piece)), ValidPieceSizeStringMaxLen,
+        locationId_to_string(insRes.source), ValidLocationIdStringMaxLen,
+        locationId_to_string(insRes.destination), ValidLocationIdStringMaxLen,
+        insRes.positionId, MaxPositionIdWidth,
+        analysisStatus_to_string(insRes.analysisStatus));
+}
+
 void GobbInspectProcessor::do_show_history_command(const std::vector<std::string>& args) {
     if (args.size() != 1) {
-        show_line("invalid arguments to 'show-history' command");
+        show_error("invalid arguments to 'show-history' command");
         show_hint();
         return;
     }
@@ -211,27 +265,24 @@ void GobbInspectProcessor::do_show_history_command(const std::vector<std::string
 
 void GobbInspectProcessor::do_goto_history_command(const std::vector<std::string>& args) {
     if (args.size() != 2) {
-        show_line("invalid arguments to 'history' command");
+        show_error("invalid arguments to 'history' command");
         show_hint();
         return;
     }
 
     unsigned long index = 0u;
     if (!string_to_uint(args[1], index)) {
-        show_line("invalid index");
+        show_error("invalid index");
         return;
     }
     if (index >= historyTable_.size()) {
-        show_line("invalid index for 'history' command");
+        show_error("invalid index for 'history' command");
         return;
     }
 
     currentHistoryIndex_ = index;
     PositionId posId = historyTable_[currentHistoryIndex_].positionId;
-    position_ = posId;
-    positionInspectionResult_ = inspector_.inspect_position(posId);
-    moveInspectionResults_ = inspector_.inspect_moves(posId);
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(posId);
+    inspect_position(posId);
 
     show_horizontal_line();
     show_position();
@@ -240,20 +291,17 @@ void GobbInspectProcessor::do_goto_history_command(const std::vector<std::string
 
 void GobbInspectProcessor::do_next_command(const std::vector<std::string>& args) {
     if (args.size() != 1) {
-        show_line("invalid arguments to 'next' command");
+        show_error("invalid arguments to 'next' command");
         show_hint();
         return;
     }
     if (currentHistoryIndex_ + 1 >= historyTable_.size()) {
-        show_line("no next entry in the history table");
+        show_error("no next entry in the history table");
         return;
     }
     currentHistoryIndex_++;
     PositionId posId = historyTable_[currentHistoryIndex_].positionId;
-    position_ = posId;
-    positionInspectionResult_ = inspector_.inspect_position(posId);
-    moveInspectionResults_ = inspector_.inspect_moves(posId);
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(posId);
+    inspect_position(posId);
 
     show_position();
     show_moves();
@@ -261,26 +309,146 @@ void GobbInspectProcessor::do_next_command(const std::vector<std::string>& args)
 
 void GobbInspectProcessor::do_previous_command(const std::vector<std::string>& args){
     if (args.size() != 1) {
-        show_line("invalid arguments to 'previous' command");
+        show_error("invalid arguments to 'previous' command");
         show_hint();
         return;
     }
     if (currentHistoryIndex_ == 0) {
-        show_line("no previous entry in the history table");
+        show_error("no previous entry in the history table");
         return;
     }
 
     currentHistoryIndex_--;
     PositionId posId = historyTable_[currentHistoryIndex_].positionId;
-    position_ = posId;
-    positionInspectionResult_ = inspector_.inspect_position(posId);
-    moveInspectionResults_ = inspector_.inspect_moves(posId);
-    moveBackInspectionResults_ = inspector_.inspect_move_backs(posId);
+    inspect_position(posId);
 
     show_position();
     show_moves();
 }
 
+void GobbInspectProcessor::do_show_index_command(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        show_error("invalid arguments to 'show-index' command");
+        show_hint();
+        return;
+    }
+    const StatusIndex& index = inspector_.status_index();
+    if (index.empty()) {
+        show_error("no status index is mapped");
+        return;
+    }
+
+    if (jsonOutput_) {
+        std::string line = "{\"index\":[";
+        for (std::size_t i = 0u; i < index.bucket_nums(); i++) {
+            const StatusIndexBucket& bucket = index.bucket(i);
+            if (i > 0u) {
+                line += ',';
+            }
+            line += "{\"status\":\"" + analysisStatus_to_string(status_of_analysisData(bucket.data));
+            line += "\",\"turn\":" + turn_to_json(turn_of_analysisData(bucket.data));
+            line += ",\"count\":" + std::to_string(bucket.cardinality) + "}";
+        }
+        line += "]}";
+        show_line(line);
+        return;
+    }
+
+    show_line("index:");
+    for (std::size_t i = 0u; i < index.bucket_nums(); i++) {
+        const StatusIndexBucket& bucket = index.bucket(i);
+        show_line("  {:{}s} remainingTurns = {:>{}s}, positions = {}",
+            analysisStatus_to_string(status_of_analysisData(bucket.data)), ValidAnalysisStatusStringMaxLen,
+            turn_to_string(turn_of_analysisData(bucket.data)), maxTurnWidth_,
+            bucket.cardinality);
+    }
+}
+
+void GobbInspectProcessor::do_find_positions_command(const std::vector<std::string>& args) {
+    if (args.size() != 3 && args.size() != 4) {
+        show_error("invalid arguments to 'find-positions' command");
+        show_hint();
+        return;
+    }
+    if (inspector_.status_index().empty()) {
+        show_error("no status index is mapped");
+        return;
+    }
+
+    AnalysisStatus status = AnalysisStatus::Invalid;
+    for (int i = 0; i <= static_cast<int>(AnalysisStatus::Contradictory); i++) {
+        std::string name = analysisStatus_to_string(static_cast<AnalysisStatus>(i));
+        if (args[1].size() == name.size() && std::equal(name.begin(), name.end(), args[1].begin(),
+                [](char c1, char c2) { return std::tolower(c1) == std::tolower(c2); })) {
+            status = static_cast<AnalysisStatus>(i);
+        }
+    }
+    if (status == AnalysisStatus::Invalid) {
+        show_error("invalid status for 'find-positions' command");
+        return;
+    }
+    Turn turn;
+    if (!string_to_uint(args[2], turn) || turn > MaxTurn) {
+        show_error("invalid number of turns for 'find-positions' command");
+        return;
+    }
+    PositionId beginId = 0u;
+    if (args.size() == 4 && !string_to_uint(args[3], beginId)) {
+        show_error("invalid position for 'find-positions' command");
+        return;
+    }
+
+    //
+    // One more position is found to tell where the next page begins.
+    //
+    std::uint64_t count = inspector_.count_positions(status, turn);
+    std::vector<PositionId> ids = inspector_.find_positions(status, turn, beginId, maxFoundPositionNums_ + 1u);
+    bool hasNext = ids.size() > maxFoundPositionNums_;
+    PositionId nextId = hasNext ? ids.back() : 0u;
+    if (hasNext) {
+        ids.pop_back();
+    }
+
+    if (jsonOutput_) {
+        std::string line = "{\"status\":\"" + analysisStatus_to_string(status);
+        line += "\",\"turn\":" + std::to_string(turn);
+        line += ",\"count\":" + std::to_string(count) + ",\"positions\":[";
+        for (std::size_t i = 0u; i < ids.size(); i++) {
+            if (i > 0u) {
+                line += ',';
+            }
+            line += std::to_string(ids[i]);
+        }
+        line += "],\"next\":" + (hasNext ? std::to_string(nextId) : std::string("null")) + "}";
+        show_line(line);
+        return;
+    }
+
+    show_line("positions: {} in total", count);
+    for (PositionId id: ids) {
+        show_line("  position = {:{}d}", id, MaxPositionIdWidth);
+    }
+    if (hasNext) {
+        show_line("more positions from {}", nextId);
+    }
+}
+
+void GobbInspectProcessor::do_show_cache_command(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        show_error("invalid arguments to 'show-cache' command");
+        show_hint();
+        return;
+    }
+
+    std::size_t hitNums = cache_.hit_nums();
+    std::size_t missNums = cache_.miss_nums();
+    if (jsonOutput_) {
+        show_line("{\"hits\":" + std::to_string(hitNums) + ",\"misses\":" + std::to_string(missNums) + "}");
+        return;
+    }
+    show_line("cache: hits = {}, misses = {}", hitNums, missNums);
+}
+
 void GobbInspectProcessor::do_help_command(const std::vector<std::string>& args) {
     static_cast<void>(args);
 
@@ -294,15 +462,24 @@ void GobbInspectProcessor::do_help_command(const std::vector<std::string>& args)
     show_line("  (m)   move NUM          execute the movement of the possible move NUM");
     show_line("  (mb)  moveback NUM      execute the movement of the possible");
     show_line("                          retrograde move NUM");
+    show_line("  (bm)  best-move         look up the best move in the best-move table");
 
     show_line("History:");
     show_line("  (sh)  show-history      show the history table");
     show_line("  (gh)  goto-history NUM  go to the position of the history NUM");
     show_line("  (n)   next              go to the next position of the history");
     show_line("  (p)   previous          go to the previous position of the history");
+
+    show_line("Status index:");
+    show_line("  (si)  show-index        show the number of positions for each status and");
+    show_line("                          remaining turns");
+    show_line("  (fp)  find-positions STATUS TURN [ID]");
+    show_line("                          find positions with STATUS and TURN remaining");
+    show_line("                          turns, from the position ID");
     show_line("");
 
     show_line("Miscellaneous:");
+    show_line("  (sc)  show-cache        show the number of hits and misses of the cache");
     show_line("  (?)   help              print this help");
     show_line("        exit              exit the program");
 }
@@ -314,7 +491,7 @@ void GobbInspectProcessor::show_horizontal_line() const {
 void GobbInspectProcessor::show_position() const {
     show_line(fmt::format("position = {}, remainingTurns = {}, {}",
             position_.id(),
-            positionInspectionResult_.turn,
+            turn_to_string(positionInspectionResult_.turn),
             analysisStatus_to_string(positionInspectionResult_.analysisStatus)));
 
     if (!position_.is_valid()) {
@@ -333,6 +510,10 @@ void GobbInspectProcessor::show_position() const {
 }
 
 void GobbInspectProcessor::show_moves() const {
+    if (jsonOutput_) {
+        show_moves_json("moves", moveInspectionResults_);
+        return;
+    }
     show_line("possible moves:");
 
     std::string bestMark;
@@ -344,13 +525,13 @@ void GobbInspectProcessor::show_moves() const {
             bestMark = "";
         }
 
-        show_line("  {:{}d}| {:{}s}, {:{}s} -> {:{}s}, position = {:{}d}, remainingTurns = {:{}d}, {}{}",
+        show_line("  {:{}d}| {:{}s}, {:{}s} -> {:{}s}, position = {:{}d}, remainingTurns = {:>{}s}, {}{}",
             index, maxIndexWidth_,
             pieceSize_to_string(pieceSize_of_pieceId(insRes.piece)), ValidPieceSizeStringMaxLen,
             locationId_to_string(insRes.source), ValidLocationIdStringMaxLen,
             locationId_to_string(insRes.destination), ValidLocationIdStringMaxLen,
             insRes.positionId, MaxPositionIdWidth,
-            insRes.turn, maxTurnWidth_,
+            turn_to_string(insRes.turn), maxTurnWidth_,
             analysisStatus_to_string(insRes.analysisStatus),
             bestMark);
         index++;
@@ -358,6 +539,10 @@ void GobbInspectProcessor::show_moves() const {
 }
 
 void GobbInspectProcessor::show_move_backs() const {
+    if (jsonOutput_) {
+        show_moves_json("movebacks", moveBackInspectionResults_);
+        return;
+    }
     show_line("possible retrograde moves:");
 
     std::string bestMark;
@@ -369,13 +554,13 @@ void GobbInspectProcessor::show_move_backs() const {
             bestMark = "";
         }
 
-        show_line("  {:{}d}| {:{}s}, {:{}s} -> {:{}s}, position = {:{}d}, remainingTurns = {:{}d}, {}{}",
+        show_line("  {:{}d}| {:{}s}, {:{}s} -> {:{}s}, position = {:{}d}, remainingTurns = {:>{}s}, {}{}",
             index, maxIndexWidth_,
             pieceSize_to_string(pieceSize_of_pieceId(insRes.piece)), ValidPieceSizeStringMaxLen,
             locationId_to_string(insRes.source), ValidLocationIdStringMaxLen,
             locationId_to_string(insRes.destination), ValidLocationIdStringMaxLen,
             insRes.positionId, MaxPositionIdWidth,
-            insRes.turn, maxTurnWidth_,
+            turn_to_string(insRes.turn), maxTurnWidth_,
             analysisStatus_to_string(insRes.analysisStatus),
             bestMark);
         index++;
@@ -383,6 +568,10 @@ void GobbInspectProcessor::show_move_backs() const {
 }
 
 void GobbInspectProcessor::show_history() const {
+    if (jsonOutput_) {
+        show_history_json();
+        return;
+    }
     show_line("history:");
 
     std::string hereMark;
@@ -394,17 +583,105 @@ void GobbInspectProcessor::show_history() const {
             hereMark = "";
         }
 
-        show_line("  {:{}d}| position = {:{}d}, remainingTurns = {:{}d}, {}{}",
+        show_line("  {:{}d}| position = {:{}d}, remainingTurns = {:>{}s}, {}{}",
             index, maxIndexWidth_,
             entry.positionId, MaxPositionIdWidth,
-            entry.turn, maxTurnWidth_,
+            turn_to_string(entry.turn), maxTurnWidth_,
             analysisStatus_to_string(entry.analysisStatus),
             hereMark);
         index++;
     }
 }
 
+void GobbInspectProcessor::show_moves_json(const char* name, const std::vector<MoveInspectionResult>& moves) const {
+    std::string line = "{\"position\":" + std::to_string(position_.id()) + ",\"" + name + "\":[";
+    std::size_t index = 0u;
+    for (const MoveInspectionResult& insRes: moves) {
+        if (index > 0u) {
+            line += ',';
+        }
+        line += "{\"index\":" + std::to_string(index);
+        line += ",\"piece\":\"" + pieceSize_to_string(pieceSize_of_pieceId(insRes.piece));
+        line += "\",\"source\":\"" + locationId_to_string(insRes.source);
+        line += "\",\"destination\":\"" + locationId_to_string(insRes.destination);
+        line += "\",\"position\":" + std::to_string(insRes.positionId);
+        line += ",\"status\":\"" + analysisStatus_to_string(insRes.analysisStatus);
+        line += "\",\"turn\":" + turn_to_json(insRes.turn);
+        line += insRes.isBestMove ? ",\"best\":true}" : ",\"best\":false}";
+        index++;
+    }
+    line += "]}";
+    show_line(line);
+}
+
+void GobbInspectProcessor::show_history_json() const {
+    std::string line = "{\"history\":[";
+    std::size_t index = 0u;
+    for (const PositionInspectionResult& entry: historyTable_) {
+        if (index > 0u) {
+            line += ',';
+        }
+        line += "{\"index\":" + std::to_string(index);
+        line += ",\"position\":" + std::to_string(entry.positionId);
+        line += ",\"status\":\"" + analysisStatus_to_string(entry.analysisStatus);
+        line += "\",\"turn\":" + turn_to_json(entry.turn);
+        line += (index == currentHistoryIndex_) ? ",\"here\":true}" : ",\"here\":false}";
+        index++;
+    }
+    line += "]}";
+    show_line(line);
+}
+
+void GobbInspectProcessor::inspect_position(PositionId posId) {
+    std::shared_ptr<const InspectionCacheEntry> entry = cache_.inspect(posId);
+    position_ = posId;
+    positionInspectionResult_ = entry->position;
+    moveInspectionResults_ = entry->moves;
+    moveBackInspectionResults_ = entry->moveBacks;
+    cache_.prefetch_children(*entry);
+}
+
+std::string GobbInspectProcessor::turn_to_string(Turn turn) const {
+    //
+    // WDL data don't record the number of remaining turns.
+    //
+    if (inspector_.wdl_only()) {
+        return "-";
+    }
+    return std::to_string(turn);
+}
+
+std::string GobbInspectProcessor::turn_to_json(Turn turn) const {
+    if (inspector_.wdl_only()) {
+        return "null";
+    }
+    return std::to_string(turn);
+}
+
+void GobbInspectProcessor::show_error(const std::string& message) const {
+    if (!jsonOutput_) {
+        show_line(message);
+        return;
+    }
+
+    std::string line = "{\"error\":\"";
+    for (char ch: message) {
+        if (ch == '"' || ch == '\\') {
+            line += '\\';
+        }
+        line += ch;
+    }
+    line += "\"}";
+    show_line(line);
+}
+
 void GobbInspectProcessor::show_hint() const {
+    //
+    // The hint is for people, and it is not printed in JSON.
+    //
+    if (jsonOutput_) {
+        return;
+    }
     show_line("Try 'help' or '?' for more information.");
 }
 
@@ -423,11 +700,11 @@ void GobbInspectProcessor::add_history(const PositionInspectionResult& entry) {
 }
 
 void GobbInspectProcessor::show_line() const {
-    std::cout << std::endl;
+    output_ << '\n';
 }
 
 void GobbInspectProcessor::show_line(const std::string& line) const {
-    std::cout << line << std::endl;
+    output_ << line << '\n';
 }
 
 std::vector<std::string> GobbInspectProcessor::split_into_arguments(const std::string& line) const {
@@ -20,9 +20,11 @@
 
 #include <cstddef>
 #include <deque>
+#include <iostream>
 #include <string>
 #include <vector>
 #include <fmt/core.h>
+#include "inspection_cache.hpp"
 #include "position_text_creator.hpp"
 #include "position.hpp"
 #include "inspector.hpp"
@@ -36,7 +38,8 @@ using namespace gobb_analyzer;
 class GobbInspectProcessor {
 public:
     GobbInspectProcessor() = delete;
-    GobbInspectProcessor(Inspector& inspector, PositionTextCreator& viewer, PositionId posId = 0u);
+    GobbInspectProcessor(Inspector& inspector, PositionTextCreator& viewer, PositionId posId = 0u,
+        std::ostream& output = std::cout);
     GobbInspectProcessor(const GobbInspectProcessor& other) = delete;
     GobbInspectProcessor(GobbInspectProcessor&& other) = delete;
     ~GobbInspectProcessor();
@@ -44,24 +47,34 @@ public:
     GobbInspectProcessor& operator=(GobbInspectProcessor&& other) = delete;
 
     void do_main_loop();
+    void do_script(std::istream& in);
+    void set_json_output(bool jsonOutput);
     void do_show_position_command(const std::vector<std::string>& args);
     void do_goto_position_command(const std::vector<std::string>& args);
     void do_show_moves_command(const std::vector<std::string>& args);
     void do_show_move_backs_command(const std::vector<std::string>& args);
     void do_move_command(const std::vector<std::string>& args);
     void do_move_back_command(const std::vector<std::string>& args);
+    void do_best_move_command(const std::vector<std::string>& args);
     void do_show_history_command(const std::vector<std::string>& args);
     void do_goto_history_command(const std::vector<std::string>& args);
     void do_next_command(const std::vector<std::string>& args);
     void do_previous_command(const std::vector<std::string>& args);
+    void do_show_index_command(const std::vector<std::string>& args);
+    void do_find_positions_command(const std::vector<std::string>& args);
+    void do_show_cache_command(const std::vector<std::string>& args);
     void do_help_command(const std::vector<std::string>& args);
 
 private:
+    bool execute_command(const std::string& line);
     void show_horizontal_line() const;
     void show_position() const;
     void show_moves() const;
     void show_move_backs() const;
     void show_history() const;
+    void show_moves_json(const char* name, const std::vector<MoveInspectionResult>& moves) const;
+    void show_history_json() const;
+    void show_error(const std::string& message) const;
     void show_hint() const;
     void show_line() const;
     void show_line(const std::string& line) const;
@@ -71,10 +84,14 @@ private:
         show_line(fmt::format(fmt, args...));
     }
 
+    void inspect_position(PositionId posId);
+    std::string turn_to_string(Turn turn) const;
+    std::string turn_to_json(Turn turn) const;
     void add_history(const PositionInspectionResult& entry);
     std::vector<std::string> split_into_arguments(const std::string& line) const;
 
     Inspector& inspector_;
+    InspectionCache cache_;
     PositionTextCreator& textCreator_;
     Position position_;
     PositionInspectionResult positionInspectionResult_;
@@ -82,10 +99,14 @@ private:
     std::vector<MoveInspectionResult> moveBackInspectionResults_;
     std::deque<PositionInspectionResult> historyTable_;
     std::size_t currentHistoryIndex_;
+    std::ostream& output_;
+    bool jsonOutput_;
 
     static constexpr std::size_t maxHistoryTableSize_ = 32u;
+    static constexpr std::size_t cacheCapacity_ = 1024u;
     static constexpr std::size_t maxIndexWidth_ = 2u;
     static constexpr std::size_t maxTurnWidth_ = 2u;
+    static constexpr std::size_t maxFoundPositionNums_ = 20u;
 };
 
 #endif // GOBB_INSPECT_PROCESSOR_HPP
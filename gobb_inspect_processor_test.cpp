@@ -0,0 +1,210 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gobb_inspect_processor.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// Return the position after putting a piece of the active player at the center of a position.
+//
+PositionId put_at_center(PositionId id, PieceId piece) {
+    return Position(id).move(piece, LocationId::Out, LocationId::Center).position.id();
+}
+
+//
+// Load an opening database where the initial position has two moves: putting a large piece at the center
+// wins, and putting a medium piece at the center draws.  The other moves lead to positions missing in the
+// database, and they are not listed.
+//
+void load_opening(Inspector& inspector) {
+    OpeningHandler handler;
+    handler.set_opening(InitialPositionId, AnalysisStatus::Won, 3u);
+    handler.set_opening(put_at_center(InitialPositionId, PieceId::ActivePlayerLarge), AnalysisStatus::Lost, 2u);
+    handler.set_opening(put_at_center(InitialPositionId, PieceId::ActivePlayerMedium), AnalysisStatus::Unfixed, 0u);
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// Run a script on a processor starting at a position, and return the output.
+//
+std::string run_script(Inspector& inspector, PositionId id, bool jsonOutput, const std::string& script) {
+    PositionAsciiCreator textCreator(false);
+    std::ostringstream out;
+    GobbInspectProcessor processor(inspector, textCreator, id, out);
+    processor.set_json_output(jsonOutput);
+    std::istringstream in(script);
+    processor.do_script(in);
+    return out.str();
+}
+
+} // namespace
+
+//
+// Test that a script skips comments and blank lines, and stops at `exit`.
+//
+TEST(GobbInspectProcessorTest, Script) {
+    Inspector inspector;
+    load_opening(inspector);
+    ASSERT_EQ(put_at_center(InitialPositionId, PieceId::ActivePlayerMedium), 2881750029u);
+    ASSERT_EQ(put_at_center(InitialPositionId, PieceId::ActivePlayerLarge), 3274310193u);
+
+    std::string output = run_script(inspector, InitialPositionId, false,
+        "# show the moves of the initial position\n"
+        "\n"
+        "   # an indented comment\n"
+        "  sm\r\n"
+        "m 0\n"
+        "sh\n"
+        "mb 9\n"
+        "bogus\n"
+        "exit\n"
+        "sm\n");
+    ASSERT_EQ(output,
+        "possible moves:\n"
+        "   0| Medium, Out    -> Center, position = 2881750029, remainingTurns =  0, Unfixed\n"
+        "   1| Large , Out    -> Center, position = 3274310193, remainingTurns =  2, Won [best]\n"
+        "----------------------------------------\n"
+        "position = 2881750029, remainingTurns = 0, Unfixed\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |== M ==|       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "(the player having the turn: \"**\")\n"
+        "\n"
+        "possible moves:\n"
+        "history:\n"
+        "   0| position =          0, remainingTurns =  3, Won\n"
+        "   1| position = 2881750029, remainingTurns =  0, Unfixed [here]\n"
+        "invalid index for 'moveback' command\n"
+        "invalid command\n"
+        "Try 'help' or '?' for more information.\n");
+}
+
+//
+// Test the JSON output of moves, retrograde moves, the history and errors.  Other commands print text.
+//
+TEST(GobbInspectProcessorTest, JsonOutput) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    std::string output = run_script(inspector, put_at_center(InitialPositionId, PieceId::ActivePlayerLarge), true,
+        "sm\n"
+        "smb\n"
+        "sh\n"
+        "mb 0\n"
+        "sh\n"
+        "m 7\n"
+        "mb x\n"
+        "sh 1\n"
+        "smb extra\n"
+        "foo\n");
+    ASSERT_EQ(output,
+        "{\"position\":3274310193,\"moves\":[]}\n"
+        "{\"position\":3274310193,\"movebacks\":[{\"index\":0,\"piece\":\"Large\",\"source\":\"Center\","
+        "\"destination\":\"Out\",\"position\":0,\"status\":\"Lost\",\"turn\":3,\"best\":true}]}\n"
+        "{\"history\":[{\"index\":0,\"position\":3274310193,\"status\":\"Lost\",\"turn\":2,\"here\":true}]}\n"
+        "----------------------------------------\n"
+        "position = 0, remainingTurns = 3, Won\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "|       |       |       |\n"
+        "+-------+-------+-------+\n"
+        "(the player having the turn: \"==\")\n"
+        "\n"
+        "{\"position\":0,\"moves\":[{\"index\":0,\"piece\":\"Medium\",\"source\":\"Out\","
+        "\"destination\":\"Center\",\"position\":2881750029,\"status\":\"Unfixed\",\"turn\":0,"
+        "\"best\":false},{\"index\":1,\"piece\":\"Large\",\"source\":\"Out\",\"destination\":\"Center\","
+        "\"position\":3274310193,\"status\":\"Won\",\"turn\":2,\"best\":true}]}\n"
+        "{\"history\":[{\"index\":0,\"position\":3274310193,\"status\":\"Lost\",\"turn\":2,\"here\":false},"
+        "{\"index\":1,\"position\":0,\"status\":\"Won\",\"turn\":3,\"here\":true}]}\n"
+        "{\"error\":\"invalid index for 'move' command\"}\n"
+        "{\"error\":\"invalid index\"}\n"
+        "{\"error\":\"invalid arguments to 'show-history' command\"}\n"
+        "{\"error\":\"invalid arguments to 'show-movebacks' command\"}\n"
+        "{\"error\":\"invalid command\"}\n");
+}
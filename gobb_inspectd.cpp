@@ -0,0 +1,220 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "analysis_data_file_handler.hpp"
+#include "gobb_inspectd_server.hpp"
+#include "inspector.hpp"
+#include "inspector_loader.hpp"
+#include "mapped_file.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+using namespace gobb_analyzer;
+
+/// The maximum number of threads.
+constexpr unsigned long MaxThreadNums = 1024u;
+
+/// Set by SIGINT or SIGTERM to stop the server.
+volatile std::sig_atomic_t stopRequested = 0;
+
+//
+// Handle SIGINT and SIGTERM.
+//
+extern "C" void handle_stop_signal(int) {
+    stopRequested = 1;
+}
+
+//
+// Print the help message.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_inspectd [OPTION...]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -b          also load the best-move table written by 'gobb_export'" << std::endl;
+    std::cout << "  -d DIR      map an analysis data file in DIR (default: .)" << std::endl;
+    std::cout << "  -g NUM      map analysis data file of the NUM'th generation" << std::endl;
+    std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -j NUM      answer requests with NUM threads (default: the number of CPUs)" << std::endl;
+    std::cout << "  -o          load the opening database written by 'gobb_export'" << std::endl;
+    std::cout << "  -s PATH     listen at the Unix domain socket PATH (default: gobb_inspectd.sock)" << std::endl;
+    std::cout << "  -w          load the WDL file written by 'gobb_analyze --wdl-only'" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_inspectd --help' ..." message.
+//
+void print_hint(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string dataDir;
+    std::string socketPath("gobb_inspectd.sock");
+    unsigned long generation = 0u;
+    bool opt_b = false;
+    bool opt_d = false;
+    bool opt_g = false;
+    bool opt_o = false;
+    bool opt_w = false;
+    unsigned long threadNums = std::thread::hardware_concurrency();
+    if (threadNums == 0u) {
+        threadNums = 1u;
+    }
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'b') {
+            opt_b = true;
+            optind++;
+        } else if (ch == 'o') {
+            opt_o = true;
+            optind++;
+        } else if (ch == 'w') {
+            opt_w = true;
+            optind++;
+        } else if (ch == 'd' || ch == 'g' || ch == 'j' || ch == 's') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'd') {
+                opt_d = true;
+                dataDir = std::string(optarg);
+            } else if (ch == 'g') {
+                opt_g = true;
+                if (!string_to_uint(optarg, generation) || generation > MaxGeneration) {
+                    std::cerr << argv[0] << ": invalid generation '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'j') {
+                if (!string_to_uint(optarg, threadNums) || threadNums < 1u || threadNums > MaxThreadNums) {
+                    std::cerr << argv[0] << ": invalid number of threads: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else {
+                socketPath = std::string(optarg);
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_hint(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((opt_g && opt_w) || (opt_g && opt_o) || (opt_o && opt_w)) {
+        std::cerr << argv[0] << ": '-g', '-o' and '-w' options are conflicted" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (optind < argc) {
+        std::cerr << argv[0] << ": too many arguments" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+
+    //
+    // Maps or loads the data, and then serves requests until SIGINT or SIGTERM.
+    //
+    try {
+        AnalysisDataFileHandler fileHandler;
+        if (opt_d) {
+            fileHandler = AnalysisDataFileHandler(dataDir);
+        }
+
+        Inspector inspector;
+        MappedFile mapping;
+        std::string errorMessage;
+        InspectorDataSource source = opt_o ? InspectorDataSource::Opening :
+            (opt_w ? InspectorDataSource::Wdl : InspectorDataSource::AnalysisData);
+        Generation dataGeneration = opt_g ? static_cast<Generation>(generation) : InvalidGeneration;
+        if (!load_inspector_data(fileHandler, source, dataGeneration, false, inspector, mapping, errorMessage)) {
+            std::cerr << errorMessage << std::endl;
+            return 1;
+        }
+        if (opt_b && !inspector.load_best_moves(fileHandler)) {
+            std::cerr << "failed to load the best-move table" << std::endl;
+            return 1;
+        }
+
+        GobbInspectdServer server(inspector, static_cast<int>(threadNums));
+        if (!server.open(socketPath)) {
+            return 1;
+        }
+
+        //
+        // Writing to a connection closed by the client must not kill the server.
+        //
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, handle_stop_signal);
+        std::signal(SIGTERM, handle_stop_signal);
+
+        std::cout << "listening at " << socketPath << std::endl;
+        server.run(stopRequested);
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+
+    return 0;
+}
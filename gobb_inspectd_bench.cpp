@@ -0,0 +1,338 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "gobb_inspectd_protocol.hpp"
+#include "position.hpp"
+#include "run_threads.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+extern "C" {
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+using namespace gobb_analyzer;
+
+/// The maximum number of connections.
+constexpr unsigned long MaxConnectionNums = 1024u;
+
+/// The maximum depth of pipelining.
+constexpr unsigned long MaxPipelineDepth = 4096u;
+
+//
+// Result of a connection.
+//
+struct ConnectionResult {
+    bool success;                   // true if all the requests have been answered.
+    std::uint64_t invalidNums;      // the number of responses other than InspectdResponseStatus::Success.
+    std::vector<double> latencies;  // latencies of the requests in microseconds.
+};
+
+//
+// Print the help message.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_inspectd_bench [OPTION...]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c NUM      open NUM connections at a time (default: 1)" << std::endl;
+    std::cout << "  -n NUM      send NUM requests in each connection (default: 100000)" << std::endl;
+    std::cout << "  -p DEPTH    keep DEPTH requests in flight in each connection (default: 16)" << std::endl;
+    std::cout << "  -r SEED     seed of random position IDs (default: 1)" << std::endl;
+    std::cout << "  -s PATH     connect to the Unix domain socket PATH (default: gobb_inspectd.sock)" << std::endl;
+    std::cout << "  -t TYPE     type of requests: position, moves or bestmove (default: position)" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_inspectd_bench --help' ..." message.
+//
+void print_hint(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Connect to the server.
+//
+int connect_to_server(const std::string& socketPath) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//
+// Send requests in a connection, and measure latencies.
+//
+void run_connection(const std::string& socketPath, InspectdRequestType type, std::uint64_t requestNums,
+    std::size_t pipelineDepth, std::uint64_t seed, ConnectionResult& result) {
+    result.success = false;
+    result.invalidNums = 0u;
+    result.latencies.reserve(requestNums);
+
+    int fd = connect_to_server(socketPath);
+    if (fd < 0) {
+        return;
+    }
+
+    std::mt19937_64 engine(seed);
+    std::uniform_int_distribution<PositionId> distribution(0u, PositionIdNums - 1u);
+    std::deque<std::chrono::steady_clock::time_point> sentTimes;
+    std::vector<char> readBuffer(64u * 1024u);
+    std::size_t filledSize = 0u;
+    std::string writeBuffer;
+    std::uint64_t sentNums = 0u;
+    std::uint64_t receivedNums = 0u;
+
+    while (receivedNums < requestNums) {
+        //
+        // Requests are sent until `pipelineDepth` requests are in flight.
+        //
+        writeBuffer.clear();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        while (sentNums < requestNums && sentNums - receivedNums < pipelineDepth) {
+            InspectdRequest request = {static_cast<std::uint32_t>(sentNums), static_cast<std::uint8_t>(type),
+                {0u, 0u, 0u}, distribution(engine)};
+            writeBuffer.append(reinterpret_cast<const char*>(&request), sizeof(request));
+            sentTimes.push_back(now);
+            sentNums++;
+        }
+        std::size_t writtenSize = 0u;
+        while (writtenSize < writeBuffer.size()) {
+            ssize_t size = ::write(fd, writeBuffer.data() + writtenSize, writeBuffer.size() - writtenSize);
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size <= 0) {
+                ::close(fd);
+                return;
+            }
+            writtenSize += static_cast<std::size_t>(size);
+        }
+
+        //
+        // Responses are read until at least one is complete.
+        //
+        std::uint64_t prevReceivedNums = receivedNums;
+        while (receivedNums == prevReceivedNums) {
+            ssize_t size = ::read(fd, readBuffer.data() + filledSize, readBuffer.size() - filledSize);
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size <= 0) {
+                ::close(fd);
+                return;
+            }
+            filledSize += static_cast<std::size_t>(size);
+
+            std::chrono::steady_clock::time_point receivedTime = std::chrono::steady_clock::now();
+            std::size_t offset = 0u;
+            while (offset + sizeof(InspectdResponseHeader) <= filledSize) {
+                InspectdResponseHeader header;
+                std::memcpy(&header, readBuffer.data() + offset, sizeof(header));
+                std::size_t responseSize = sizeof(header) + header.recordNums * sizeof(InspectdRecord);
+                if (offset + responseSize > filledSize) {
+                    break;
+                }
+                if (header.status != static_cast<std::uint8_t>(InspectdResponseStatus::Success)) {
+                    result.invalidNums++;
+                }
+                std::chrono::duration<double, std::micro> latency = receivedTime - sentTimes.front();
+                result.latencies.push_back(latency.count());
+                sentTimes.pop_front();
+                receivedNums++;
+                offset += responseSize;
+            }
+            std::memmove(readBuffer.data(), readBuffer.data() + offset, filledSize - offset);
+            filledSize -= offset;
+        }
+    }
+
+    ::close(fd);
+    result.success = true;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string socketPath("gobb_inspectd.sock");
+    InspectdRequestType type = InspectdRequestType::InspectPosition;
+    unsigned long connectionNums = 1u;
+    unsigned long requestNums = 100000u;
+    unsigned long pipelineDepth = 16u;
+    unsigned long seed = 1u;
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'c' || ch == 'n' || ch == 'p' || ch == 'r' || ch == 's' || ch == 't') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'c') {
+                if (!string_to_uint(optarg, connectionNums) || connectionNums < 1u ||
+                    connectionNums > MaxConnectionNums) {
+                    std::cerr << argv[0] << ": invalid number of connections: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'n') {
+                if (!string_to_uint(optarg, requestNums) || requestNums < 1u) {
+                    std::cerr << argv[0] << ": invalid number of requests: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'p') {
+                if (!string_to_uint(optarg, pipelineDepth) || pipelineDepth < 1u ||
+                    pipelineDepth > MaxPipelineDepth) {
+                    std::cerr << argv[0] << ": invalid depth: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'r') {
+                if (!string_to_uint(optarg, seed)) {
+                    std::cerr << argv[0] << ": invalid seed: " << optarg << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 's') {
+                socketPath = std::string(optarg);
+            } else {
+                if (std::strcmp(optarg, "position") == 0) {
+                    type = InspectdRequestType::InspectPosition;
+                } else if (std::strcmp(optarg, "moves") == 0) {
+                    type = InspectdRequestType::InspectMoves;
+                } else if (std::strcmp(optarg, "bestmove") == 0) {
+                    type = InspectdRequestType::BestMove;
+                } else {
+                    std::cerr << argv[0] << ": unknown type '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_hint(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        std::cerr << argv[0] << ": too many arguments" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+
+    //
+    // Runs the connections in parallel, and then reports the throughput and the latencies.
+    //
+    std::vector<ConnectionResult> results(connectionNums);
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    try {
+        run_threads(static_cast<int>(connectionNums), [&](int i) {
+            run_connection(socketPath, type, requestNums, pipelineDepth, seed + i, results[i]);
+        });
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    std::vector<double> latencies;
+    std::uint64_t invalidNums = 0u;
+    for (const ConnectionResult& result: results) {
+        if (!result.success) {
+            std::cerr << "failed to communicate with the server at '" << socketPath << "'" << std::endl;
+            return 1;
+        }
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        invalidNums += result.invalidNums;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "requests: " << latencies.size() << " (" << invalidNums << " invalid), connections: "
+              << connectionNums << ", pipeline depth: " << pipelineDepth << std::endl;
+    std::cout << "elapsed: " << std::setprecision(3) << elapsed.count() << " s, throughput: "
+              << std::setprecision(0) << latencies.size() / elapsed.count() << " requests/s" << std::endl;
+    std::cout << std::setprecision(1) << "latency (us): p50 " << latencies[latencies.size() / 2]
+              << ", p99 " << latencies[latencies.size() * 99 / 100]
+              << ", max " << latencies.back() << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_INSPECTD_PROTOCOL_HPP
+#define GOBB_INSPECTD_PROTOCOL_HPP
+
+#include <cstdint>
+
+//
+// Protocol of gobb_inspectd.
+//
+// A client sends fixed-size requests over a Unix domain socket, and the server answers them in the
+// order of the requests.  A client may send requests without waiting for responses (pipelining).
+// A response consists of a header followed by `recordNums` records.  All integers are in the byte
+// order of the host, since the server and clients run on the same host.
+//
+
+// Types of requests.
+enum class InspectdRequestType: std::uint8_t {
+    InspectPosition = 1,  // analysis data of a position (a record).
+    InspectMoves    = 2,  // possible moves of a position (a record for each move).
+    BestMove        = 3   // the best move of a position (a record, or no record if there is no move).
+};
+
+// Status codes of responses.
+enum class InspectdResponseStatus: std::uint8_t {
+    Success        = 0,  // success.
+    InvalidRequest = 1,  // unknown request type or invalid position ID.
+    Unsupported    = 2   // the loaded data can't answer the request (a best move with WDL data only).
+};
+
+// A request (16 bytes).
+struct InspectdRequest {
+    std::uint32_t requestId;   // an ID chosen by the client, copied to the response.
+    std::uint8_t type;         // InspectdRequestType.
+    std::uint8_t reserved[3];  // must be 0.
+    std::uint64_t positionId;  // a position ID.
+};
+
+// A header of a response (8 bytes).
+struct InspectdResponseHeader {
+    std::uint32_t requestId;   // the ID of the request.
+    std::uint8_t type;         // the type of the request.
+    std::uint8_t status;       // InspectdResponseStatus.
+    std::uint16_t recordNums;  // the number of records following the header.
+};
+
+// A record of a response (16 bytes).
+struct InspectdRecord {
+    std::uint64_t positionId;     // the position, or the position after the move.
+    std::uint16_t turn;           // the number of remaining turns.
+    std::uint8_t analysisStatus;  // AnalysisStatus (of the player moving, for a move).
+    std::uint8_t piece;           // PieceId of a moved piece (PieceId::None for a position).
+    std::uint8_t source;          // LocationId of the source (LocationId::Invalid for a position).
+    std::uint8_t destination;     // LocationId of the destination (LocationId::Invalid for a position).
+    std::uint8_t flags;           // InspectdRecordBestMove if the move is the best one.
+    std::uint8_t reserved;        // 0.
+};
+
+// A flag of InspectdRecord::flags.
+constexpr std::uint8_t InspectdRecordBestMove = 0x01u;
+
+// The maximum number of records in a response.
+constexpr std::uint16_t InspectdMaxRecordNums = 64u;
+
+static_assert(sizeof(InspectdRequest) == 16u, "a request must be 16 bytes");
+static_assert(sizeof(InspectdResponseHeader) == 8u, "a response header must be 8 bytes");
+static_assert(sizeof(InspectdRecord) == 16u, "a record must be 16 bytes");
+
+#endif // GOBB_INSPECTD_PROTOCOL_HPP
@@ -0,0 +1,360 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gobb_inspectd_server.hpp"
+#include "run_threads.hpp"
+
+extern "C" {
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+using namespace gobb_analyzer;
+
+GobbInspectdServer::GobbInspectdServer(const Inspector& inspector, int threadNums)
+    : inspector_(inspector),
+      threadNums_(threadNums < 1 ? 1 : threadNums),
+      listenFd_(-1),
+      wakeupFds_{-1, -1},
+      socketPath_(),
+      connections_(),
+      mutex_(),
+      condition_(),
+      batches_(),
+      finishedBatches_(),
+      stopping_(false) {
+}
+
+GobbInspectdServer::~GobbInspectdServer() {
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        ::unlink(socketPath_.c_str());
+    }
+    for (int fd: wakeupFds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool GobbInspectdServer::open(const std::string& socketPath) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "too long socket path '" << socketPath << "'" << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "failed to create a socket, " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    //
+    // A socket file left by a server terminated abnormally is removed.
+    //
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0) {
+        std::cerr << "failed to listen at '" << socketPath << "', " << std::strerror(errno) << std::endl;
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    socketPath_ = socketPath;
+
+    //
+    // A thread in the pool wakes up the polling thread through the pipe when it finishes a batch.
+    //
+    if (::pipe(wakeupFds_) != 0 ||
+        ::fcntl(wakeupFds_[0], F_SETFL, O_NONBLOCK) != 0 ||
+        ::fcntl(wakeupFds_[1], F_SETFL, O_NONBLOCK) != 0) {
+        std::cerr << "failed to create a pipe, " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GobbInspectdServer::run(const volatile std::sig_atomic_t& stopFlag) {
+    //
+    // The calling thread polls the connections as the thread 0, and the others answer batches.  If it fails
+    // to create a thread, the server stops.
+    //
+    auto worker = [&](int i) {
+        if (i == 0) {
+            poll_connections(stopFlag);
+        } else {
+            answer_batches();
+        }
+    };
+    auto on_create_failure = [this](int) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        condition_.notify_all();
+    };
+
+    try {
+        run_threads(threadNums_ + 1, worker, on_create_failure);
+    } catch (...) {
+        for (const auto& entry: connections_) {
+            ::close(entry.first);
+        }
+        connections_.clear();
+        throw;
+    }
+
+    for (const auto& entry: connections_) {
+        ::close(entry.first);
+    }
+    connections_.clear();
+    batches_.clear();
+    finishedBatches_.clear();
+}
+
+void GobbInspectdServer::poll_connections(const volatile std::sig_atomic_t& stopFlag) {
+    std::vector<struct pollfd> pfds;
+
+    while (!stopFlag && !stopping_) {
+        //
+        // The listening socket and the pipe come first, followed by the connections not busy, and those
+        // having responses left to be written.
+        //
+        pfds.clear();
+        pfds.push_back(pollfd {listenFd_, POLLIN, 0});
+        pfds.push_back(pollfd {wakeupFds_[0], POLLIN, 0});
+        for (const auto& entry: connections_) {
+            if (!entry.second.busy) {
+                pfds.push_back(pollfd {entry.first, POLLIN, 0});
+            } else if (!entry.second.output.empty()) {
+                pfds.push_back(pollfd {entry.first, POLLOUT, 0});
+            }
+        }
+
+        int pollResult = ::poll(pfds.data(), pfds.size(), pollTimeout_);
+        if (pollResult <= 0) {
+            continue;
+        }
+
+        if (pfds[1].revents != 0) {
+            char drain[64];
+            while (::read(wakeupFds_[0], drain, sizeof(drain)) > 0) {
+            }
+            finish_batches();
+        }
+
+        for (std::size_t i = 2u; i < pfds.size(); i++) {
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+            auto it = connections_.find(pfds[i].fd);
+            bool alive;
+            if (pfds[i].events == POLLOUT) {
+                alive = write_responses(it->first, it->second);
+            } else {
+                alive = read_requests(it->first, it->second);
+            }
+            if (!alive) {
+                ::close(it->first);
+                connections_.erase(it);
+            }
+        }
+
+        //
+        // Connections are non-blocking, so that no thread waits for a client.
+        //
+        if (pfds[0].revents != 0) {
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd >= 0 && ::fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+                ::close(fd);
+            } else if (fd >= 0) {
+                connections_.emplace(fd,
+                    Connection {std::vector<char>(readBufferSize_), 0u, std::string(), 0u, false});
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    condition_.notify_all();
+}
+
+bool GobbInspectdServer::read_requests(int fd, Connection& connection) {
+    ssize_t readSize = ::read(fd, connection.buffer.data() + connection.filledSize,
+        connection.buffer.size() - connection.filledSize);
+    if (readSize < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+    }
+    if (readSize <= 0) {
+        return false;
+    }
+    connection.filledSize += static_cast<std::size_t>(readSize);
+
+    //
+    // All the complete requests make a batch.  An incomplete one is kept for the next read.
+    //
+    std::size_t requestNums = connection.filledSize / sizeof(InspectdRequest);
+    if (requestNums == 0u) {
+        return true;
+    }
+    Batch batch = {fd, std::vector<InspectdRequest>(requestNums)};
+    std::size_t batchSize = requestNums * sizeof(InspectdRequest);
+    std::memcpy(batch.requests.data(), connection.buffer.data(), batchSize);
+    std::memmove(connection.buffer.data(), connection.buffer.data() + batchSize,
+        connection.filledSize - batchSize);
+    connection.filledSize -= batchSize;
+    connection.busy = true;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    batches_.push_back(std::move(batch));
+    condition_.notify_one();
+    return true;
+}
+
+bool GobbInspectdServer::write_responses(int fd, Connection& connection) {
+    if (!write_some(fd, connection.output, connection.writtenSize)) {
+        return false;
+    }
+    if (connection.writtenSize == connection.output.size()) {
+        connection.output.clear();
+        connection.writtenSize = 0u;
+        connection.busy = false;
+    }
+    return true;
+}
+
+void GobbInspectdServer::finish_batches() {
+    std::vector<FinishedBatch> finishedBatches;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishedBatches.swap(finishedBatches_);
+    }
+
+    for (FinishedBatch& finished: finishedBatches) {
+        auto it = connections_.find(finished.fd);
+        if (!finished.written) {
+            ::close(it->first);
+            connections_.erase(it);
+        } else if (finished.output.empty()) {
+            it->second.busy = false;
+        } else {
+            it->second.output = std::move(finished.output);
+            it->second.writtenSize = 0u;
+        }
+    }
+}
+
+void GobbInspectdServer::answer_batches() {
+    std::string output;
+
+    for (;;) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || !batches_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            batch = std::move(batches_.front());
+            batches_.pop_front();
+        }
+
+        output.clear();
+        for (const InspectdRequest& request: batch.requests) {
+            answer_request(request, output);
+        }
+        std::size_t writtenSize = 0u;
+        bool written = write_some(batch.fd, output, writtenSize);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finishedBatches_.push_back(FinishedBatch {batch.fd, written,
+                written ? output.substr(writtenSize) : std::string()});
+        }
+        char wakeup = 0;
+        static_cast<void>(::write(wakeupFds_[1], &wakeup, 1u));
+    }
+}
+
+void GobbInspectdServer::answer_request(const InspectdRequest& request, std::string& output) const {
+    InspectdResponseHeader header = {request.requestId, request.type,
+        static_cast<std::uint8_t>(InspectdResponseStatus::Success), 0u};
+    std::vector<InspectdRecord> records;
+
+    InspectdRequestType type = static_cast<InspectdRequestType>(request.type);
+    if (!is_valid_positionId(request.positionId)) {
+        header.status = static_cast<std::uint8_t>(InspectdResponseStatus::InvalidRequest);
+    } else if (type == InspectdRequestType::InspectPosition) {
+        PositionInspectionResult result = inspector_.inspect_position(request.positionId);
+        records.push_back(InspectdRecord {result.positionId, result.turn,
+            static_cast<std::uint8_t>(result.analysisStatus), static_cast<std::uint8_t>(PieceId::None),
+            static_cast<std::uint8_t>(LocationId::Invalid), static_cast<std::uint8_t>(LocationId::Invalid),
+            0u, 0u});
+    } else if (type == InspectdRequestType::BestMove && inspector_.wdl_only() && !inspector_.has_best_moves()) {
+        header.status = static_cast<std::uint8_t>(InspectdResponseStatus::Unsupported);
+    } else if (type == InspectdRequestType::InspectMoves || type == InspectdRequestType::BestMove) {
+        std::vector<MoveInspectionResult> moves;
+        if (type == InspectdRequestType::InspectMoves) {
+            moves = inspector_.inspect_moves(request.positionId);
+        } else {
+            moves = inspector_.principal_variation(request.positionId, 1);
+        }
+        for (const MoveInspectionResult& move: moves) {
+            records.push_back(InspectdRecord {move.positionId, move.turn,
+                static_cast<std::uint8_t>(move.analysisStatus), static_cast<std::uint8_t>(move.piece),
+                static_cast<std::uint8_t>(move.source), static_cast<std::uint8_t>(move.destination),
+                move.isBestMove ? InspectdRecordBestMove : std::uint8_t(0u), 0u});
+        }
+    } else {
+        header.status = static_cast<std::uint8_t>(InspectdResponseStatus::InvalidRequest);
+    }
+
+    header.recordNums = static_cast<std::uint16_t>(records.size());
+    output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(InspectdRecord));
+}
+
+bool GobbInspectdServer::write_some(int fd, const std::string& output, std::size_t& writtenSize) const {
+    //
+    // It stops when the socket doesn't take more, and `writtenSize` tells where to continue.  A client
+    // which has closed the connection doesn't raise SIGPIPE.
+    //
+    while (writtenSize < output.size()) {
+        ssize_t size = ::send(fd, output.data() + writtenSize, output.size() - writtenSize, MSG_NOSIGNAL);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        writtenSize += static_cast<std::size_t>(size);
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_INSPECTD_SERVER_HPP
+#define GOBB_INSPECTD_SERVER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gobb_inspectd_protocol.hpp"
+#include "inspector.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Class GobbInspectdServer.
+//
+// The calling thread of run() multiplexes the listening socket and all the connections with poll().  It
+// reads as many requests as have arrived at a connection, and hands the complete ones to the pool of
+// threads as a batch.  A thread in the pool answers a batch in order, and writes the responses as far as
+// the socket takes them without blocking.  The polling thread writes the rest when the socket becomes
+// writable, so that a client which doesn't read its responses holds no thread of the pool.  A connection
+// is not read while its batch is being answered or written, so that responses keep the order of requests.
+//
+
+class GobbInspectdServer {
+public:
+    GobbInspectdServer() = delete;
+    GobbInspectdServer(const Inspector& inspector, int threadNums);
+    GobbInspectdServer(const GobbInspectdServer& other) = delete;
+    GobbInspectdServer(GobbInspectdServer&& other) = delete;
+    ~GobbInspectdServer();
+    GobbInspectdServer& operator=(const GobbInspectdServer& other) = delete;
+    GobbInspectdServer& operator=(GobbInspectdServer&& other) = delete;
+
+    bool open(const std::string& socketPath);
+    void run(const volatile std::sig_atomic_t& stopFlag);
+
+private:
+    struct Connection {
+        std::vector<char> buffer;  // received bytes not answered yet.
+        std::size_t filledSize;    // the number of bytes in `buffer`.
+        std::string output;        // responses left to be written by the polling thread.
+        std::size_t writtenSize;   // the number of bytes in `output` already written.
+        bool busy;                 // true while a batch of the connection is being answered or written.
+    };
+
+    struct Batch {
+        int fd;                                 // the connection.
+        std::vector<InspectdRequest> requests;  // complete requests in the order of arrival.
+    };
+
+    struct FinishedBatch {
+        int fd;                                 // the connection.
+        bool written;                           // false if the connection has failed.
+        std::string output;                     // responses which the socket hasn't taken yet.
+    };
+
+    void poll_connections(const volatile std::sig_atomic_t& stopFlag);
+    bool read_requests(int fd, Connection& connection);
+    bool write_responses(int fd, Connection& connection);
+    void finish_batches();
+    void answer_batches();
+    void answer_request(const InspectdRequest& request, std::string& output) const;
+    bool write_some(int fd, const std::string& output, std::size_t& writtenSize) const;
+
+    const Inspector& inspector_;
+    int threadNums_;
+    int listenFd_;
+    int wakeupFds_[2];
+    std::string socketPath_;
+    std::map<int, Connection> connections_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Batch> batches_;
+    std::vector<FinishedBatch> finishedBatches_;
+    std::atomic<bool> stopping_;
+
+    static constexpr std::size_t readBufferSize_ = 64u * 1024u;
+    static constexpr int pollTimeout_ = 200;
+};
+
+#endif // GOBB_INSPECTD_SERVER_HPP
@@ -0,0 +1,329 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gobb_inspectd_server.hpp"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+namespace {
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// Return the position after putting a piece of the active player at the center of the initial position.
+//
+PositionId put_at_center(PieceId piece) {
+    return Position(InitialPositionId).move(piece, LocationId::Out, LocationId::Center).position.id();
+}
+
+//
+// Load an opening database where the initial position has two moves: putting a large piece at the center
+// wins, and putting a medium piece at the center draws.
+//
+void load_opening(Inspector& inspector) {
+    OpeningHandler handler;
+    handler.set_opening(InitialPositionId, AnalysisStatus::Won, 3u);
+    handler.set_opening(put_at_center(PieceId::ActivePlayerLarge), AnalysisStatus::Lost, 2u);
+    handler.set_opening(put_at_center(PieceId::ActivePlayerMedium), AnalysisStatus::Unfixed, 0u);
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// A server running in a thread on a socket in a temporary directory.
+//
+class RunningServer {
+public:
+    RunningServer(const Inspector& inspector, int threadNums)
+        : server_(inspector, threadNums),
+          stopFlag_(0),
+          directory_(),
+          socketPath_(),
+          thread_() {
+        char directoryTemplate[] = "/tmp/gobb_inspectd_test_XXXXXX";
+        if (::mkdtemp(directoryTemplate) == nullptr) {
+            return;
+        }
+        directory_ = directoryTemplate;
+        socketPath_ = directory_ + "/socket";
+        if (server_.open(socketPath_)) {
+            thread_ = std::thread([this] { server_.run(stopFlag_); });
+        }
+    }
+
+    ~RunningServer() {
+        stopFlag_ = 1;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        ::unlink(socketPath_.c_str());
+        ::rmdir(directory_.c_str());
+    }
+
+    bool running() const { return thread_.joinable(); }
+    const std::string& socket_path() const { return socketPath_; }
+
+private:
+    GobbInspectdServer server_;
+    volatile std::sig_atomic_t stopFlag_;
+    std::string directory_;
+    std::string socketPath_;
+    std::thread thread_;
+};
+
+//
+// Connect to a server.  A read waits for 10 seconds at most, so that a server which doesn't answer fails
+// the test instead of hanging it.
+//
+int connect_to(const std::string& socketPath) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socketPath.c_str());
+    if (fd < 0 || ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    struct timeval timeout = {10, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+//
+// Send requests, and return false if the socket doesn't take them all.
+//
+bool send_requests(int fd, const std::vector<InspectdRequest>& requests, int flags = 0) {
+    const char* data = reinterpret_cast<const char*>(requests.data());
+    std::size_t size = requests.size() * sizeof(InspectdRequest);
+    while (size > 0u) {
+        ssize_t sentSize = ::send(fd, data, size, flags | MSG_NOSIGNAL);
+        if (sentSize <= 0) {
+            return false;
+        }
+        data += sentSize;
+        size -= static_cast<std::size_t>(sentSize);
+    }
+    return true;
+}
+
+//
+// Receive exactly `size` bytes.
+//
+bool receive_bytes(int fd, void* buffer, std::size_t size) {
+    char* p = static_cast<char*>(buffer);
+    while (size > 0u) {
+        ssize_t readSize = ::recv(fd, p, size, 0);
+        if (readSize <= 0) {
+            return false;
+        }
+        p += readSize;
+        size -= static_cast<std::size_t>(readSize);
+    }
+    return true;
+}
+
+//
+// Receive a response.
+//
+bool receive_response(int fd, InspectdResponseHeader& header, std::vector<InspectdRecord>& records) {
+    if (!receive_bytes(fd, &header, sizeof(header))) {
+        return false;
+    }
+    records.resize(header.recordNums);
+    return receive_bytes(fd, records.data(), records.size() * sizeof(InspectdRecord));
+}
+
+//
+// Return a request.
+//
+InspectdRequest make_request(std::uint32_t requestId, std::uint8_t type, PositionId id) {
+    return InspectdRequest {requestId, type, {0u, 0u, 0u}, id};
+}
+
+} // namespace
+
+//
+// Test the responses to each type of request and to invalid requests, sent at once by pipelining.
+//
+TEST(GobbInspectdServerTest, Requests) {
+    Inspector inspector;
+    load_opening(inspector);
+    RunningServer server(inspector, 2);
+    ASSERT_TRUE(server.running());
+    int fd = connect_to(server.socket_path());
+    ASSERT_GE(fd, 0);
+
+    ASSERT_TRUE(send_requests(fd, {
+        make_request(1u, static_cast<std::uint8_t>(InspectdRequestType::InspectPosition), InitialPositionId),
+        make_request(2u, static_cast<std::uint8_t>(InspectdRequestType::InspectMoves), InitialPositionId),
+        make_request(3u, static_cast<std::uint8_t>(InspectdRequestType::BestMove), InitialPositionId),
+        make_request(4u, 9u, InitialPositionId),
+        make_request(5u, static_cast<std::uint8_t>(InspectdRequestType::InspectPosition), PositionIdNums)}));
+
+    InspectdResponseHeader header;
+    std::vector<InspectdRecord> records;
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 1u);
+    ASSERT_EQ(header.type, static_cast<std::uint8_t>(InspectdRequestType::InspectPosition));
+    ASSERT_EQ(header.status, static_cast<std::uint8_t>(InspectdResponseStatus::Success));
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].positionId, InitialPositionId);
+    ASSERT_EQ(records[0].turn, 3u);
+    ASSERT_EQ(records[0].analysisStatus, static_cast<std::uint8_t>(AnalysisStatus::Won));
+    ASSERT_EQ(records[0].piece, static_cast<std::uint8_t>(PieceId::None));
+
+    //
+    // The moves are in the order of Inspector::inspect_moves(), and the status is of the player moving.
+    //
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 2u);
+    ASSERT_EQ(header.status, static_cast<std::uint8_t>(InspectdResponseStatus::Success));
+    std::vector<MoveInspectionResult> moves = inspector.inspect_moves(InitialPositionId);
+    ASSERT_EQ(moves.size(), 2u);
+    ASSERT_EQ(records.size(), moves.size());
+    for (std::size_t i = 0u; i < moves.size(); i++) {
+        ASSERT_EQ(records[i].positionId, moves[i].positionId);
+        ASSERT_EQ(records[i].turn, moves[i].turn);
+        ASSERT_EQ(records[i].analysisStatus, static_cast<std::uint8_t>(moves[i].analysisStatus));
+        ASSERT_EQ(records[i].piece, static_cast<std::uint8_t>(moves[i].piece));
+        ASSERT_EQ(records[i].source, static_cast<std::uint8_t>(LocationId::Out));
+        ASSERT_EQ(records[i].destination, static_cast<std::uint8_t>(LocationId::Center));
+        ASSERT_EQ(records[i].flags, moves[i].isBestMove ? InspectdRecordBestMove : 0u);
+    }
+
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 3u);
+    ASSERT_EQ(header.status, static_cast<std::uint8_t>(InspectdResponseStatus::Success));
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].positionId, put_at_center(PieceId::ActivePlayerLarge));
+    ASSERT_EQ(records[0].analysisStatus, static_cast<std::uint8_t>(AnalysisStatus::Won));
+    ASSERT_EQ(records[0].piece, static_cast<std::uint8_t>(PieceId::ActivePlayerLarge));
+    ASSERT_EQ(records[0].flags, InspectdRecordBestMove);
+
+    //
+    // An unknown type and an invalid position are answered with no record.
+    //
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 4u);
+    ASSERT_EQ(header.type, 9u);
+    ASSERT_EQ(header.status, static_cast<std::uint8_t>(InspectdResponseStatus::InvalidRequest));
+    ASSERT_TRUE(records.empty());
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 5u);
+    ASSERT_EQ(header.status, static_cast<std::uint8_t>(InspectdResponseStatus::InvalidRequest));
+    ASSERT_TRUE(records.empty());
+
+    ::close(fd);
+}
+
+//
+// Test that a client which sends many requests but doesn't read the responses holds no thread, and that
+// another client is still answered by a server with a single thread.
+//
+TEST(GobbInspectdServerTest, ClientNotReading) {
+    Inspector inspector;
+    load_opening(inspector);
+    RunningServer server(inspector, 1);
+    ASSERT_TRUE(server.running());
+
+    //
+    // The responses of moves are 2.5 times as large as the requests.  Send requests until the socket stops
+    // taking them, which happens only after the output to the client has filled up the socket.
+    //
+    int idleFd = connect_to(server.socket_path());
+    ASSERT_GE(idleFd, 0);
+    std::vector<InspectdRequest> requests(4096u,
+        make_request(0u, static_cast<std::uint8_t>(InspectdRequestType::InspectMoves), InitialPositionId));
+    std::size_t sentBatchNums = 0u;
+    while (sentBatchNums < 64u && send_requests(idleFd, requests, MSG_DONTWAIT)) {
+        sentBatchNums++;
+    }
+    ASSERT_LT(sentBatchNums, 64u);
+
+    int fd = connect_to(server.socket_path());
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(send_requests(fd,
+        {make_request(7u, static_cast<std::uint8_t>(InspectdRequestType::InspectPosition), InitialPositionId)}));
+    InspectdResponseHeader header;
+    std::vector<InspectdRecord> records;
+    ASSERT_TRUE(receive_response(fd, header, records));
+    ASSERT_EQ(header.requestId, 7u);
+    ASSERT_EQ(records.size(), 1u);
+
+    ::close(fd);
+    ::close(idleFd);
+}
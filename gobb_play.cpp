@@ -0,0 +1,203 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include "analysis_data_file_handler.hpp"
+#include "gobb_play_engine.hpp"
+#include "inspector.hpp"
+#include "inspector_loader.hpp"
+#include "mapped_file.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Print the help message.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_play [OPTION...]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -d DIR      map an analysis data file in DIR (default: .)" << std::endl;
+    std::cout << "  -g NUM      map analysis data file of the NUM'th generation" << std::endl;
+    std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -o          load the opening database written by 'gobb_export'" << std::endl;
+    std::cout << "  -r NUM      seed the random tie-break with NUM (default: random)" << std::endl;
+    std::cout << "  -t TYPE     break a tie of best moves by TYPE: first, last, random" << std::endl;
+    std::cout << "              (default: first)" << std::endl;
+    std::cout << "  -w          load the WDL file written by 'gobb_analyze --wdl-only'" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_play --help' ..." message.
+//
+void print_hint(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string dataDir;
+    unsigned long generation = 0u;
+    unsigned long seed = 0u;
+    bool opt_d = false;
+    bool opt_g = false;
+    bool opt_o = false;
+    bool opt_r = false;
+    bool opt_w = false;
+    TieBreak tieBreak = TieBreak::First;
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'o') {
+            opt_o = true;
+            optind++;
+        } else if (ch == 'w') {
+            opt_w = true;
+            optind++;
+        } else if (ch == 'd' || ch == 'g' || ch == 'r' || ch == 't') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'd') {
+                opt_d = true;
+                dataDir = std::string(optarg);
+            } else if (ch == 'g') {
+                opt_g = true;
+                if (!string_to_uint(optarg, generation) || generation > MaxGeneration) {
+                    std::cerr << argv[0] << ": invalid generation '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'r') {
+                opt_r = true;
+                if (!string_to_uint(optarg, seed) || seed > 0xffff'ffffu) {
+                    std::cerr << argv[0] << ": invalid seed '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else {
+                if (std::strcmp(optarg, "first") == 0) {
+                    tieBreak = TieBreak::First;
+                } else if (std::strcmp(optarg, "last") == 0) {
+                    tieBreak = TieBreak::Last;
+                } else if (std::strcmp(optarg, "random") == 0) {
+                    tieBreak = TieBreak::Random;
+                } else {
+                    std::cerr << argv[0] << ": unknown tie-break '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_hint(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((opt_g && opt_w) || (opt_g && opt_o) || (opt_o && opt_w)) {
+        std::cerr << argv[0] << ": '-g', '-o' and '-w' options are conflicted" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (optind < argc) {
+        std::cerr << argv[0] << ": too many arguments" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+    if (!opt_r) {
+        seed = std::random_device()();
+    }
+
+    //
+    // Maps or loads the data, and then plays until 'quit' or EOF.
+    //
+    try {
+        AnalysisDataFileHandler fileHandler;
+        if (opt_d) {
+            fileHandler = AnalysisDataFileHandler(dataDir);
+        }
+
+        //
+        // A data file is loaded into memory if it cannot be mapped (e.g. it is in the legacy format).
+        //
+        Inspector inspector;
+        MappedFile mapping;
+        std::string errorMessage;
+        InspectorDataSource source = opt_o ? InspectorDataSource::Opening :
+            (opt_w ? InspectorDataSource::Wdl : InspectorDataSource::AnalysisData);
+        Generation dataGeneration = opt_g ? static_cast<Generation>(generation) : InvalidGeneration;
+        if (!load_inspector_data(fileHandler, source, dataGeneration, true, inspector, mapping, errorMessage)) {
+            std::cerr << errorMessage << std::endl;
+            return 1;
+        }
+
+        std::ios::sync_with_stdio(false);
+        GobbPlayEngine engine(inspector, tieBreak, static_cast<std::uint32_t>(seed));
+        engine.run(std::cin, std::cout);
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+
+    return 0;
+}
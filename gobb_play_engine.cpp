@@ -0,0 +1,302 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "gobb_play_engine.hpp"
+#include "string_to_uint.hpp"
+
+using namespace gobb_analyzer;
+
+GobbPlayEngine::GobbPlayEngine(const Inspector& inspector, TieBreak tieBreak, std::uint32_t seed)
+    : inspector_(inspector),
+      tieBreak_(tieBreak),
+      randomEngine_(seed),
+      position_(InitialPositionId),
+      lost_(false),
+      latencies_(),
+      latencyNums_(0u) {
+}
+
+GobbPlayEngine::~GobbPlayEngine() {
+}
+
+void GobbPlayEngine::run(std::istream& in, std::ostream& out) {
+    std::string line;
+
+    while (std::getline(in, line)) {
+        std::vector<std::string> args = split_into_arguments(line);
+        if (args.size() == 0) {
+            continue;
+        }
+        if (!execute_command(args, out)) {
+            break;
+        }
+
+        //
+        // A client waits for the response of each command.
+        //
+        out << std::flush;
+    }
+    out << std::flush;
+}
+
+bool GobbPlayEngine::execute_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args[0] == "position") {
+        do_position_command(args, out);
+    } else if (args[0] == "move") {
+        do_move_command(args, out);
+    } else if (args[0] == "go") {
+        do_go_command(args, out);
+    } else if (args[0] == "show") {
+        do_show_command(args, out);
+    } else if (args[0] == "tiebreak") {
+        do_tiebreak_command(args, out);
+    } else if (args[0] == "stats") {
+        do_stats_command(args, out);
+    } else if (args[0] == "isready") {
+        out << "readyok\n";
+    } else if (args[0] == "quit") {
+        return false;
+    } else {
+        out << "error unknown command '" << args[0] << "'\n";
+    }
+    return true;
+}
+
+void GobbPlayEngine::do_position_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() != 2) {
+        out << "error usage: position startpos|ID\n";
+        return;
+    }
+
+    PositionId posId;
+    if (args[1] == "startpos") {
+        posId = InitialPositionId;
+    } else if (!string_to_uint(args[1], posId) || !is_valid_positionId(posId)) {
+        out << "error invalid position '" << args[1] << "'\n";
+        return;
+    }
+    position_ = Position(posId);
+    lost_ = false;
+    out << "ok " << position_.id() << "\n";
+}
+
+void GobbPlayEngine::do_move_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() < 2) {
+        out << "error usage: move MOVE...\n";
+        return;
+    }
+
+    //
+    // Moves are applied to a copy, so that the position is not changed by an illegal move.
+    //
+    Position pos = position_;
+    bool lost = lost_;
+    for (std::size_t i = 1u; i < args.size(); i++) {
+        PieceId piece;
+        LocationId source;
+        LocationId destination;
+        if (!notation_to_move(args[i].data(), args[i].data() + args[i].size(), piece, source, destination)) {
+            out << "error invalid move '" << args[i] << "'\n";
+            return;
+        }
+        if (lost || pos.is_winner(PlayerId::Active) || pos.is_winner(PlayerId::Inactive)) {
+            out << "error the game is over before '" << args[i] << "'\n";
+            return;
+        }
+        MoveResult moveResult = pos.move(piece, source, destination);
+        if (moveResult.status == MoveResultStatus::Invalid) {
+            out << "error illegal move '" << args[i] << "'\n";
+            return;
+        }
+
+        //
+        // After a move losing at once, the position before it is kept, as gobb_annotate does.
+        //
+        if (moveResult.status == MoveResultStatus::Lost) {
+            lost = true;
+        } else {
+            pos = moveResult.position;
+        }
+    }
+    position_ = pos;
+    lost_ = lost;
+    out << "ok " << position_.id() << (lost_ ? " lost" : "") << "\n";
+}
+
+void GobbPlayEngine::do_go_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() != 1) {
+        out << "error usage: go\n";
+        return;
+    }
+
+    //
+    // WDL data tell won moves but not how far the win is, and following them may never win the game.
+    //
+    if (inspector_.wdl_only() && !inspector_.has_best_moves()) {
+        out << "error best moves are unknown from WDL data\n";
+        return;
+    }
+
+    if (lost_) {
+        out << "bestmove none status " << analysisStatus_to_string(AnalysisStatus::Lost) << "\n";
+        return;
+    }
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    MoveInspectionResult move;
+    bool found = choose_move(move);
+    std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - startTime;
+
+    //
+    // Latencies of the last `maxLatencyNums_` moves are kept.
+    //
+    std::uint32_t latencyNs = static_cast<std::uint32_t>(
+        std::min<std::chrono::nanoseconds::rep>(latency.count(), 0xffff'ffff));
+    if (latencies_.size() < maxLatencyNums_) {
+        latencies_.push_back(latencyNs);
+    } else {
+        latencies_[latencyNums_ % maxLatencyNums_] = latencyNs;
+    }
+    latencyNums_++;
+
+    PositionInspectionResult posResult = inspector_.inspect_position(position_.id());
+    if (!found) {
+        out << "bestmove none status " << analysisStatus_to_string(posResult.analysisStatus) << "\n";
+        return;
+    }
+    out << "bestmove " << move_to_notation(move.piece, move.source, move.destination)
+        << " position " << move.positionId
+        << " status " << analysisStatus_to_string(posResult.analysisStatus);
+    if (!inspector_.wdl_only()) {
+        out << " turns " << posResult.turn;
+    }
+    out << "\n";
+}
+
+void GobbPlayEngine::do_show_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() != 1) {
+        out << "error usage: show\n";
+        return;
+    }
+
+    PositionInspectionResult posResult = inspector_.inspect_position(position_.id());
+    out << "position " << position_.id()
+        << " status " << analysisStatus_to_string(posResult.analysisStatus);
+    if (!inspector_.wdl_only()) {
+        out << " turns " << posResult.turn;
+    }
+    out << (lost_ ? " lost" : "") << "\n";
+}
+
+void GobbPlayEngine::do_tiebreak_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() != 2) {
+        out << "error usage: tiebreak first|last|random\n";
+        return;
+    }
+
+    if (args[1] == "first") {
+        tieBreak_ = TieBreak::First;
+    } else if (args[1] == "last") {
+        tieBreak_ = TieBreak::Last;
+    } else if (args[1] == "random") {
+        tieBreak_ = TieBreak::Random;
+    } else {
+        out << "error unknown tie-break '" << args[1] << "'\n";
+        return;
+    }
+    out << "ok\n";
+}
+
+void GobbPlayEngine::do_stats_command(const std::vector<std::string>& args, std::ostream& out) {
+    if (args.size() == 2 && args[1] == "reset") {
+        latencies_.clear();
+        latencyNums_ = 0u;
+        out << "ok\n";
+        return;
+    }
+    if (args.size() != 1) {
+        out << "error usage: stats [reset]\n";
+        return;
+    }
+
+    if (latencies_.empty()) {
+        out << "stats moves 0\n";
+        return;
+    }
+    std::vector<std::uint32_t> sorted(latencies_);
+    std::sort(sorted.begin(), sorted.end());
+    std::uint64_t sum = 0u;
+    for (std::uint32_t latency: sorted) {
+        sum += latency;
+    }
+    out << "stats moves " << latencyNums_
+        << " mean_ns " << sum / sorted.size()
+        << " p50_ns " << sorted[sorted.size() / 2]
+        << " p99_ns " << sorted[sorted.size() * 99 / 100]
+        << " max_ns " << sorted.back() << "\n";
+}
+
+bool GobbPlayEngine::choose_move(MoveInspectionResult& result) {
+    MoveInspectionResult moves[MaxMoveNums];
+    std::size_t moveNums = inspector_.inspect_moves(position_.id(), moves);
+
+    std::size_t bestIndexes[MaxMoveNums];
+    std::size_t bestNums = 0u;
+    for (std::size_t i = 0u; i < moveNums; i++) {
+        if (moves[i].isBestMove) {
+            bestIndexes[bestNums++] = i;
+        }
+    }
+    if (bestNums == 0u) {
+        return false;
+    }
+
+    std::size_t chosen;
+    if (tieBreak_ == TieBreak::First) {
+        chosen = 0u;
+    } else if (tieBreak_ == TieBreak::Last) {
+        chosen = bestNums - 1u;
+    } else {
+        chosen = std::uniform_int_distribution<std::size_t>(0u, bestNums - 1u)(randomEngine_);
+    }
+    result = moves[bestIndexes[chosen]];
+    return true;
+}
+
+std::vector<std::string> GobbPlayEngine::split_into_arguments(const std::string& line) const {
+    std::vector<std::string> args;
+    std::size_t index = 0u;
+
+    for (;;) {
+        while (index < line.size() && std::strchr(" \t\r\n", line[index]) != nullptr) {
+            index++;
+        }
+        if (index == line.size()) {
+            break;
+        }
+        std::size_t argStartIndex = index;
+        while (index < line.size() && std::strchr(" \t\r\n", line[index]) == nullptr) {
+            index++;
+        }
+        args.push_back(line.substr(argStartIndex, index - argStartIndex));
+    }
+
+    return args;
+}
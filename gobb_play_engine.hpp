@@ -0,0 +1,83 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_PLAY_ENGINE_HPP
+#define GOBB_PLAY_ENGINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "inspector.hpp"
+#include "position.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Class GobbPlayEngine.
+//
+// It reads commands line by line, and writes a line for each command.  The best moves of a position are
+// chosen in the same way as Inspector::inspect_moves(), and a tie among them is broken by TieBreak.
+// Moves are written as SIZE:SOURCE-DESTINATION (e.g. Large:Out-Center), in the orientation of the
+// current position.  A move picking up a piece which reveals a line of the opponent is legal, but it loses
+// the game at once.  The position before the move remains current, and no move is accepted after it.
+//
+
+// How to choose one of equally good moves.
+enum class TieBreak {
+    First,   // the first move in the order of inspect_moves().
+    Last,    // the last move in the order of inspect_moves().
+    Random   // a move chosen at random.
+};
+
+class GobbPlayEngine {
+public:
+    GobbPlayEngine() = delete;
+    GobbPlayEngine(const Inspector& inspector, TieBreak tieBreak, std::uint32_t seed);
+    GobbPlayEngine(const GobbPlayEngine& other) = delete;
+    GobbPlayEngine(GobbPlayEngine&& other) = delete;
+    ~GobbPlayEngine();
+    GobbPlayEngine& operator=(const GobbPlayEngine& other) = delete;
+    GobbPlayEngine& operator=(GobbPlayEngine&& other) = delete;
+
+    void run(std::istream& in, std::ostream& out);
+
+private:
+    bool execute_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_position_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_move_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_go_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_show_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_tiebreak_command(const std::vector<std::string>& args, std::ostream& out);
+    void do_stats_command(const std::vector<std::string>& args, std::ostream& out);
+    bool choose_move(MoveInspectionResult& result);
+    std::vector<std::string> split_into_arguments(const std::string& line) const;
+
+    const Inspector& inspector_;
+    TieBreak tieBreak_;
+    std::mt19937 randomEngine_;
+    Position position_;
+    bool lost_;
+    std::vector<std::uint32_t> latencies_;
+    std::uint64_t latencyNums_;
+
+    static constexpr std::size_t maxLatencyNums_ = 1u << 20;
+};
+
+#endif // GOBB_PLAY_ENGINE_HPP
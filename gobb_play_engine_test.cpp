@@ -0,0 +1,365 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gobb_play_engine.hpp"
+#include "wdl_analyzer.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// An I/O handler which gives WDL data kept in memory to an inspector.
+//
+class WdlHandler: public AnalysisDataIOHandler {
+public:
+    WdlHandler()
+        : wdlTable_() {
+        std::uint8_t byte = 0u;
+        for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+            byte = set_wdlValue_of_byte(byte, id, WdlValue::Excluded);
+        }
+        wdlTable_.assign(WdlTableSize, byte);
+    }
+
+    virtual bool store(Generation, const AnalysisStatistics&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool load(Generation, AnalysisStatistics&, AnalysisData*, std::size_t) const { return false; }
+    virtual Generation find_latest() const { return InvalidGeneration; }
+    virtual Generation load_latest(AnalysisStatistics&, AnalysisData*, std::size_t) const {
+        return InvalidGeneration;
+    }
+    virtual bool store_checkpoint(const AnalysisCheckpoint&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool find_checkpoint(AnalysisCheckpoint&) const { return false; }
+    virtual bool load_checkpoint(AnalysisCheckpoint&, AnalysisData*, std::size_t) const { return false; }
+    virtual void remove_checkpoint() {}
+    virtual bool store_wdl(const AnalysisStatistics&, bool, const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+        std::size_t tableSize) const {
+        if (wdlTable_.size() != tableSize) {
+            return false;
+        }
+        stats = AnalysisStatistics();
+        complete = true;
+        std::copy(wdlTable_.begin(), wdlTable_.end(), table);
+        return true;
+    }
+    virtual bool store_reachability(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_reachability(std::uint8_t*, std::size_t) const { return false; }
+    virtual void clean() {}
+
+    //
+    // Set a WDL value of a position.
+    //
+    void set_wdl(PositionId id, WdlValue value) {
+        std::uint8_t& byte = wdlTable_[id / WdlValuesPerByte];
+        byte = set_wdlValue_of_byte(byte, id, value);
+    }
+
+private:
+    std::vector<std::uint8_t> wdlTable_;
+};
+
+//
+// Load an opening database where putting the large piece on a corner wins, and the other first moves draw.
+//
+void load_opening(Inspector& inspector) {
+    OpeningHandler handler;
+    Position pos(InitialPositionId);
+    handler.set_opening(InitialPositionId, AnalysisStatus::Won, 6u);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        for (LocationId dst: OnBoardLocationIds) {
+            MoveResult moveResult = pos.move(piece, LocationId::Out, dst);
+            if (moveResult.status == MoveResultStatus::Success) {
+                handler.set_opening(moveResult.position.id(), AnalysisStatus::Unfixed, MaxTurn);
+            }
+        }
+    }
+    MoveResult wonMove = pos.move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::NW);
+    ASSERT_EQ(wonMove.status, MoveResultStatus::Success);
+    handler.set_opening(wonMove.position.id(), AnalysisStatus::Lost, 5u);
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// Run an engine on commands, and return the lines answered.
+//
+std::vector<std::string> run_engine(GobbPlayEngine& engine, const std::string& input) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    engine.run(in, out);
+
+    std::vector<std::string> lines;
+    std::istringstream outLines(out.str());
+    std::string line;
+    while (std::getline(outLines, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+//
+// Return the words of a line.
+//
+std::vector<std::string> split_words(const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream in(line);
+    std::string word;
+    while (in >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+//
+// Return the best moves of the initial position as the engine writes them, in the order of inspect_moves().
+//
+std::vector<std::string> best_moves_of_initial_position(const Inspector& inspector) {
+    std::vector<std::string> moves;
+    for (const MoveInspectionResult& move: inspector.inspect_moves(InitialPositionId)) {
+        if (move.isBestMove) {
+            moves.push_back(pieceSize_to_string(pieceSize_of_pieceId(move.piece)) + ":" +
+                locationId_to_string(move.source) + "-" + locationId_to_string(move.destination));
+        }
+    }
+    return moves;
+}
+
+} // namespace
+
+//
+// Test that each tie-break mode chooses its move among the equally good ones.
+//
+TEST(GobbPlayEngineTest, TieBreak) {
+    Inspector inspector;
+    load_opening(inspector);
+    std::vector<std::string> bestMoves = best_moves_of_initial_position(inspector);
+    ASSERT_EQ(bestMoves.size(), 4u);
+
+    GobbPlayEngine firstEngine(inspector, TieBreak::First, 1u);
+    std::vector<std::string> lines = run_engine(firstEngine, "go\ntiebreak last\ngo\ntiebreak first\ngo\n");
+    ASSERT_EQ(lines.size(), 5u);
+    ASSERT_EQ(split_words(lines[0])[1], bestMoves.front());
+    ASSERT_EQ(lines[1], "ok");
+    ASSERT_EQ(split_words(lines[2])[1], bestMoves.back());
+    ASSERT_EQ(split_words(lines[4])[1], bestMoves.front());
+
+    //
+    // The go command answers the position after the move, and the status of the current position.
+    //
+    std::vector<std::string> words = split_words(lines[0]);
+    ASSERT_EQ(words.size(), 8u);
+    ASSERT_EQ(words[0], "bestmove");
+    ASSERT_EQ(words[4], "status");
+    ASSERT_EQ(words[5], "Won");
+    ASSERT_EQ(words[7], "6");
+
+    //
+    // Random tie-breaks choose only the best moves, all of them in the long run, and are reproduced by a seed.
+    //
+    std::string input = "tiebreak random\n";
+    for (int i = 0; i < 64; i++) {
+        input += "go\n";
+    }
+    GobbPlayEngine randomEngine(inspector, TieBreak::First, 7u);
+    GobbPlayEngine sameSeedEngine(inspector, TieBreak::First, 7u);
+    lines = run_engine(randomEngine, input);
+    ASSERT_EQ(lines, run_engine(sameSeedEngine, input));
+    std::set<std::string> chosen;
+    for (std::size_t i = 1u; i < lines.size(); i++) {
+        chosen.insert(split_words(lines[i])[1]);
+    }
+    ASSERT_EQ(chosen, std::set<std::string>(bestMoves.begin(), bestMoves.end()));
+
+    ASSERT_EQ(run_engine(randomEngine, "tiebreak best\n"),
+        std::vector<std::string> {"error unknown tie-break 'best'"});
+}
+
+//
+// Test that a list of moves is applied all or nothing.
+//
+TEST(GobbPlayEngineTest, MoveList) {
+    Inspector inspector;
+    GobbPlayEngine engine(inspector, TieBreak::First, 1u);
+
+    Position pos(InitialPositionId);
+    MoveResult first = pos.move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center);
+    ASSERT_EQ(first.status, MoveResultStatus::Success);
+    MoveResult second = first.position.move(PieceId::ActivePlayerMedium, LocationId::Out, LocationId::NW);
+    ASSERT_EQ(second.status, MoveResultStatus::Success);
+
+    std::vector<std::string> lines = run_engine(engine,
+        "move Large:Out-Center Large:Out-Center\n"
+        "show\n"
+        "move Large:Out-Center Medium:Out-Middle\n"
+        "show\n"
+        "move Large:Out-Center Medium:Out-NW\n"
+        "show\n"
+        "move\n"
+        "position startpos\n");
+    ASSERT_EQ(lines.size(), 8u);
+    ASSERT_EQ(lines[0], "error illegal move 'Large:Out-Center'");
+    ASSERT_EQ(split_words(lines[1])[1], "0");
+    ASSERT_EQ(lines[2], "error invalid move 'Medium:Out-Middle'");
+    ASSERT_EQ(split_words(lines[3])[1], "0");
+    ASSERT_EQ(lines[4], "ok " + std::to_string(second.position.id()));
+    ASSERT_EQ(split_words(lines[5])[1], std::to_string(second.position.id()));
+    ASSERT_EQ(lines[6], "error usage: move MOVE...");
+    ASSERT_EQ(lines[7], "ok 0");
+}
+
+//
+// Test that a move revealing a line of the opponent is accepted as a lost game, and that the game is over
+// until a new position is given.
+//
+TEST(GobbPlayEngineTest, LosingMove) {
+    Inspector inspector;
+    GobbPlayEngine engine(inspector, TieBreak::First, 1u);
+
+    //
+    // Picking up the large piece at NW reveals the line of the opponent at the top.
+    //
+    Position pos(PlayerColor::Orange,
+        {{LocationId::Out, LocationId::Out}, {LocationId::NW, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::N,  LocationId::Out},
+         {LocationId::NW,  LocationId::Out}, {LocationId::NE, LocationId::Out}});
+    ASSERT_EQ(pos.move(PieceId::ActivePlayerLarge, LocationId::NW, LocationId::Center).status,
+        MoveResultStatus::Lost);
+    std::string id = std::to_string(pos.id());
+
+    std::vector<std::string> lines = run_engine(engine,
+        "position " + id + "\n"
+        "move Large:NW-Center Small:Out-SE\n"
+        "show\n"
+        "move Large:NW-Center\n"
+        "show\n"
+        "move Small:Out-SE\n"
+        "go\n"
+        "position startpos\n"
+        "move Large:Out-Center\n");
+    ASSERT_EQ(lines.size(), 9u);
+    ASSERT_EQ(lines[0], "ok " + id);
+    ASSERT_EQ(lines[1], "error the game is over before 'Small:Out-SE'");
+    ASSERT_NE(lines[2].substr(lines[2].size() - 5u), " lost");
+    ASSERT_EQ(lines[3], "ok " + id + " lost");
+    ASSERT_EQ(split_words(lines[4])[1], id);
+    ASSERT_EQ(split_words(lines[4]).back(), "lost");
+    ASSERT_EQ(lines[5], "error the game is over before 'Small:Out-SE'");
+    ASSERT_EQ(lines[6], "bestmove none status Lost");
+    ASSERT_EQ(lines[7], "ok 0");
+    ASSERT_EQ(split_words(lines[8])[0], "ok");
+    ASSERT_EQ(split_words(lines[8]).size(), 2u);
+}
+
+//
+// Test that the stats command counts go commands, and that it is reset.
+//
+TEST(GobbPlayEngineTest, Stats) {
+    Inspector inspector;
+    load_opening(inspector);
+    GobbPlayEngine engine(inspector, TieBreak::First, 1u);
+
+    std::vector<std::string> lines = run_engine(engine, "stats\ngo\ngo\ngo\nstats\nstats reset\nstats\nstats all\n");
+    ASSERT_EQ(lines.size(), 8u);
+    ASSERT_EQ(lines[0], "stats moves 0");
+
+    std::vector<std::string> words = split_words(lines[4]);
+    ASSERT_EQ(words.size(), 11u);
+    ASSERT_EQ(words[1], "moves");
+    ASSERT_EQ(words[2], "3");
+    ASSERT_EQ(words[3], "mean_ns");
+    ASSERT_EQ(words[5], "p50_ns");
+    ASSERT_EQ(words[7], "p99_ns");
+    ASSERT_EQ(words[9], "max_ns");
+    ASSERT_LE(std::stoull(words[6]), std::stoull(words[10]));
+    ASSERT_LE(std::stoull(words[8]), std::stoull(words[10]));
+
+    ASSERT_EQ(lines[5], "ok");
+    ASSERT_EQ(lines[6], "stats moves 0");
+    ASSERT_EQ(lines[7], "error usage: stats [reset]");
+}
+
+//
+// Test that the go command is refused on WDL data, which don't tell the fastest win.
+//
+TEST(GobbPlayEngineTest, WdlData) {
+    Position pos(InitialPositionId);
+    WdlHandler handler;
+    handler.set_wdl(pos.minimize_id(), WdlValue::Won);
+    MoveResult lostMove = pos.move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center);
+    ASSERT_EQ(lostMove.status, MoveResultStatus::Success);
+    handler.set_wdl(lostMove.position.minimize_id(), WdlValue::Lost);
+
+    Inspector inspector;
+    ASSERT_TRUE(inspector.load_wdl(handler));
+    GobbPlayEngine engine(inspector, TieBreak::First, 1u);
+    std::vector<std::string> lines = run_engine(engine, "go\nshow\n");
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_EQ(lines[0], "error best moves are unknown from WDL data");
+    ASSERT_EQ(lines[1], "position 0 status Won");
+}
@@ -0,0 +1,153 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <filesystem>
+#include <new>
+#include <system_error>
+#include "gobb_probe.h"
+#include "analysis_data_file_handler.hpp"
+#include "inspector.hpp"
+#include "mapped_file.hpp"
+#include "position.hpp"
+
+using namespace gobb_analyzer;
+
+static_assert(GOBB_PROBE_MAX_MOVES == MaxMoveNums, "GOBB_PROBE_MAX_MOVES must be the maximum number of moves");
+static_assert(GOBB_PROBE_STATUS_WON == static_cast<int>(AnalysisStatus::Won), "status codes must be the same");
+static_assert(GOBB_PROBE_STATUS_INVALID == static_cast<int>(AnalysisStatus::Invalid),
+    "status codes must be the same");
+
+//
+// A handle of an opened analysis data file.
+//
+// The inspector only reads the mapped table, so that it may be used by threads at the same time.
+//
+struct gobb_probe {
+    MappedFile mapping;
+    Inspector inspector;
+};
+
+//
+// Copy an inspection result of a move to the C structure.
+//
+static void copy_move_result(const MoveInspectionResult& src, gobb_probe_move_result* dst) noexcept {
+    dst->position_id = src.positionId;
+    dst->turn = src.turn;
+    dst->status = static_cast<std::uint8_t>(src.analysisStatus);
+    dst->piece = static_cast<std::uint8_t>(src.piece);
+    dst->source = static_cast<std::uint8_t>(src.source);
+    dst->destination = static_cast<std::uint8_t>(src.destination);
+    dst->is_best_move = src.isBestMove ? 1u : 0u;
+}
+
+int gobb_probe_abi_version(void) {
+    return GOBB_PROBE_ABI_VERSION;
+}
+
+gobb_probe* gobb_probe_open(const char* path) {
+    return gobb_probe_open_with_error(path, nullptr);
+}
+
+gobb_probe* gobb_probe_open_with_error(const char* path, int* error) {
+    int errorCode = GOBB_PROBE_ERROR_NONE;
+    gobb_probe* probe = nullptr;
+
+    //
+    // Exceptions must not be propagated to C callers.
+    //
+    try {
+        std::filesystem::path filePath(path);
+        std::error_code ec;
+        if (std::filesystem::is_directory(filePath, ec)) {
+            filePath = AnalysisDataFileHandler(path).latest_file_path();
+        }
+
+        probe = new gobb_probe;
+        AnalysisStatistics stats;
+        if (filePath.empty()) {
+            errorCode = GOBB_PROBE_ERROR_OPEN;
+        } else if (!AnalysisDataFileHandler::map_file(filePath, stats, probe->mapping)) {
+            if (AnalysisDataFileHandler::is_legacy_file(filePath)) {
+                errorCode = GOBB_PROBE_ERROR_LEGACY_FORMAT;
+            } else if (std::filesystem::is_regular_file(filePath, ec)) {
+                errorCode = GOBB_PROBE_ERROR_FORMAT;
+            } else {
+                errorCode = GOBB_PROBE_ERROR_OPEN;
+            }
+        } else {
+            probe->inspector.use_mapped_table(AnalysisDataFileHandler::mapped_table(probe->mapping), stats);
+        }
+    } catch (std::bad_alloc&) {
+        errorCode = GOBB_PROBE_ERROR_MEMORY;
+    } catch (...) {
+        errorCode = GOBB_PROBE_ERROR_OPEN;
+    }
+
+    if (errorCode != GOBB_PROBE_ERROR_NONE) {
+        delete probe;
+        probe = nullptr;
+    }
+    if (error != nullptr) {
+        *error = errorCode;
+    }
+    return probe;
+}
+
+void gobb_probe_close(gobb_probe* probe) {
+    delete probe;
+}
+
+int gobb_probe_position(const gobb_probe* probe, uint64_t id, gobb_probe_position_result* result) {
+    if (!is_valid_positionId(id)) {
+        return -1;
+    }
+
+    PositionInspectionResult insRes = probe->inspector.inspect_position(id);
+    result->position_id = insRes.positionId;
+    result->turn = insRes.turn;
+    result->status = static_cast<std::uint8_t>(insRes.analysisStatus);
+    return 0;
+}
+
+int gobb_probe_moves(const gobb_probe* probe, uint64_t id, gobb_probe_move_result* results, size_t resultNums) {
+    if (!is_valid_positionId(id)) {
+        return -1;
+    }
+
+    MoveInspectionResult insResults[MaxMoveNums];
+    std::size_t moveNums = probe->inspector.inspect_moves(id, insResults);
+    for (std::size_t i = 0u; i < moveNums && i < resultNums; i++) {
+        copy_move_result(insResults[i], results + i);
+    }
+    return static_cast<int>(moveNums);
+}
+
+int gobb_probe_best_move(const gobb_probe* probe, uint64_t id, gobb_probe_move_result* result) {
+    if (!is_valid_positionId(id)) {
+        return -1;
+    }
+
+    MoveInspectionResult insResults[MaxMoveNums];
+    std::size_t moveNums = probe->inspector.inspect_moves(id, insResults);
+    for (std::size_t i = 0u; i < moveNums; i++) {
+        if (insResults[i].isBestMove) {
+            copy_move_result(insResults[i], result);
+            return 1;
+        }
+    }
+    return 0;
+}
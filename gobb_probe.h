@@ -0,0 +1,176 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_PROBE_H
+#define GOBB_PROBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// @file   gobb_probe.h
+/// @brief  C interface of the probing library `libgobb_probe`.
+///
+/// The library maps an analysis data file written by `gobb_analyze` and answers queries about positions
+/// in the calling process.  A handle may be shared by any number of threads, since the mapping is read
+/// only.  Probing functions never allocate memory.  Piece IDs, location IDs and status codes are the same
+/// as those printed by `gobb_inspect`.
+///
+/// The interface is stable: functions and structures are only added, and the major version of the
+/// shared library is incremented on an incompatible change.
+///
+
+#if defined(__GNUC__)
+#  define GOBB_PROBE_API __attribute__((visibility("default")))
+#else
+#  define GOBB_PROBE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The version of the interface described in this header.
+#define GOBB_PROBE_ABI_VERSION 2
+
+/// The maximum number of possible moves of a position.
+#define GOBB_PROBE_MAX_MOVES 54
+
+/// Status codes of positions.
+#define GOBB_PROBE_STATUS_UNFIXED         0  ///< Not fixed (a draw).
+#define GOBB_PROBE_STATUS_LOST            1  ///< The active player loses.
+#define GOBB_PROBE_STATUS_LOST_STALEMATE  2  ///< The active player loses with stalemate.
+#define GOBB_PROBE_STATUS_WON             3  ///< The active player wins.
+#define GOBB_PROBE_STATUS_WON_STALEMATE   4  ///< The active player wins with stalemate.
+#define GOBB_PROBE_STATUS_CONTRADICTORY   6  ///< The position never appears during a game.
+#define GOBB_PROBE_STATUS_INVALID         7  ///< Invalid.
+
+/// Error codes of gobb_probe_open_with_error().
+#define GOBB_PROBE_ERROR_NONE           0  ///< No error.
+#define GOBB_PROBE_ERROR_OPEN           1  ///< No analysis data file is found, or it cannot be mapped.
+#define GOBB_PROBE_ERROR_LEGACY_FORMAT  2  ///< The file is in the legacy format.
+#define GOBB_PROBE_ERROR_FORMAT         3  ///< The file is not an analysis data file.
+#define GOBB_PROBE_ERROR_MEMORY         4  ///< Memory is exhausted.
+
+/// An opaque handle of an opened analysis data file.
+typedef struct gobb_probe gobb_probe;
+
+///
+/// Analysis data of a position.
+///
+typedef struct gobb_probe_position_result {
+    uint64_t position_id;  ///< a position ID.
+    uint16_t turn;         ///< the number of remaining turns.
+    uint8_t status;        ///< a status code (`GOBB_PROBE_STATUS_*`).
+} gobb_probe_position_result;
+
+///
+/// A possible move of a position.
+///
+typedef struct gobb_probe_move_result {
+    uint64_t position_id;  ///< a position ID after the move.
+    uint16_t turn;         ///< the number of remaining turns after the move.
+    uint8_t status;        ///< a status code after the move, for the player moving next.
+    uint8_t piece;         ///< a piece ID to be moved.
+    uint8_t source;        ///< the source location ID of the piece (0 for a piece out of the board).
+    uint8_t destination;   ///< the destination location ID of the piece.
+    uint8_t is_best_move;  ///< 1 if this is the best move, 0 otherwise.
+} gobb_probe_move_result;
+
+///
+/// Return the version of the interface implemented by the library.
+///
+/// @return  the version, which is compared with `GOBB_PROBE_ABI_VERSION`.
+///
+GOBB_PROBE_API int gobb_probe_abi_version(void);
+
+///
+/// Open an analysis data file.
+///
+/// @param   path  a path to an analysis data file, or a directory where the analysis data file of the
+///                latest generation is opened.
+/// @return  a handle, or NULL upon failure.
+///
+/// The file is mapped into memory and is not copied, so that processes opening the same file share it.
+/// Files in the legacy format cannot be opened; load and store them by `gobb_analyze` to convert them.
+/// Use gobb_probe_open_with_error() to tell the reason of a failure.
+///
+GOBB_PROBE_API gobb_probe* gobb_probe_open(const char* path);
+
+///
+/// Open an analysis data file, and tell the reason of a failure.
+///
+/// @param   path   a path to an analysis data file, or a directory where the analysis data file of the
+///                 latest generation is opened.
+/// @param   error  an error code (`GOBB_PROBE_ERROR_*`), or NULL.
+/// @return  a handle, or NULL upon failure.
+///
+/// It is the same as gobb_probe_open() except that `*error` is set.  It is available since the version 2
+/// of the interface.
+///
+GOBB_PROBE_API gobb_probe* gobb_probe_open_with_error(const char* path, int* error);
+
+///
+/// Close a handle.
+///
+/// @param   probe  a handle, or NULL.
+///
+/// The handle must not be used by any thread after it is closed.
+///
+GOBB_PROBE_API void gobb_probe_close(gobb_probe* probe);
+
+///
+/// Probe a position.
+///
+/// @param   probe   a handle.
+/// @param   id      a position ID.
+/// @param   result  the analysis data of the position.
+/// @return  0 upon success, -1 if the position ID is invalid.
+///
+GOBB_PROBE_API int gobb_probe_position(const gobb_probe* probe, uint64_t id, gobb_probe_position_result* result);
+
+///
+/// Probe possible moves of a position.
+///
+/// @param   probe       a handle.
+/// @param   id          a position ID.
+/// @param   results     possible moves of the position.
+/// @param   resultNums  the number of elements in `results`.  `GOBB_PROBE_MAX_MOVES` is always enough.
+/// @return  the number of possible moves, or -1 if the position ID is invalid.
+///
+/// If the number of possible moves exceeds `resultNums`, only the first `resultNums` moves are stored.
+///
+GOBB_PROBE_API int gobb_probe_moves(const gobb_probe* probe, uint64_t id, gobb_probe_move_result* results,
+    size_t resultNums);
+
+///
+/// Probe the best move of a position.
+///
+/// @param   probe   a handle.
+/// @param   id      a position ID.
+/// @param   result  the best move.
+/// @return  1 if the best move is found, 0 if there is no possible move, or -1 if the position ID is invalid.
+///
+/// If two or more moves are equally good, the first one is chosen.
+///
+GOBB_PROBE_API int gobb_probe_best_move(const gobb_probe* probe, uint64_t id, gobb_probe_move_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GOBB_PROBE_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2022 Motoyuki Kasahara.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>
+ */
+
+/*
+ * Test of the C interface of libgobb_probe, which is compiled as C and linked with the shared library.
+ *
+ * The analysis data files are sparse files filled with zeros, where every position is `Unfixed`.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "gobb_probe.h"
+
+/* The size of the statistics data at the head of an analysis data file. */
+#define STATISTICS_SIZE 48L
+
+/* The size of the table in an analysis data file. */
+#define TABLE_SIZE (2L * (776L * 1423L * 1423L + 1423L * 1423L + 1423L))
+
+/* The magic number of an analysis data file. */
+static const char file_magic[8] = {'G', 'O', 'B', 'B', 'A', 'D', '0', '2'};
+
+static int failure_nums = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failure_nums++; \
+        } \
+    } while (0)
+
+/*
+ * Create a sparse file, which starts with the magic number if `with_magic` is nonzero.
+ */
+static int create_file(const char* path, int with_magic, long size) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    if (with_magic && fwrite(file_magic, 1u, sizeof(file_magic), file) != sizeof(file_magic)) {
+        fclose(file);
+        return -1;
+    }
+    if (fclose(file) != 0 || truncate(path, size) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Test that opening fails with the error code.
+ */
+static void check_open_error(const char* path, int expected) {
+    int error = GOBB_PROBE_ERROR_NONE;
+    gobb_probe* probe = gobb_probe_open_with_error(path, &error);
+    CHECK(probe == NULL);
+    CHECK(error == expected);
+    CHECK(gobb_probe_open(path) == NULL);
+    gobb_probe_close(probe);
+}
+
+/*
+ * Test the probing functions on a file where every position is `Unfixed`.
+ */
+static void check_probe(gobb_probe* probe) {
+    gobb_probe_position_result position;
+    gobb_probe_move_result moves[GOBB_PROBE_MAX_MOVES];
+    gobb_probe_move_result best_move;
+    int move_nums;
+    int i;
+
+    CHECK(gobb_probe_position(probe, 0u, &position) == 0);
+    CHECK(position.position_id == 0u);
+    CHECK(position.status == GOBB_PROBE_STATUS_UNFIXED);
+    CHECK(gobb_probe_position(probe, ~(uint64_t)0u, &position) == -1);
+
+    /* Every move of the initial position puts a piece out of the board on the board. */
+    move_nums = gobb_probe_moves(probe, 0u, moves, GOBB_PROBE_MAX_MOVES);
+    CHECK(move_nums > 0 && move_nums <= GOBB_PROBE_MAX_MOVES);
+    for (i = 0; i < move_nums; i++) {
+        CHECK(moves[i].status == GOBB_PROBE_STATUS_UNFIXED);
+        CHECK(moves[i].source == 0u);
+        CHECK(moves[i].destination != 0u);
+    }
+    CHECK(gobb_probe_moves(probe, 0u, moves, 1u) == move_nums);
+    CHECK(gobb_probe_moves(probe, ~(uint64_t)0u, moves, GOBB_PROBE_MAX_MOVES) == -1);
+
+    CHECK(gobb_probe_best_move(probe, 0u, &best_move) >= 0);
+    CHECK(gobb_probe_best_move(probe, ~(uint64_t)0u, &best_move) == -1);
+}
+
+int main(void) {
+    char dir[] = "/tmp/gobb_probe_test.XXXXXX";
+    char data_path[64];
+    char legacy_path[64];
+    char short_path[64];
+    int error = -1;
+    gobb_probe* probe;
+
+    CHECK(gobb_probe_abi_version() == GOBB_PROBE_ABI_VERSION);
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(data_path, sizeof(data_path), "%s/gobb_analyzer_3.dat", dir);
+    snprintf(legacy_path, sizeof(legacy_path), "%s/legacy.dat", dir);
+    snprintf(short_path, sizeof(short_path), "%s/short.dat", dir);
+
+    /* No analysis data file is in the directory yet. */
+    check_open_error(dir, GOBB_PROBE_ERROR_OPEN);
+    check_open_error(data_path, GOBB_PROBE_ERROR_OPEN);
+
+    if (create_file(data_path, 1, (long)sizeof(file_magic) + STATISTICS_SIZE + TABLE_SIZE) != 0 ||
+        create_file(legacy_path, 0, STATISTICS_SIZE + TABLE_SIZE) != 0 ||
+        create_file(short_path, 1, (long)sizeof(file_magic) + STATISTICS_SIZE) != 0) {
+        perror("create a file");
+        return 1;
+    }
+    check_open_error(legacy_path, GOBB_PROBE_ERROR_LEGACY_FORMAT);
+    check_open_error(short_path, GOBB_PROBE_ERROR_FORMAT);
+
+    probe = gobb_probe_open_with_error(data_path, &error);
+    CHECK(probe != NULL);
+    CHECK(error == GOBB_PROBE_ERROR_NONE);
+    if (probe != NULL) {
+        check_probe(probe);
+        gobb_probe_close(probe);
+    }
+
+    /* The latest generation in a directory is opened. */
+    probe = gobb_probe_open(dir);
+    CHECK(probe != NULL);
+    gobb_probe_close(probe);
+    gobb_probe_close(NULL);
+
+    unlink(data_path);
+    unlink(legacy_path);
+    unlink(short_path);
+    rmdir(dir);
+
+    if (failure_nums > 0) {
+        fprintf(stderr, "%d checks failed\n", failure_nums);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,205 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "analysis_data_file_handler.hpp"
+#include "gobb_query_scanner.hpp"
+#include "mapped_file.hpp"
+#include "position_query.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+using namespace gobb_analyzer;
+
+/// The maximum number of threads.
+constexpr unsigned long MaxThreadNums = 1024u;
+
+//
+// Print the help message.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_query [OPTION...] QUERY" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c          print the number of matching positions only" << std::endl;
+    std::cout << "  -d DIR      map an analysis data file in DIR (default: .)" << std::endl;
+    std::cout << "  -g NUM      map analysis data file of the NUM'th generation" << std::endl;
+    std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -j NUM      use NUM threads (default: the number of CPUs)" << std::endl;
+    std::cout << "  -n NUM      print at most NUM positions (default: no limit)" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example: gobb_query 'onboard(blue large) = 2 and status = lost and turn <= 5'" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_query --help' ..." message.
+//
+void print_try_help_message(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string dataDir;
+    unsigned long generation = 0u;
+    unsigned long limit = 0u;
+    bool opt_c = false;
+    bool opt_d = false;
+    bool opt_g = false;
+    unsigned long threadNums = std::thread::hardware_concurrency();
+    if (threadNums == 0u) {
+        threadNums = 1u;
+    }
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'c') {
+            opt_c = true;
+            optind++;
+        } else if (ch == 'd' || ch == 'g' || ch == 'j' || ch == 'n') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'd') {
+                opt_d = true;
+                dataDir = std::string(optarg);
+            } else if (ch == 'g') {
+                opt_g = true;
+                if (!string_to_uint(optarg, generation) || generation > MaxGeneration) {
+                    std::cerr << argv[0] << ": invalid generation '" << optarg << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'j') {
+                if (!string_to_uint(optarg, threadNums) || threadNums < 1u || threadNums > MaxThreadNums) {
+                    std::cerr << argv[0] << ": invalid number of threads '" << optarg << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            } else {
+                if (!string_to_uint(optarg, limit) || limit < 1u) {
+                    std::cerr << argv[0] << ": invalid number of positions '" << optarg << "'" << std::endl;
+                    print_try_help_message(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_try_help_message(argv[0]);
+            return 1;
+        }
+    }
+
+    //
+    // The rest of the arguments are joined into a query.
+    //
+    if (optind >= argc) {
+        std::cerr << argv[0] << ": missing query" << std::endl;
+        print_try_help_message(argv[0]);
+        return 1;
+    }
+    std::string text;
+    for (int i = optind; i < argc; i++) {
+        if (!text.empty()) {
+            text += " ";
+        }
+        text += argv[i];
+    }
+    PositionQuery query;
+    std::string error;
+    if (!query.parse(text, error)) {
+        std::cerr << argv[0] << ": invalid query, " << error << std::endl;
+        return 1;
+    }
+
+    //
+    // Maps an analysis data file, and scans it.
+    //
+    try {
+        AnalysisDataFileHandler fileHandler;
+        if (opt_d) {
+            fileHandler = AnalysisDataFileHandler(dataDir);
+        }
+        MappedFile mapping;
+        AnalysisStatistics stats;
+        if (opt_g) {
+            if (!fileHandler.map(static_cast<Generation>(generation), stats, mapping)) {
+                std::cerr << "failed to map the analysis data file of the specified generation" << std::endl;
+                return 1;
+            }
+        } else {
+            if (fileHandler.map_latest(stats, mapping) == InvalidGeneration) {
+                std::cerr << "failed to map an analysis data file" << std::endl;
+                return 1;
+            }
+        }
+
+        std::ios::sync_with_stdio(false);
+        GobbQueryScanner scanner(query, AnalysisDataFileHandler::mapped_table(mapping), static_cast<int>(threadNums));
+        std::uint64_t matchNums = scanner.scan(std::cout, limit, opt_c);
+        if (opt_c) {
+            std::cout << matchNums << std::endl;
+        }
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "gobb_query_scanner.hpp"
+#include "run_threads.hpp"
+
+//
+// Class GobbQueryScanner.
+//
+GobbQueryScanner::GobbQueryScanner(const PositionQuery& query, const AnalysisData* table, int threadNums)
+    : query_(query),
+      table_(table),
+      threadNums_(threadNums < 1 ? 1 : threadNums),
+      countOnly_(false),
+      chunkNums_(0u),
+      nextChunk_(0u),
+      writtenChunks_(0u),
+      stopped_(false),
+      results_(),
+      mutex_(),
+      chunkDone_(),
+      chunkWritten_() {
+}
+
+std::uint64_t GobbQueryScanner::scan(std::ostream& out, std::uint64_t limit, bool countOnly) {
+    constexpr PositionId chunkSize = PieceQuadCombinationNums * PieceQuadCombinationNums;
+    countOnly_ = countOnly;
+    chunkNums_ = (AnalysisDataTableSize + chunkSize - 1u) / chunkSize;
+    nextChunk_ = 0u;
+    writtenChunks_ = 0u;
+    stopped_ = false;
+    results_.assign(chunkNums_, ChunkResult {false, 0u, {}});
+
+    //
+    // Chunks are written in order by the calling thread, while the workers scan the following chunks.
+    // The thread 0 is the writer, and the others are the workers.
+    //
+    std::uint64_t matchNums = 0u;
+    bool noWorkers = false;
+    auto writer = [&]() {
+        for (std::size_t chunk = 0u; chunk < chunkNums_ && !noWorkers; chunk++) {
+            ChunkResult result;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                chunkDone_.wait(lock, [&] { return results_[chunk].done; });
+                result.matchNums = results_[chunk].matchNums;
+                result.ids.swap(results_[chunk].ids);
+            }
+
+            if (limit > 0u && matchNums + result.matchNums >= limit) {
+                result.matchNums = limit - matchNums;
+            }
+            if (!countOnly_) {
+                for (std::uint64_t i = 0u; i < result.matchNums; i++) {
+                    std::uint32_t id = result.ids[i];
+                    AnalysisData data = table_[id];
+                    out << id << " " << analysisStatus_to_string(status_of_analysisData(data)) << " "
+                        << turn_of_analysisData(data) << "\n";
+                }
+                out << std::flush;
+            }
+            matchNums += result.matchNums;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            writtenChunks_ = chunk + 1u;
+            if (limit > 0u && matchNums >= limit) {
+                stopped_ = true;
+            }
+            chunkWritten_.notify_all();
+            if (stopped_) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        chunkWritten_.notify_all();
+    };
+
+    run_threads(threadNums_ + 1, [&](int i) {
+        if (i == 0) {
+            writer();
+        } else {
+            worker();
+        }
+    }, [&](int missingNums) { noWorkers = (missingNums == threadNums_); });
+    results_.clear();
+    return matchNums;
+}
+
+void GobbQueryScanner::worker() {
+    //
+    // A worker doesn't go ahead of the written chunks too far, so that results waiting to be written don't
+    // consume too much memory.
+    //
+    std::size_t window = static_cast<std::size_t>(threadNums_) * 4u;
+    for (;;) {
+        std::size_t chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopped_ || nextChunk_ >= chunkNums_) {
+                return;
+            }
+            chunk = nextChunk_++;
+            chunkWritten_.wait(lock, [&] { return stopped_ || countOnly_ || chunk < writtenChunks_ + window; });
+            if (stopped_) {
+                return;
+            }
+        }
+
+        ChunkResult result {false, 0u, {}};
+        scan_chunk(chunk, result);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_[chunk].matchNums = result.matchNums;
+        results_[chunk].ids.swap(result.ids);
+        results_[chunk].done = true;
+        chunkDone_.notify_all();
+    }
+}
+
+void GobbQueryScanner::scan_chunk(std::size_t chunk, ChunkResult& result) {
+    constexpr PositionId quadNums = PieceQuadCombinationNums;
+    using Truth = PositionQuery::Truth;
+
+    //
+    // The quad index of large pieces is fixed in a chunk, and that of medium pieces is fixed in a row of
+    // the chunk.  Rows which never match are skipped without reading the table.
+    //
+    PositionQuery::Context context {{-1, -1, static_cast<int>(chunk)}, -1, true};
+    Truth chunkTruth = query_.evaluate(context);
+    if (chunkTruth == Truth::False) {
+        return;
+    }
+
+    for (PositionId m = 0u; m < quadNums; m++) {
+        PositionId base = (chunk * quadNums + m) * quadNums;
+        if (base >= AnalysisDataTableSize) {
+            break;
+        }
+        context.quads[1] = static_cast<int>(m);
+        context.quads[0] = -1;
+        Truth rowTruth = (chunkTruth == Truth::True) ? Truth::True : query_.evaluate(context);
+        if (rowTruth == Truth::False) {
+            continue;
+        }
+
+        PositionId endS = (AnalysisDataTableSize - base < quadNums) ? AnalysisDataTableSize - base : quadNums;
+        const AnalysisData* row = table_ + base;
+        for (PositionId s = 0u; s < endS; s++) {
+            AnalysisData data = row[s];
+            if (status_of_analysisData(data) == AnalysisStatus::Transformed) {
+                continue;
+            }
+            Truth truth = rowTruth;
+            if (truth != Truth::True) {
+                truth = query_.evaluate_data(data);
+                if (truth == Truth::Unknown) {
+                    context.quads[0] = static_cast<int>(s);
+                    context.data = data;
+                    truth = query_.evaluate(context);
+                    context.data = -1;
+                }
+            }
+            if (truth == Truth::True) {
+                result.matchNums++;
+                if (!countOnly_) {
+                    result.ids.push_back(static_cast<std::uint32_t>(base + s));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_QUERY_SCANNER_HPP
+#define GOBB_QUERY_SCANNER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include "analyzer.hpp"
+#include "position_query.hpp"
+
+using namespace gobb_analyzer;
+
+//
+// Class GobbQueryScanner.
+//
+// It scans a mapped table of analysis data for positions matching a query.  The table is divided into
+// chunks of the same quad index of large pieces, and threads take chunks in order.  Matching positions are
+// written in the order of position IDs as soon as the preceding chunks are written, so that the output
+// is streamed and it is the same for any number of threads.
+//
+class GobbQueryScanner {
+public:
+    GobbQueryScanner() = delete;
+    GobbQueryScanner(const PositionQuery& query, const AnalysisData* table, int threadNums);
+    GobbQueryScanner(const GobbQueryScanner& other) = delete;
+    GobbQueryScanner(GobbQueryScanner&& other) = delete;
+    ~GobbQueryScanner() = default;
+    GobbQueryScanner& operator=(const GobbQueryScanner& other) = delete;
+    GobbQueryScanner& operator=(GobbQueryScanner&& other) = delete;
+
+    // Write matching positions as lines of "ID STATUS TURNS" to `out`, up to `limit` positions (0 means no
+    // limit).  If `countOnly` is true, nothing is written.  Returns the number of matching positions.
+    std::uint64_t scan(std::ostream& out, std::uint64_t limit, bool countOnly);
+
+private:
+    // Matching positions of a chunk.
+    struct ChunkResult {
+        bool done;
+        std::uint64_t matchNums;
+        std::vector<std::uint32_t> ids;
+    };
+
+    void worker();
+    void scan_chunk(std::size_t chunk, ChunkResult& result);
+
+    const PositionQuery& query_;
+    const AnalysisData* table_;
+    int threadNums_;
+    bool countOnly_;
+    std::size_t chunkNums_;
+    std::size_t nextChunk_;
+    std::size_t writtenChunks_;
+    bool stopped_;
+    std::vector<ChunkResult> results_;
+    std::mutex mutex_;
+    std::condition_variable chunkDone_;
+    std::condition_variable chunkWritten_;
+};
+
+#endif // GOBB_QUERY_SCANNER_HPP
@@ -0,0 +1,296 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "analysis_data_file_handler.hpp"
+#include "hybrid_prober.hpp"
+#include "inspector.hpp"
+#include "inspector_loader.hpp"
+#include "mapped_file.hpp"
+#include "search_solver.hpp"
+#include "string_to_uint.hpp"
+#include "version.hpp"
+
+using namespace gobb_analyzer;
+
+/// The maximum size of the transposition table in MiB.
+constexpr unsigned long MaxTableMegabytes = 65536u;
+
+//
+// Print the help message.
+//
+void print_help_message() {
+    std::cout << "Usage: gobb_solve [OPTION...] [POSITION...]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c          check the results against an analysis data file" << std::endl;
+    std::cout << "  -d DIR      read data files in DIR (default: .)" << std::endl;
+    std::cout << "  -g NUM      check against analysis data file of the NUM'th generation" << std::endl;
+    std::cout << "              (default: the latest generation stored)" << std::endl;
+    std::cout << "  -l          search until the late-game database is reached" << std::endl;
+    std::cout << "  -m NUM      use a transposition table of NUM MiB (default: 64)" << std::endl;
+    std::cout << "  -n NUM      search at most NUM turns (default: 30)" << std::endl;
+    std::cout << "  -s NUM      search at most NUM positions with '-l' (default: " << HybridProberDefaultNodeNums
+              << ")" << std::endl;
+    std::cout << "  --help      print this help, then exit" << std::endl;
+    std::cout << "  --version   print version information, then exit" << std::endl;
+}
+
+//
+// Print the version information.
+//
+void print_version() {
+    std::cout << "Gobb Analyzer version " << GOBB_ANALYZER_VERSION << std::endl;
+}
+
+//
+// Print "try 'gobb_solve --help' ..." message.
+//
+void print_hint(const char* argv0) {
+    std::cout << "Try '" << argv0 << " --help' for more information." << std::endl;
+}
+
+//
+// Solve a position and print the result in a line.  The position is searched by `solver` up to `maxDepth`
+// turns, or probed by `prober` if it is given.  If `inspector` is given, the result is checked against
+// the table.  Returns false if the result differs from the table or the search is aborted.
+//
+bool solve_position(SearchSolver& solver, HybridProber* prober, const Inspector* inspector, PositionId posId,
+    int maxDepth) {
+    PositionInspectionResult result;
+    std::uint64_t nodeNums;
+    bool completed = true;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    if (prober != nullptr) {
+        completed = prober->probe(posId, result);
+        nodeNums = prober->node_nums();
+    } else {
+        std::uint64_t startNodeNums = solver.node_nums();
+        result = solver.solve(posId, maxDepth);
+        nodeNums = solver.node_nums() - startNodeNums;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    if (!completed) {
+        std::cout << posId << " aborted nodes " << nodeNums << " ms " << elapsed.count() << "\n";
+        return false;
+    }
+    if (result.analysisStatus == AnalysisStatus::Unfixed) {
+        result.turn = 0u;
+    }
+    std::cout << posId << " " << analysisStatus_to_string(result.analysisStatus) << " " << result.turn
+              << " nodes " << nodeNums << " ms " << elapsed.count();
+    if (inspector == nullptr) {
+        std::cout << "\n";
+        return true;
+    }
+
+    //
+    // The search doesn't prove a result beyond the maximum depth, and the table marks positions unreachable
+    // from the initial position with Contradictory if they are filtered out.
+    //
+    PositionInspectionResult expected = inspector->inspect_position(posId);
+    std::cout << " table " << analysisStatus_to_string(expected.analysisStatus) << " " << expected.turn;
+    if (expected.analysisStatus == AnalysisStatus::Unfixed ||
+        ((expected.analysisStatus == AnalysisStatus::Won || expected.analysisStatus == AnalysisStatus::Lost ||
+        expected.analysisStatus == AnalysisStatus::LostStalemate) && expected.turn > maxDepth)) {
+        expected.analysisStatus = AnalysisStatus::Unfixed;
+        expected.turn = 0u;
+    }
+    if (expected.analysisStatus == AnalysisStatus::Contradictory &&
+        result.analysisStatus != AnalysisStatus::Contradictory) {
+        std::cout << " unreachable\n";
+        return true;
+    }
+    if (expected.analysisStatus != result.analysisStatus || expected.turn != result.turn) {
+        std::cout << " mismatch\n";
+        return false;
+    }
+    std::cout << " ok\n";
+    return true;
+}
+
+//
+// Main.
+//
+int main(int argc, char* argv[]) {
+    //
+    // Parses command line arguments.
+    //
+    std::string dataDir;
+    unsigned long generation = 0u;
+    unsigned long tableMegabytes = 64u;
+    unsigned long maxDepth = 30u;
+    unsigned long maxNodeNums = HybridProberDefaultNodeNums;
+    bool opt_c = false;
+    bool opt_d = false;
+    bool opt_g = false;
+    bool opt_l = false;
+
+    int optind = 1;
+    while (optind < argc) {
+        if (argv[optind][0] != '-' || argv[optind][1] == '\0') {
+            break;
+        }
+
+        char ch = argv[optind][1];
+        if (ch == '-' && argv[optind][2] == '\0') {
+            optind++;
+            break;
+        } else if (ch == 'c') {
+            opt_c = true;
+            optind++;
+        } else if (ch == 'l') {
+            opt_l = true;
+            optind++;
+        } else if (ch == 'd' || ch == 'g' || ch == 'm' || ch == 'n' || ch == 's') {
+            const char* optarg;
+            if (argv[optind][2] == '\0') {
+                if (optind + 1 >= argc) {
+                    std::cerr << argv[0] << ": missing argument to option '-" << ch << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+                optarg = argv[optind + 1];
+                optind += 2;
+            } else {
+                optarg = argv[optind] + 2;
+                optind++;
+            }
+
+            if (ch == 'd') {
+                opt_d = true;
+                dataDir = std::string(optarg);
+            } else if (ch == 'g') {
+                opt_g = true;
+                if (!string_to_uint(optarg, generation) || generation > MaxGeneration) {
+                    std::cerr << argv[0] << ": invalid generation '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'm') {
+                if (!string_to_uint(optarg, tableMegabytes) || tableMegabytes < 1u ||
+                    tableMegabytes > MaxTableMegabytes) {
+                    std::cerr << argv[0] << ": invalid table size '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else if (ch == 'n') {
+                if (!string_to_uint(optarg, maxDepth) || maxDepth > static_cast<unsigned long>(MaxSearchDepth)) {
+                    std::cerr << argv[0] << ": invalid number of turns '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            } else {
+                if (!string_to_uint(optarg, maxNodeNums) || maxNodeNums < 1u) {
+                    std::cerr << argv[0] << ": invalid number of positions '" << optarg << "'" << std::endl;
+                    print_hint(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (std::strcmp(argv[optind], "--help") == 0) {
+            print_help_message();
+            return 0;
+        } else if (std::strcmp(argv[optind], "--version") == 0) {
+            print_version();
+            return 0;
+        } else {
+            std::cerr << argv[0] << ": invalid option '-" << ch << "'" << std::endl;
+            print_hint(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((opt_d && !opt_c && !opt_l) || (opt_g && !opt_c)) {
+        std::cerr << argv[0] << ": '-d' option needs '-c' or '-l', and '-g' option needs '-c'" << std::endl;
+        print_hint(argv[0]);
+        return 1;
+    }
+
+    std::vector<PositionId> posIds;
+    for (int i = optind; i < argc; i++) {
+        PositionId posId;
+        if (!string_to_uint(argv[i], posId) || !is_valid_positionId(posId)) {
+            std::cerr << argv[0] << ": invalid position '" << argv[i] << "'" << std::endl;
+            print_hint(argv[0]);
+            return 1;
+        }
+        posIds.push_back(posId);
+    }
+
+    //
+    // Solves the positions given as arguments, or read from standard in.
+    //
+    try {
+        AnalysisDataFileHandler fileHandler;
+        if (opt_d) {
+            fileHandler = AnalysisDataFileHandler(dataDir);
+        }
+        HybridProber prober;
+        if (opt_l) {
+            if (!prober.load(fileHandler)) {
+                std::cerr << "failed to load the late-game database" << std::endl;
+                return 1;
+            }
+            prober.set_max_node_nums(maxNodeNums);
+        }
+
+        Inspector inspector;
+        MappedFile mapping;
+        if (opt_c) {
+            std::string errorMessage;
+            Generation dataGeneration = opt_g ? static_cast<Generation>(generation) : InvalidGeneration;
+            if (!load_inspector_data(fileHandler, InspectorDataSource::AnalysisData, dataGeneration, true, inspector,
+                    mapping, errorMessage)) {
+                std::cerr << errorMessage << std::endl;
+                return 1;
+            }
+        }
+
+        std::ios::sync_with_stdio(false);
+        SearchSolver solver(opt_l ? 1u : tableMegabytes * 1024u * 1024u / 8u);
+        HybridProber* hybridProber = opt_l ? &prober : nullptr;
+        const Inspector* checker = opt_c ? &inspector : nullptr;
+        int depth = opt_l ? static_cast<int>(MaxTurn) : static_cast<int>(maxDepth);
+        bool success = true;
+        if (!posIds.empty()) {
+            for (PositionId posId: posIds) {
+                success = solve_position(solver, hybridProber, checker, posId, depth) && success;
+            }
+        } else {
+            std::string word;
+            while (std::cin >> word) {
+                PositionId posId;
+                if (!string_to_uint(word, posId) || !is_valid_positionId(posId)) {
+                    std::cerr << "invalid position '" << word << "'" << std::endl;
+                    success = false;
+                    continue;
+                }
+                success = solve_position(solver, hybridProber, checker, posId, depth) && success;
+            }
+        }
+        std::cout << std::flush;
+        return success ? 0 : 1;
+    } catch (std::exception& err) {
+        std::cerr << "an exception raised, " << err.what() <<  std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,252 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include "hybrid_prober.hpp"
+#include "search_solver.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(AnalysisDataTableSize <= 0xffff'ffffu, "minimized position IDs must fit keys of the nodes");
+
+//
+// Class HybridProber.
+//
+HybridProber::HybridProber()
+    : offBoardPieceNums_(-1),
+      ids_(),
+      data_(),
+      maxNodeNums_(HybridProberDefaultNodeNums),
+      nodes_(),
+      indexes_(),
+      children_(),
+      nodeNums_(0u) {
+}
+
+bool HybridProber::load(ExportDataIOHandler& handler) {
+    AnalysisStatistics stats;
+    int offBoardPieceNums;
+    std::vector<std::uint32_t> ids;
+    std::vector<AnalysisData> data;
+    if (!handler.load_late_game(stats, offBoardPieceNums, ids, data)) {
+        return false;
+    }
+    use_late_game(offBoardPieceNums, std::move(ids), std::move(data));
+    return true;
+}
+
+void HybridProber::use_late_game(int offBoardPieceNums, std::vector<std::uint32_t>&& ids,
+    std::vector<AnalysisData>&& data) {
+    offBoardPieceNums_ = offBoardPieceNums;
+    ids_ = std::move(ids);
+    data_ = std::move(data);
+}
+
+int HybridProber::off_board_piece_nums() const noexcept {
+    return offBoardPieceNums_;
+}
+
+std::size_t HybridProber::byte_size() const noexcept {
+    return ids_.size() * sizeof(std::uint32_t) + data_.size() * sizeof(AnalysisData);
+}
+
+void HybridProber::set_max_node_nums(std::size_t nodeNums) noexcept {
+    maxNodeNums_ = nodeNums;
+}
+
+bool HybridProber::probe(PositionId id, PositionInspectionResult& result) {
+    result = PositionInspectionResult {id, 0u, AnalysisStatus::Invalid};
+    nodeNums_ = 0u;
+    if (!is_valid_positionId(id)) {
+        return true;
+    }
+
+    Position pos(id);
+    if (pos.off_board_piece_nums() <= offBoardPieceNums_) {
+        AnalysisData data = lookup(pos.minimize_id());
+        result.turn = turn_of_analysisData(data);
+        result.analysisStatus = status_of_analysisData(data);
+        return true;
+    }
+
+    //
+    // Collects positions reachable from the root until the database is reached, in the breadth-first order.
+    //
+    node_of(pos, pos.minimize_id());
+
+    bool aborted = false;
+    for (std::size_t i = 0u; i < nodes_.size(); i++) {
+        if (nodes_[i].expanded) {
+            continue;
+        }
+        if (nodes_.size() > maxNodeNums_) {
+            aborted = true;
+            break;
+        }
+
+        Position children[MaxMoveNums];
+        Position node(static_cast<PositionId>(nodes_[i].id));
+        int childNums = SearchSolver::generate_children(node, children);
+        std::uint32_t firstChild = static_cast<std::uint32_t>(children_.size());
+        for (int j = 0; j < childNums; j++) {
+            std::uint32_t index = node_of(children[j], children[j].minimize_id());
+            children_.push_back(index);
+        }
+        nodes_[i].firstChild = firstChild;
+        nodes_[i].childNums = static_cast<std::uint8_t>(childNums);
+        nodes_[i].expanded = true;
+
+        //
+        // The root is won in a turn if the opponent loses at once after a move, and no more search is needed.
+        //
+        if (i == 0u) {
+            for (int j = 0; j < childNums; j++) {
+                const Node& child = nodes_[children_[firstChild + j]];
+                if (child.status == AnalysisStatus::Lost && child.turn == 0u) {
+                    nodes_[0].status = AnalysisStatus::Won;
+                    nodes_[0].turn = 1u;
+                    nodes_[0].childNums = 0u;
+                    break;
+                }
+            }
+            if (nodes_[0].status == AnalysisStatus::Won) {
+                break;
+            }
+        }
+    }
+    nodeNums_ = nodes_.size();
+
+    if (!aborted) {
+        solve_nodes();
+        result.turn = nodes_[0].turn;
+        result.analysisStatus = nodes_[0].status;
+    }
+
+    //
+    // The memory for the search is released, since it may be large.
+    //
+    nodes_ = std::vector<Node>();
+    indexes_ = std::unordered_map<std::uint32_t, std::uint32_t>();
+    children_ = std::vector<std::uint32_t>();
+    return !aborted;
+}
+
+std::size_t HybridProber::node_nums() const noexcept {
+    return nodeNums_;
+}
+
+AnalysisData HybridProber::lookup(PositionId id) const noexcept {
+    //
+    // Positions missing in the database are contradictory.
+    //
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end() || *it != id) {
+        return to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+    }
+    return data_[it - ids_.begin()];
+}
+
+std::uint32_t HybridProber::node_of(const Position& pos, PositionId id) {
+    auto it = indexes_.find(static_cast<std::uint32_t>(id));
+    if (it != indexes_.end()) {
+        return it->second;
+    }
+
+    //
+    // Positions in the database and positions where the game is over are resolved at once.  The others
+    // are expanded later.
+    //
+    Node node {static_cast<std::uint32_t>(id), 0u, 0u, true, AnalysisStatus::Unfixed, 0u};
+    if (pos.off_board_piece_nums() <= offBoardPieceNums_) {
+        AnalysisData data = lookup(id);
+        node.status = status_of_analysisData(data);
+        node.turn = turn_of_analysisData(data);
+    } else {
+        SearchSolver::NodeKind kind = SearchSolver::classify(pos);
+        if (kind == SearchSolver::NodeKind::Contradictory) {
+            node.status = AnalysisStatus::Contradictory;
+        } else if (kind == SearchSolver::NodeKind::Lost) {
+            node.status = AnalysisStatus::Lost;
+        } else {
+            node.expanded = false;
+        }
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(node);
+    indexes_.emplace(static_cast<std::uint32_t>(id), index);
+    return index;
+}
+
+void HybridProber::solve_nodes() {
+    std::vector<std::uint32_t> pendings;
+    Turn maxResolvedTurn = 0u;
+    for (std::size_t i = 0u; i < nodes_.size(); i++) {
+        const Node& node = nodes_[i];
+        if (node.childNums > 0u) {
+            pendings.push_back(static_cast<std::uint32_t>(i));
+        } else if (node.status != AnalysisStatus::Unfixed && node.turn > maxResolvedTurn) {
+            maxResolvedTurn = node.turn;
+        }
+    }
+
+    //
+    // A position is won in `turn` turns if a move leads to a position lost in less turns, and lost in
+    // `turn` turns if all moves lead to positions won in less turns.  Since positions resolved in this
+    // round have `turn` turns, they don't affect the others in the same round.
+    //
+    for (Turn turn = 1u; !pendings.empty() && turn < MaxTurn; turn++) {
+        std::size_t pendingNums = 0u;
+        bool resolved = false;
+
+        for (std::uint32_t index: pendings) {
+            Node& node = nodes_[index];
+            bool won = false;
+            bool allWon = true;
+            for (std::uint32_t j = 0u; j < node.childNums && !won; j++) {
+                const Node& child = nodes_[children_[node.firstChild + j]];
+                if (child.status == AnalysisStatus::Lost || child.status == AnalysisStatus::LostStalemate) {
+                    won = won || child.turn < turn;
+                    allWon = false;
+                } else if (child.status != AnalysisStatus::Won && child.status != AnalysisStatus::WonStalemate) {
+                    allWon = false;
+                } else if (child.turn >= turn) {
+                    allWon = false;
+                }
+            }
+
+            if (won) {
+                node.status = AnalysisStatus::Won;
+                node.turn = turn;
+                resolved = true;
+            } else if (allWon) {
+                node.status = AnalysisStatus::Lost;
+                node.turn = turn;
+                resolved = true;
+            } else {
+                pendings[pendingNums++] = index;
+            }
+        }
+        pendings.resize(pendingNums);
+
+        if (nodes_[0].status != AnalysisStatus::Unfixed || (!resolved && turn > maxResolvedTurn)) {
+            break;
+        }
+    }
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,208 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_HYBRID_PROBER_HPP
+#define GOBB_ANALYZER_HYBRID_PROBER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "analyzer.hpp"
+#include "inspector.hpp"
+#include "position.hpp"
+
+///
+/// @file   hybrid_prober.hpp
+/// @brief  Define `HybridProber` class, which probes a late-game database and searches positions above it.
+///
+namespace gobb_analyzer {
+
+/// The memory taken by a search for a position, in bytes on average.
+constexpr std::size_t HybridProberNodeSize = 200u;
+
+/// The memory a search may take by default, in bytes.
+constexpr std::size_t HybridProberDefaultMemorySize = std::size_t(256u) << 20;
+
+/// The maximum number of positions searched for a position by default.
+constexpr std::size_t HybridProberDefaultNodeNums = HybridProberDefaultMemorySize / HybridProberNodeSize;
+
+///
+/// A prober with a late-game database and search.
+///
+/// The late-game database written by `gobb_export -t lategame` contains analysis data of positions with
+/// a few pieces off the board.  Since a move never increases the number of pieces off the board, positions
+/// after moves from a position in the database are also in the database.
+///
+/// A position in the database is answered by a lookup.  For another position, the prober collects
+/// positions reachable from it until every path reaches the database, and then solves them by retrograde
+/// analysis, in the same way as `Analyzer`.  Thus the result is the same as that of the whole table.
+/// The more pieces off the board the database covers, the larger it is, and the less positions are
+/// searched.
+///
+/// The search grows quickly with the number of pieces off the board beyond the database: up to dozens
+/// of positions for one more piece, and millions of positions for three more pieces.  Positions far from
+/// the database, such as the initial position, reach most of the table and cannot be answered within
+/// a practical limit of positions; use the whole table or an opening database for them.
+///
+class HybridProber {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// It constructs a prober without a database, which covers no position.
+    ///
+    HybridProber();
+
+    HybridProber(const HybridProber& other) = delete;
+    HybridProber(HybridProber&& other) = delete;
+    HybridProber& operator=(const HybridProber& other) = delete;
+    HybridProber& operator=(HybridProber&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~HybridProber() = default;
+
+    ///
+    /// Load a late-game database written by `gobb_export -t lategame`.
+    ///
+    /// @param   handler  an I/O handler to load the database.
+    /// @return  true upon success.
+    ///
+    bool load(ExportDataIOHandler& handler);
+
+    ///
+    /// Use a late-game database given in memory.
+    ///
+    /// @param   offBoardPieceNums  the maximum number of pieces off the board of the entries.
+    /// @param   ids                minimized position IDs of the entries, in ascending order.
+    /// @param   data               analysis data of the entries.
+    ///
+    /// Positions with `offBoardPieceNums` pieces or less off the board missing in `ids` are regarded as
+    /// contradictory.
+    ///
+    void use_late_game(int offBoardPieceNums, std::vector<std::uint32_t>&& ids, std::vector<AnalysisData>&& data);
+
+    ///
+    /// Return the maximum number of pieces off the board of positions in the database.
+    ///
+    /// @return  the number of pieces, or -1 if no database is used.
+    ///
+    int off_board_piece_nums() const noexcept;
+
+    ///
+    /// Return the size of the database in memory.
+    ///
+    /// @return  the number of bytes.
+    ///
+    std::size_t byte_size() const noexcept;
+
+    ///
+    /// Set the maximum number of positions searched for a position.
+    ///
+    /// @param   nodeNums  the number of positions.
+    ///
+    /// A search takes about `HybridProberNodeSize` bytes of memory for a position.  The default is
+    /// `HybridProberDefaultNodeNums`, which keeps a search within `HybridProberDefaultMemorySize`.
+    ///
+    void set_max_node_nums(std::size_t nodeNums) noexcept;
+
+    ///
+    /// Probe a position.
+    ///
+    /// @param   id      a position ID.
+    /// @param   result  the status and the number of remaining turns of the position.
+    /// @return  true upon success, or false if the search exceeds the maximum number of positions.
+    ///
+    /// It throws `std::bad_alloc` if it fails to allocate memory for the search.
+    ///
+    bool probe(PositionId id, PositionInspectionResult& result);
+
+    ///
+    /// Return the number of positions searched for the last position probed.
+    ///
+    /// @return  the number of positions.  It is 0 if the position is in the database.
+    ///
+    std::size_t node_nums() const noexcept;
+
+private:
+    ///
+    /// A position in a search.
+    ///
+    struct Node {
+        std::uint32_t id;          ///< a minimized position ID.
+        std::uint32_t firstChild;  ///< the index of the first child in `children_`.
+        std::uint8_t childNums;    ///< the number of children.
+        bool expanded;             ///< whether the children have been collected.
+        AnalysisStatus status;     ///< the status, `AnalysisStatus::Unfixed` until it is resolved.
+        Turn turn;                 ///< the number of remaining turns.
+    };
+
+    ///
+    /// Look up a position in the database.
+    ///
+    /// @param   id  a minimized position ID covered by the database.
+    /// @return  the analysis data of the position.
+    ///
+    AnalysisData lookup(PositionId id) const noexcept;
+
+    ///
+    /// Return the index of the node of a position, adding a new node if missing.
+    ///
+    /// @param   pos  a position.
+    /// @param   id   the minimized position ID of `pos`.
+    /// @return  the index of the node.
+    ///
+    std::uint32_t node_of(const Position& pos, PositionId id);
+
+    ///
+    /// Solve the nodes by retrograde analysis.
+    ///
+    /// It resolves positions won or lost in 1 turn, then in 2 turns, and so on, until the root is resolved
+    /// or no position is resolved any longer.  Positions left unresolved are draws.
+    ///
+    void solve_nodes();
+
+    /// The maximum number of pieces off the board of positions in the database, or -1.
+    int offBoardPieceNums_;
+
+    /// Minimized position IDs in the database, in ascending order.
+    std::vector<std::uint32_t> ids_;
+
+    /// Analysis data in the database.
+    std::vector<AnalysisData> data_;
+
+    /// The maximum number of positions searched for a position.
+    std::size_t maxNodeNums_;
+
+    /// Positions in the current search.  The first one is the root.
+    std::vector<Node> nodes_;
+
+    /// Indexes of nodes in `nodes_` keyed by minimized position IDs.
+    std::unordered_map<std::uint32_t, std::uint32_t> indexes_;
+
+    /// Indexes of children of the nodes.
+    std::vector<std::uint32_t> children_;
+
+    /// The number of positions searched for the last position probed.
+    std::size_t nodeNums_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_HYBRID_PROBER_HPP
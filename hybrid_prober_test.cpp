@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "hybrid_prober.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test HybridProber::probe() for positions in the database.
+//
+TEST(HybridProberTest, ProbeLateGame) {
+    Position pos(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::N},  {LocationId::W,   LocationId::SW},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    PositionId minId = pos.minimize_id();
+
+    HybridProber prober;
+    prober.use_late_game(8, {static_cast<std::uint32_t>(minId)}, {to_analysisData(false, 3u, AnalysisStatus::Won)});
+    ASSERT_EQ(prober.off_board_piece_nums(), 8);
+
+    PositionInspectionResult result;
+    ASSERT_TRUE(prober.probe(pos.id(), result));
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Won);
+    ASSERT_EQ(result.turn, 3u);
+    ASSERT_EQ(prober.node_nums(), 0u);
+
+    // Positions missing in the database are contradictory.
+    Position other(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::N},  {LocationId::W,   LocationId::S},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    ASSERT_TRUE(prober.probe(other.id(), result));
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Contradictory);
+}
+
+//
+// Test HybridProber::probe() for positions searched.
+//
+TEST(HybridProberTest, ProbeSearch) {
+    // The active player puts the large piece on NE.
+    Position pos(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::N},  {LocationId::W,   LocationId::SW},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    MoveResult moveResult = pos.move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::NE);
+    ASSERT_EQ(moveResult.status, MoveResultStatus::Success);
+    PositionId lostId = moveResult.position.minimize_id();
+
+    HybridProber prober;
+    prober.use_late_game(7, {static_cast<std::uint32_t>(lostId)}, {to_analysisData(false, 0u, AnalysisStatus::Lost)});
+    PositionInspectionResult result;
+    ASSERT_TRUE(prober.probe(pos.id(), result));
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Won);
+    ASSERT_EQ(result.turn, 1u);
+
+    // The search is aborted without the win.
+    prober.use_late_game(7, {}, {});
+    prober.set_max_node_nums(10u);
+    ASSERT_FALSE(prober.probe(pos.id(), result));
+}
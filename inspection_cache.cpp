@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <new>
+#include "inspection_cache.hpp"
+#include "position.hpp"
+
+namespace gobb_analyzer {
+
+//
+// Class InspectionCache.
+//
+InspectionCache::InspectionCache(const Inspector& inspector, std::size_t capacity)
+    : inspector_(inspector),
+      capacity_(capacity < 1u ? 1u : capacity),
+      entryList_(),
+      entryMap_(),
+      hitNums_(0u),
+      missNums_(0u),
+      prefetchIds_(),
+      stopping_(false),
+      mutex_(),
+      prefetchCondition_(),
+      prefetchThread_() {
+    entryMap_.reserve(capacity_);
+    prefetchThread_ = std::thread(&InspectionCache::prefetch_loop, this);
+}
+
+InspectionCache::~InspectionCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    prefetchCondition_.notify_one();
+    prefetchThread_.join();
+}
+
+std::shared_ptr<const InspectionCacheEntry> InspectionCache::inspect(PositionId id) {
+    if (!is_valid_positionId(id)) {
+        return create_entry(id);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<const InspectionCacheEntry> entry = find(id);
+        if (entry != nullptr) {
+            hitNums_++;
+            return entry;
+        }
+        missNums_++;
+    }
+
+    //
+    // The position is inspected without locking, so that the prefetching thread is not blocked.
+    //
+    std::shared_ptr<const InspectionCacheEntry> entry = create_entry(id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert(id, entry);
+    return entry;
+}
+
+void InspectionCache::prefetch_children(const InspectionCacheEntry& entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        prefetchIds_.clear();
+        for (const MoveInspectionResult& move: entry.moves) {
+            prefetchIds_.push_back(move.positionId);
+        }
+    }
+    prefetchCondition_.notify_one();
+}
+
+std::size_t InspectionCache::hit_nums() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hitNums_;
+}
+
+std::size_t InspectionCache::miss_nums() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return missNums_;
+}
+
+std::shared_ptr<const InspectionCacheEntry> InspectionCache::find(PositionId id) {
+    auto mapIterator = entryMap_.find(id);
+    if (mapIterator == entryMap_.end()) {
+        return nullptr;
+    }
+    entryList_.splice(entryList_.begin(), entryList_, mapIterator->second);
+    return mapIterator->second->second;
+}
+
+void InspectionCache::insert(PositionId id, const std::shared_ptr<const InspectionCacheEntry>& entry) {
+    //
+    // The position may have been inspected by another thread meanwhile.
+    //
+    if (find(id) != nullptr) {
+        return;
+    }
+
+    if (entryList_.size() >= capacity_) {
+        entryMap_.erase(entryList_.back().first);
+        entryList_.pop_back();
+    }
+    entryList_.emplace_front(id, entry);
+    entryMap_[id] = entryList_.begin();
+}
+
+std::shared_ptr<const InspectionCacheEntry> InspectionCache::create_entry(PositionId id) const {
+    std::shared_ptr<InspectionCacheEntry> entry = std::make_shared<InspectionCacheEntry>();
+    entry->position = inspector_.inspect_position(id);
+    entry->moves = inspector_.inspect_moves(id);
+    entry->moveBacks = inspector_.inspect_move_backs(id);
+    return entry;
+}
+
+void InspectionCache::prefetch_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        prefetchCondition_.wait(lock, [this] { return stopping_ || !prefetchIds_.empty(); });
+        if (stopping_) {
+            break;
+        }
+
+        PositionId id = prefetchIds_.back();
+        prefetchIds_.pop_back();
+        if (entryMap_.find(id) != entryMap_.end()) {
+            continue;
+        }
+
+        //
+        // Prefetching is only a hint, so that a failure to allocate an entry is ignored.
+        //
+        lock.unlock();
+        std::shared_ptr<const InspectionCacheEntry> entry;
+        try {
+            entry = create_entry(id);
+        } catch (std::bad_alloc&) {
+        }
+        lock.lock();
+        if (entry != nullptr) {
+            insert(id, entry);
+        }
+    }
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,185 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_INSPECTION_CACHE_HPP
+#define GOBB_ANALYZER_INSPECTION_CACHE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "inspector.hpp"
+
+///
+/// @file   inspection_cache.hpp
+/// @brief  Define `InspectionCache` class, an LRU cache of inspection results.
+///
+namespace gobb_analyzer {
+
+///
+/// Inspection results of a position.
+///
+struct InspectionCacheEntry {
+    PositionInspectionResult position;               ///< the result of `Inspector::inspect_position()`.
+    std::vector<MoveInspectionResult> moves;         ///< the result of `Inspector::inspect_moves()`.
+    std::vector<MoveInspectionResult> moveBacks;     ///< the result of `Inspector::inspect_move_backs()`.
+};
+
+///
+/// An LRU cache of inspection results, with background prefetching.
+///
+/// Entries are keyed by position IDs as they are given, not by minimized position IDs, because possible
+/// moves depend on the orientation of the board.  Positions after the possible moves of a position can be
+/// inspected by a background thread in advance, so that following a line of moves hits the cache.
+/// The cache may be used by threads at the same time.
+///
+class InspectionCache {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   inspector  an inspector, which must remain while the cache is used.
+    /// @param   capacity   the maximum number of entries.  If it is less than 1, 1 is used.
+    ///
+    /// It throws an exception if it fails to create the prefetching thread.
+    ///
+    InspectionCache(const Inspector& inspector, std::size_t capacity);
+
+    InspectionCache(const InspectionCache& other) = delete;
+    InspectionCache(InspectionCache&& other) = delete;
+    InspectionCache& operator=(const InspectionCache& other) = delete;
+    InspectionCache& operator=(InspectionCache&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    /// It stops the prefetching thread.
+    ///
+    virtual ~InspectionCache();
+
+    ///
+    /// Return inspection results of the specified position.
+    ///
+    /// @param   id  a position ID.
+    /// @return  inspection results.
+    ///
+    /// Results are inspected and added to the cache unless they are cached.  The least recently used entry
+    /// is discarded if the cache is full.  Results of an invalid position ID are not cached.
+    ///
+    std::shared_ptr<const InspectionCacheEntry> inspect(PositionId id);
+
+    ///
+    /// Inspect positions after the possible moves in the background.
+    ///
+    /// @param   entry  inspection results of a position.
+    ///
+    /// Positions requested before and not inspected yet are forgotten.
+    ///
+    void prefetch_children(const InspectionCacheEntry& entry);
+
+    ///
+    /// Return the number of lookups by inspect() found in the cache.
+    ///
+    /// @return  the number of hits.
+    ///
+    std::size_t hit_nums() const noexcept;
+
+    ///
+    /// Return the number of lookups by inspect() not found in the cache.
+    ///
+    /// @return  the number of misses.
+    ///
+    std::size_t miss_nums() const noexcept;
+
+private:
+    /// Unit tests access the internals through it.
+    friend class InspectionCacheTestPeer;
+
+    /// A list of cached entries, in the order of recent use.
+    using EntryList = std::list<std::pair<PositionId, std::shared_ptr<const InspectionCacheEntry>>>;
+
+    ///
+    /// Find an entry and mark it most recently used.  `mutex_` must be locked.
+    ///
+    /// @param   id  a position ID.
+    /// @return  the entry, or nullptr if not found.
+    ///
+    std::shared_ptr<const InspectionCacheEntry> find(PositionId id);
+
+    ///
+    /// Add an entry, discarding the least recently used one if the cache is full.  `mutex_` must be locked.
+    ///
+    /// @param   id     a position ID.
+    /// @param   entry  inspection results of the position.
+    ///
+    void insert(PositionId id, const std::shared_ptr<const InspectionCacheEntry>& entry);
+
+    ///
+    /// Inspect a position.
+    ///
+    /// @param   id  a position ID.
+    /// @return  inspection results.
+    ///
+    std::shared_ptr<const InspectionCacheEntry> create_entry(PositionId id) const;
+
+    ///
+    /// The main loop of the prefetching thread.
+    ///
+    void prefetch_loop();
+
+    /// Inspector.
+    const Inspector& inspector_;
+
+    /// The maximum number of entries.
+    std::size_t capacity_;
+
+    /// Cached entries, the most recently used first.
+    EntryList entryList_;
+
+    /// Iterators of `entryList_`, keyed by position IDs.
+    std::unordered_map<PositionId, EntryList::iterator> entryMap_;
+
+    /// The number of hits.
+    std::size_t hitNums_;
+
+    /// The number of misses.
+    std::size_t missNums_;
+
+    /// Position IDs to be prefetched.
+    std::vector<PositionId> prefetchIds_;
+
+    /// Whether the prefetching thread should stop.
+    bool stopping_;
+
+    /// Mutex for the members above.
+    mutable std::mutex mutex_;
+
+    /// Notified when position IDs to be prefetched are added, or the thread should stop.
+    std::condition_variable prefetchCondition_;
+
+    /// Prefetching thread.
+    std::thread prefetchThread_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_INSPECTION_CACHE_HPP
@@ -0,0 +1,241 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "inspection_cache.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+namespace gobb_analyzer {
+
+//
+// Access to the internals of InspectionCache for the tests.
+//
+class InspectionCacheTestPeer {
+public:
+    //
+    // Return the cached position IDs, the most recently used first.
+    //
+    static std::vector<PositionId> cached_ids(const InspectionCache& cache) {
+        std::lock_guard<std::mutex> lock(cache.mutex_);
+        std::vector<PositionId> ids;
+        for (const auto& entry: cache.entryList_) {
+            ids.push_back(entry.first);
+        }
+        return ids;
+    }
+
+    //
+    // Whether the prefetching thread has no position left to inspect.
+    //
+    static bool prefetch_drained(const InspectionCache& cache) {
+        std::lock_guard<std::mutex> lock(cache.mutex_);
+        return cache.prefetchIds_.empty();
+    }
+};
+
+} // namespace gobb_analyzer
+
+namespace {
+
+//
+// An I/O handler which gives an opening database kept in memory to an inspector.
+//
+class OpeningHandler: public ExportDataIOHandler {
+public:
+    OpeningHandler()
+        : opening_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t*, std::size_t) const { return false; }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+};
+
+//
+// Load an opening database which has the initial position and the positions after the first move.
+//
+void load_opening(Inspector& inspector) {
+    OpeningHandler handler;
+    handler.set_opening(InitialPositionId, AnalysisStatus::Unfixed, MaxTurn);
+    Position pos(InitialPositionId);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        for (LocationId dst: OnBoardLocationIds) {
+            MoveResult moveResult = pos.move(piece, LocationId::Out, dst);
+            if (moveResult.status == MoveResultStatus::Success) {
+                handler.set_opening(moveResult.position.id(), AnalysisStatus::Unfixed, MaxTurn);
+            }
+        }
+    }
+    ASSERT_TRUE(inspector.load_opening(handler));
+}
+
+//
+// Return distinct position IDs after the first move, which are not minimized.
+//
+std::vector<PositionId> first_positions(const Inspector& inspector) {
+    std::set<PositionId> ids;
+    for (const MoveInspectionResult& move: inspector.inspect_moves(InitialPositionId)) {
+        ids.insert(move.positionId);
+    }
+    return std::vector<PositionId>(ids.begin(), ids.end());
+}
+
+} // namespace
+
+//
+// Test that the least recently used entry is discarded, and that a hit marks an entry most recently used.
+//
+TEST(InspectionCacheTest, EvictionOrder) {
+    Inspector inspector;
+    load_opening(inspector);
+    std::vector<PositionId> ids = first_positions(inspector);
+    ASSERT_GE(ids.size(), 3u);
+
+    InspectionCache cache(inspector, 2u);
+    std::shared_ptr<const InspectionCacheEntry> first = cache.inspect(ids[0]);
+    cache.inspect(ids[1]);
+    ASSERT_EQ(cache.inspect(ids[0]), first);
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(cache), (std::vector<PositionId> {ids[0], ids[1]}));
+
+    cache.inspect(ids[2]);
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(cache), (std::vector<PositionId> {ids[2], ids[0]}));
+    ASSERT_EQ(cache.hit_nums(), 1u);
+    ASSERT_EQ(cache.miss_nums(), 3u);
+
+    cache.inspect(ids[1]);
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(cache), (std::vector<PositionId> {ids[1], ids[2]}));
+    ASSERT_EQ(cache.hit_nums(), 1u);
+    ASSERT_EQ(cache.miss_nums(), 4u);
+}
+
+//
+// Test that the cache never holds more entries than its capacity, and that invalid positions are not cached.
+//
+TEST(InspectionCacheTest, Capacity) {
+    Inspector inspector;
+    load_opening(inspector);
+    std::vector<PositionId> ids = first_positions(inspector);
+    ASSERT_GE(ids.size(), 5u);
+
+    InspectionCache cache(inspector, 3u);
+    for (PositionId id: ids) {
+        std::shared_ptr<const InspectionCacheEntry> entry = cache.inspect(id);
+        ASSERT_EQ(entry->position.positionId, id);
+        ASSERT_LE(InspectionCacheTestPeer::cached_ids(cache).size(), 3u);
+    }
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(cache),
+        (std::vector<PositionId> {ids[ids.size() - 1u], ids[ids.size() - 2u], ids[ids.size() - 3u]}));
+
+    cache.inspect(PositionIdNums);
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(cache).size(), 3u);
+
+    //
+    // A capacity less than 1 is taken as 1.
+    //
+    InspectionCache smallCache(inspector, 0u);
+    smallCache.inspect(ids[0]);
+    smallCache.inspect(ids[1]);
+    ASSERT_EQ(InspectionCacheTestPeer::cached_ids(smallCache), (std::vector<PositionId> {ids[1]}));
+}
+
+//
+// Test that the positions after the possible moves hit the cache once they are prefetched.
+//
+TEST(InspectionCacheTest, HitsAfterPrefetch) {
+    Inspector inspector;
+    load_opening(inspector);
+    std::vector<PositionId> ids = first_positions(inspector);
+
+    InspectionCache cache(inspector, 1024u);
+    std::shared_ptr<const InspectionCacheEntry> entry = cache.inspect(InitialPositionId);
+    ASSERT_FALSE(entry->moves.empty());
+    cache.prefetch_children(*entry);
+
+    //
+    // Wait until the prefetching thread inspects all the positions.
+    //
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (InspectionCacheTestPeer::cached_ids(cache).size() < ids.size() + 1u &&
+        std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(InspectionCacheTestPeer::prefetch_drained(cache));
+
+    for (PositionId id: ids) {
+        ASSERT_EQ(cache.inspect(id)->position.positionId, id);
+    }
+    ASSERT_EQ(cache.hit_nums(), ids.size());
+    ASSERT_EQ(cache.miss_nums(), 1u);
+}
+
+//
+// Test that the cache is destroyed cleanly while the prefetching thread is inspecting positions.
+//
+TEST(InspectionCacheTest, DestroyWhilePrefetching) {
+    Inspector inspector;
+    load_opening(inspector);
+
+    for (int i = 0; i < 100; i++) {
+        InspectionCache cache(inspector, 4u);
+        std::shared_ptr<const InspectionCacheEntry> entry = cache.inspect(InitialPositionId);
+        cache.prefetch_children(*entry);
+        if (i % 2 == 0) {
+            cache.inspect(entry->moves[0].positionId);
+        }
+    }
+}
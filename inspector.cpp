@@ -15,32 +15,220 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
 #include "inspector.hpp"
+#include "analysis_data_table.hpp"
+#include "best_move_table.hpp"
+#include "run_threads.hpp"
 #include "transformer.hpp"
+#include "wdl_analyzer.hpp"
 
 namespace gobb_analyzer {
 
+/// How many lookups ahead inspect_positions() prefetches analysis data.
+constexpr std::size_t InspectPrefetchDistance = 16u;
+
 //
 // Class Inspector.
 //
 Inspector::Inspector()
     : analysisDataTable_(nullptr),
-      statistics_() {
-    analysisDataTable_ = new AnalysisData [AnalysisDataTableSize];
+      mappedTable_(nullptr),
+      statistics_(),
+      wdlTable_(),
+      openingIds_(),
+      openingData_(),
+      bestMoveTable_(),
+      statusIndex_() {
 }
 
 Inspector::~Inspector() {
-    delete[] analysisDataTable_;
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
 }
 
 bool Inspector::load(AnalysisDataIOHandler& handler, Generation generation) {
+    allocate_table();
     return handler.load(generation, statistics_, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData));
 }
 
 Generation Inspector::load_latest(AnalysisDataIOHandler& handler) {
+    allocate_table();
     return handler.load_latest(statistics_, analysisDataTable_, AnalysisDataTableSize * sizeof(AnalysisData));
 }
 
+void Inspector::use_mapped_table(const AnalysisData* table, const AnalysisStatistics& stats) {
+    openingIds_.clear();
+    openingIds_.shrink_to_fit();
+    openingData_.clear();
+    openingData_.shrink_to_fit();
+    wdlTable_.clear();
+    wdlTable_.shrink_to_fit();
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
+    analysisDataTable_ = nullptr;
+    mappedTable_ = table;
+    statistics_ = stats;
+}
+
+bool Inspector::load_wdl(AnalysisDataIOHandler& handler) {
+    std::vector<std::uint8_t> wdlTable(WdlTableSize);
+    bool complete;
+    if (!handler.load_wdl(statistics_, complete, wdlTable.data(), WdlTableSize) || !complete) {
+        return false;
+    }
+
+    //
+    // The packed table is looked up by analysisData_of().  Other tables are not needed any longer.
+    //
+    openingIds_.clear();
+    openingIds_.shrink_to_fit();
+    openingData_.clear();
+    openingData_.shrink_to_fit();
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
+    analysisDataTable_ = nullptr;
+    mappedTable_ = nullptr;
+    wdlTable_ = std::move(wdlTable);
+    return true;
+}
+
+bool Inspector::wdl_only() const noexcept {
+    return !wdlTable_.empty();
+}
+
+bool Inspector::load_opening(ExportDataIOHandler& handler) {
+    mappedTable_ = nullptr;
+    if (!handler.load_opening(statistics_, openingIds_, openingData_)) {
+        openingIds_.clear();
+        openingData_.clear();
+        return false;
+    }
+
+    //
+    // The full table is not needed any longer.
+    //
+    free_analysisDataTable(analysisDataTable_, AnalysisDataTableSize);
+    analysisDataTable_ = nullptr;
+    wdlTable_.clear();
+    wdlTable_.shrink_to_fit();
+    return true;
+}
+
+bool Inspector::load_best_moves(ExportDataIOHandler& handler) {
+    bestMoveTable_.resize(BestMoveTableSize);
+    if (!handler.load_best_moves(bestMoveTable_.data(), BestMoveTableSize)) {
+        bestMoveTable_.clear();
+        bestMoveTable_.shrink_to_fit();
+        return false;
+    }
+    return true;
+}
+
+bool Inspector::has_best_moves() const noexcept {
+    return !bestMoveTable_.empty();
+}
+
+bool Inspector::best_move(PositionId id, MoveInspectionResult& result) const noexcept {
+    if (bestMoveTable_.empty() || !is_valid_positionId(id)) {
+        return false;
+    }
+    Position pos(id);
+
+    PositionId minId = pos.minimize_id();
+    std::uint8_t entry = bestMoveTable_[minId];
+    int moveIndex = moveIndex_of_bestMoveEntry(entry);
+    if (moveIndex == NoBestMoveIndex) {
+        return false;
+    }
+
+    //
+    // The entry holds a move of the minimized position.  Its locations are transformed back, since
+    // the move is the same one of the specified position under the symmetry.
+    //
+    PieceId piece;
+    LocationId src;
+    LocationId dst;
+    if (!nth_move(Position(minId), moveIndex, piece, src, dst)) {
+        return false;
+    }
+    TransformerId trans = pos.minimize_transformer();
+    src = antitransform_LocationId(trans, src);
+    dst = antitransform_LocationId(trans, dst);
+
+    MoveResult moveResult = pos.move(piece, src, dst);
+    if (moveResult.status != MoveResultStatus::Success) {
+        return false;
+    }
+    result = MoveInspectionResult {piece, src, dst, moveResult.position.id(), 0u,
+        wdlValue_to_analysisStatus(wdlValue_of_bestMoveEntry(entry)), true};
+    return true;
+}
+
+void Inspector::allocate_table() {
+    openingIds_.clear();
+    openingIds_.shrink_to_fit();
+    openingData_.clear();
+    openingData_.shrink_to_fit();
+    wdlTable_.clear();
+    wdlTable_.shrink_to_fit();
+    mappedTable_ = nullptr;
+    if (analysisDataTable_ == nullptr) {
+        analysisDataTable_ = allocate_analysisDataTable(AnalysisDataTableSize);
+    }
+}
+
+AnalysisData Inspector::analysisData_of(PositionId id) const noexcept {
+    if (analysisDataTable_ != nullptr) {
+        return analysisDataTable_[table_index(id)];
+    }
+    if (mappedTable_ != nullptr) {
+        return mappedTable_[id];
+    }
+    if (!wdlTable_.empty()) {
+        WdlValue value = wdlValue_of_byte(wdlTable_[id / WdlValuesPerByte], id);
+        return to_analysisData(false, 0u, wdlValue_to_analysisStatus(value));
+    }
+
+    //
+    // Positions missing in the opening database are never reached from the initial position.
+    //
+    auto it = std::lower_bound(openingIds_.begin(), openingIds_.end(), id);
+    if (it == openingIds_.end() || *it != id) {
+        return to_analysisData(false, 0u, AnalysisStatus::Contradictory);
+    }
+    return openingData_[it - openingIds_.begin()];
+}
+
+void Inspector::prefetch_analysisData_of(PositionId id) const noexcept {
+    if (analysisDataTable_ != nullptr) {
+        prefetch_analysisData(&analysisDataTable_[table_index(id)]);
+    } else if (mappedTable_ != nullptr) {
+        prefetch_analysisData(&mappedTable_[id]);
+    }
+}
+
+bool Inspector::use_status_index(const std::uint8_t* image, std::size_t imageSize) noexcept {
+    return statusIndex_.assign(image, imageSize);
+}
+
+const StatusIndex& Inspector::status_index() const noexcept {
+    return statusIndex_;
+}
+
+std::uint64_t Inspector::count_positions(AnalysisStatus status, Turn turn) const noexcept {
+    return statusIndex_.count(to_analysisData(false, turn, status));
+}
+
+std::vector<PositionId> Inspector::find_positions(AnalysisStatus status, Turn turn, PositionId beginId,
+    std::size_t maxNums) const {
+    AnalysisData data = to_analysisData(false, turn, status);
+    std::uint64_t nums = statusIndex_.count(data);
+    std::vector<PositionId> ids(std::min<std::uint64_t>(nums, maxNums));
+    ids.resize(statusIndex_.list(data, beginId, ids.data(), ids.size()));
+    return ids;
+}
+
 PositionInspectionResult Inspector::inspect_position(PositionId id) const noexcept {
     PositionInspectionResult result;
 
@@ -49,22 +237,92 @@ PositionInspectionResult Inspector::inspect_position(PositionId id) const noexce
     }
     Position pos(id);
 
-    AnalysisData analysisData = analysisDataTable_[pos.minimize_id()];
+    AnalysisData analysisData = analysisData_of(pos.minimize_id());
     return PositionInspectionResult {id, turn_of_analysisData(analysisData), status_of_analysisData(analysisData)};
 }
 
+void Inspector::inspect_positions(const PositionId* ids, std::size_t idNums, PositionInspectionResult* results,
+    int threadNums) const {
+    if (threadNums < 1) {
+        threadNums = 1;
+    }
+
+    //
+    // Minimizing a position ID takes much longer than looking up the table, so that it is done by threads.
+    // The calling thread works on the range 0.
+    //
+    std::vector<PositionId> minIds(idNums);
+    std::size_t rangeSize = (idNums + threadNums - 1) / threadNums;
+    auto worker = [&](int range) {
+        std::size_t begin = std::min(range * rangeSize, idNums);
+        std::size_t end = std::min(begin + rangeSize, idNums);
+        for (std::size_t i = begin; i < end; i++) {
+            if (is_valid_positionId(ids[i])) {
+                minIds[i] = Position(ids[i]).minimize_id();
+            } else {
+                minIds[i] = PositionIdNums;
+            }
+        }
+    };
+
+    run_threads(threadNums, worker);
+
+    //
+    // Lookups are sorted by table indexes (or by position IDs for a mapped table, the opening database or WDL
+    // data).  Invalid positions are put at the end.
+    //
+    std::vector<std::pair<std::size_t, std::size_t>> order(idNums);
+    for (std::size_t i = 0u; i < idNums; i++) {
+        std::size_t key;
+        if (minIds[i] == PositionIdNums) {
+            key = PositionIdNums;
+        } else if (analysisDataTable_ != nullptr) {
+            key = table_index(minIds[i]);
+        } else {
+            key = minIds[i];
+        }
+        order[i] = std::make_pair(key, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (std::size_t k = 0u; k < idNums; k++) {
+        if (k + InspectPrefetchDistance < idNums) {
+            PositionId aheadId = minIds[order[k + InspectPrefetchDistance].second];
+            if (aheadId != PositionIdNums) {
+                prefetch_analysisData_of(aheadId);
+            }
+        }
+
+        std::size_t i = order[k].second;
+        if (minIds[i] == PositionIdNums) {
+            results[i] = PositionInspectionResult {ids[i], 0u, AnalysisStatus::Invalid};
+            continue;
+        }
+        AnalysisData analysisData = analysisData_of(minIds[i]);
+        results[i] = PositionInspectionResult {ids[i], turn_of_analysisData(analysisData),
+            status_of_analysisData(analysisData)};
+    }
+}
+
 std::vector<MoveInspectionResult> Inspector::inspect_moves(PositionId id) const noexcept {
-    std::vector<MoveInspectionResult> result;
+    MoveInspectionResult results[MaxMoveNums];
+    std::size_t resultNums = inspect_moves(id, results);
+    return std::vector<MoveInspectionResult>(results, results + resultNums);
+}
+
+std::size_t Inspector::inspect_moves(PositionId id, MoveInspectionResult* results) const noexcept {
+    std::size_t resultNums = 0u;
 
     if (!is_valid_positionId(id)) {
-        return result;
+        return resultNums;
     }
     Position pos(id);
 
-    if (status_of_analysisData(analysisDataTable_[pos.minimize_id()]) == AnalysisStatus::Contradictory ||
+    AnalysisData posData = analysisData_of(pos.minimize_id());
+    if (status_of_analysisData(posData) == AnalysisStatus::Contradictory ||
         pos.is_winner(PlayerId::Active) ||
         pos.is_winner(PlayerId::Inactive)) {
-        return result;
+        return resultNums;
     }
 
     for (PieceId piece: ActivePlayerPieceIds) {
@@ -84,7 +342,7 @@ std::vector<MoveInspectionResult> Inspector::inspect_moves(PositionId id) const
                 // The status code recorded in `analysisData` is the status of the active player at the next turn,
                 // but what we want here is the status of the active player at the current turn.
                 //
-                AnalysisData analysisData = analysisDataTable_[moveResult.position.minimize_id()];
+                AnalysisData analysisData = analysisData_of(moveResult.position.minimize_id());
                 AnalysisStatus analysisStatus = invert_analysisStatus(status_of_analysisData(analysisData));
 
                 if (analysisStatus == AnalysisStatus::Contradictory ||
@@ -92,9 +350,9 @@ std::vector<MoveInspectionResult> Inspector::inspect_moves(PositionId id) const
                     analysisStatus == AnalysisStatus::Invalid) {
                     continue;
                 }
-                result.push_back(
+                results[resultNums++] =
                     MoveInspectionResult {piece, src, dst, moveResult.position.id(),
-                        turn_of_analysisData(analysisData), analysisStatus, false});
+                        turn_of_analysisData(analysisData), analysisStatus, false};
             }
             if (locPair.locations[0] == locPair.locations[1]) {
                 break;
@@ -102,8 +360,8 @@ std::vector<MoveInspectionResult> Inspector::inspect_moves(PositionId id) const
         }
     }
 
-    mark_best_move(result);
-    return result;
+    mark_best_move(results, resultNums);
+    return resultNums;
 }
 
 std::vector<MoveInspectionResult> Inspector::inspect_move_backs(PositionId id) const noexcept {
@@ -114,7 +372,8 @@ std::vector<MoveInspectionResult> Inspector::inspect_move_backs(PositionId id) c
     }
 
     Position pos(id);
-    if (status_of_analysisData(analysisDataTable_[pos.minimize_id()]) == AnalysisStatus::Contradictory) {
+    AnalysisData posData = analysisData_of(pos.minimize_id());
+    if (status_of_analysisData(posData) == AnalysisStatus::Contradictory) {
         return result;
     }
 
@@ -135,7 +394,7 @@ std::vector<MoveInspectionResult> Inspector::inspect_move_backs(PositionId id) c
                 // The status code recorded in `analysisData` is the status of the active player at the next turn,
                 // but what we want here is the status of the active player at the current turn.
                 //
-                AnalysisData analysisData = analysisDataTable_[moveResult.position.minimize_id()];
+                AnalysisData analysisData = analysisData_of(moveResult.position.minimize_id());
                 AnalysisStatus analysisStatus = invert_analysisStatus(status_of_analysisData(analysisData));
                 if (analysisStatus == AnalysisStatus::Contradictory ||
                     analysisStatus == AnalysisStatus::Transformed ||
@@ -153,59 +412,103 @@ std::vector<MoveInspectionResult> Inspector::inspect_move_backs(PositionId id) c
         }
     }
 
-    mark_best_move(result);
+    mark_best_move(result.data(), result.size());
     return result;
 }
 
-void Inspector::mark_best_move(std::vector<MoveInspectionResult>& moveInspectionResults) const noexcept {
+std::vector<MoveInspectionResult> Inspector::principal_variation(PositionId id, int maxPlies) const noexcept {
+    std::vector<MoveInspectionResult> result;
+
+    if (!is_valid_positionId(id)) {
+        return result;
+    }
+
+    PositionId posId = id;
+    for (int ply = 0; ply < maxPlies; ply++) {
+        MoveInspectionResult move;
+        if (!choose_best_move(posId, move)) {
+            break;
+        }
+        result.push_back(move);
+        posId = move.positionId;
+    }
+    return result;
+}
+
+bool Inspector::choose_best_move(PositionId id, MoveInspectionResult& result) const noexcept {
+    if (has_best_moves()) {
+        return best_move(id, result);
+    }
+
+    //
+    // The first one is taken if two or more moves are the best.
+    //
+    for (const MoveInspectionResult& move: inspect_moves(id)) {
+        if (move.isBestMove) {
+            result = move;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Inspector::mark_best_move(MoveInspectionResult* results, std::size_t resultNums) const noexcept {
+    //
+    // WDL data can't tell which of the winning moves makes progress.
+    //
+    if (wdl_only()) {
+        return;
+    }
+
     AnalysisStatus bestStatus = AnalysisStatus::Contradictory;
     Turn bestTurn = MaxTurn;
+    MoveInspectionResult* resultsEnd = results + resultNums;
 
-    for (MoveInspectionResult& res: moveInspectionResults) {
-        if (res.analysisStatus == AnalysisStatus::Lost || res.analysisStatus == AnalysisStatus::LostStalemate) {
+    for (MoveInspectionResult* res = results; res != resultsEnd; res++) {
+        if (res->analysisStatus == AnalysisStatus::Lost || res->analysisStatus == AnalysisStatus::LostStalemate) {
             if (bestStatus == AnalysisStatus::Lost || bestStatus == AnalysisStatus::LostStalemate) {
-                if (res.turn > bestTurn) {
-                    bestTurn = res.turn;
+                if (res->turn > bestTurn) {
+                    bestTurn = res->turn;
                 }
             } else if (bestStatus == AnalysisStatus::Contradictory) {
-                bestStatus = res.analysisStatus;
-                bestTurn = res.turn;
+                bestStatus = res->analysisStatus;
+                bestTurn = res->turn;
             }
-        } else if (res.analysisStatus == AnalysisStatus::Unfixed) {
+        } else if (res->analysisStatus == AnalysisStatus::Unfixed) {
             if (bestStatus != AnalysisStatus::Won && bestStatus != AnalysisStatus::WonStalemate) {
-                bestStatus = res.analysisStatus;
+                bestStatus = res->analysisStatus;
             }
-        } else if (res.analysisStatus == AnalysisStatus::Won || res.analysisStatus == AnalysisStatus::WonStalemate) {
+        } else if (res->analysisStatus == AnalysisStatus::Won || res->analysisStatus == AnalysisStatus::WonStalemate) {
             if (bestStatus == AnalysisStatus::Won || bestStatus == AnalysisStatus::WonStalemate) {
-                if (res.turn < bestTurn) {
-                    bestTurn = res.turn;
+                if (res->turn < bestTurn) {
+                    bestTurn = res->turn;
                 }
             } else {
-                bestStatus = res.analysisStatus;
-                bestTurn = res.turn;
+                bestStatus = res->analysisStatus;
+                bestTurn = res->turn;
             }
         }
     }
 
     if (bestStatus == AnalysisStatus::Lost || bestStatus == AnalysisStatus::LostStalemate) {
-        for (MoveInspectionResult& res: moveInspectionResults) {
-            if (res.analysisStatus == AnalysisStatus::Lost || res.analysisStatus == AnalysisStatus::LostStalemate) {
-                if (res.turn == bestTurn) {
-                    res.isBestMove = true;
+        for (MoveInspectionResult* res = results; res != resultsEnd; res++) {
+            if (res->analysisStatus == AnalysisStatus::Lost || res->analysisStatus == AnalysisStatus::LostStalemate) {
+                if (res->turn == bestTurn) {
+                    res->isBestMove = true;
                 }
             }
         }
     } else if (bestStatus == AnalysisStatus::Unfixed) {
-        for (MoveInspectionResult& res: moveInspectionResults) {
-            if (res.analysisStatus == bestStatus) {
-                res.isBestMove = true;
+        for (MoveInspectionResult* res = results; res != resultsEnd; res++) {
+            if (res->analysisStatus == bestStatus) {
+                res->isBestMove = true;
             }
         }
     } else if (bestStatus == AnalysisStatus::Won || bestStatus == AnalysisStatus::WonStalemate) {
-        for (MoveInspectionResult& res: moveInspectionResults) {
-            if (res.analysisStatus == AnalysisStatus::Won || res.analysisStatus == AnalysisStatus::WonStalemate) {
-                if (res.turn == bestTurn) {
-                    res.isBestMove = true;
+        for (MoveInspectionResult* res = results; res != resultsEnd; res++) {
+            if (res->analysisStatus == AnalysisStatus::Won || res->analysisStatus == AnalysisStatus::WonStalemate) {
+                if (res->turn == bestTurn) {
+                    res->isBestMove = true;
                 }
             }
         }
@@ -19,8 +19,10 @@
 #define GOBB_ANALYZER_INSPECTOR_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include "analyzer.hpp"
+#include "status_index.hpp"
 
 ///
 /// @file   inspector.hpp
@@ -47,7 +49,7 @@ struct MoveInspectionResult {
     PositionId positionId;          ///< a position ID after moving the piece.
     Turn turn;                      ///< the number of remaining turns.
     AnalysisStatus analysisStatus;  ///< the status code of a position after moving the piece.
-    bool isBestMove;                ///< true if this is the best move among the candidates.
+    bool isBestMove;                ///< true if this is the best move among the candidates (never with WDL data).
 };
 
 ///
@@ -92,6 +94,126 @@ public:
     ///
     Generation load_latest(AnalysisDataIOHandler& handler);
 
+    ///
+    /// Use a table of analysis data mapped by `AnalysisDataFileHandler::map()`.
+    ///
+    /// @param   table  the table in the linear layout.
+    /// @param   stats  statistics data.
+    ///
+    /// The table is not copied, so that it must remain mapped while the inspector is used.  The table
+    /// allocated by the inspector and the opening database are discarded.
+    ///
+    void use_mapped_table(const AnalysisData* table, const AnalysisStatistics& stats);
+
+    ///
+    /// Load win/draw/loss values written by `WdlAnalyzer`.
+    ///
+    /// @param   handler  an I/O handler to store the analysis data.
+    /// @return  true upon success.
+    ///
+    /// Positions are inspected as `AnalysisStatus::Won`, `AnalysisStatus::Lost` or `AnalysisStatus::Unfixed`
+    /// (draw), and the number of remaining turns is 0.  The values are looked up in the packed table, and the
+    /// whole table of analysis data is not allocated.  A partial result of an interrupted analysis is not
+    /// loaded.
+    ///
+    /// Without the number of remaining turns, a move keeping a win may never end the game, so that no move
+    /// is marked as the best, and principal_variation() needs a best-move table.
+    ///
+    bool load_wdl(AnalysisDataIOHandler& handler);
+
+    ///
+    /// Whether the loaded data are win/draw/loss values only.
+    ///
+    /// @return  true if the data have been loaded by load_wdl().
+    ///
+    bool wdl_only() const noexcept;
+
+    ///
+    /// Load an opening database written by `gobb_export -t opening`.
+    ///
+    /// @param   handler  an I/O handler to load the database.
+    /// @return  true upon success.
+    ///
+    /// The opening database contains positions reachable from the initial position only.  Other positions
+    /// are inspected as `AnalysisStatus::Contradictory`, so that moves and retrograde moves to them are not
+    /// listed.  The whole table of analysis data is not allocated.
+    ///
+    bool load_opening(ExportDataIOHandler& handler);
+
+    ///
+    /// Load a best-move table written by `gobb_export -t bestmove`.
+    ///
+    /// @param   handler  an I/O handler to load the table.
+    /// @return  true upon success.
+    ///
+    /// The table is used by best_move() only, and it can be loaded with or without analysis data.
+    /// It throws `std::bad_alloc` if it fails to allocate the table.
+    ///
+    bool load_best_moves(ExportDataIOHandler& handler);
+
+    ///
+    /// Whether a best-move table is loaded.
+    ///
+    /// @return  true if the table has been loaded by load_best_moves().
+    ///
+    bool has_best_moves() const noexcept;
+
+    ///
+    /// Look up the best move of the specified position in the best-move table.
+    ///
+    /// @param   id      a position ID.
+    /// @param   result  the best move is put here.
+    /// @return  true if the best move is found.
+    ///
+    /// The move is looked up in the entry of the minimized position, and then mapped back to the specified
+    /// position.  `result.analysisStatus` is the status of the specified position, which is `Won`, `Lost` or
+    /// `Unfixed` (draw), and `result.turn` is 0 since the table doesn't record the number of remaining turns.
+    /// It returns false if the table is not loaded, or the position has no move.
+    ///
+    bool best_move(PositionId id, MoveInspectionResult& result) const noexcept;
+
+    ///
+    /// Use an image of a status index written by `gobb_export -t index`.
+    ///
+    /// @param   image      the image, typically mapped by `AnalysisDataFileHandler::map_status_index()`.
+    /// @param   imageSize  the number of bytes of the image.
+    /// @return  true upon success.
+    ///
+    /// The image is not copied, so that it must remain mapped while the inspector is used.  The index is used
+    /// by count_positions() and find_positions() only, and it can be used with or without analysis data.
+    ///
+    bool use_status_index(const std::uint8_t* image, std::size_t imageSize) noexcept;
+
+    ///
+    /// Return the status index.
+    ///
+    /// @return  the status index, which is empty if use_status_index() has not succeeded.
+    ///
+    const StatusIndex& status_index() const noexcept;
+
+    ///
+    /// Count positions with the specified status and number of remaining turns in the status index.
+    ///
+    /// @param   status  a status.
+    /// @param   turn    the number of remaining turns.
+    /// @return  the number of minimized positions, or 0 if no status index is used.
+    ///
+    std::uint64_t count_positions(AnalysisStatus status, Turn turn) const noexcept;
+
+    ///
+    /// Find positions with the specified status and number of remaining turns in the status index.
+    ///
+    /// @param   status   a status.
+    /// @param   turn     the number of remaining turns.
+    /// @param   beginId  the smallest position ID to be found.
+    /// @param   maxNums  the maximum number of positions.
+    /// @return  minimized position IDs in ascending order.
+    ///
+    /// The cost is proportional to the number of positions found, not to the size of the table.
+    ///
+    std::vector<PositionId> find_positions(AnalysisStatus status, Turn turn, PositionId beginId,
+        std::size_t maxNums) const;
+
     ///
     /// Return analysis data of the specified position.
     ///
@@ -100,6 +222,23 @@ public:
     ///
     PositionInspectionResult inspect_position(PositionId id) const noexcept;
 
+    ///
+    /// Return analysis data of many positions.
+    ///
+    /// @param   ids         position IDs.
+    /// @param   idNums      the number of position IDs.
+    /// @param   results     analysis data of the positions are put here, in the order of `ids`.
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    ///
+    /// It gives the same results as inspect_position(), but faster for many positions.  Position IDs are
+    /// minimized by threads in parallel, and then the table is looked up in the order of table indexes,
+    /// so that neighboring entries are read together.  Entries a few lookups ahead are prefetched.  An
+    /// invalid position ID gets
+    /// `AnalysisStatus::Invalid`.  It throws an exception if it fails to create threads.
+    ///
+    void inspect_positions(const PositionId* ids, std::size_t idNums, PositionInspectionResult* results,
+        int threadNums) const;
+
     ///
     /// Return a list of possible moves of the specified position.
     ///
@@ -108,6 +247,15 @@ public:
     ///
     std::vector<MoveInspectionResult> inspect_moves(PositionId id) const noexcept;
 
+    ///
+    /// Return possible moves of the specified position without allocating memory.
+    ///
+    /// @param   id       a position ID.
+    /// @param   results  an array of `MaxMoveNums` elements, where possible moves are put.
+    /// @return  the number of possible moves.
+    ///
+    std::size_t inspect_moves(PositionId id, MoveInspectionResult* results) const noexcept;
+
     ///
     /// Return a list of possible retrograde moves of the specified position.
     ///
@@ -116,19 +264,88 @@ public:
     ///
     std::vector<MoveInspectionResult> inspect_move_backs(PositionId id) const noexcept;
 
+    ///
+    /// Return the principal variation from the specified position.
+    ///
+    /// @param   id        a position ID.
+    /// @param   maxPlies  the maximum number of moves.
+    /// @return  a list of moves.
+    ///
+    /// It follows the best moves until the game ends or `maxPlies` moves are found.  A best move is looked
+    /// up in the best-move table if it is loaded (see best_move()), or chosen in the same way as
+    /// inspect_moves() otherwise.  In both cases, the moves are those of the specified position, not of the
+    /// minimized positions.  Retrograde moves are not inspected.  If the position is a draw, the variation
+    /// goes on until `maxPlies`.  With WDL data and without the best-move table, the list is empty.
+    ///
+    std::vector<MoveInspectionResult> principal_variation(PositionId id, int maxPlies) const noexcept;
+
 private:
+    ///
+    /// Choose the best move of a position.
+    ///
+    /// @param   id      a position ID.
+    /// @param   result  the best move is put here.
+    /// @return  true if the best move is found.
+    ///
+    bool choose_best_move(PositionId id, MoveInspectionResult& result) const noexcept;
+
+    ///
+    /// Allocate the whole table of analysis data if it is not allocated, and discard the opening database
+    /// and WDL data.
+    ///
+    /// It throws `std::bad_alloc` if it fails to allocate the table.
+    ///
+    void allocate_table();
+
+    ///
+    /// Return analysis data of a position.
+    ///
+    /// @param   id  a minimized position ID.
+    /// @return  analysis data.
+    ///
+    AnalysisData analysisData_of(PositionId id) const noexcept;
+
+    ///
+    /// Prefetch analysis data of a position into the cache.
+    ///
+    /// @param   id  a minimized position ID.
+    ///
+    /// It does nothing for the opening database and WDL data, which are looked up by binary search or
+    /// are small enough.
+    ///
+    void prefetch_analysisData_of(PositionId id) const noexcept;
+
     ///
     /// Mark the best moves among the candidates.
     ///
-    /// @param   moveInspectionResults  a vector of `MoveInspectionResult`.
+    /// @param   results     an array of `MoveInspectionResult`.
+    /// @param   resultNums  the number of elements in `results`.
     ///
-    void mark_best_move(std::vector<MoveInspectionResult>& moveInspectionResults) const noexcept;
+    void mark_best_move(MoveInspectionResult* results, std::size_t resultNums) const noexcept;
 
-    /// Analysis data of all positions.
+    /// Analysis data of all positions (nullptr if a mapped table, the opening database or WDL data is used).
     AnalysisData* analysisDataTable_;
 
+    /// Analysis data of all positions in a mapped file, in the linear layout (nullptr if not used).
+    const AnalysisData* mappedTable_;
+
     /// Statistics of the analysis.
     AnalysisStatistics statistics_;
+
+    /// WDL values of all positions, 2 bits per position (empty if WDL data are not loaded).
+    std::vector<std::uint8_t> wdlTable_;
+
+    /// Minimized position IDs in the opening database, in ascending order.
+    std::vector<std::uint32_t> openingIds_;
+
+    /// Analysis data in the opening database.
+    std::vector<AnalysisData> openingData_;
+
+    /// The best-move table (empty if it is not loaded).
+    std::vector<std::uint8_t> bestMoveTable_;
+
+    /// The status index (empty if it is not used).
+    StatusIndex statusIndex_;
 };
 
 } // namespace gobb_analyzer
@@ -0,0 +1,78 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "inspector_loader.hpp"
+
+namespace gobb_analyzer {
+
+bool load_inspector_data(AnalysisDataFileHandler& handler, InspectorDataSource source, Generation generation,
+    bool allowLoading, Inspector& inspector, MappedFile& mapping, std::string& errorMessage) {
+    if (source == InspectorDataSource::Opening) {
+        if (!inspector.load_opening(handler)) {
+            errorMessage = "failed to load the opening database";
+            return false;
+        }
+        return true;
+    }
+    if (source == InspectorDataSource::Wdl) {
+        if (!inspector.load_wdl(handler)) {
+            errorMessage = "failed to load the WDL file";
+            return false;
+        }
+        return true;
+    }
+
+    //
+    // An analysis data file is mapped, so that processes using the same file share it in memory.
+    //
+    AnalysisStatistics stats;
+    bool mapped;
+    if (generation != InvalidGeneration) {
+        mapped = handler.map(generation, stats, mapping);
+    } else {
+        mapped = (handler.map_latest(stats, mapping) != InvalidGeneration);
+    }
+    if (mapped) {
+        inspector.use_mapped_table(AnalysisDataFileHandler::mapped_table(mapping), stats);
+        return true;
+    }
+
+    //
+    // A file which cannot be mapped (e.g. it is in the legacy format) may be loaded into memory instead.
+    //
+    if (allowLoading) {
+        bool loaded;
+        if (generation != InvalidGeneration) {
+            loaded = inspector.load(handler, generation);
+        } else {
+            loaded = (inspector.load_latest(handler) != InvalidGeneration);
+        }
+        if (loaded) {
+            return true;
+        }
+    }
+
+    const char* verb = allowLoading ? "load" : "map";
+    if (generation != InvalidGeneration) {
+        errorMessage = std::string("failed to ") + verb + " the analysis data file of the specified generation";
+    } else {
+        errorMessage = std::string("failed to ") + verb + " an analysis data file";
+    }
+    return false;
+}
+
+} // namespace gobb_analyzer
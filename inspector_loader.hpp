@@ -0,0 +1,60 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_INSPECTOR_LOADER_HPP
+#define GOBB_ANALYZER_INSPECTOR_LOADER_HPP
+
+#include <cstdint>
+#include <string>
+#include "analysis_data_file_handler.hpp"
+#include "inspector.hpp"
+#include "mapped_file.hpp"
+
+///
+/// @file   inspector_loader.hpp
+/// @brief  Define `load_inspector_data()`, which gives the data selected by command options to an inspector.
+///
+namespace gobb_analyzer {
+
+///
+/// Data given to an inspector.
+///
+enum class InspectorDataSource: std::uint8_t {
+    AnalysisData,  ///< An analysis data file.
+    Opening,       ///< The opening database written by `gobb_export -t opening`.
+    Wdl            ///< The WDL file written by `gobb_analyze --wdl-only`.
+};
+
+///
+/// Map or load data for an inspector.
+///
+/// @param   handler       an I/O handler of the data directory.
+/// @param   source        the data to be used.
+/// @param   generation    the generation of an analysis data file, or `InvalidGeneration` for the latest one.
+/// @param   allowLoading  whether an analysis data file is loaded into memory if it cannot be mapped
+///                        (e.g. it is in the legacy format).
+/// @param   inspector     an inspector.
+/// @param   mapping       a mapping of an analysis data file, which must remain while `inspector` is used.
+/// @param   errorMessage  a message upon failure, such as "failed to load the WDL file".
+/// @return  true upon success.
+///
+bool load_inspector_data(AnalysisDataFileHandler& handler, InspectorDataSource source, Generation generation,
+    bool allowLoading, Inspector& inspector, MappedFile& mapping, std::string& errorMessage);
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_INSPECTOR_LOADER_HPP
@@ -0,0 +1,342 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "best_move_table.hpp"
+#include "inspector.hpp"
+#include "wdl_analyzer.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+namespace {
+
+//
+// An I/O handler which gives data kept in memory to an inspector.
+//
+class DataHandler: public AnalysisDataIOHandler {
+public:
+    DataHandler()
+        : wdlTable_(),
+          wdlComplete_(true) {
+    }
+
+    virtual bool store(Generation, const AnalysisStatistics&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool load(Generation, AnalysisStatistics&, AnalysisData*, std::size_t) const { return false; }
+    virtual Generation find_latest() const { return InvalidGeneration; }
+    virtual Generation load_latest(AnalysisStatistics&, AnalysisData*, std::size_t) const {
+        return InvalidGeneration;
+    }
+    virtual bool store_checkpoint(const AnalysisCheckpoint&, const AnalysisData*, std::size_t) { return false; }
+    virtual bool find_checkpoint(AnalysisCheckpoint&) const { return false; }
+    virtual bool load_checkpoint(AnalysisCheckpoint&, AnalysisData*, std::size_t) const { return false; }
+    virtual void remove_checkpoint() {}
+    virtual bool store_wdl(const AnalysisStatistics&, bool, const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_wdl(AnalysisStatistics& stats, bool& complete, std::uint8_t* table,
+        std::size_t tableSize) const {
+        if (wdlTable_.size() != tableSize) {
+            return false;
+        }
+        stats = AnalysisStatistics();
+        complete = wdlComplete_;
+        std::copy(wdlTable_.begin(), wdlTable_.end(), table);
+        return true;
+    }
+    virtual bool store_reachability(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_reachability(std::uint8_t*, std::size_t) const { return false; }
+    virtual void clean() {}
+
+    //
+    // Set WDL data where all positions are excluded.
+    //
+    void set_excluded_wdl(bool complete) {
+        std::uint8_t byte = 0u;
+        for (PositionId id = 0u; id < WdlValuesPerByte; id++) {
+            byte = set_wdlValue_of_byte(byte, id, WdlValue::Excluded);
+        }
+        wdlTable_.assign(WdlTableSize, byte);
+        wdlComplete_ = complete;
+    }
+
+    //
+    // Set a WDL value of a position.
+    //
+    void set_wdl(PositionId id, WdlValue value) {
+        std::uint8_t& byte = wdlTable_[id / WdlValuesPerByte];
+        byte = set_wdlValue_of_byte(byte, id, value);
+    }
+
+private:
+    std::vector<std::uint8_t> wdlTable_;
+    bool wdlComplete_;
+};
+
+//
+// An I/O handler which gives an opening database and a best-move table kept in memory to an inspector.
+//
+class ExportHandler: public ExportDataIOHandler {
+public:
+    ExportHandler()
+        : opening_(),
+          bestMoves_() {
+    }
+
+    virtual bool store_opening(const AnalysisStatistics&, const std::uint32_t*, const AnalysisData*, std::size_t) {
+        return false;
+    }
+    virtual bool load_opening(AnalysisStatistics& stats, std::vector<std::uint32_t>& ids,
+        std::vector<AnalysisData>& data) const {
+        stats = AnalysisStatistics();
+        ids.clear();
+        data.clear();
+        for (const auto& entry: opening_) {
+            ids.push_back(static_cast<std::uint32_t>(entry.first));
+            data.push_back(entry.second);
+        }
+        return true;
+    }
+    virtual bool store_best_moves(const std::uint8_t*, std::size_t) { return false; }
+    virtual bool load_best_moves(std::uint8_t* table, std::size_t tableSize) const {
+        std::fill(table, table + tableSize, to_bestMoveEntry(WdlValue::Unknown, NoBestMoveIndex));
+        for (const auto& entry: bestMoves_) {
+            table[entry.first] = entry.second;
+        }
+        return true;
+    }
+    virtual bool store_late_game(const AnalysisStatistics&, int, const std::uint32_t*, const AnalysisData*,
+        std::size_t) {
+        return false;
+    }
+    virtual bool load_late_game(AnalysisStatistics&, int&, std::vector<std::uint32_t>&,
+        std::vector<AnalysisData>&) const {
+        return false;
+    }
+    virtual bool store_status_index(Generation, const std::uint8_t*, std::size_t) { return false; }
+
+    //
+    // Put a position in the opening database.
+    //
+    void set_opening(PositionId id, AnalysisStatus status, Turn turn) {
+        opening_[Position(id).minimize_id()] = to_analysisData(false, turn, status);
+    }
+
+    //
+    // Put a best-move entry of a position.
+    //
+    void set_best_move(PositionId id, WdlValue value, int moveIndex) {
+        bestMoves_[Position(id).minimize_id()] = to_bestMoveEntry(value, moveIndex);
+    }
+
+private:
+    std::map<PositionId, AnalysisData> opening_;
+    std::map<PositionId, std::uint8_t> bestMoves_;
+};
+
+//
+// Find a move to a position which is not minimized.
+//
+MoveResult noncanonical_move(PositionId id) {
+    Position pos(id);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        for (LocationId dst: OnBoardLocationIds) {
+            MoveResult moveResult = pos.move(piece, LocationId::Out, dst);
+            if (moveResult.status == MoveResultStatus::Success &&
+                moveResult.position.id() != moveResult.position.minimize_id()) {
+                return moveResult;
+            }
+        }
+    }
+    return MoveResult {MoveResultStatus::Invalid, Position()};
+}
+
+//
+// Return the positions reachable by a move from a position.
+//
+std::vector<PositionId> next_positions(PositionId id) {
+    std::vector<PositionId> ids;
+    Position pos(id);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+        for (LocationId src: locPair.locations) {
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status == MoveResultStatus::Success) {
+                    ids.push_back(moveResult.position.id());
+                }
+            }
+        }
+    }
+    return ids;
+}
+
+//
+// Whether a move inspected at a position reaches the position recorded in it.
+//
+bool move_reaches(PositionId id, const MoveInspectionResult& move) {
+    MoveResult moveResult = Position(id).move(move.piece, move.source, move.destination);
+    return moveResult.status == MoveResultStatus::Success && moveResult.position.id() == move.positionId;
+}
+
+} // namespace
+
+//
+// Test that WDL data are looked up without the number of remaining turns, and no move is marked as the best.
+//
+TEST(InspectorTest, WdlData) {
+    //
+    // The initial position is Won.  A move of it reaches a Lost position, and the other moves reach draws.
+    //
+    Position pos(InitialPositionId);
+    DataHandler handler;
+    handler.set_excluded_wdl(true);
+    handler.set_wdl(pos.minimize_id(), WdlValue::Won);
+    MoveResult lostMove = pos.move(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center);
+    ASSERT_EQ(lostMove.status, MoveResultStatus::Success);
+    for (LocationId dst: OnBoardLocationIds) {
+        MoveResult moveResult = pos.move(PieceId::ActivePlayerSmall, LocationId::Out, dst);
+        ASSERT_EQ(moveResult.status, MoveResultStatus::Success);
+        handler.set_wdl(moveResult.position.minimize_id(), WdlValue::Unknown);
+    }
+    handler.set_wdl(lostMove.position.minimize_id(), WdlValue::Lost);
+
+    Inspector inspector;
+    ASSERT_TRUE(inspector.load_wdl(handler));
+    ASSERT_TRUE(inspector.wdl_only());
+
+    PositionInspectionResult posResult = inspector.inspect_position(InitialPositionId);
+    ASSERT_EQ(posResult.analysisStatus, AnalysisStatus::Won);
+    ASSERT_EQ(posResult.turn, 0u);
+
+    std::vector<MoveInspectionResult> moves = inspector.inspect_moves(InitialPositionId);
+    std::size_t wonNums = 0u;
+    std::size_t drawNums = 0u;
+    for (const MoveInspectionResult& move: moves) {
+        ASSERT_FALSE(move.isBestMove);
+        if (move.analysisStatus == AnalysisStatus::Won) {
+            ASSERT_EQ(Position(move.positionId).minimize_id(), lostMove.position.minimize_id());
+            wonNums++;
+        } else {
+            ASSERT_EQ(move.analysisStatus, AnalysisStatus::Unfixed);
+            drawNums++;
+        }
+    }
+    ASSERT_GE(wonNums, 1u);
+    ASSERT_GE(drawNums, 1u);
+    ASSERT_TRUE(inspector.principal_variation(InitialPositionId, 4).empty());
+}
+
+//
+// Test that a partial result of an interrupted WDL analysis is not loaded.
+//
+TEST(InspectorTest, PartialWdlData) {
+    DataHandler handler;
+    handler.set_excluded_wdl(false);
+    Inspector inspector;
+    ASSERT_FALSE(inspector.load_wdl(handler));
+    ASSERT_FALSE(inspector.wdl_only());
+}
+
+//
+// Test that a move of a best-move table is turned to the orientation of a position which is not minimized,
+// and that the principal variation follows the table.
+//
+TEST(InspectorTest, BestMoveTable) {
+    MoveResult firstMove = noncanonical_move(InitialPositionId);
+    ASSERT_EQ(firstMove.status, MoveResultStatus::Success);
+    PositionId posId = firstMove.position.id();
+    PositionId minId = firstMove.position.minimize_id();
+    ASSERT_NE(posId, minId);
+
+    //
+    // The entry holds the second move of the minimized position.
+    //
+    PieceId piece;
+    LocationId src;
+    LocationId dst;
+    ASSERT_TRUE(nth_move(Position(minId), 1, piece, src, dst));
+    MoveResult minMove = Position(minId).move(piece, src, dst);
+    ASSERT_EQ(minMove.status, MoveResultStatus::Success);
+
+    ExportHandler handler;
+    handler.set_best_move(posId, WdlValue::Won, 1);
+    handler.set_best_move(minMove.position.id(), WdlValue::Lost, 0);
+    Inspector inspector;
+    ASSERT_TRUE(inspector.load_best_moves(handler));
+    ASSERT_TRUE(inspector.has_best_moves());
+
+    MoveInspectionResult move;
+    ASSERT_TRUE(inspector.best_move(posId, move));
+    ASSERT_TRUE(move_reaches(posId, move));
+    ASSERT_EQ(move.piece, piece);
+    ASSERT_EQ(Position(move.positionId).minimize_id(), minMove.position.minimize_id());
+    ASSERT_EQ(move.analysisStatus, AnalysisStatus::Won);
+    ASSERT_TRUE(move.isBestMove);
+
+    std::vector<MoveInspectionResult> pv = inspector.principal_variation(posId, 2);
+    ASSERT_EQ(pv.size(), 2u);
+    ASSERT_EQ(pv[0].positionId, move.positionId);
+    ASSERT_TRUE(move_reaches(pv[0].positionId, pv[1]));
+    ASSERT_EQ(pv[1].analysisStatus, AnalysisStatus::Lost);
+}
+
+//
+// Test that the principal variation follows the best moves found by inspect_moves() without a best-move
+// table, and that moves of a position which is not minimized are in its own orientation.
+//
+TEST(InspectorTest, PrincipalVariationOfMoves) {
+    //
+    // At the initial position, the move to `lostPos` wins the fastest.  At `lostPos`, the only move
+    // reaches `wonPos`, which has no move in the database.
+    //
+    MoveResult firstMove = noncanonical_move(InitialPositionId);
+    ASSERT_EQ(firstMove.status, MoveResultStatus::Success);
+    PositionId lostPos = firstMove.position.id();
+    MoveResult secondMove = Position(lostPos).move(PieceId::ActivePlayerMedium, LocationId::Out, LocationId::Center);
+    ASSERT_EQ(secondMove.status, MoveResultStatus::Success);
+    PositionId wonPos = secondMove.position.id();
+
+    ExportHandler handler;
+    handler.set_opening(InitialPositionId, AnalysisStatus::Won, 3u);
+    for (PositionId id: next_positions(InitialPositionId)) {
+        handler.set_opening(id, AnalysisStatus::Lost, 4u);
+    }
+    handler.set_opening(lostPos, AnalysisStatus::Lost, 2u);
+    handler.set_opening(wonPos, AnalysisStatus::Won, 1u);
+
+    Inspector inspector;
+    ASSERT_TRUE(inspector.load_opening(handler));
+    ASSERT_FALSE(inspector.has_best_moves());
+
+    std::vector<MoveInspectionResult> moves = inspector.inspect_moves(lostPos);
+    ASSERT_EQ(moves.size(), 1u);
+    ASSERT_TRUE(move_reaches(lostPos, moves[0]));
+    ASSERT_EQ(Position(moves[0].positionId).minimize_id(), Position(wonPos).minimize_id());
+
+    std::vector<MoveInspectionResult> pv = inspector.principal_variation(InitialPositionId, 4);
+    ASSERT_EQ(pv.size(), 2u);
+    ASSERT_TRUE(move_reaches(InitialPositionId, pv[0]));
+    ASSERT_EQ(Position(pv[0].positionId).minimize_id(), Position(lostPos).minimize_id());
+    ASSERT_EQ(pv[0].analysisStatus, AnalysisStatus::Won);
+    ASSERT_EQ(pv[0].turn, 2u);
+    ASSERT_TRUE(move_reaches(pv[0].positionId, pv[1]));
+    ASSERT_EQ(Position(pv[1].positionId).minimize_id(), Position(wonPos).minimize_id());
+    ASSERT_EQ(pv[1].analysisStatus, AnalysisStatus::Lost);
+    ASSERT_EQ(pv[1].turn, 1u);
+}
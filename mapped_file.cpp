@@ -0,0 +1,89 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "mapped_file.hpp"
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#define GOBB_ANALYZER_USE_MMAP
+#endif
+
+namespace gobb_analyzer {
+
+//
+// Class MappedFile.
+//
+MappedFile::MappedFile() noexcept
+    : data_(nullptr),
+      size_(0u) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::filesystem::path& path) noexcept {
+    close();
+
+#if defined(GOBB_ANALYZER_USE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    //
+    // The mapping remains valid after the file descriptor is closed.
+    //
+    void* addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+#if defined(MADV_RANDOM)
+    madvise(addr, static_cast<std::size_t>(st.st_size), MADV_RANDOM);
+#endif
+    data_ = static_cast<const unsigned char*>(addr);
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+#else
+    static_cast<void>(path);
+    return false;
+#endif
+}
+
+void MappedFile::close() noexcept {
+    if (data_ == nullptr) {
+        return;
+    }
+#if defined(GOBB_ANALYZER_USE_MMAP)
+    munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0u;
+}
+
+} // namespace gobb_analyzer
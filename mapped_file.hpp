@@ -0,0 +1,100 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_MAPPED_FILE_HPP
+#define GOBB_ANALYZER_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+
+///
+/// @file   mapped_file.hpp
+/// @brief  Define `MappedFile` class, a file mapped into memory for reading.
+///
+namespace gobb_analyzer {
+
+///
+/// A file mapped into memory for reading.
+///
+/// Pages of the file are shared with the page cache, so that processes mapping the same file share
+/// its contents in memory.  The file is mapped with `mmap()` if available.  Otherwise open() fails.
+///
+class MappedFile {
+public:
+    ///
+    /// Default constructor.
+    ///
+    /// No file is mapped.
+    ///
+    MappedFile() noexcept;
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile& operator=(MappedFile&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    /// It unmaps the file.
+    ///
+    virtual ~MappedFile();
+
+    ///
+    /// Map a file.
+    ///
+    /// @param   path  a path to the file.
+    /// @return  true upon success.
+    ///
+    /// A file mapped before is unmapped.  Pages are advised to be read at random.
+    ///
+    bool open(const std::filesystem::path& path) noexcept;
+
+    ///
+    /// Unmap the file.
+    ///
+    void close() noexcept;
+
+    ///
+    /// Return the contents of the file.
+    ///
+    /// @return  a pointer to the mapped contents, or nullptr if no file is mapped.
+    ///
+    const unsigned char* data() const noexcept {
+        return data_;
+    }
+
+    ///
+    /// Return the size of the file.
+    ///
+    /// @return  the number of bytes.
+    ///
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+private:
+    /// The mapped contents.
+    const unsigned char* data_;
+
+    /// The size of the file.
+    std::size_t size_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_MAPPED_FILE_HPP
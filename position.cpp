@@ -183,6 +183,19 @@ std::vector<PieceId> Position::find_pieces(std::function<bool(PieceId, LocationI
     return pieces;
 }
 
+int Position::off_board_piece_nums() const noexcept {
+    int nums = 0;
+    for (PieceId piece: PieceIds) {
+        const LocationIdPair& locPair = piecePairs_[static_cast<int>(piece)];
+        for (LocationId loc: locPair.locations) {
+            if (loc == LocationId::Out) {
+                nums++;
+            }
+        }
+    }
+    return nums;
+}
+
 bool Position::is_winner(PlayerId player) const noexcept {
     static const LocationId lines[][BoardLength] = {
         {LocationId::NW, LocationId::N,      LocationId::NE},
@@ -379,6 +392,21 @@ PositionId Position::minimize_id() const noexcept {
     return minId;
 }
 
+TransformerId Position::minimize_transformer() const noexcept {
+    PositionId minId = id_;
+    TransformerId minTrans = TransformerId::Unchange;
+
+    for (TransformerId trans: EffectiveTransformerIds) {
+        Position transPos = transform(trans);
+        if (transPos.id_ < minId) {
+            minId = transPos.id_;
+            minTrans = trans;
+        }
+    }
+
+    return minTrans;
+}
+
 void Position::update_largestPieces() noexcept {
     for (LocationId loc: OnBoardLocationIds) {
         largestPieces_[static_cast<LocationIdUint>(loc)] = PieceId::None;
@@ -394,6 +394,15 @@ public:
     ///
     bool is_winner(PlayerId player) const noexcept;
 
+    ///
+    /// Return the number of pieces off the board.
+    ///
+    /// @return  the number of pieces of both players at `LocationId::Out`.
+    ///
+    /// A piece on the board never goes off the board, so that the number never increases by a move.
+    ///
+    int off_board_piece_nums() const noexcept;
+
     ///
     /// Move an active player's piece from `src` to `dst`.
     ///
@@ -441,6 +450,16 @@ public:
     ///
     PositionId minimize_id() const noexcept;
 
+    ///
+    /// Return the transformation which gives the smallest position ID among the symmetric positions.
+    ///
+    /// @return  a transformer ID.
+    ///
+    /// `transform(minimize_transformer()).id()` equals to `minimize_id()`, except for the color information.
+    /// If two or more transformations give the smallest ID, the first one in `TransformerIds` is returned.
+    ///
+    TransformerId minimize_transformer() const noexcept;
+
 private:
     ///
     /// Invert owners of all pieces.
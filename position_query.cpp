@@ -0,0 +1,545 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cctype>
+#include "position_query.hpp"
+
+namespace gobb_analyzer {
+
+namespace {
+
+//
+// Locations of the pieces in a quad, which are the same for all the sizes.
+//
+struct QuadInfo {
+    std::uint8_t onBoardNums[2];             // the number of pieces on the board of active and inactive.
+    std::uint8_t owners[LocationIdNums];     // 0 (none), 1 (active) or 2 (inactive) at each location.
+};
+
+//
+// Return the table of QuadInfo for all quad indexes.
+//
+const std::vector<QuadInfo>& quad_infos() {
+    static const std::vector<QuadInfo> infos = [] {
+        std::vector<QuadInfo> result(PieceQuadCombinationNums);
+        for (PositionId q = 0u; q < PieceQuadCombinationNums; q++) {
+            // Medium and large pieces are off the board in the position with the quad index of small pieces.
+            Position pos(q);
+            QuadInfo& info = result[q];
+            info = QuadInfo {{0u, 0u}, {}};
+            PieceId pieces[2] = {PieceId::ActivePlayerSmall, PieceId::InactivePlayerSmall};
+            for (int player = 0; player < 2; player++) {
+                LocationIdPair locPair = pos.locations_of_piece(pieces[player]);
+                for (LocationId loc: locPair.locations) {
+                    if (loc != LocationId::Out) {
+                        info.onBoardNums[player]++;
+                        info.owners[static_cast<int>(loc)] = static_cast<std::uint8_t>(player + 1);
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+    return infos;
+}
+
+//
+// Return whether `lhs OP rhs` holds.
+//
+template <typename T>
+bool compare(T lhs, T rhs, int op) noexcept {
+    switch (op) {
+    case 0: return lhs == rhs;
+    case 1: return lhs != rhs;
+    case 2: return lhs < rhs;
+    case 3: return lhs <= rhs;
+    case 4: return lhs > rhs;
+    default: return lhs >= rhs;
+    }
+}
+
+//
+// Compare every value in [lower, upper] with `rhs`: 0 (false for all), 1 (true for all) or 2 (it depends).
+//
+int compare_range(int lower, int upper, int rhs, int op) noexcept {
+    if (lower == upper) {
+        return compare(lower, rhs, op) ? 1 : 0;
+    }
+    bool lowerTruth = compare(lower, rhs, op);
+    bool upperTruth = compare(upper, rhs, op);
+    if (lowerTruth != upperTruth) {
+        return 2;
+    }
+    if ((op == 0 || op == 1) && lower < rhs && rhs < upper) {
+        return 2;
+    }
+    return lowerTruth ? 1 : 0;
+}
+
+} // namespace
+
+//
+// Parser of query strings.
+//
+class PositionQueryParser {
+public:
+    PositionQueryParser(const std::string& text, std::vector<PositionQuery::Node>& nodes)
+        : text_(text), pos_(0u), nodes_(nodes), error_() {
+    }
+
+    bool parse(std::string& error) {
+        next_token();
+        if (token_.empty()) {
+            error = "empty query";
+            return false;
+        }
+        if (!parse_or() || !expect_end()) {
+            error = error_;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    using Node = PositionQuery::Node;
+    using NodeKind = PositionQuery::NodeKind;
+    using CompareOp = PositionQuery::CompareOp;
+
+    //
+    // Read the next token into `token_`: a word, a number, an operator or a parenthesis.
+    //
+    void next_token() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            pos_++;
+        }
+        tokenPos_ = pos_;
+        token_.clear();
+        if (pos_ >= text_.size()) {
+            return;
+        }
+
+        char ch = text_[pos_];
+        if (std::isalnum(static_cast<unsigned char>(ch)) || ch == '_') {
+            while (pos_ < text_.size() &&
+                (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_')) {
+                token_ += static_cast<char>(std::tolower(static_cast<unsigned char>(text_[pos_])));
+                pos_++;
+            }
+        } else if ((ch == '<' || ch == '>' || ch == '!' || ch == '=') && pos_ + 1 < text_.size() &&
+            text_[pos_ + 1] == '=') {
+            token_ = text_.substr(pos_, 2);
+            pos_ += 2;
+        } else {
+            token_ = std::string(1, ch);
+            pos_++;
+        }
+    }
+
+    bool fail(const std::string& message) {
+        if (error_.empty()) {
+            error_ = message + " at column " + std::to_string(tokenPos_ + 1);
+        }
+        return false;
+    }
+
+    bool unexpected() {
+        if (token_.empty()) {
+            return fail("unexpected end of the query");
+        }
+        return fail("unexpected '" + token_ + "'");
+    }
+
+    bool expect(const std::string& token) {
+        if (token_ != token) {
+            return unexpected();
+        }
+        next_token();
+        return true;
+    }
+
+    bool expect_end() {
+        if (!token_.empty()) {
+            return unexpected();
+        }
+        return true;
+    }
+
+    int add_node(const Node& node) {
+        nodes_.push_back(node);
+        return static_cast<int>(nodes_.size()) - 1;
+    }
+
+    static Node new_node(NodeKind kind) {
+        return Node {kind, CompareOp::Eq, -1, -1, 0, -1, -1, LocationId::Invalid};
+    }
+
+    // or-expr := and-expr ('or' and-expr)*
+    bool parse_or() {
+        if (!parse_and()) {
+            return false;
+        }
+        while (token_ == "or") {
+            int left = static_cast<int>(nodes_.size()) - 1;
+            next_token();
+            if (!parse_and()) {
+                return false;
+            }
+            Node node = new_node(NodeKind::Or);
+            node.left = left;
+            node.right = static_cast<int>(nodes_.size()) - 1;
+            add_node(node);
+        }
+        return true;
+    }
+
+    // and-expr := not-expr ('and' not-expr)*
+    bool parse_and() {
+        if (!parse_not()) {
+            return false;
+        }
+        while (token_ == "and") {
+            int left = static_cast<int>(nodes_.size()) - 1;
+            next_token();
+            if (!parse_not()) {
+                return false;
+            }
+            Node node = new_node(NodeKind::And);
+            node.left = left;
+            node.right = static_cast<int>(nodes_.size()) - 1;
+            add_node(node);
+        }
+        return true;
+    }
+
+    // not-expr := 'not' not-expr | '(' or-expr ')' | condition
+    bool parse_not() {
+        if (token_ == "not") {
+            next_token();
+            if (!parse_not()) {
+                return false;
+            }
+            Node node = new_node(NodeKind::Not);
+            node.left = static_cast<int>(nodes_.size()) - 1;
+            add_node(node);
+            return true;
+        } else if (token_ == "(") {
+            next_token();
+            return parse_or() && expect(")");
+        }
+        return parse_condition();
+    }
+
+    bool parse_condition() {
+        if (token_ == "status") {
+            next_token();
+            Node node = new_node(NodeKind::Status);
+            if (!parse_equality(node.op)) {
+                return false;
+            }
+            for (int i = 0; i <= static_cast<int>(AnalysisStatus::Contradictory); i++) {
+                if (token_ == lower(analysisStatus_to_string(static_cast<AnalysisStatus>(i)))) {
+                    node.value = i;
+                    next_token();
+                    add_node(node);
+                    return true;
+                }
+            }
+            return fail("unknown status '" + token_ + "'");
+        } else if (token_ == "turn") {
+            next_token();
+            Node node = new_node(NodeKind::Turn);
+            if (!parse_comparison(node.op) || !parse_number(node.value)) {
+                return false;
+            }
+            add_node(node);
+            return true;
+        } else if (token_ == "onboard" || token_ == "offboard") {
+            Node node = new_node(token_ == "onboard" ? NodeKind::OnBoard : NodeKind::OffBoard);
+            next_token();
+            if (!expect("(") || !parse_player(node.player, false) || !parse_size(node.size) || !expect(")") ||
+                !parse_comparison(node.op) || !parse_number(node.value)) {
+                return false;
+            }
+            add_node(node);
+            return true;
+        } else if (token_ == "top") {
+            Node node = new_node(NodeKind::Top);
+            next_token();
+            if (!expect("(") || !parse_location(node.location) || !expect(")") || !parse_equality(node.op) ||
+                !parse_player(node.player, true)) {
+                return false;
+            }
+            if (node.player >= 0 && !parse_size(node.size)) {
+                return false;
+            }
+            add_node(node);
+            return true;
+        }
+        return unexpected();
+    }
+
+    bool parse_equality(CompareOp& op) {
+        if (token_ == "=" || token_ == "==") {
+            op = CompareOp::Eq;
+        } else if (token_ == "!=") {
+            op = CompareOp::Ne;
+        } else {
+            return unexpected();
+        }
+        next_token();
+        return true;
+    }
+
+    bool parse_comparison(CompareOp& op) {
+        static const char* const names[] = {"=", "!=", "<", "<=", ">", ">="};
+        if (token_ == "==") {
+            op = CompareOp::Eq;
+            next_token();
+            return true;
+        }
+        for (int i = 0; i < 6; i++) {
+            if (token_ == names[i]) {
+                op = static_cast<CompareOp>(i);
+                next_token();
+                return true;
+            }
+        }
+        return unexpected();
+    }
+
+    bool parse_number(int& value) {
+        if (token_.empty() || token_.size() > 5u ||
+            token_.find_first_not_of("0123456789") != std::string::npos) {
+            return fail("invalid number '" + token_ + "'");
+        }
+        value = std::stoi(token_);
+        next_token();
+        return true;
+    }
+
+    bool parse_player(int& player, bool allowEmpty) {
+        static const char* const names[] = {"orange", "blue", "active", "inactive", "any"};
+        for (int i = 0; i < 5; i++) {
+            if (token_ == names[i]) {
+                player = i;
+                next_token();
+                return true;
+            }
+        }
+        if (allowEmpty && token_ == "empty") {
+            player = -1;
+            next_token();
+            return true;
+        }
+        return fail("unknown player '" + token_ + "'");
+    }
+
+    bool parse_size(int& size) {
+        for (std::size_t i = 0u; i < PieceSizeNums; i++) {
+            if (token_ == lower(pieceSize_to_string(PieceSizes[i]))) {
+                size = static_cast<int>(i);
+                next_token();
+                return true;
+            }
+        }
+        size = -1;
+        return true;
+    }
+
+    bool parse_location(LocationId& location) {
+        for (LocationId loc: OnBoardLocationIds) {
+            if (token_ == lower(locationId_to_string(loc))) {
+                location = loc;
+                next_token();
+                return true;
+            }
+        }
+        return fail("unknown location '" + token_ + "'");
+    }
+
+    static std::string lower(const std::string& s) {
+        std::string result;
+        for (char ch: s) {
+            result += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+        return result;
+    }
+
+    const std::string& text_;
+    std::size_t pos_;
+    std::size_t tokenPos_;
+    std::string token_;
+    std::vector<Node>& nodes_;
+    std::string error_;
+};
+
+//
+// Class PositionQuery.
+//
+PositionQuery::PositionQuery()
+    : nodes_(),
+      dataTruths_(std::size_t(1) << (sizeof(AnalysisData) * 8u), Truth::True) {
+}
+
+bool PositionQuery::parse(const std::string& text, std::string& error) {
+    std::vector<Node> nodes;
+    PositionQueryParser parser(text, nodes);
+    if (!parser.parse(error)) {
+        return false;
+    }
+    nodes_.swap(nodes);
+
+    Context context {{-1, -1, -1}, -1, true};
+    for (std::size_t data = 0u; data < dataTruths_.size(); data++) {
+        context.data = static_cast<int>(data);
+        dataTruths_[data] = evaluate(context);
+    }
+    return true;
+}
+
+PositionQuery::Truth PositionQuery::evaluate(const Context& context) const noexcept {
+    if (nodes_.empty()) {
+        return Truth::True;
+    }
+    return evaluate_node(static_cast<int>(nodes_.size()) - 1, context);
+}
+
+bool PositionQuery::matches(PositionId id, AnalysisData data) const noexcept {
+    if (!is_valid_positionId(id)) {
+        return false;
+    }
+    PositionId setId = id % PieceSetCombinationNums;
+    Context context {
+        {static_cast<int>(setId % PieceQuadCombinationNums),
+         static_cast<int>(setId / PieceQuadCombinationNums % PieceQuadCombinationNums),
+         static_cast<int>(setId / (PieceQuadCombinationNums * PieceQuadCombinationNums))},
+        data,
+        id < PieceSetCombinationNums};
+    return evaluate(context) == Truth::True;
+}
+
+PositionQuery::Truth PositionQuery::evaluate_node(int index, const Context& context) const noexcept {
+    const Node& node = nodes_[index];
+    int op = static_cast<int>(node.op);
+
+    switch (node.kind) {
+    case NodeKind::And: {
+        Truth left = evaluate_node(node.left, context);
+        if (left == Truth::False) {
+            return Truth::False;
+        }
+        Truth right = evaluate_node(node.right, context);
+        if (right == Truth::False) {
+            return Truth::False;
+        }
+        return (left == Truth::True && right == Truth::True) ? Truth::True : Truth::Unknown;
+    }
+    case NodeKind::Or: {
+        Truth left = evaluate_node(node.left, context);
+        if (left == Truth::True) {
+            return Truth::True;
+        }
+        Truth right = evaluate_node(node.right, context);
+        if (right == Truth::True) {
+            return Truth::True;
+        }
+        return (left == Truth::False && right == Truth::False) ? Truth::False : Truth::Unknown;
+    }
+    case NodeKind::Not: {
+        Truth operand = evaluate_node(node.left, context);
+        if (operand == Truth::Unknown) {
+            return Truth::Unknown;
+        }
+        return (operand == Truth::True) ? Truth::False : Truth::True;
+    }
+    case NodeKind::Status:
+        if (context.data < 0) {
+            return Truth::Unknown;
+        }
+        return compare(static_cast<int>(status_of_analysisData(static_cast<AnalysisData>(context.data))),
+            node.value, op) ? Truth::True : Truth::False;
+    case NodeKind::Turn:
+        if (context.data < 0) {
+            return Truth::Unknown;
+        }
+        return compare(static_cast<int>(turn_of_analysisData(static_cast<AnalysisData>(context.data))),
+            node.value, op) ? Truth::True : Truth::False;
+    default:
+        break;
+    }
+
+    //
+    // Conditions on pieces.  Players are indexes of `QuadInfo::onBoardNums`: 0 (active) and 1 (inactive).
+    //
+    const std::vector<QuadInfo>& infos = quad_infos();
+    int player = node.player;
+    if (player == 0 || player == 1) {
+        player = (context.activeIsOrange == (player == 0)) ? 0 : 1;
+    } else if (player == 2 || player == 3) {
+        player -= 2;
+    } else if (player == 4) {
+        player = 2;
+    }
+
+    if (node.kind == NodeKind::Top) {
+        for (int size = static_cast<int>(PieceSizeNums) - 1; size >= 0; size--) {
+            int quad = context.quads[size];
+            if (quad < 0) {
+                return Truth::Unknown;
+            }
+            int owner = infos[quad].owners[static_cast<int>(node.location)];
+            if (owner != 0) {
+                bool same = player >= 0 && (player == 2 || player == owner - 1) && (node.size < 0 || node.size == size);
+                return (same == (node.op == CompareOp::Eq)) ? Truth::True : Truth::False;
+            }
+        }
+        bool same = player < 0;
+        return (same == (node.op == CompareOp::Eq)) ? Truth::True : Truth::False;
+    }
+
+    //
+    // Pieces of unknown sizes make the count a range, which may still decide the comparison.
+    //
+    int nums = 0;
+    int unknownNums = 0;
+    int maxNums = 0;
+    for (int size = 0; size < static_cast<int>(PieceSizeNums); size++) {
+        if (node.size >= 0 && node.size != size) {
+            continue;
+        }
+        int quad = context.quads[size];
+        for (int p = 0; p < 2; p++) {
+            if (player == 2 || player == p) {
+                if (quad < 0) {
+                    unknownNums += 2;
+                } else {
+                    nums += infos[quad].onBoardNums[p];
+                }
+                maxNums += 2;
+            }
+        }
+    }
+    int lower = nums;
+    int upper = nums + unknownNums;
+    if (node.kind == NodeKind::OffBoard) {
+        lower = maxNums - (nums + unknownNums);
+        upper = maxNums - nums;
+    }
+    return static_cast<Truth>(compare_range(lower, upper, node.value, op));
+}
+
+} // namespace gobb_analyzer
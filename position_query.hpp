@@ -0,0 +1,195 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_POSITION_QUERY_HPP
+#define GOBB_ANALYZER_POSITION_QUERY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "analyzer.hpp"
+#include "position.hpp"
+
+///
+/// @file   position_query.hpp
+/// @brief  Define `PositionQuery` class, a predicate on positions and their analysis data.
+///
+namespace gobb_analyzer {
+
+///
+/// A predicate on positions and their analysis data, parsed from a query string.
+///
+/// A query is a boolean expression of the following conditions, combined with `and`, `or`, `not` and
+/// parentheses:
+///
+/// - `status = STATUS` or `status != STATUS`, where `STATUS` is a name of `AnalysisStatus`.
+/// - `turn OP NUM`, where `OP` is one of `=`, `!=`, `<`, `<=`, `>` and `>=`.
+/// - `onboard(PLAYER [SIZE]) OP NUM`, the number of pieces on the board.
+/// - `offboard(PLAYER [SIZE]) OP NUM`, the number of pieces off the board.
+/// - `top(LOCATION) = PLAYER [SIZE]`, `top(LOCATION) = empty`, or the same with `!=`, the largest piece at
+///   a square.
+///
+/// `PLAYER` is `orange`, `blue`, `active`, `inactive` or `any`.  If `SIZE` (`small`, `medium` or `large`)
+/// is omitted, pieces of all the sizes are counted.  Names are case insensitive.
+///
+/// A query can be evaluated while some components of a position are unknown, in three-valued logic.  Since
+/// a position ID is composed of the indexes of the locations of small, medium and large pieces (see
+/// `PositionId`), a scan over the table decides whether a range of positions may match before it reads
+/// the analysis data of each position.
+///
+class PositionQuery {
+public:
+    ///
+    /// A truth value in three-valued logic.
+    ///
+    enum class Truth: std::uint8_t {
+        False   = 0u,  ///< False.
+        True    = 1u,  ///< True.
+        Unknown = 2u   ///< It depends on unknown components.
+    };
+
+    ///
+    /// Components of a position to evaluate a query.
+    ///
+    struct Context {
+        int quads[PieceSizeNums];  ///< quad indexes of small, medium and large pieces, or -1 if unknown.
+        int data;                  ///< analysis data, or -1 if unknown.
+        bool activeIsOrange;       ///< whether the active player is Orange.
+    };
+
+    ///
+    /// Constructor.
+    ///
+    /// It constructs a query which matches all positions.
+    ///
+    PositionQuery();
+
+    ///
+    /// Copy constructor.
+    ///
+    /// @param   other  an instance to copy from.
+    ///
+    PositionQuery(const PositionQuery& other) = default;
+
+    ///
+    /// Copy assignment operator.
+    ///
+    /// @param   other  an instance to copy from.
+    /// @return  a reference of `*this`.
+    ///
+    PositionQuery& operator=(const PositionQuery& other) = default;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~PositionQuery() = default;
+
+    ///
+    /// Parse a query string.
+    ///
+    /// @param   text   a query string.
+    /// @param   error  an error message upon failure.
+    /// @return  true upon success.
+    ///
+    /// Upon failure, the query is not changed.
+    ///
+    bool parse(const std::string& text, std::string& error);
+
+    ///
+    /// Evaluate the query with components of a position.
+    ///
+    /// @param   context  components of a position.
+    /// @return  the truth value.
+    ///
+    Truth evaluate(const Context& context) const noexcept;
+
+    ///
+    /// Evaluate the query with analysis data only.
+    ///
+    /// @param   data  analysis data.
+    /// @return  the truth value, which is looked up from a table made by parse().
+    ///
+    Truth evaluate_data(AnalysisData data) const noexcept {
+        return dataTruths_[data];
+    }
+
+    ///
+    /// Whether a position matches the query.
+    ///
+    /// @param   id    a position ID.
+    /// @param   data  analysis data of the position.
+    /// @return  true if it matches.
+    ///
+    bool matches(PositionId id, AnalysisData data) const noexcept;
+
+private:
+    ///
+    /// Kinds of nodes of an expression.
+    ///
+    enum class NodeKind: std::uint8_t {
+        And,       ///< both `left` and `right` are true.
+        Or,        ///< either `left` or `right` is true.
+        Not,       ///< `left` is false.
+        Status,    ///< the status is compared with `value`.
+        Turn,      ///< the number of remaining turns is compared with `value`.
+        OnBoard,   ///< the number of pieces on the board is compared with `value`.
+        OffBoard,  ///< the number of pieces off the board is compared with `value`.
+        Top        ///< the largest piece at `location` is compared with `player` and `size`.
+    };
+
+    ///
+    /// Comparison operators.
+    ///
+    enum class CompareOp: std::uint8_t {
+        Eq, Ne, Lt, Le, Gt, Ge
+    };
+
+    ///
+    /// A node of an expression.
+    ///
+    struct Node {
+        NodeKind kind;       ///< a kind of the node.
+        CompareOp op;        ///< a comparison operator.
+        int left;            ///< the index of the left operand.
+        int right;           ///< the index of the right operand.
+        int value;           ///< a value compared with.
+        int player;          ///< 0 (Orange), 1 (Blue), 2 (active), 3 (inactive), 4 (any) or -1 (empty).
+        int size;            ///< 0 (small), 1 (medium), 2 (large) or -1 (any).
+        LocationId location; ///< a location.
+    };
+
+    ///
+    /// Evaluate a node.
+    ///
+    /// @param   index    the index of the node.
+    /// @param   context  components of a position.
+    /// @return  the truth value.
+    ///
+    Truth evaluate_node(int index, const Context& context) const noexcept;
+
+    /// Nodes of the expression.  The last one is the root, or no node means a query matching all.
+    std::vector<Node> nodes_;
+
+    /// Truth values for all analysis data, with the position unknown.
+    std::vector<Truth> dataTruths_;
+
+    friend class PositionQueryParser;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_POSITION_QUERY_HPP
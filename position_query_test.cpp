@@ -0,0 +1,133 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <random>
+#include <string>
+#include "position_query.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test PositionQuery::parse() for invalid queries.
+//
+TEST(PositionQueryTest, ParseError) {
+    PositionQuery query;
+    std::string error;
+
+    ASSERT_FALSE(query.parse("", error));
+    ASSERT_FALSE(query.parse("status", error));
+    ASSERT_FALSE(query.parse("status < won", error));
+    ASSERT_FALSE(query.parse("status = winning", error));
+    ASSERT_FALSE(query.parse("turn >= x", error));
+    ASSERT_FALSE(query.parse("onboard(red) = 1", error));
+    ASSERT_FALSE(query.parse("top(X) = empty", error));
+    ASSERT_FALSE(query.parse("(turn = 1", error));
+    ASSERT_FALSE(query.parse("turn = 1 turn = 2", error));
+    ASSERT_FALSE(error.empty());
+
+    ASSERT_TRUE(query.parse("Status = Won AND NOT (turn > 3 or top(Center) = blue large)", error));
+}
+
+//
+// Test PositionQuery::evaluate_data() and three-valued logic.
+//
+TEST(PositionQueryTest, EvaluateData) {
+    PositionQuery query;
+    std::string error;
+    AnalysisData won3 = to_analysisData(false, 3, AnalysisStatus::Won);
+    AnalysisData lost2 = to_analysisData(false, 2, AnalysisStatus::Lost);
+
+    ASSERT_TRUE(query.parse("status = won and turn <= 3", error));
+    ASSERT_EQ(query.evaluate_data(won3), PositionQuery::Truth::True);
+    ASSERT_EQ(query.evaluate_data(lost2), PositionQuery::Truth::False);
+
+    // A position component is unknown without a position.
+    ASSERT_TRUE(query.parse("status = won and onboard(any) >= 4", error));
+    ASSERT_EQ(query.evaluate_data(won3), PositionQuery::Truth::Unknown);
+    ASSERT_EQ(query.evaluate_data(lost2), PositionQuery::Truth::False);
+    ASSERT_TRUE(query.parse("status = won or onboard(any) >= 4", error));
+    ASSERT_EQ(query.evaluate_data(won3), PositionQuery::Truth::True);
+    ASSERT_EQ(query.evaluate_data(lost2), PositionQuery::Truth::Unknown);
+
+    // Known small pieces decide a condition on small pieces, before the data is read.
+    Position pos(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::N},   {LocationId::Center, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    PositionQuery::Context context = {{static_cast<int>(pos.id() % 1423u), -1, -1}, -1, true};
+    ASSERT_TRUE(query.parse("onboard(orange small) = 2 and status = won", error));
+    ASSERT_EQ(query.evaluate(context), PositionQuery::Truth::Unknown);
+    ASSERT_TRUE(query.parse("onboard(blue small) = 2 and status = won", error));
+    ASSERT_EQ(query.evaluate(context), PositionQuery::Truth::False);
+
+    // Pieces of unknown sizes make a range of counts.
+    ASSERT_TRUE(query.parse("onboard(any) >= 3", error));
+    ASSERT_EQ(query.evaluate(context), PositionQuery::Truth::True);
+    ASSERT_TRUE(query.parse("offboard(any) < 9", error));
+    ASSERT_EQ(query.evaluate(context), PositionQuery::Truth::Unknown);
+    ASSERT_TRUE(query.parse("onboard(blue) = 12", error));
+    ASSERT_EQ(query.evaluate(context), PositionQuery::Truth::False);
+}
+
+//
+// Test PositionQuery::matches() against Position.
+//
+TEST(PositionQueryTest, Matches) {
+    PositionQuery onBoardQuery;
+    PositionQuery offBoardQuery;
+    PositionQuery topQuery;
+    std::string error;
+    ASSERT_TRUE(onBoardQuery.parse("onboard(blue medium) = 1 or onboard(active) >= 5", error));
+    ASSERT_TRUE(offBoardQuery.parse("offboard(inactive large) > 0 and offboard(orange) < 3", error));
+    ASSERT_TRUE(topQuery.parse("top(center) = orange large or top(nw) = empty", error));
+
+    std::mt19937_64 random(20221018u);
+    std::uniform_int_distribution<PositionId> distribution(0u, PositionIdNums - 1u);
+    AnalysisData data = to_analysisData(false, 0, AnalysisStatus::Unfixed);
+    for (int i = 0; i < 10000; i++) {
+        PositionId id = distribution(random);
+        Position pos(id);
+        bool activeIsOrange = (pos.active_player_color() == PlayerColor::Orange);
+
+        int onBoardNums[2][PieceSizeNums] = {};
+        for (PieceId piece: PieceIds) {
+            LocationIdPair locPair = pos.locations_of_piece(piece);
+            int player = (playerId_of_pieceId(piece) == PlayerId::Active) ? 0 : 1;
+            int size = static_cast<int>(pieceSize_of_pieceId(piece)) - 1;
+            for (LocationId loc: locPair.locations) {
+                if (loc != LocationId::Out) {
+                    onBoardNums[player][size]++;
+                }
+            }
+        }
+        int blue = activeIsOrange ? 1 : 0;
+        int activeOnBoard = onBoardNums[0][0] + onBoardNums[0][1] + onBoardNums[0][2];
+        bool expected = (onBoardNums[blue][1] == 1) || (activeOnBoard >= 5);
+        ASSERT_EQ(onBoardQuery.matches(id, data), expected);
+
+        int orange = 1 - blue;
+        int orangeOffBoard = 6 - (onBoardNums[orange][0] + onBoardNums[orange][1] + onBoardNums[orange][2]);
+        expected = (onBoardNums[1][2] < 2) && (orangeOffBoard < 3);
+        ASSERT_EQ(offBoardQuery.matches(id, data), expected);
+
+        PieceId orangeLarge = activeIsOrange ? PieceId::ActivePlayerLarge : PieceId::InactivePlayerLarge;
+        expected = (pos.largetst_piece_at_location(LocationId::Center) == orangeLarge)
+            || (pos.largetst_piece_at_location(LocationId::NW) == PieceId::None);
+        ASSERT_EQ(topQuery.matches(id, data), expected);
+    }
+}
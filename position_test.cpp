@@ -15,6 +15,7 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>
 //
 
+#include <string>
 #include "position.hpp"
 #include "gtest/gtest.h"
 
@@ -340,6 +341,27 @@ TEST(PositionTest, Transform) {
     ASSERT_EQ(posInvalid.transform(TransformerId::MirrorRotate270), posInvalid);
 }
 
+//
+// Test Position::minimize_transformer().
+//
+TEST(PositionTest, MinimizeTransformer) {
+    for (PositionId id = InitialPositionId; id < PieceQuadCombinationNums; id++) {
+        Position pos(id);
+        PositionId transId = pos.transform(pos.minimize_transformer()).id();
+        if (transId >= PieceSetCombinationNums) {
+            transId -= PieceSetCombinationNums;
+        }
+        ASSERT_EQ(transId, pos.minimize_id());
+    }
+
+    // A move of the minimized position is mapped back by antitransform_LocationId().
+    for (TransformerId trans: TransformerIds) {
+        for (LocationId loc: LocationIds) {
+            ASSERT_EQ(loc, antitransform_LocationId(trans, transform_LocationId(trans, loc)));
+        }
+    }
+}
+
 //
 // Test Position::move(PieceId piece, LocationId src, LocationId dst).
 // in case of MoveResult::Success.
@@ -707,3 +729,40 @@ TEST(PositionTest, MoveBackInvalid) {
     result = pos.move_back(PieceId::InactivePlayerSmall, LocationId::NW, LocationId::NW);
     ASSERT_EQ(result.status, MoveResultStatus::Invalid);
 }
+
+//
+// Test move_to_notation() and notation_to_move().
+//
+TEST(PositionTest, MoveNotation) {
+    ASSERT_EQ(move_to_notation(PieceId::ActivePlayerLarge, LocationId::Out, LocationId::Center), "Large:Out-Center");
+    ASSERT_EQ(move_to_notation(PieceId::InactivePlayerSmall, LocationId::NW, LocationId::SE), "Small:NW-SE");
+
+    PieceId piece;
+    LocationId source;
+    LocationId destination;
+    auto parse = [&](const std::string& text) {
+        return notation_to_move(text.data(), text.data() + text.size(), piece, source, destination);
+    };
+
+    ASSERT_TRUE(parse("Large:Out-Center"));
+    ASSERT_EQ(piece, PieceId::ActivePlayerLarge);
+    ASSERT_EQ(source, LocationId::Out);
+    ASSERT_EQ(destination, LocationId::Center);
+
+    //
+    // Names are compared without case, and the piece is always of the active player.
+    //
+    ASSERT_TRUE(parse("small:nw-se"));
+    ASSERT_EQ(piece, PieceId::ActivePlayerSmall);
+    ASSERT_EQ(source, LocationId::NW);
+    ASSERT_EQ(destination, LocationId::SE);
+    ASSERT_TRUE(parse("MEDIUM:E-W"));
+    ASSERT_EQ(piece, PieceId::ActivePlayerMedium);
+    ASSERT_EQ(source, LocationId::E);
+    ASSERT_EQ(destination, LocationId::W);
+
+    for (const char* text: {"", "Large", "Large:Out", "Large-Out:Center", "Large:OutCenter", "Huge:Out-Center",
+            "None:Out-Center", "Large:Out-Middle", "Large:Out-Center-N", ":Out-Center", "Large:-Center"}) {
+        ASSERT_FALSE(parse(text)) << text;
+    }
+}
@@ -0,0 +1,155 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <utility>
+#include <vector>
+#include "reachability.hpp"
+#include "run_threads.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+    "a reachability bitmap must be stored as 64-bit words");
+
+//
+// Class ReachabilityBitmap.
+//
+ReachabilityBitmap::ReachabilityBitmap()
+    : words_(new std::atomic<std::uint64_t>[ReachabilityBitmapWordNums]()) {
+}
+
+int ReachabilityBitmap::compute(int threadNums) {
+    if (threadNums < 1) {
+        threadNums = 1;
+    }
+    for (std::size_t i = 0u; i < ReachabilityBitmapWordNums; i++) {
+        words_[i].store(0u, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> frontier(
+        new std::atomic<std::uint64_t>[ReachabilityBitmapWordNums]());
+    std::unique_ptr<std::atomic<std::uint64_t>[]> next(new std::atomic<std::uint64_t>[ReachabilityBitmapWordNums]());
+
+    PositionId initialId = Position(InitialPositionId).minimize_id();
+    set(initialId);
+    frontier[initialId / 64u].fetch_or(std::uint64_t(1) << (initialId % 64u));
+
+    std::size_t rangeSize = (ReachabilityBitmapWordNums + threadNums - 1) / threadNums;
+    int levelNums = 1;
+    for (;;) {
+        std::vector<char> threadExpanded(threadNums, false);
+        auto worker = [&](int range) {
+            std::size_t beginWord = range * rangeSize;
+            std::size_t endWord = beginWord + rangeSize;
+            if (beginWord > ReachabilityBitmapWordNums) {
+                beginWord = ReachabilityBitmapWordNums;
+            }
+            if (endWord > ReachabilityBitmapWordNums) {
+                endWord = ReachabilityBitmapWordNums;
+            }
+            threadExpanded[range] = expand_range(frontier.get(), next.get(), beginWord, endWord);
+        };
+
+        //
+        // The calling thread works on the range 0.
+        //
+        run_threads(threadNums, worker);
+
+        bool expanded = false;
+        for (char e: threadExpanded) {
+            expanded = expanded || e;
+        }
+        if (!expanded) {
+            break;
+        }
+
+        std::swap(frontier, next);
+        for (std::size_t i = 0u; i < ReachabilityBitmapWordNums; i++) {
+            next[i].store(0u, std::memory_order_relaxed);
+        }
+        levelNums++;
+    }
+
+    return levelNums;
+}
+
+PositionId ReachabilityBitmap::count() const noexcept {
+    PositionId nums = 0u;
+    for (std::size_t i = 0u; i < ReachabilityBitmapWordNums; i++) {
+        std::uint64_t word = words_[i].load(std::memory_order_relaxed);
+        while (word != 0u) {
+            word &= word - 1u;
+            nums++;
+        }
+    }
+    return nums;
+}
+
+bool ReachabilityBitmap::expand_range(const std::atomic<std::uint64_t>* frontier, std::atomic<std::uint64_t>* next,
+    std::size_t beginWord, std::size_t endWord) noexcept {
+    bool expanded = false;
+
+    for (std::size_t w = beginWord; w < endWord; w++) {
+        std::uint64_t word = frontier[w].load(std::memory_order_relaxed);
+        while (word != 0u) {
+            int bit = 0;
+            while (((word >> bit) & 1u) == 0u) {
+                bit++;
+            }
+            word &= word - 1u;
+
+            //
+            // The game is over at a position where either player has won.
+            //
+            Position pos(static_cast<PositionId>(w * 64u + bit));
+            if (pos.is_winner(PlayerId::Active) || pos.is_winner(PlayerId::Inactive)) {
+                continue;
+            }
+
+            for (PieceId piece: ActivePlayerPieceIds) {
+                LocationIdPair locPair = pos.locations_of_piece(piece);
+
+                for (int i = 0; i < 2; i++) {
+                    LocationId src = locPair.locations[i];
+
+                    for (LocationId dst: OnBoardLocationIds) {
+                        MoveResult moveResult = pos.move(piece, src, dst);
+                        if (moveResult.status != MoveResultStatus::Success) {
+                            continue;
+                        }
+
+                        //
+                        // Only the thread which sets the bit first adds the position to the next frontier.
+                        //
+                        PositionId id = moveResult.position.minimize_id();
+                        if (set(id)) {
+                            next[id / 64u].fetch_or(std::uint64_t(1) << (id % 64u), std::memory_order_relaxed);
+                            expanded = true;
+                        }
+                    }
+                    if (locPair.locations[0] == locPair.locations[1]) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return expanded;
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_REACHABILITY_HPP
+#define GOBB_ANALYZER_REACHABILITY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "analyzer.hpp"
+
+///
+/// @file   reachability.hpp
+/// @brief  Define `ReachabilityBitmap` class.
+///
+namespace gobb_analyzer {
+
+/// The number of 64-bit words of a reachability bitmap.
+constexpr std::size_t ReachabilityBitmapWordNums = (AnalysisDataTableSize + 63u) / 64u;
+
+///
+/// A bitmap of positions reachable from the initial position, one bit for each position ID.
+///
+/// Only the bits of minimized position IDs (see `Position::minimize_id()`) are set.  The set of positions
+/// is closed under moves: every position after a move from a reachable position which is not over is also
+/// reachable.  Thus the results of retrograde analysis of reachable positions don't depend on unreachable
+/// positions.
+///
+class ReachabilityBitmap {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// It allocates a bitmap with no bit set.  It throws `std::bad_alloc` if it fails to allocate the bitmap.
+    ///
+    ReachabilityBitmap();
+
+    ReachabilityBitmap(const ReachabilityBitmap& other) = delete;
+    ReachabilityBitmap(ReachabilityBitmap&& other) = delete;
+    ReachabilityBitmap& operator=(const ReachabilityBitmap& other) = delete;
+    ReachabilityBitmap& operator=(ReachabilityBitmap&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~ReachabilityBitmap() = default;
+
+    ///
+    /// Search positions reachable from the initial position.
+    ///
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    /// @return  the number of levels of the search, which is the number of turns to reach the farthest
+    ///          position plus one.
+    ///
+    /// It performs breadth-first search level by level.  Positions in the frontier of a level are divided
+    /// among threads.  Positions where either player has won are not expanded.  It throws an exception if
+    /// it fails to allocate the frontiers or to create threads.
+    ///
+    int compute(int threadNums);
+
+    ///
+    /// Whether the position is reachable.
+    ///
+    /// @param   id  a minimized position ID.
+    /// @return  true if reachable.
+    ///
+    bool test(PositionId id) const noexcept {
+        return (words_[id / 64u].load(std::memory_order_relaxed) >> (id % 64u)) & 1u;
+    }
+
+    ///
+    /// Mark the position as reachable.
+    ///
+    /// @param   id  a minimized position ID.
+    /// @return  true if the bit has been set by this call, false if it had already been set.
+    ///
+    /// It is safe to call it from multiple threads at once.  Only one of the threads setting the same bit
+    /// gets true.
+    ///
+    bool set(PositionId id) noexcept {
+        std::uint64_t mask = std::uint64_t(1) << (id % 64u);
+        if ((words_[id / 64u].load(std::memory_order_relaxed) & mask) != 0u) {
+            return false;
+        }
+        return (words_[id / 64u].fetch_or(mask, std::memory_order_relaxed) & mask) == 0u;
+    }
+
+    ///
+    /// Return the number of reachable positions.
+    ///
+    /// @return  the number of bits set.
+    ///
+    PositionId count() const noexcept;
+
+    ///
+    /// Return the bitmap as bytes.
+    ///
+    /// @return  a pointer to the bitmap of `byte_size()` bytes.
+    ///
+    /// It must not be used while compute() is running.
+    ///
+    const std::uint8_t* data() const noexcept {
+        return reinterpret_cast<const std::uint8_t*>(words_.get());
+    }
+
+    ///
+    /// Return the bitmap as bytes to be written.
+    ///
+    /// @return  a pointer to the bitmap of `byte_size()` bytes.
+    ///
+    std::uint8_t* data() noexcept {
+        return reinterpret_cast<std::uint8_t*>(words_.get());
+    }
+
+    ///
+    /// Return the size of the bitmap.
+    ///
+    /// @return  the number of bytes.
+    ///
+    static constexpr std::size_t byte_size() noexcept {
+        return ReachabilityBitmapWordNums * sizeof(std::uint64_t);
+    }
+
+private:
+    /// Unit tests access the internals through it.
+    friend class ReachabilityBitmapTestPeer;
+
+    ///
+    /// Expand positions in a range of the frontier.
+    ///
+    /// @param   frontier     the frontier of the current level.
+    /// @param   next         the frontier of the next level.
+    /// @param   beginWord    the first word of the range.
+    /// @param   endWord      the word next to the last of the range.
+    /// @return  true if a position has been added to the next frontier.
+    ///
+    bool expand_range(const std::atomic<std::uint64_t>* frontier, std::atomic<std::uint64_t>* next,
+        std::size_t beginWord, std::size_t endWord) noexcept;
+
+    /// Bits of reachable positions.
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_REACHABILITY_HPP
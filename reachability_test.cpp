@@ -0,0 +1,200 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include "reachability.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+namespace gobb_analyzer {
+
+//
+// Access to the internals of ReachabilityBitmap for the tests.
+//
+class ReachabilityBitmapTestPeer {
+public:
+    static bool expand_range(ReachabilityBitmap& reachable, const std::atomic<std::uint64_t>* frontier,
+        std::atomic<std::uint64_t>* next, std::size_t beginWord, std::size_t endWord) {
+        return reachable.expand_range(frontier, next, beginWord, endWord);
+    }
+};
+
+} // namespace gobb_analyzer
+
+namespace {
+
+using Frontier = std::unique_ptr<std::atomic<std::uint64_t>[]>;
+
+//
+// Allocate a frontier with no bit set.
+//
+Frontier allocate_frontier() {
+    return Frontier(new std::atomic<std::uint64_t>[ReachabilityBitmapWordNums]());
+}
+
+//
+// Whether the position is in the frontier.
+//
+bool frontier_has(const Frontier& frontier, PositionId id) {
+    return (frontier[id / 64u].load() >> (id % 64u)) & 1u;
+}
+
+//
+// Return the positions in the frontier.
+//
+std::set<PositionId> frontier_positions(const Frontier& frontier) {
+    std::set<PositionId> ids;
+    for (std::size_t w = 0u; w < ReachabilityBitmapWordNums; w++) {
+        std::uint64_t word = frontier[w].load();
+        for (int bit = 0; word != 0u; bit++, word >>= 1) {
+            if (word & 1u) {
+                ids.insert(static_cast<PositionId>(w * 64u + bit));
+            }
+        }
+    }
+    return ids;
+}
+
+//
+// Return the minimized positions reachable by a move from a position.
+//
+std::set<PositionId> successors(PositionId id) {
+    std::set<PositionId> ids;
+    Position pos(id);
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+        for (LocationId src: locPair.locations) {
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status == MoveResultStatus::Success) {
+                    ids.insert(moveResult.position.minimize_id());
+                }
+            }
+        }
+    }
+    return ids;
+}
+
+//
+// Start a search from the initial position.
+//
+PositionId seed_initial_position(ReachabilityBitmap& reachable, Frontier& frontier) {
+    PositionId initialId = Position(InitialPositionId).minimize_id();
+    reachable.set(initialId);
+    frontier[initialId / 64u].fetch_or(std::uint64_t(1) << (initialId % 64u));
+    return initialId;
+}
+
+} // namespace
+
+//
+// Test that set() marks only the given position, and tells whether the bit was newly set.
+//
+TEST(ReachabilityBitmapTest, SetAndTest) {
+    ReachabilityBitmap reachable;
+    const PositionId ids[] = {0u, 63u, 64u, AnalysisDataTableSize - 1u};
+
+    for (PositionId id: ids) {
+        ASSERT_FALSE(reachable.test(id));
+        ASSERT_TRUE(reachable.set(id));
+        ASSERT_FALSE(reachable.set(id));
+        ASSERT_TRUE(reachable.test(id));
+    }
+    ASSERT_FALSE(reachable.test(1u));
+    ASSERT_FALSE(reachable.test(62u));
+    ASSERT_FALSE(reachable.test(65u));
+    ASSERT_FALSE(reachable.test(AnalysisDataTableSize - 2u));
+    ASSERT_EQ(reachable.count(), 4u);
+}
+
+//
+// Test that the next frontier of the initial position consists of the positions reachable by a move, and
+// that a position already reached is not added again.
+//
+TEST(ReachabilityBitmapTest, FrontierOfInitialPosition) {
+    ReachabilityBitmap reachable;
+    Frontier frontier = allocate_frontier();
+    Frontier next = allocate_frontier();
+    PositionId initialId = seed_initial_position(reachable, frontier);
+
+    ASSERT_TRUE(ReachabilityBitmapTestPeer::expand_range(reachable, frontier.get(), next.get(), 0u,
+        ReachabilityBitmapWordNums));
+    std::set<PositionId> expected = successors(InitialPositionId);
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(frontier_positions(next), expected);
+    for (PositionId id: expected) {
+        ASSERT_TRUE(reachable.test(id));
+    }
+    ASSERT_FALSE(frontier_has(next, initialId));
+    ASSERT_EQ(reachable.count(), expected.size() + 1u);
+
+    //
+    // Expanding the same frontier again finds nothing new.
+    //
+    Frontier again = allocate_frontier();
+    ASSERT_FALSE(ReachabilityBitmapTestPeer::expand_range(reachable, frontier.get(), again.get(), 0u,
+        ReachabilityBitmapWordNums));
+    ASSERT_TRUE(frontier_positions(again).empty());
+}
+
+//
+// Test that dividing a frontier into ranges, as threads do, gives the same next frontier as one range.
+//
+TEST(ReachabilityBitmapTest, FrontierRanges) {
+    ReachabilityBitmap wholeReachable;
+    ReachabilityBitmap splitReachable;
+    Frontier frontier = allocate_frontier();
+    Frontier wholeNext = allocate_frontier();
+    Frontier splitNext = allocate_frontier();
+
+    //
+    // Both searches expand the second level from the same frontier.
+    //
+    Frontier initial = allocate_frontier();
+    seed_initial_position(wholeReachable, initial);
+    ReachabilityBitmapTestPeer::expand_range(wholeReachable, initial.get(), frontier.get(), 0u,
+        ReachabilityBitmapWordNums);
+    for (PositionId id: frontier_positions(frontier)) {
+        splitReachable.set(id);
+    }
+    splitReachable.set(Position(InitialPositionId).minimize_id());
+
+    ASSERT_TRUE(ReachabilityBitmapTestPeer::expand_range(wholeReachable, frontier.get(), wholeNext.get(), 0u,
+        ReachabilityBitmapWordNums));
+    constexpr std::size_t rangeNums = 3u;
+    std::size_t rangeSize = (ReachabilityBitmapWordNums + rangeNums - 1u) / rangeNums;
+    for (std::size_t range = 0u; range < rangeNums; range++) {
+        std::size_t endWord = (range + 1u) * rangeSize;
+        if (endWord > ReachabilityBitmapWordNums) {
+            endWord = ReachabilityBitmapWordNums;
+        }
+        ReachabilityBitmapTestPeer::expand_range(splitReachable, frontier.get(), splitNext.get(),
+            range * rangeSize, endWord);
+    }
+
+    std::set<PositionId> wholePositions = frontier_positions(wholeNext);
+    ASSERT_FALSE(wholePositions.empty());
+    ASSERT_EQ(frontier_positions(splitNext), wholePositions);
+    ASSERT_EQ(splitReachable.count(), wholeReachable.count());
+    for (PositionId id: wholePositions) {
+        ASSERT_TRUE(splitReachable.test(id));
+    }
+}
@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#ifndef GOBB_ANALYZER_RUN_THREADS_HPP
+#define GOBB_ANALYZER_RUN_THREADS_HPP
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+///
+/// @file   run_threads.hpp
+/// @brief  Define `run_threads()` function.
+///
+namespace gobb_analyzer {
+
+///
+/// Run a worker on the given number of threads, and wait until all of them finish.
+///
+/// The worker is called with the thread number from 0 to `threadNums - 1`.  The calling thread works as
+/// the thread 0, and the others are created.  If it fails to create a thread, it gives up creating the
+/// rest, calls `on_create_failure` with the number of the threads not created, runs the thread 0 and
+/// joins the created threads, and then rethrows the exception of the failure.
+///
+/// @param   threadNums         the number of threads.
+/// @param   worker             the worker, callable as `worker(int)`.
+/// @param   on_create_failure  called as `on_create_failure(int)` when it fails to create a thread.
+///
+template <typename Worker, typename CreateFailureHandler>
+void run_threads(int threadNums, Worker&& worker, CreateFailureHandler&& on_create_failure) {
+    std::vector<std::thread> threads;
+    std::exception_ptr createError;
+    for (int i = 1; i < threadNums; i++) {
+        try {
+            threads.emplace_back(worker, i);
+        } catch (...) {
+            createError = std::current_exception();
+            on_create_failure(threadNums - i);
+            break;
+        }
+    }
+    worker(0);
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+    if (createError) {
+        std::rethrow_exception(createError);
+    }
+}
+
+///
+/// Run a worker on the given number of threads, and wait until all of them finish.
+///
+/// It is the same as the other `run_threads()`, but does nothing more on a failure to create a thread.
+///
+/// @param   threadNums  the number of threads.
+/// @param   worker      the worker, callable as `worker(int)`.
+///
+template <typename Worker>
+void run_threads(int threadNums, Worker&& worker) {
+    run_threads(threadNums, worker, [](int) {});
+}
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_RUN_THREADS_HPP
@@ -0,0 +1,285 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "search_solver.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(AnalysisDataTableSize <= 0xffff'ffffu, "minimized position IDs must fit keys of the table");
+static_assert(MaxSearchDepth < 0xff, "a depth must fit an entry of the table");
+
+//
+// Class SearchSolver.
+//
+SearchSolver::SearchSolver(std::size_t tableEntryNums)
+    : table_(),
+      tableMask_(0u),
+      nodeNums_(0u) {
+    std::size_t entryNums = 1u;
+    while (entryNums * 2u <= tableEntryNums) {
+        entryNums *= 2u;
+    }
+    table_.resize(entryNums);
+    tableMask_ = entryNums - 1u;
+    clear();
+}
+
+PositionInspectionResult SearchSolver::solve(PositionId id, int maxDepth) noexcept {
+    if (!is_valid_positionId(id)) {
+        return PositionInspectionResult {id, 0u, AnalysisStatus::Invalid};
+    }
+    if (maxDepth > MaxSearchDepth) {
+        maxDepth = MaxSearchDepth;
+    }
+
+    Position pos(id);
+    NodeKind kind = classify(pos);
+    if (kind == NodeKind::Contradictory) {
+        return PositionInspectionResult {id, 0u, AnalysisStatus::Contradictory};
+    } else if (kind == NodeKind::Lost) {
+        return PositionInspectionResult {id, 0u, AnalysisStatus::Lost};
+    }
+
+    //
+    // The first depth where a win or a loss is proved is the number of remaining turns.
+    //
+    PositionId key = pos.minimize_id();
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        if (wins_within(pos, key, depth)) {
+            return PositionInspectionResult {id, static_cast<Turn>(depth), AnalysisStatus::Won};
+        }
+        if (loses_within(pos, key, depth)) {
+            return PositionInspectionResult {id, static_cast<Turn>(depth), AnalysisStatus::Lost};
+        }
+    }
+    return PositionInspectionResult {id, 0u, AnalysisStatus::Unfixed};
+}
+
+void SearchSolver::clear() noexcept {
+    for (TableEntry& entry: table_) {
+        entry = TableEntry {EmptyKey, UnknownTurn, 0u, UnknownTurn, 0u};
+    }
+}
+
+std::uint64_t SearchSolver::node_nums() const noexcept {
+    return nodeNums_;
+}
+
+std::size_t SearchSolver::table_byte_size() const noexcept {
+    return table_.size() * sizeof(TableEntry);
+}
+
+SearchSolver::NodeKind SearchSolver::classify(const Position& pos) noexcept {
+    if (pos.is_winner(PlayerId::Active)) {
+        return NodeKind::Contradictory;
+    }
+
+    int activePieceNums = 0;
+    int inactivePieceNums = 0;
+    for (std::size_t i = 0u; i < PlayerPieceIdNums; i++) {
+        LocationIdPair activeLocPair = pos.locations_of_piece(ActivePlayerPieceIds[i]);
+        LocationIdPair inactiveLocPair = pos.locations_of_piece(InactivePlayerPieceIds[i]);
+        for (int j = 0; j < 2; j++) {
+            if (activeLocPair.locations[j] != LocationId::Out) {
+                activePieceNums++;
+            }
+            if (inactiveLocPair.locations[j] != LocationId::Out) {
+                inactivePieceNums++;
+            }
+        }
+    }
+    if ((activePieceNums == 0 && inactivePieceNums >= 2) || (inactivePieceNums == 0 && activePieceNums >= 1)) {
+        return NodeKind::Contradictory;
+    }
+
+    if (pos.is_winner(PlayerId::Inactive) || !has_moves(pos)) {
+        return NodeKind::Lost;
+    }
+    return NodeKind::Inner;
+}
+
+bool SearchSolver::wins_within(const Position& pos, PositionId key, int depth) noexcept {
+    if (depth < 1) {
+        return false;
+    }
+    const TableEntry* entry = find_entry(key);
+    if (entry != nullptr && entry->winTurn <= depth) {
+        return true;
+    }
+    if (entry != nullptr && depth < entry->winFailDepth) {
+        return false;
+    }
+    nodeNums_++;
+
+    //
+    // A move after which the opponent has lost wins at once.  Then moves whose results are in the table
+    // are tried, and the others are searched.
+    //
+    Position children[MaxMoveNums];
+    PositionId childKeys[MaxMoveNums];
+    int pendingIndexes[MaxMoveNums];
+    int pendingNums = 0;
+    int childNums = generate_children(pos, children);
+    bool won = false;
+
+    for (int i = 0; i < childNums && !won; i++) {
+        NodeKind kind = classify(children[i]);
+        if (kind == NodeKind::Lost) {
+            won = true;
+        } else if (kind == NodeKind::Inner && depth >= 3) {
+            childKeys[i] = children[i].minimize_id();
+            const TableEntry* childEntry = find_entry(childKeys[i]);
+            if (childEntry != nullptr && childEntry->lossTurn <= depth - 1) {
+                won = true;
+            } else if (childEntry == nullptr || depth - 1 >= childEntry->lossFailDepth) {
+                pendingIndexes[pendingNums++] = i;
+            }
+        }
+    }
+    for (int j = 0; j < pendingNums && !won; j++) {
+        int i = pendingIndexes[j];
+        won = loses_within(children[i], childKeys[i], depth - 1);
+    }
+
+    TableEntry& newEntry = entry_of(key);
+    if (won) {
+        if (depth < newEntry.winTurn) {
+            newEntry.winTurn = static_cast<std::uint8_t>(depth);
+        }
+    } else if (depth + 1 > newEntry.winFailDepth) {
+        newEntry.winFailDepth = static_cast<std::uint8_t>(depth + 1);
+    }
+    return won;
+}
+
+bool SearchSolver::loses_within(const Position& pos, PositionId key, int depth) noexcept {
+    //
+    // The active player has a possible move, and the opponent needs a turn to win after it.
+    //
+    if (depth < 2) {
+        return false;
+    }
+    const TableEntry* entry = find_entry(key);
+    if (entry != nullptr && entry->lossTurn <= depth) {
+        return true;
+    }
+    if (entry != nullptr && depth < entry->lossFailDepth) {
+        return false;
+    }
+    nodeNums_++;
+
+    //
+    // Every move must be followed by a win of the opponent.  Moves refuted by the table are found first.
+    //
+    Position children[MaxMoveNums];
+    PositionId childKeys[MaxMoveNums];
+    int pendingIndexes[MaxMoveNums];
+    int pendingNums = 0;
+    int childNums = generate_children(pos, children);
+    bool lost = true;
+
+    for (int i = 0; i < childNums && lost; i++) {
+        NodeKind kind = classify(children[i]);
+        if (kind != NodeKind::Inner) {
+            lost = false;
+        } else {
+            childKeys[i] = children[i].minimize_id();
+            const TableEntry* childEntry = find_entry(childKeys[i]);
+            if (childEntry != nullptr && depth - 1 < childEntry->winFailDepth) {
+                lost = false;
+            } else if (childEntry == nullptr || childEntry->winTurn > depth - 1) {
+                pendingIndexes[pendingNums++] = i;
+            }
+        }
+    }
+    for (int j = 0; j < pendingNums && lost; j++) {
+        int i = pendingIndexes[j];
+        lost = wins_within(children[i], childKeys[i], depth - 1);
+    }
+
+    TableEntry& newEntry = entry_of(key);
+    if (lost) {
+        if (depth < newEntry.lossTurn) {
+            newEntry.lossTurn = static_cast<std::uint8_t>(depth);
+        }
+    } else if (depth + 1 > newEntry.lossFailDepth) {
+        newEntry.lossFailDepth = static_cast<std::uint8_t>(depth + 1);
+    }
+    return lost;
+}
+
+bool SearchSolver::has_moves(const Position& pos) noexcept {
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                if (pos.move(piece, src, dst).status == MoveResultStatus::Success) {
+                    return true;
+                }
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+int SearchSolver::generate_children(const Position& pos, Position* children) noexcept {
+    int nums = 0;
+
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status == MoveResultStatus::Success) {
+                    children[nums++] = moveResult.position;
+                }
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+
+    return nums;
+}
+
+SearchSolver::TableEntry& SearchSolver::entry_of(PositionId key) noexcept {
+    TableEntry& entry = table_[(key * 0x9e37'79b9'7f4a'7c15u >> 32) & tableMask_];
+    if (entry.key != key) {
+        entry = TableEntry {static_cast<std::uint32_t>(key), UnknownTurn, 0u, UnknownTurn, 0u};
+    }
+    return entry;
+}
+
+const SearchSolver::TableEntry* SearchSolver::find_entry(PositionId key) const noexcept {
+    const TableEntry& entry = table_[(key * 0x9e37'79b9'7f4a'7c15u >> 32) & tableMask_];
+    if (entry.key != key) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,210 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_SEARCH_SOLVER_HPP
+#define GOBB_ANALYZER_SEARCH_SOLVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "analyzer.hpp"
+#include "inspector.hpp"
+#include "position.hpp"
+
+///
+/// @file   search_solver.hpp
+/// @brief  Define `SearchSolver` class, which solves a position by search without the analysis table.
+///
+namespace gobb_analyzer {
+
+/// The maximum depth of search in plies.
+constexpr int MaxSearchDepth = 250;
+
+///
+/// A solver of a single position by search, without the analysis table.
+///
+/// It searches the game tree from a position by iterative deepening on the number of remaining turns.
+/// At each depth, it asks whether the active player wins within the depth and whether he loses within
+/// the depth, with short-circuit evaluation (alpha-beta search with a null window).  The first depth where
+/// either is proved gives the status and the number of remaining turns, which are the same as those of
+/// the analysis table generated by `Analyzer`.  A position which is neither won nor lost within the
+/// maximum depth is reported as `AnalysisStatus::Unfixed`, so that it is a draw if the maximum depth is
+/// large enough.
+///
+/// Results of sub-searches are kept in a transposition table of a fixed size, keyed by minimized position
+/// IDs.  Moves which win at once and moves whose results are in the table are tried first.
+///
+class SearchSolver {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   tableEntryNums  the number of entries of the transposition table, which is rounded down
+    ///                          to a power of two.  If it is less than 1, 1 is used.
+    ///
+    /// It throws `std::bad_alloc` if it fails to allocate the table.
+    ///
+    SearchSolver(std::size_t tableEntryNums);
+
+    SearchSolver(const SearchSolver& other) = delete;
+    SearchSolver(SearchSolver&& other) = delete;
+    SearchSolver& operator=(const SearchSolver& other) = delete;
+    SearchSolver& operator=(SearchSolver&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~SearchSolver() = default;
+
+    ///
+    /// Solve a position.
+    ///
+    /// @param   id        a position ID.
+    /// @param   maxDepth  the maximum depth of search in plies, up to `MaxSearchDepth`.
+    /// @return  the status and the number of remaining turns of the position.
+    ///
+    /// The transposition table is kept between calls, so that solving positions of the same game is faster.
+    ///
+    PositionInspectionResult solve(PositionId id, int maxDepth) noexcept;
+
+    ///
+    /// Clear the transposition table.
+    ///
+    void clear() noexcept;
+
+    ///
+    /// Return the number of positions searched since the solver was constructed.
+    ///
+    /// @return  the number of positions.
+    ///
+    std::uint64_t node_nums() const noexcept;
+
+    ///
+    /// Return the size of the transposition table.
+    ///
+    /// @return  the number of bytes.
+    ///
+    std::size_t table_byte_size() const noexcept;
+
+    ///
+    /// Classification of a position before searching its moves.
+    ///
+    enum class NodeKind {
+        Inner,          ///< the game goes on.
+        Lost,           ///< the active player has lost with no remaining turn.
+        Contradictory   ///< the position never appears in a game, and it is neither won nor lost.
+    };
+
+    ///
+    /// Classify a position in the same way as `Analyzer` initializes the table.
+    ///
+    /// @param   pos  a position.
+    /// @return  the kind of the position.
+    ///
+    /// A position without possible moves is classified as `NodeKind::Lost`.  `Analyzer` marks it with
+    /// `AnalysisStatus::LostStalemate` at first, but then it derives `AnalysisStatus::Lost` with no
+    /// remaining turn from the empty set of moves, and the table keeps the latter.
+    ///
+    static NodeKind classify(const Position& pos) noexcept;
+
+    ///
+    /// Whether the active player has a possible move.
+    ///
+    /// @param   pos  a position.
+    /// @return  true if he has.
+    ///
+    static bool has_moves(const Position& pos) noexcept;
+
+    ///
+    /// Generate positions after possible moves.
+    ///
+    /// @param   pos        a position.
+    /// @param   children   an array of `MaxMoveNums` elements, where positions after moves are put.
+    /// @return  the number of possible moves.
+    ///
+    static int generate_children(const Position& pos, Position* children) noexcept;
+
+private:
+    ///
+    /// An entry of the transposition table.
+    ///
+    /// The active player wins within `d` plies if `d >= winTurn`, and doesn't if `d < winFailDepth`.
+    /// It is the same for losses.  `UnknownTurn` means that no depth is proved.
+    ///
+    struct TableEntry {
+        std::uint32_t key;           ///< a minimized position ID, or `EmptyKey`.
+        std::uint8_t winTurn;        ///< the least depth where a win is proved.
+        std::uint8_t winFailDepth;   ///< a win is disproved at depths less than this.
+        std::uint8_t lossTurn;       ///< the least depth where a loss is proved.
+        std::uint8_t lossFailDepth;  ///< a loss is disproved at depths less than this.
+    };
+
+    /// The key of an empty entry.
+    static constexpr std::uint32_t EmptyKey = 0xffff'ffffu;
+
+    /// The turn of an entry where nothing is proved.
+    static constexpr std::uint8_t UnknownTurn = 0xffu;
+
+    ///
+    /// Whether the active player wins within the specified number of plies.
+    ///
+    /// @param   pos    a position classified as `NodeKind::Inner`.
+    /// @param   key    the minimized position ID of `pos`.
+    /// @param   depth  the number of plies.
+    /// @return  true if he wins.
+    ///
+    bool wins_within(const Position& pos, PositionId key, int depth) noexcept;
+
+    ///
+    /// Whether the active player loses within the specified number of plies.
+    ///
+    /// @param   pos    a position classified as `NodeKind::Inner`.
+    /// @param   key    the minimized position ID of `pos`.
+    /// @param   depth  the number of plies.
+    /// @return  true if he loses.
+    ///
+    bool loses_within(const Position& pos, PositionId key, int depth) noexcept;
+
+    ///
+    /// Return the entry of the transposition table for a position.
+    ///
+    /// @param   key  a minimized position ID.
+    /// @return  the entry, which is cleared if it has been used by another position.
+    ///
+    TableEntry& entry_of(PositionId key) noexcept;
+
+    ///
+    /// Look up a proved result in the transposition table without replacing an entry.
+    ///
+    /// @param   key  a minimized position ID.
+    /// @return  the entry, or nullptr if the position is not found.
+    ///
+    const TableEntry* find_entry(PositionId key) const noexcept;
+
+    /// The transposition table.
+    std::vector<TableEntry> table_;
+
+    /// The mask to get an index of `table_` from a hash value.
+    std::size_t tableMask_;
+
+    /// The number of positions searched.
+    std::uint64_t nodeNums_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_SEARCH_SOLVER_HPP
@@ -0,0 +1,125 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "search_solver.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test SearchSolver::solve() for positions decided without search.
+//
+TEST(SearchSolverTest, SolveTerminal) {
+    SearchSolver solver(1024u);
+    PositionInspectionResult result;
+
+    // The active player has a line.
+    Position pos(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::W}, {LocationId::Out, LocationId::Out},
+         {LocationId::N,   LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::NE,  LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    result = solver.solve(pos.id(), 10);
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Contradictory);
+
+    // The inactive player has a line.
+    pos = Position(PlayerColor::Orange,
+        {{LocationId::W,   LocationId::Out}, {LocationId::NW, LocationId::Out},
+         {LocationId::SW,  LocationId::Out}, {LocationId::N,  LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::NE, LocationId::Out}});
+    result = solver.solve(pos.id(), 10);
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Lost);
+    ASSERT_EQ(result.turn, 0);
+
+    result = solver.solve(InvalidPositionId, 10);
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Invalid);
+}
+
+//
+// Test SearchSolver::solve() for a position won at once.
+//
+TEST(SearchSolverTest, SolveWonAtOnce) {
+    SearchSolver solver(1024u);
+
+    // The active player puts the large piece on NE.
+    Position pos(PlayerColor::Orange,
+        {{LocationId::NW,  LocationId::N},  {LocationId::W,   LocationId::SW},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out},
+         {LocationId::Out, LocationId::Out}, {LocationId::Out, LocationId::Out}});
+    PositionInspectionResult result = solver.solve(pos.id(), 10);
+    ASSERT_EQ(result.analysisStatus, AnalysisStatus::Won);
+    ASSERT_EQ(result.turn, 1);
+}
+
+//
+// Test that results of SearchSolver::solve() agree with the results of the positions after moves.
+//
+TEST(SearchSolverTest, SolveConsistency) {
+    constexpr int MaxDepth = 5;
+    SearchSolver solver(1u << 16);
+
+    //
+    // Follows a game where the first possible move is chosen at each turn.
+    //
+    Position pos(InitialPositionId);
+    for (int turn = 0; turn < 6; turn++) {
+        PositionInspectionResult result = solver.solve(pos.id(), MaxDepth);
+        ASSERT_TRUE(result.analysisStatus == AnalysisStatus::Won || result.analysisStatus == AnalysisStatus::Lost ||
+            result.analysisStatus == AnalysisStatus::Unfixed);
+
+        //
+        // A position won in n turns has a move to a position lost in n - 1 turns, and all moves of a position
+        // lost in n turns lead to positions won in n - 1 turns or less.
+        //
+        bool foundLost = false;
+        int maxWonTurn = 0;
+        Position next;
+        bool hasNext = false;
+        for (PieceId piece: ActivePlayerPieceIds) {
+            LocationIdPair locPair = pos.locations_of_piece(piece);
+            for (int i = 0; i < 2; i++) {
+                for (LocationId dst: OnBoardLocationIds) {
+                    MoveResult moveResult = pos.move(piece, locPair.locations[i], dst);
+                    if (moveResult.status != MoveResultStatus::Success) {
+                        continue;
+                    }
+                    PositionInspectionResult childResult = solver.solve(moveResult.position.id(), MaxDepth - 1);
+                    if (childResult.analysisStatus == AnalysisStatus::Lost && childResult.turn + 1 == result.turn) {
+                        foundLost = true;
+                    }
+                    if (childResult.analysisStatus == AnalysisStatus::Won && childResult.turn > maxWonTurn) {
+                        maxWonTurn = childResult.turn;
+                    }
+                    if (!hasNext && !moveResult.position.is_winner(PlayerId::Inactive)) {
+                        next = moveResult.position;
+                        hasNext = true;
+                    }
+                }
+                if (locPair.locations[0] == locPair.locations[1]) {
+                    break;
+                }
+            }
+        }
+        if (result.analysisStatus == AnalysisStatus::Won) {
+            ASSERT_TRUE(foundLost);
+        } else if (result.analysisStatus == AnalysisStatus::Lost) {
+            ASSERT_EQ(maxWonTurn + 1, result.turn);
+        }
+
+        ASSERT_TRUE(hasNext);
+        pos = next;
+    }
+}
@@ -0,0 +1,295 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include "status_index.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(sizeof(StatusIndexHeader) % 8u == 0u, "containers must be aligned to 8 bytes");
+static_assert(sizeof(StatusIndexBucket) == 24u, "a bucket must be packed");
+static_assert(sizeof(StatusIndexContainer) == 16u, "a container must be packed");
+static_assert(StatusIndexKeyNums <= 0xffff'ffffu, "keys must fit 32 bits");
+
+namespace {
+
+/// The number of values of analysis data without the update flag.
+constexpr std::size_t BucketDataNums = 0x8000u;
+
+//
+// Return the number of bytes of a container, including the padding.
+//
+inline std::size_t container_byte_size(std::uint32_t cardinality) noexcept {
+    if (cardinality > StatusIndexArrayMaxNums) {
+        return StatusIndexBitmapSize;
+    }
+    return (cardinality * sizeof(std::uint16_t) + 7u) & ~std::size_t(7u);
+}
+
+//
+// Append a plain value to an image.
+//
+template <typename T>
+void append_value(std::vector<std::uint8_t>& image, const T& value) {
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    image.insert(image.end(), bytes, bytes + sizeof(T));
+}
+
+} // namespace
+
+//
+// Class StatusIndex.
+//
+StatusIndex::StatusIndex() noexcept
+    : image_(nullptr),
+      buckets_(nullptr),
+      bucketNums_(0u),
+      containers_(nullptr) {
+}
+
+bool StatusIndex::assign(const std::uint8_t* image, std::size_t imageSize) noexcept {
+    image_ = nullptr;
+    buckets_ = nullptr;
+    bucketNums_ = 0u;
+    containers_ = nullptr;
+
+    if (image == nullptr || reinterpret_cast<std::uintptr_t>(image) % 8u != 0u ||
+        imageSize < sizeof(StatusIndexHeader)) {
+        return false;
+    }
+    const StatusIndexHeader* header = reinterpret_cast<const StatusIndexHeader*>(image);
+    if (header->bucketNums > BucketDataNums || header->containerNums > BucketDataNums * StatusIndexKeyNums ||
+        header->bucketOffset % 8u != 0u || header->containerOffset % 8u != 0u ||
+        header->bucketOffset > imageSize ||
+        header->bucketNums * sizeof(StatusIndexBucket) > imageSize - header->bucketOffset ||
+        header->containerOffset > imageSize ||
+        header->containerNums * sizeof(StatusIndexContainer) > imageSize - header->containerOffset) {
+        return false;
+    }
+
+    //
+    // Every container must be in the image, so that list() never reads out of it.
+    //
+    const StatusIndexBucket* buckets = reinterpret_cast<const StatusIndexBucket*>(image + header->bucketOffset);
+    const StatusIndexContainer* containers =
+        reinterpret_cast<const StatusIndexContainer*>(image + header->containerOffset);
+    for (std::uint64_t i = 0u; i < header->bucketNums; i++) {
+        const StatusIndexBucket& bucket = buckets[i];
+        if ((i > 0u && buckets[i - 1u].data >= bucket.data) || bucket.data >= BucketDataNums ||
+            bucket.firstContainer > header->containerNums ||
+            bucket.containerNums > header->containerNums - bucket.firstContainer) {
+            return false;
+        }
+        std::uint64_t cardinality = 0u;
+        for (std::uint64_t j = bucket.firstContainer; j < bucket.firstContainer + bucket.containerNums; j++) {
+            const StatusIndexContainer& container = containers[j];
+            if ((j > bucket.firstContainer && containers[j - 1u].key >= container.key) ||
+                container.key >= StatusIndexKeyNums || container.cardinality == 0u ||
+                container.cardinality > StatusIndexContainerSize || container.offset % 8u != 0u ||
+                container.offset > imageSize ||
+                container_byte_size(container.cardinality) > imageSize - container.offset) {
+                return false;
+            }
+            cardinality += container.cardinality;
+        }
+        if (cardinality != bucket.cardinality) {
+            return false;
+        }
+    }
+
+    image_ = image;
+    buckets_ = buckets;
+    bucketNums_ = header->bucketNums;
+    containers_ = containers;
+    return true;
+}
+
+std::uint64_t StatusIndex::count(AnalysisData data) const noexcept {
+    const StatusIndexBucket* bucket = find_bucket(data);
+    if (bucket == nullptr) {
+        return 0u;
+    }
+    return bucket->cardinality;
+}
+
+std::size_t StatusIndex::list(AnalysisData data, PositionId beginId, PositionId* ids, std::size_t maxNums)
+    const noexcept {
+    const StatusIndexBucket* bucket = find_bucket(data);
+    if (bucket == nullptr || maxNums == 0u) {
+        return 0u;
+    }
+
+    const StatusIndexContainer* first = containers_ + bucket->firstContainer;
+    const StatusIndexContainer* last = first + bucket->containerNums;
+    std::uint32_t beginKey = static_cast<std::uint32_t>(beginId / StatusIndexContainerSize);
+    const StatusIndexContainer* container = std::lower_bound(first, last, beginKey,
+        [](const StatusIndexContainer& c, std::uint32_t key) { return c.key < key; });
+
+    std::size_t nums = 0u;
+    for (; container != last; container++) {
+        PositionId base = static_cast<PositionId>(container->key) * StatusIndexContainerSize;
+        std::uint32_t beginValue = 0u;
+        if (container->key == beginKey) {
+            beginValue = static_cast<std::uint32_t>(beginId % StatusIndexContainerSize);
+        }
+
+        if (container->cardinality <= StatusIndexArrayMaxNums) {
+            const std::uint16_t* values = reinterpret_cast<const std::uint16_t*>(image_ + container->offset);
+            const std::uint16_t* end = values + container->cardinality;
+            for (const std::uint16_t* v = std::lower_bound(values, end, beginValue); v != end; v++) {
+                ids[nums++] = base + *v;
+                if (nums >= maxNums) {
+                    return nums;
+                }
+            }
+        } else {
+            const std::uint64_t* words = reinterpret_cast<const std::uint64_t*>(image_ + container->offset);
+            for (std::uint32_t w = beginValue / 64u; w < StatusIndexContainerSize / 64u; w++) {
+                std::uint64_t word = words[w];
+                if (w == beginValue / 64u) {
+                    word &= ~std::uint64_t(0) << (beginValue % 64u);
+                }
+                for (int bit = 0; word != 0u; bit++) {
+                    if (((word >> bit) & 1u) == 0u) {
+                        continue;
+                    }
+                    word &= ~(std::uint64_t(1) << bit);
+                    ids[nums++] = base + w * 64u + bit;
+                    if (nums >= maxNums) {
+                        return nums;
+                    }
+                }
+            }
+        }
+    }
+
+    return nums;
+}
+
+void StatusIndex::encode_chunk(std::uint32_t key, const AnalysisData* data, std::size_t dataNums,
+    StatusIndexChunk& chunk) {
+    chunk.key = key;
+    chunk.data.clear();
+    chunk.cardinalities.clear();
+    chunk.payload.clear();
+
+    //
+    // Distributes the lower 16 bits of IDs among buckets, in the order of IDs.
+    //
+    std::vector<std::int32_t> slots(BucketDataNums, -1);
+    std::vector<std::vector<std::uint16_t>> values;
+    for (std::size_t i = 0u; i < dataNums; i++) {
+        AnalysisData bucketData = set_updateFlag_of_analysisData(data[i], false);
+        if (status_of_analysisData(bucketData) == AnalysisStatus::Transformed) {
+            continue;
+        }
+        if (slots[bucketData] < 0) {
+            slots[bucketData] = static_cast<std::int32_t>(chunk.data.size());
+            chunk.data.push_back(bucketData);
+            values.emplace_back();
+        }
+        values[slots[bucketData]].push_back(static_cast<std::uint16_t>(i));
+    }
+
+    //
+    // Encodes the containers in ascending order of analysis data.
+    //
+    std::sort(chunk.data.begin(), chunk.data.end());
+    for (AnalysisData bucketData: chunk.data) {
+        const std::vector<std::uint16_t>& bucketValues = values[slots[bucketData]];
+        std::uint32_t cardinality = static_cast<std::uint32_t>(bucketValues.size());
+        std::size_t offset = chunk.payload.size();
+        chunk.cardinalities.push_back(cardinality);
+        chunk.payload.resize(offset + container_byte_size(cardinality), 0u);
+
+        if (cardinality <= StatusIndexArrayMaxNums) {
+            std::memcpy(chunk.payload.data() + offset, bucketValues.data(), cardinality * sizeof(std::uint16_t));
+        } else {
+            std::uint64_t words[StatusIndexContainerSize / 64u] = {};
+            for (std::uint16_t v: bucketValues) {
+                words[v / 64u] |= std::uint64_t(1) << (v % 64u);
+            }
+            std::memcpy(chunk.payload.data() + offset, words, sizeof(words));
+        }
+    }
+}
+
+const StatusIndexBucket* StatusIndex::find_bucket(AnalysisData data) const noexcept {
+    AnalysisData bucketData = set_updateFlag_of_analysisData(data, false);
+    const StatusIndexBucket* last = buckets_ + bucketNums_;
+    const StatusIndexBucket* bucket = std::lower_bound(buckets_, last, bucketData,
+        [](const StatusIndexBucket& b, AnalysisData d) { return b.data < d; });
+    if (bucket == last || bucket->data != bucketData) {
+        return nullptr;
+    }
+    return bucket;
+}
+
+//
+// Class StatusIndexBuilder.
+//
+StatusIndexBuilder::StatusIndexBuilder()
+    : image_(sizeof(StatusIndexHeader), 0u),
+      bucketContainers_(BucketDataNums) {
+}
+
+void StatusIndexBuilder::append(const StatusIndexChunk& chunk) {
+    std::size_t payloadOffset = 0u;
+    for (std::size_t i = 0u; i < chunk.data.size(); i++) {
+        std::size_t size = container_byte_size(chunk.cardinalities[i]);
+        StatusIndexContainer container = {chunk.key, chunk.cardinalities[i], image_.size()};
+        image_.insert(image_.end(), chunk.payload.begin() + payloadOffset,
+            chunk.payload.begin() + payloadOffset + size);
+        bucketContainers_[chunk.data[i]].push_back(container);
+        payloadOffset += size;
+    }
+}
+
+std::vector<std::uint8_t> StatusIndexBuilder::finish() {
+    StatusIndexHeader header = {0u, 0u, image_.size(), 0u};
+    for (AnalysisData data = 0u; data < BucketDataNums; data++) {
+        const std::vector<StatusIndexContainer>& containers = bucketContainers_[data];
+        if (containers.empty()) {
+            continue;
+        }
+        StatusIndexBucket bucket = {data, 0u, static_cast<std::uint32_t>(containers.size()), header.containerNums, 0u};
+        for (const StatusIndexContainer& container: containers) {
+            bucket.cardinality += container.cardinality;
+        }
+        append_value(image_, bucket);
+        header.bucketNums++;
+        header.containerNums += containers.size();
+    }
+
+    header.containerOffset = image_.size();
+    for (std::vector<StatusIndexContainer>& containers: bucketContainers_) {
+        for (const StatusIndexContainer& container: containers) {
+            append_value(image_, container);
+        }
+        containers = std::vector<StatusIndexContainer>();
+    }
+    std::memcpy(image_.data(), &header, sizeof(header));
+
+    std::vector<std::uint8_t> image(std::move(image_));
+    image_.assign(sizeof(StatusIndexHeader), 0u);
+    return image;
+}
+
+} // namespace gobb_analyzer
@@ -0,0 +1,265 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_STATUS_INDEX_HPP
+#define GOBB_ANALYZER_STATUS_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "analyzer.hpp"
+
+///
+/// @file   status_index.hpp
+/// @brief  Define `StatusIndex` class, compressed bitmaps of positions for each status and turn.
+///
+/// A status index has a bucket for each value of analysis data without the update flag, that is, for each
+/// pair of a status and the number of remaining turns.  A bucket is a set of minimized position IDs, which
+/// is divided into containers of `StatusIndexContainerSize` consecutive IDs in the same way as Roaring
+/// bitmaps.  A container with `StatusIndexArrayMaxNums` IDs or less is an array of the lower 16 bits of
+/// the IDs in ascending order, and a larger one is a bitmap of 8192 bytes.  Transformed positions are not
+/// indexed.
+///
+/// An image of a status index is laid out as follows.  Offsets are counted from the beginning of the image,
+/// and containers are aligned to 8 bytes.
+///
+/// 1. `StatusIndexHeader`.
+/// 2. containers.
+/// 3. `StatusIndexBucket` for each bucket, in ascending order of analysis data.
+/// 4. `StatusIndexContainer` for each container, grouped by buckets and sorted by keys.
+///
+namespace gobb_analyzer {
+
+/// The number of position IDs covered by a container.
+constexpr PositionId StatusIndexContainerSize = 0x1'0000u;
+
+/// The number of containers covering the table of analysis data.
+constexpr PositionId StatusIndexKeyNums = (AnalysisDataTableSize + StatusIndexContainerSize - 1u)
+    / StatusIndexContainerSize;
+
+/// The maximum number of IDs in an array container.
+constexpr std::uint32_t StatusIndexArrayMaxNums = 4096u;
+
+/// The number of bytes of a bitmap container.
+constexpr std::size_t StatusIndexBitmapSize = StatusIndexContainerSize / 8u;
+
+///
+/// The header of an image of a status index.
+///
+struct StatusIndexHeader {
+    std::uint64_t bucketNums;       ///< the number of buckets.
+    std::uint64_t containerNums;    ///< the number of containers.
+    std::uint64_t bucketOffset;     ///< the offset of the first `StatusIndexBucket`.
+    std::uint64_t containerOffset;  ///< the offset of the first `StatusIndexContainer`.
+};
+
+///
+/// A bucket of a status index.
+///
+struct StatusIndexBucket {
+    AnalysisData data;               ///< analysis data without the update flag.
+    std::uint16_t reserved;          ///< reserved (0).
+    std::uint32_t containerNums;     ///< the number of containers.
+    std::uint64_t firstContainer;    ///< the index of the first container.
+    std::uint64_t cardinality;       ///< the number of IDs.
+};
+
+///
+/// A container of a status index.
+///
+struct StatusIndexContainer {
+    std::uint32_t key;               ///< the upper bits of IDs, i.e. ID / `StatusIndexContainerSize`.
+    std::uint32_t cardinality;       ///< the number of IDs.
+    std::uint64_t offset;            ///< the offset of the array or the bitmap.
+};
+
+///
+/// Containers of the same key, encoded for all buckets.
+///
+struct StatusIndexChunk {
+    std::uint32_t key;                          ///< the key of the containers.
+    std::vector<AnalysisData> data;             ///< analysis data of the buckets, in ascending order.
+    std::vector<std::uint32_t> cardinalities;   ///< the number of IDs of the containers.
+    std::vector<std::uint8_t> payload;          ///< the arrays and bitmaps of the containers.
+};
+
+///
+/// A status index in memory, typically in a mapped file.
+///
+class StatusIndex {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// It constructs an empty index.
+    ///
+    StatusIndex() noexcept;
+
+    StatusIndex(const StatusIndex& other) = delete;
+    StatusIndex(StatusIndex&& other) = delete;
+    StatusIndex& operator=(const StatusIndex& other) = delete;
+    StatusIndex& operator=(StatusIndex&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~StatusIndex() = default;
+
+    ///
+    /// Use an image of a status index.
+    ///
+    /// @param   image      the image, aligned to 8 bytes.
+    /// @param   imageSize  the number of bytes of the image.
+    /// @return  true upon success.
+    ///
+    /// The image is not copied, so that it must remain while the index is used.  If the image is broken,
+    /// the index gets empty.
+    ///
+    bool assign(const std::uint8_t* image, std::size_t imageSize) noexcept;
+
+    ///
+    /// Whether the index is empty.
+    ///
+    /// @return  true if no image is assigned.
+    ///
+    bool empty() const noexcept {
+        return image_ == nullptr;
+    }
+
+    ///
+    /// Return the number of buckets.
+    ///
+    /// @return  the number of buckets.
+    ///
+    std::size_t bucket_nums() const noexcept {
+        return bucketNums_;
+    }
+
+    ///
+    /// Return a bucket.
+    ///
+    /// @param   index  the index of a bucket, less than `bucket_nums()`.
+    /// @return  the bucket.
+    ///
+    const StatusIndexBucket& bucket(std::size_t index) const noexcept {
+        return buckets_[index];
+    }
+
+    ///
+    /// Count positions with the specified analysis data.
+    ///
+    /// @param   data  analysis data.  The update flag is ignored.
+    /// @return  the number of minimized position IDs.
+    ///
+    std::uint64_t count(AnalysisData data) const noexcept;
+
+    ///
+    /// List positions with the specified analysis data.
+    ///
+    /// @param   data     analysis data.  The update flag is ignored.
+    /// @param   beginId  the smallest position ID to be listed.
+    /// @param   ids      minimized position IDs are put here in ascending order.
+    /// @param   maxNums  the maximum number of IDs to be put.
+    /// @return  the number of IDs put.
+    ///
+    /// Containers before `beginId` are skipped by binary search, so that the cost is proportional to
+    /// the number of IDs listed.
+    ///
+    std::size_t list(AnalysisData data, PositionId beginId, PositionId* ids, std::size_t maxNums) const noexcept;
+
+    ///
+    /// Encode containers of a key.
+    ///
+    /// @param   key       the key of the containers.
+    /// @param   data      analysis data of the positions of the key, in the order of position IDs.
+    /// @param   dataNums  the number of elements in `data`, up to `StatusIndexContainerSize`.
+    /// @param   chunk     the encoded containers are put here.
+    ///
+    /// It is thread safe.
+    ///
+    static void encode_chunk(std::uint32_t key, const AnalysisData* data, std::size_t dataNums,
+        StatusIndexChunk& chunk);
+
+private:
+    ///
+    /// Find a bucket.
+    ///
+    /// @param   data  analysis data.
+    /// @return  the bucket, or nullptr if not found.
+    ///
+    const StatusIndexBucket* find_bucket(AnalysisData data) const noexcept;
+
+    /// The image (nullptr if empty).
+    const std::uint8_t* image_;
+
+    /// The buckets.
+    const StatusIndexBucket* buckets_;
+
+    /// The number of buckets.
+    std::size_t bucketNums_;
+
+    /// The containers.
+    const StatusIndexContainer* containers_;
+};
+
+///
+/// A builder of an image of a status index.
+///
+/// Chunks must be appended in ascending order of keys.
+///
+class StatusIndexBuilder {
+public:
+    ///
+    /// Constructor.
+    ///
+    StatusIndexBuilder();
+
+    StatusIndexBuilder(const StatusIndexBuilder& other) = delete;
+    StatusIndexBuilder(StatusIndexBuilder&& other) = delete;
+    StatusIndexBuilder& operator=(const StatusIndexBuilder& other) = delete;
+    StatusIndexBuilder& operator=(StatusIndexBuilder&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~StatusIndexBuilder() = default;
+
+    ///
+    /// Append containers encoded by `StatusIndex::encode_chunk()`.
+    ///
+    /// @param   chunk  the containers.
+    ///
+    void append(const StatusIndexChunk& chunk);
+
+    ///
+    /// Finish the image.
+    ///
+    /// @return  the image.  The builder gets empty.
+    ///
+    std::vector<std::uint8_t> finish();
+
+private:
+    /// The image being built.
+    std::vector<std::uint8_t> image_;
+
+    /// Containers of each bucket, indexed by analysis data.
+    std::vector<std::vector<StatusIndexContainer>> bucketContainers_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_STATUS_INDEX_HPP
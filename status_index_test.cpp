@@ -0,0 +1,91 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <cstdint>
+#include <vector>
+#include "status_index.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test StatusIndex with an image built from array and bitmap containers.
+//
+TEST(StatusIndexTest, CountAndList) {
+    AnalysisData won3 = to_analysisData(false, 3, AnalysisStatus::Won);
+    AnalysisData lost2 = to_analysisData(false, 2, AnalysisStatus::Lost);
+    AnalysisData unfixed = to_analysisData(false, 0, AnalysisStatus::Unfixed);
+    AnalysisData transformed = to_analysisData(false, 0, AnalysisStatus::Transformed);
+
+    //
+    // Key 0 has a few positions Won in 3 turns (an array container), and key 2 has many (a bitmap container).
+    // Positions Lost in 2 turns have the update flag set.
+    //
+    std::vector<std::uint32_t> keys = {0u, 2u};
+    std::vector<PositionId> wonIds;
+    std::uint64_t transformedNums = 0u;
+    StatusIndexBuilder builder;
+    StatusIndexChunk chunk;
+    for (std::uint32_t key: keys) {
+        std::vector<AnalysisData> data(StatusIndexContainerSize, unfixed);
+        for (std::uint32_t i = 0u; i < StatusIndexContainerSize; i++) {
+            if ((key == 0u && i % 1000u == 7u) || (key == 2u && i % 3u == 0u)) {
+                data[i] = won3;
+                wonIds.push_back(key * StatusIndexContainerSize + i);
+            } else if (i % 5u == 1u) {
+                data[i] = set_updateFlag_of_analysisData(lost2, true);
+            } else if (i % 5u == 2u) {
+                data[i] = transformed;
+                transformedNums++;
+            }
+        }
+        StatusIndex::encode_chunk(key, data.data(), data.size(), chunk);
+        builder.append(chunk);
+    }
+    std::vector<std::uint8_t> image = builder.finish();
+
+    StatusIndex index;
+    ASSERT_TRUE(index.assign(image.data(), image.size()));
+    ASSERT_EQ(index.bucket_nums(), 3u);
+    ASSERT_EQ(index.count(won3), wonIds.size());
+    ASSERT_EQ(index.count(set_updateFlag_of_analysisData(won3, true)), wonIds.size());
+    ASSERT_EQ(index.count(transformed), 0u);
+    ASSERT_EQ(index.count(to_analysisData(false, 4, AnalysisStatus::Won)), 0u);
+
+    // All the IDs, and IDs from the middle of each container.
+    std::vector<PositionId> ids(wonIds.size() + 1u);
+    ASSERT_EQ(index.list(won3, 0u, ids.data(), ids.size()), wonIds.size());
+    for (std::size_t i = 0u; i < wonIds.size(); i++) {
+        ASSERT_EQ(ids[i], wonIds[i]);
+    }
+    ASSERT_EQ(index.list(won3, 30000u, ids.data(), 2u), 2u);
+    ASSERT_EQ(ids[0], 30007u);
+    ASSERT_EQ(ids[1], 31007u);
+    ASSERT_EQ(index.list(won3, 2u * StatusIndexContainerSize + 100u, ids.data(), 2u), 2u);
+    ASSERT_EQ(ids[0], 2u * StatusIndexContainerSize + 102u);
+    ASSERT_EQ(ids[1], 2u * StatusIndexContainerSize + 105u);
+    ASSERT_EQ(index.list(won3, 3u * StatusIndexContainerSize, ids.data(), ids.size()), 0u);
+
+    std::uint64_t lostNums = index.count(lost2);
+    std::uint64_t unfixedNums = index.count(unfixed);
+    ASSERT_EQ(wonIds.size() + lostNums + unfixedNums, 2u * StatusIndexContainerSize - transformedNums);
+
+    // A truncated image is rejected.
+    ASSERT_FALSE(index.assign(image.data(), image.size() - 8u));
+    ASSERT_TRUE(index.empty());
+    ASSERT_EQ(index.count(won3), 0u);
+}
@@ -0,0 +1,73 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#include <cstring>
+#include "thread_affinity.hpp"
+
+#if defined(__linux__) && defined(HAVE_SCHED_H)
+extern "C" {
+#include <sched.h>
+}
+#define GOBB_ANALYZER_USE_SCHED_AFFINITY
+#endif
+
+namespace gobb_analyzer {
+
+ThreadAffinityGuard::ThreadAffinityGuard()
+    : savedMask_(),
+      pinned_(false) {
+#if defined(GOBB_ANALYZER_USE_SCHED_AFFINITY)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        savedMask_.resize(sizeof(mask));
+        std::memcpy(savedMask_.data(), &mask, sizeof(mask));
+    }
+#endif
+}
+
+ThreadAffinityGuard::~ThreadAffinityGuard() {
+#if defined(GOBB_ANALYZER_USE_SCHED_AFFINITY)
+    if (pinned_ && savedMask_.size() == sizeof(cpu_set_t)) {
+        cpu_set_t mask;
+        std::memcpy(&mask, savedMask_.data(), sizeof(mask));
+        sched_setaffinity(0, sizeof(mask), &mask);
+    }
+#endif
+}
+
+bool ThreadAffinityGuard::pin(int cpu) noexcept {
+#if defined(GOBB_ANALYZER_USE_SCHED_AFFINITY)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+        return false;
+    }
+    pinned_ = true;
+    return true;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+} // namespace gobb_analyzer
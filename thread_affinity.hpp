@@ -0,0 +1,75 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#ifndef GOBB_ANALYZER_THREAD_AFFINITY_HPP
+#define GOBB_ANALYZER_THREAD_AFFINITY_HPP
+
+#include <vector>
+
+///
+/// @file   thread_affinity.hpp
+/// @brief  Define `ThreadAffinityGuard` class.
+///
+namespace gobb_analyzer {
+
+///
+/// Pin the calling thread to a CPU, and restore the original CPU affinity on destruction.
+///
+/// Pinning is available only on Linux.  Elsewhere pin() always fails and the guard does nothing.
+///
+class ThreadAffinityGuard {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// It saves the CPU affinity of the calling thread.
+    ///
+    ThreadAffinityGuard();
+
+    ThreadAffinityGuard(const ThreadAffinityGuard& other) = delete;
+    ThreadAffinityGuard(ThreadAffinityGuard&& other) = delete;
+    ThreadAffinityGuard& operator=(const ThreadAffinityGuard& other) = delete;
+    ThreadAffinityGuard& operator=(ThreadAffinityGuard&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    /// If the calling thread has been pinned, its saved CPU affinity is restored.  It must be destroyed
+    /// on the thread which has constructed it.
+    ///
+    ~ThreadAffinityGuard();
+
+    ///
+    /// Pin the calling thread to a CPU.
+    ///
+    /// @param   cpu  a CPU number.
+    /// @return  true upon success.
+    ///
+    bool pin(int cpu) noexcept;
+
+private:
+    /// The saved CPU affinity (`cpu_set_t`), or empty if it is not saved.
+    std::vector<unsigned char> savedMask_;
+
+    /// Whether the calling thread has been pinned.
+    bool pinned_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_THREAD_AFFINITY_HPP
@@ -0,0 +1,116 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_THREAD_BARRIER_HPP
+#define GOBB_ANALYZER_THREAD_BARRIER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+///
+/// @file   thread_barrier.hpp
+/// @brief  Define `ThreadBarrier` class.
+///
+namespace gobb_analyzer {
+
+///
+/// A reusable barrier for a fixed number of threads.
+///
+/// It is a minimal substitute for `std::barrier` in C++20.
+///
+class ThreadBarrier {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   threadNums  the number of threads which arrive at the barrier in each phase.
+    ///
+    explicit ThreadBarrier(std::size_t threadNums)
+        : expectedNums_(threadNums),
+          arrivedNums_(0u),
+          phase_(0u) {
+    }
+
+    ThreadBarrier(const ThreadBarrier& other) = delete;
+    ThreadBarrier(ThreadBarrier&& other) = delete;
+    ThreadBarrier& operator=(const ThreadBarrier& other) = delete;
+    ThreadBarrier& operator=(ThreadBarrier&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    ~ThreadBarrier() = default;
+
+    ///
+    /// Arrive at the barrier, and wait until all the threads arrive.
+    ///
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::size_t phase = phase_;
+        arrivedNums_++;
+        if (arrivedNums_ >= expectedNums_) {
+            complete_phase();
+            return;
+        }
+        condition_.wait(lock, [this, phase] { return phase_ != phase; });
+    }
+
+    ///
+    /// Leave the barrier permanently.
+    ///
+    /// The number of threads expected in the current and subsequent phases decreases by one.
+    ///
+    void arrive_and_drop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        expectedNums_--;
+        if (arrivedNums_ >= expectedNums_) {
+            complete_phase();
+        }
+    }
+
+private:
+    ///
+    /// Release the threads waiting at the barrier, and start the next phase.
+    ///
+    /// The mutex must be locked by the caller.
+    ///
+    void complete_phase() {
+        arrivedNums_ = 0u;
+        phase_++;
+        condition_.notify_all();
+    }
+
+    /// The number of threads expected to arrive in a phase.
+    std::size_t expectedNums_;
+
+    /// The number of threads arrived in the current phase.
+    std::size_t arrivedNums_;
+
+    /// The current phase number.
+    std::size_t phase_;
+
+    /// Mutex guarding the members above.
+    std::mutex mutex_;
+
+    /// Condition variable to wait for the completion of a phase.
+    std::condition_variable condition_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_THREAD_BARRIER_HPP
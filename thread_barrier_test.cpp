@@ -0,0 +1,101 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "run_threads.hpp"
+#include "thread_barrier.hpp"
+#include "gtest/gtest.h"
+
+using namespace gobb_analyzer;
+
+//
+// Test that no thread passes ThreadBarrier::wait() before all the threads arrive.
+//
+TEST(ThreadBarrierTest, Wait) {
+    constexpr int threadNums = 4;
+    constexpr int roundNums = 100;
+    ThreadBarrier barrier(threadNums);
+    std::vector<std::atomic<int>> arrivedNums(roundNums);
+    std::atomic<bool> failed(false);
+
+    run_threads(threadNums, [&](int) {
+        for (int round = 0; round < roundNums; round++) {
+            arrivedNums[round]++;
+            barrier.wait();
+            if (arrivedNums[round] != threadNums) {
+                failed = true;
+            }
+        }
+    });
+    ASSERT_FALSE(failed);
+}
+
+//
+// Test that the other threads go on after a thread leaves by ThreadBarrier::arrive_and_drop().
+//
+TEST(ThreadBarrierTest, ArriveAndDrop) {
+    constexpr int threadNums = 3;
+    constexpr int roundNums = 50;
+    ThreadBarrier barrier(threadNums);
+    std::vector<std::atomic<int>> arrivedNums(roundNums);
+    std::atomic<bool> failed(false);
+
+    // The thread 2 leaves after the round 0, and the thread 1 leaves after the round 10.
+    run_threads(threadNums, [&](int thread) {
+        for (int round = 0; round < roundNums; round++) {
+            if ((thread == 2 && round == 1) || (thread == 1 && round == 11)) {
+                barrier.arrive_and_drop();
+                return;
+            }
+            arrivedNums[round]++;
+            barrier.wait();
+            int expectedNums = (round == 0) ? 3 : (round <= 10) ? 2 : 1;
+            if (arrivedNums[round] != expectedNums) {
+                failed = true;
+            }
+        }
+    });
+    ASSERT_FALSE(failed);
+}
+
+//
+// Test that ThreadBarrier::arrive_and_drop() releases the threads already waiting.
+//
+TEST(ThreadBarrierTest, ArriveAndDropReleasesWaitingThreads) {
+    ThreadBarrier barrier(3);
+    std::atomic<int> passedNums(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++) {
+        threads.emplace_back([&] {
+            barrier.wait();
+            passedNums++;
+        });
+    }
+
+    // Two threads wait for the third, which never arrives.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(passedNums, 0);
+    barrier.arrive_and_drop();
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+    ASSERT_EQ(passedNums, 2);
+}
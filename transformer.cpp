@@ -30,7 +30,7 @@ const std::array<TransformerId, TransformerIdNums> TransformerIds = {
     TransformerId::MirrorRotate270
 };
 
-const std::array<TransformerId, TransformerIdNums> InverseTransformerIds = {
+const std::array<TransformerId, TransformerIdNums> AntitransformerIds = {
     TransformerId::Unchange,
     TransformerId::Rotate270,
     TransformerId::Rotate180,
@@ -1,6 +1,6 @@
 #ifndef GOBB_ANALYZER_VERSION_HPP
 #define GOBB_ANALYZER_VERSION_HPP
 
-#define GOBB_ANALYZER_VERSION "1.0.0"
+#define GOBB_ANALYZER_VERSION "1.1.0"
 
 #endif // GOBB_ANALYZER_VERSION_HPP
@@ -0,0 +1,480 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include <chrono>
+#include <vector>
+#include "wdl_analyzer.hpp"
+#include "run_threads.hpp"
+
+namespace gobb_analyzer {
+
+static_assert(sizeof(std::atomic<std::uint8_t>) == 1u, "a WDL table must be stored as bytes");
+
+//
+// A propagation pass follows when the positions fixed in the last pass, multiplied by it, are fewer than
+// the unfixed positions.  A position before another costs about 4 times as much to look up as a position
+// after another, in a late-game part of the table.
+//
+constexpr std::size_t WdlPropagationCostRatio = 4u;
+
+//
+// Return true if a byte of a WDL table has `WdlValue::Unknown`, whose bits are 00.
+//
+inline bool has_unknown_value(std::uint8_t byte) noexcept {
+    return ((byte | (byte >> 1)) & 0x55u) != 0x55u;
+}
+
+//
+// Class WdlAnalyzer.
+//
+WdlAnalyzer::WdlAnalyzer(AnalysisLogger& logger)
+    : table_(new std::atomic<std::uint8_t>[WdlTableSize]()),
+      marks_(new std::atomic<std::uint8_t>[WdlMarkTableSize]()),
+      statistics_(),
+      threadNums_(1),
+      stopFlag_(nullptr),
+      interrupted_(false),
+      logger_(logger) {
+    logger_.notice("WDL table: {} bytes.", WdlTableSize);
+    logger_.notice("WDL marks: {} bytes.", WdlMarkTableSize);
+}
+
+void WdlAnalyzer::set_thread_nums(int threadNums) noexcept {
+    if (threadNums < 1) {
+        threadNums_ = 1;
+    } else {
+        threadNums_ = threadNums;
+    }
+}
+
+void WdlAnalyzer::set_stop_flag(const volatile std::sig_atomic_t* stopFlag) noexcept {
+    stopFlag_ = stopFlag;
+}
+
+bool WdlAnalyzer::interrupted() const noexcept {
+    return interrupted_;
+}
+
+bool WdlAnalyzer::start(AnalysisDataIOHandler& handler) {
+    logger_.notice("start the WDL initialization.");
+    statistics_.clear();
+    run_in_parallel([this](PositionId begin, PositionId end, AnalysisStatistics& stats) {
+        initialize_range(begin, end, stats);
+    }, statistics_);
+    log_statistics(0, true, statistics_);
+    return analyze(handler);
+}
+
+bool WdlAnalyzer::resume(AnalysisDataIOHandler& handler) {
+    //
+    // No thread runs yet, so that the table can be written as plain bytes.
+    //
+    bool complete;
+    if (!handler.load_wdl(statistics_, complete, reinterpret_cast<std::uint8_t*>(table_.get()), WdlTableSize)) {
+        logger_.warn("no partial WDL data found.");
+        return start(handler);
+    }
+    if (complete) {
+        logger_.notice("the WDL analysis is already complete.");
+        return true;
+    }
+    logger_.notice("resume the WDL analysis from the partial data.");
+    return analyze(handler);
+}
+
+bool WdlAnalyzer::analyze(AnalysisDataIOHandler& handler) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    //
+    // Marks are not stored with a partial result, so that the first pass is always a scan.
+    //
+    bool scanning = true;
+    std::size_t unfixedNums = 0u;
+    for (int pass = 1; ; pass++) {
+        if (stopFlag_ != nullptr && *stopFlag_ != 0) {
+            logger_.notice("the analysis is interrupted.");
+            interrupted_ = true;
+            return store(handler, false);
+        }
+
+        AnalysisStatistics passStats;
+        std::size_t fixedNums;
+        if (scanning) {
+            run_in_parallel([this](PositionId begin, PositionId end, AnalysisStatistics& stats) {
+                scan_range(begin, end, stats);
+            }, passStats);
+            fixedNums = passStats.lostNums + passStats.wonNums;
+            unfixedNums = passStats.unfixedNums;
+            passStats.unfixedNums = 0u;
+        } else {
+            run_in_parallel([this](PositionId begin, PositionId end, AnalysisStatistics& stats) {
+                analyze_range(begin, end, stats);
+            }, passStats);
+            fixedNums = passStats.lostNums + passStats.wonNums;
+            unfixedNums -= fixedNums;
+        }
+        statistics_.add(passStats);
+        log_statistics(pass, scanning, passStats);
+        if (fixedNums == 0u) {
+            break;
+        }
+        scanning = (fixedNums * WdlPropagationCostRatio >= unfixedNums);
+    }
+
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+    logger_.notice("no update occurred. the analysis is complete. ({:.3f} sec.)", elapsedTime.count());
+    return store(handler, true);
+}
+
+bool WdlAnalyzer::store(AnalysisDataIOHandler& handler, bool complete) {
+    //
+    // All the threads have been joined, so that the table can be read as plain bytes.
+    //
+    if (!handler.store_wdl(statistics_, complete, reinterpret_cast<const std::uint8_t*>(table_.get()),
+        WdlTableSize)) {
+        logger_.error("failed to store the WDL data.");
+        return false;
+    }
+    if (complete) {
+        logger_.notice("stored the WDL data.");
+    } else {
+        logger_.notice("stored the partial WDL data.");
+    }
+    return true;
+}
+
+template <typename Func>
+void WdlAnalyzer::run_in_parallel(Func func, AnalysisStatistics& stats) {
+    std::size_t rangeSize = (AnalysisDataTableSize + threadNums_ - 1) / threadNums_;
+    rangeSize = (rangeSize + WdlMarksPerByte - 1u) / WdlMarksPerByte * WdlMarksPerByte;
+    std::vector<AnalysisStatistics> threadStats(threadNums_);
+
+    auto worker = [&](int range) {
+        std::size_t begin = range * rangeSize;
+        std::size_t end = begin + rangeSize;
+        if (begin > AnalysisDataTableSize) {
+            begin = AnalysisDataTableSize;
+        }
+        if (end > AnalysisDataTableSize) {
+            end = AnalysisDataTableSize;
+        }
+        func(begin, end, threadStats[range]);
+    };
+
+    //
+    // The calling thread works on the range 0.
+    //
+    run_threads(threadNums_, worker);
+
+    for (const AnalysisStatistics& threadStat: threadStats) {
+        stats.lostNums          += threadStat.lostNums;
+        stats.lostStalemateNums += threadStat.lostStalemateNums;
+        stats.wonNums           += threadStat.wonNums;
+        stats.transformedNums   += threadStat.transformedNums;
+        stats.contradictoryNums += threadStat.contradictoryNums;
+        stats.unfixedNums       += threadStat.unfixedNums;
+    }
+}
+
+void WdlAnalyzer::initialize_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept {
+    //
+    // Initial values are decided by the same rules as `Analyzer::initialize()`.
+    //
+    for (PositionId i = begin; i < end; i++) {
+        Position pos(i);
+        bool transformed = false;
+        for (TransformerId trans: EffectiveTransformerIds) {
+            if (pos.transform(trans).id() < i) {
+                transformed = true;
+                break;
+            }
+        }
+        if (transformed) {
+            set_value(i, WdlValue::Excluded);
+            stats.transformedNums++;
+            continue;
+        }
+
+        int activePieceNums = on_board_piece_nums(pos, PlayerId::Active);
+        int inactivePieceNums = on_board_piece_nums(pos, PlayerId::Inactive);
+        if (pos.is_winner(PlayerId::Active) ||
+            (activePieceNums == 0 && inactivePieceNums >= 2) ||
+            (inactivePieceNums == 0 && activePieceNums >= 1)) {
+            set_value(i, WdlValue::Excluded);
+            stats.contradictoryNums++;
+            continue;
+        }
+
+        if (pos.is_winner(PlayerId::Inactive)) {
+            set_value(i, WdlValue::Lost);
+            stats.lostNums++;
+            continue;
+        }
+        if (move_nums(pos) == 0) {
+            set_value(i, WdlValue::Lost);
+            stats.lostStalemateNums++;
+            continue;
+        }
+
+        stats.unfixedNums++;
+    }
+}
+
+void WdlAnalyzer::scan_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept {
+    static_assert(WdlMarksPerByte == WdlValuesPerByte * 2u, "a byte of marks must cover 2 bytes of values");
+
+    PositionId i = begin;
+    while (i < end) {
+        //
+        // No other thread writes the range in a scan pass.  A position fixed in a previous pass has been
+        // seen by all the unfixed positions in this pass, so that only the positions fixed in this pass
+        // keep their marks.  Positions of a byte of marks are skipped at once if none of them is unfixed.
+        //
+        std::atomic<std::uint8_t>& markByte = marks_[i / WdlMarksPerByte];
+        if (i % WdlMarksPerByte == 0u) {
+            markByte.store(0u, std::memory_order_relaxed);
+            if (i + WdlMarksPerByte <= end &&
+                !has_unknown_value(table_[i / WdlValuesPerByte].load(std::memory_order_relaxed)) &&
+                !has_unknown_value(table_[i / WdlValuesPerByte + 1u].load(std::memory_order_relaxed))) {
+                i += WdlMarksPerByte;
+                continue;
+            }
+        }
+        if (value(i) != WdlValue::Unknown) {
+            i++;
+            continue;
+        }
+
+        WdlValue newValue = evaluate_moves(Position(i));
+        if (newValue == WdlValue::Unknown) {
+            stats.unfixedNums++;
+            i++;
+            continue;
+        }
+        set_value(i, newValue);
+        markByte.store(static_cast<std::uint8_t>(markByte.load(std::memory_order_relaxed) |
+            (1u << (i % WdlMarksPerByte))), std::memory_order_relaxed);
+        if (newValue == WdlValue::Won) {
+            stats.wonNums++;
+        } else {
+            stats.lostNums++;
+        }
+        i++;
+    }
+}
+
+void WdlAnalyzer::analyze_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept {
+    PositionId i = begin;
+    while (i < end) {
+        //
+        // Most of the positions are not marked in a late pass, so that a byte of no mark is skipped at once.
+        //
+        if (marks_[i / WdlMarksPerByte].load(std::memory_order_relaxed) == 0u) {
+            i = (i / WdlMarksPerByte + 1u) * WdlMarksPerByte;
+            continue;
+        }
+        if (unmark(i)) {
+            analyze_position(i, stats);
+        }
+        i++;
+    }
+}
+
+void WdlAnalyzer::analyze_position(PositionId id, AnalysisStatistics& stats) noexcept {
+    const Position pos(id);
+    WdlValue current = value(id);
+
+    if (current == WdlValue::Unknown) {
+        //
+        // If another thread fixes the position first, it also marks the position again.
+        //
+        current = evaluate_moves(pos);
+        if (current == WdlValue::Unknown || !fix_value(id, current)) {
+            return;
+        }
+        if (current == WdlValue::Won) {
+            stats.wonNums++;
+        } else {
+            stats.lostNums++;
+        }
+    }
+    if (current != WdlValue::Lost && current != WdlValue::Won) {
+        return;
+    }
+
+    //
+    // A position before a Lost position is Won.  A position before a Won position may become Lost, and
+    // it is visited again.
+    //
+    for (PieceId piece: InactivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: LocationIds) {
+                MoveResult moveResult = pos.move_back(piece, src, dst);
+                if (moveResult.status != MoveResultStatus::Success) {
+                    continue;
+                }
+                PositionId prevId = moveResult.position.minimize_id();
+                if (current == WdlValue::Lost) {
+                    if (fix_value(prevId, WdlValue::Won)) {
+                        mark(prevId);
+                        stats.wonNums++;
+                    }
+                } else if (value(prevId) == WdlValue::Unknown) {
+                    mark(prevId);
+                }
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+}
+
+WdlValue WdlAnalyzer::evaluate_moves(const Position& pos) const noexcept {
+    //
+    // A position is Won as soon as a move reaches a Lost position.  Otherwise it is Lost if all the moves
+    // reach Won positions.
+    //
+    bool allWon = true;
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int j = 0; j < 2; j++) {
+            LocationId src = locPair.locations[j];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status != MoveResultStatus::Success) {
+                    continue;
+                }
+                WdlValue dstValue = value(moveResult.position.minimize_id());
+                if (dstValue == WdlValue::Lost) {
+                    return WdlValue::Won;
+                } else if (dstValue != WdlValue::Won) {
+                    allWon = false;
+                }
+            }
+            if (locPair.locations[0] == locPair.locations[1]) {
+                break;
+            }
+        }
+    }
+
+    if (allWon) {
+        return WdlValue::Lost;
+    }
+    return WdlValue::Unknown;
+}
+
+WdlValue WdlAnalyzer::value(PositionId id) const noexcept {
+    std::uint8_t byte = table_[id / WdlValuesPerByte].load(std::memory_order_relaxed);
+    return wdlValue_of_byte(byte, id);
+}
+
+void WdlAnalyzer::set_value(PositionId id, WdlValue value) noexcept {
+    std::atomic<std::uint8_t>& byte = table_[id / WdlValuesPerByte];
+    byte.store(set_wdlValue_of_byte(byte.load(std::memory_order_relaxed), id, value), std::memory_order_relaxed);
+}
+
+bool WdlAnalyzer::fix_value(PositionId id, WdlValue value) noexcept {
+    std::atomic<std::uint8_t>& byte = table_[id / WdlValuesPerByte];
+    std::uint8_t current = byte.load(std::memory_order_relaxed);
+    do {
+        if (wdlValue_of_byte(current, id) != WdlValue::Unknown) {
+            return false;
+        }
+    } while (!byte.compare_exchange_weak(current, set_wdlValue_of_byte(current, id, value),
+        std::memory_order_relaxed));
+    return true;
+}
+
+//
+// Marks are set and cleared with release and acquire, so that a thread visiting a position sees the values
+// which made another thread mark it.  Otherwise the visit could read an old value and drop the mark.
+//
+void WdlAnalyzer::mark(PositionId id) noexcept {
+    std::uint8_t bit = static_cast<std::uint8_t>(1u << (id % WdlMarksPerByte));
+    marks_[id / WdlMarksPerByte].fetch_or(bit, std::memory_order_acq_rel);
+}
+
+bool WdlAnalyzer::unmark(PositionId id) noexcept {
+    std::uint8_t bit = static_cast<std::uint8_t>(1u << (id % WdlMarksPerByte));
+    return (marks_[id / WdlMarksPerByte].fetch_and(static_cast<std::uint8_t>(~bit), std::memory_order_acq_rel)
+        & bit) != 0u;
+}
+
+int WdlAnalyzer::move_nums(const Position& pos) const noexcept {
+    int nums = 0;
+
+    for (PieceId piece: ActivePlayerPieceIds) {
+        LocationIdPair locPair = pos.locations_of_piece(piece);
+
+        for (int i = 0; i < 2; i++) {
+            LocationId src = locPair.locations[i];
+
+            for (LocationId dst: OnBoardLocationIds) {
+                MoveResult moveResult = pos.move(piece, src, dst);
+                if (moveResult.status == MoveResultStatus::Success) {
+                    nums++;
+                }
+            }
+        }
+    }
+
+    return nums;
+}
+
+int WdlAnalyzer::on_board_piece_nums(const Position& pos, PlayerId player) const noexcept {
+    const auto& pieceIds = (player == PlayerId::Active) ? ActivePlayerPieceIds : InactivePlayerPieceIds;
+    int nums = 0;
+
+    for (PieceId piece: pieceIds) {
+        const LocationIdPair locPair = pos.locations_of_piece(piece);
+        for (int i = 0; i < 2; i++) {
+            if (locPair.locations[i] != LocationId::Out) {
+                nums++;
+            }
+        }
+    }
+
+    return nums;
+}
+
+void WdlAnalyzer::log_statistics(int pass, bool scanned, const AnalysisStatistics& stats) {
+    if (pass == 0) {
+        logger_.info("WDL result of the initialization:");
+    } else {
+        logger_.info("WDL result of the pass {} ({}):", pass, scanned ? "scan" : "propagation");
+        logger_.info("  fixed positions during this pass:");
+        logger_.info("    lost          = {}", stats.lostNums);
+        logger_.info("    won           = {}", stats.wonNums);
+    }
+
+    logger_.info("  total:");
+    logger_.info("    lost          = {}", statistics_.lostNums + statistics_.lostStalemateNums);
+    logger_.info("    won           = {}", statistics_.wonNums);
+    logger_.info("    transformed   = {}", statistics_.transformedNums);
+    logger_.info("    contradictory = {}", statistics_.contradictoryNums);
+    logger_.info("    unfixed       = {}", statistics_.unfixedNums);
+    logger_.info();
+}
+
+} // namespace gobb_analyzer
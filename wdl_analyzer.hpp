@@ -0,0 +1,371 @@
+//
+// Copyright (C) 2022 Motoyuki Kasahara.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef GOBB_ANALYZER_WDL_ANALYZER_HPP
+#define GOBB_ANALYZER_WDL_ANALYZER_HPP
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "analyzer.hpp"
+
+///
+/// @file   wdl_analyzer.hpp
+/// @brief  Define `WdlAnalyzer` class, which solves win/draw/loss of positions without remaining turns.
+///
+namespace gobb_analyzer {
+
+///
+/// Win/draw/loss of a position for the active player, recorded in 2 bits.
+///
+enum class WdlValue: std::uint8_t {
+    Unknown  = 0,  ///< Not fixed.  It means a draw after the analysis is complete.
+    Lost     = 1,  ///< The active player loses.
+    Won      = 2,  ///< The active player wins.
+    Excluded = 3   ///< Transformed or contradictory.
+};
+
+/// The number of positions packed in a byte of a WDL table.
+constexpr std::size_t WdlValuesPerByte = 4u;
+
+/// The number of bytes of a WDL table.
+constexpr std::size_t WdlTableSize = (AnalysisDataTableSize + WdlValuesPerByte - 1u) / WdlValuesPerByte;
+
+/// The number of positions in a byte of the marks of positions to be visited.
+constexpr std::size_t WdlMarksPerByte = 8u;
+
+/// The number of bytes of the marks of positions to be visited.
+constexpr std::size_t WdlMarkTableSize = (AnalysisDataTableSize + WdlMarksPerByte - 1u) / WdlMarksPerByte;
+
+///
+/// Get a WDL value from a byte of a WDL table.
+///
+/// @param   byte  a byte of a WDL table.
+/// @param   id    a position ID.
+/// @return  the WDL value of the position.
+///
+/// Positions in a WDL table are indexed by position IDs; the byte `id / WdlValuesPerByte` holds the
+/// value of the position `id`.
+///
+inline WdlValue wdlValue_of_byte(std::uint8_t byte, PositionId id) noexcept {
+    return static_cast<WdlValue>((byte >> ((id % WdlValuesPerByte) * 2u)) & 0x03u);
+}
+
+///
+/// Set a WDL value in a byte of a WDL table.
+///
+/// @param   byte   a byte of a WDL table.
+/// @param   id     a position ID.
+/// @param   value  a WDL value.
+/// @return  the byte with the new value of the position.
+///
+inline std::uint8_t set_wdlValue_of_byte(std::uint8_t byte, PositionId id, WdlValue value) noexcept {
+    unsigned int shift = (id % WdlValuesPerByte) * 2u;
+    return static_cast<std::uint8_t>((byte & ~(0x03u << shift)) | (static_cast<unsigned int>(value) << shift));
+}
+
+///
+/// Convert a WDL value to an analysis status.
+///
+/// @param   value  a WDL value.
+/// @return  `AnalysisStatus::Unfixed`, `AnalysisStatus::Lost`, `AnalysisStatus::Won` or
+///          `AnalysisStatus::Contradictory`.
+///
+inline AnalysisStatus wdlValue_to_analysisStatus(WdlValue value) noexcept {
+    switch (value) {
+    case WdlValue::Lost:
+        return AnalysisStatus::Lost;
+    case WdlValue::Won:
+        return AnalysisStatus::Won;
+    case WdlValue::Excluded:
+        return AnalysisStatus::Contradictory;
+    default:
+        return AnalysisStatus::Unfixed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+///
+/// Solver of win/draw/loss of all positions.
+///
+/// Unlike `Analyzer`, it doesn't record the number of remaining turns, so that a position is never
+/// revisited once it is fixed, and the table needs only 2 bits per position.
+/// The analysis proceeds in passes of two kinds.  A scan pass visits all the unfixed positions: each of
+/// them looks up the positions after its moves, and becomes Won if one of them is Lost, or Lost if all of
+/// them are Won.  The table is updated in place, so that a position fixed in a pass is seen by the
+/// following positions in the same pass.
+/// A propagation pass visits only marked positions, with a mark of 1 bit per position in place of the
+/// update flag of `Analyzer`.  When a position becomes Lost, the positions before it (found by
+/// `Position::move_back()`) become Won at once.  When a position becomes Won, the unfixed positions before
+/// it are marked, and they look up the positions after their moves when they are visited.  A position
+/// marked in a pass is visited in the same pass if it comes later, or in the next pass.
+/// Looking up the positions before a position costs several times as much as the positions after it, so
+/// that a scan is faster while many positions are fixed in a pass.  The first pass is a scan, which
+/// marks the positions it fixes, and propagation passes follow once the positions fixed in a pass are
+/// few compared with the unfixed positions.
+/// The analysis is complete when a pass fixes no position.  Win/draw/loss of each position is the same as
+/// that of `Analyzer`.
+///
+class WdlAnalyzer {
+public:
+    ///
+    /// Constructor.
+    ///
+    /// @param   logger  a logger.
+    ///
+    /// It throws `std::bad_alloc` if it fails to allocate the table.
+    ///
+    WdlAnalyzer(AnalysisLogger& logger);
+
+    WdlAnalyzer(const WdlAnalyzer& other) = delete;
+    WdlAnalyzer(WdlAnalyzer&& other) = delete;
+    WdlAnalyzer& operator=(const WdlAnalyzer& other) = delete;
+    WdlAnalyzer& operator=(WdlAnalyzer&& other) = delete;
+
+    ///
+    /// Destructor.
+    ///
+    virtual ~WdlAnalyzer() = default;
+
+    ///
+    /// Solve win/draw/loss of all positions, and store the result.
+    ///
+    /// @param   handler  an I/O handler to store the result.
+    /// @return  true upon success.
+    ///
+    /// If the stop flag is set, it stops between passes, stores the partial result, and returns true
+    /// with interrupted() being true.
+    ///
+    bool start(AnalysisDataIOHandler& handler);
+
+    ///
+    /// Resume solving win/draw/loss from a partial result stored on a stop request.
+    ///
+    /// @param   handler  an I/O handler to load and store the result.
+    /// @return  true upon success.
+    ///
+    /// It starts from the beginning if no result is stored, and does nothing if the stored result is
+    /// complete.  Since a fixed position is never changed, unfixed positions of the partial result are
+    /// analyzed from a scan pass.
+    ///
+    bool resume(AnalysisDataIOHandler& handler);
+
+    ///
+    /// Set the number of threads.
+    ///
+    /// @param   threadNums  the number of threads.  If it is less than 1, 1 is used.
+    ///
+    /// Each thread visits positions in its own range of position IDs, while it reads the whole table.  In a
+    /// propagation pass, it also fixes and marks positions in the other ranges with atomic updates.
+    ///
+    void set_thread_nums(int threadNums) noexcept;
+
+    ///
+    /// Set a flag to request the analyzer to stop.
+    ///
+    /// @param   stopFlag  a flag set to non-zero by a signal handler, or nullptr.
+    ///
+    void set_stop_flag(const volatile std::sig_atomic_t* stopFlag) noexcept;
+
+    ///
+    /// Whether the last analysis has stopped on a stop request.
+    ///
+    /// @return  true if it has stopped before the analysis is complete.
+    ///
+    bool interrupted() const noexcept;
+
+private:
+    /// Unit tests access the internals through it.
+    friend class WdlAnalyzerTestPeer;
+
+    ///
+    /// Run passes until no position is fixed, and store the result.
+    ///
+    /// @param   handler  an I/O handler to store the result.
+    /// @return  true upon success.
+    ///
+    bool analyze(AnalysisDataIOHandler& handler);
+
+    ///
+    /// Store the table.
+    ///
+    /// @param   handler   an I/O handler to store the result.
+    /// @param   complete  false if the analysis has been interrupted.
+    /// @return  true upon success.
+    ///
+    bool store(AnalysisDataIOHandler& handler, bool complete);
+
+    ///
+    /// Run a function on ranges of position IDs in parallel.
+    ///
+    /// @param   func  a function called with the first position ID and the position ID next to the last
+    ///                of a range, and statistics of the range.
+    /// @param   stats  statistics summed up over the ranges.
+    ///
+    /// Ranges are aligned to `WdlMarksPerByte`, so that each byte of the table and of the marks is written
+    /// by a single thread in a scan pass.  It throws an exception if it fails to create threads.
+    ///
+    template <typename Func>
+    void run_in_parallel(Func func, AnalysisStatistics& stats);
+
+    ///
+    /// Set initial values of positions in a range.
+    ///
+    /// @param   begin  the first position ID of the range.
+    /// @param   end    the position ID next to the last of the range.
+    /// @param   stats  statistics of the range.
+    ///
+    void initialize_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept;
+
+    ///
+    /// Try to fix all the unfixed positions in a range, and mark the positions fixed.
+    ///
+    /// @param   begin  the first position ID of the range.
+    /// @param   end    the position ID next to the last of the range.
+    /// @param   stats  statistics of the range.  `unfixedNums` is the number of positions left unfixed.
+    ///
+    /// Marks of the previous pass in the range are cleared.
+    ///
+    void scan_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept;
+
+    ///
+    /// Visit the marked positions in a range.
+    ///
+    /// @param   begin  the first position ID of the range.
+    /// @param   end    the position ID next to the last of the range.
+    /// @param   stats  statistics of the range.
+    ///
+    void analyze_range(PositionId begin, PositionId end, AnalysisStatistics& stats) noexcept;
+
+    ///
+    /// Visit a marked position: try to fix it if it is unfixed, and then propagate its value to the
+    /// positions before it.
+    ///
+    /// @param   id     a position ID.
+    /// @param   stats  statistics of the range.
+    ///
+    void analyze_position(PositionId id, AnalysisStatistics& stats) noexcept;
+
+    ///
+    /// Look up the positions after the moves of a position.
+    ///
+    /// @param   pos  an unfixed position.
+    /// @return  `WdlValue::Won` if one of them is Lost, `WdlValue::Lost` if all of them are Won, or
+    ///          `WdlValue::Unknown` otherwise.
+    ///
+    WdlValue evaluate_moves(const Position& pos) const noexcept;
+
+    ///
+    /// Get the WDL value of a position.
+    ///
+    /// @param   id  a position ID.
+    /// @return  the WDL value.
+    ///
+    WdlValue value(PositionId id) const noexcept;
+
+    ///
+    /// Set the WDL value of a position.
+    ///
+    /// @param   id     a position ID.
+    /// @param   value  a WDL value.
+    ///
+    /// The byte holding the position must be written by the calling thread only.
+    ///
+    void set_value(PositionId id, WdlValue value) noexcept;
+
+    ///
+    /// Fix an unfixed position atomically.
+    ///
+    /// @param   id     a position ID.
+    /// @param   value  `WdlValue::Lost` or `WdlValue::Won`.
+    /// @return  true if the position was unfixed, false if it is unchanged.
+    ///
+    /// It may be called by any thread while the others read or fix positions in the same byte.
+    ///
+    bool fix_value(PositionId id, WdlValue value) noexcept;
+
+    ///
+    /// Mark a position to be visited.
+    ///
+    /// @param   id  a position ID.
+    ///
+    void mark(PositionId id) noexcept;
+
+    ///
+    /// Unmark a position.
+    ///
+    /// @param   id  a position ID.
+    /// @return  true if the position was marked.
+    ///
+    /// The values which the marking thread had written before `mark()` are seen after it returns true.
+    ///
+    bool unmark(PositionId id) noexcept;
+
+    ///
+    /// Return the number of possible moves of the position.
+    ///
+    /// @param   pos  a position.
+    /// @return  the number of moves.
+    ///
+    int move_nums(const Position& pos) const noexcept;
+
+    ///
+    /// Return the number of pieces of the player on the board.
+    ///
+    /// @param   pos     a position.
+    /// @param   player  a player.
+    /// @return  the number of pieces.
+    ///
+    int on_board_piece_nums(const Position& pos, PlayerId player) const noexcept;
+
+    ///
+    /// Log statistics of the analysis.
+    ///
+    /// @param   pass     a pass number (0 means the initialization).
+    /// @param   scanned  whether the pass has been a scan.
+    /// @param   stats    statistics of the pass.
+    ///
+    void log_statistics(int pass, bool scanned, const AnalysisStatistics& stats);
+
+    /// WDL values of all positions.  Bytes are read by all threads while they are written.
+    std::unique_ptr<std::atomic<std::uint8_t>[]> table_;
+
+    /// Marks of positions to be visited, a bit per position.
+    std::unique_ptr<std::atomic<std::uint8_t>[]> marks_;
+
+    /// Statistics of the analysis.
+    AnalysisStatistics statistics_;
+
+    /// The number of threads.
+    int threadNums_;
+
+    /// A flag to request the analyzer to stop.
+    const volatile std::sig_atomic_t* stopFlag_;
+
+    /// Whether the last analysis has stopped on a stop request.
+    bool interrupted_;
+
+    /// Logger.
+    AnalysisLogger& logger_;
+};
+
+} // namespace gobb_analyzer
+
+#endif // GOBB_ANALYZER_WDL_ANALYZER_HPP